@@ -190,6 +190,19 @@ ULS_QUALIFIED_METHOD(reset_csz)(void)
 #endif
 }
 
+void
+ULS_QUALIFIED_METHOD(csz_get_pool_stats)(uls_uint64 *n_hits, uls_uint64 *n_misses)
+{
+#ifndef NO_CSZ_POOL
+	uls_lock_mutex(uls_ptr(csz_global->mtx));
+	*n_hits = csz_global->n_hits;
+	*n_misses = csz_global->n_misses;
+	uls_unlock_mutex(uls_ptr(csz_global->mtx));
+#else
+	*n_hits = *n_misses = 0;
+#endif
+}
+
 void
 ULS_QUALIFIED_METHOD(initialize_csz)(void)
 {
@@ -201,6 +214,7 @@ ULS_QUALIFIED_METHOD(initialize_csz)(void)
 	uls_init_mutex(uls_ptr(csz_global->mtx));
 	csz_global->inactive_list = nilptr;
 	csz_global->active_list = nilptr;
+	csz_global->n_hits = csz_global->n_misses = 0;
 
 	__init_csz_pool();
 #endif
@@ -234,7 +248,11 @@ ULS_QUALIFIED_METHOD(str_init)(uls_outbuf_ptr_t outbuf, int siz)
 	}
 #ifndef NO_CSZ_POOL
 	uls_lock_mutex(uls_ptr(csz_global->mtx));
-	__find_in_pool(outbuf, siz);
+	if (__find_in_pool(outbuf, siz) != NULL) {
+		++csz_global->n_hits;
+	} else {
+		++csz_global->n_misses;
+	}
 	uls_unlock_mutex(uls_ptr(csz_global->mtx));
 #endif
 	if (outbuf->buf == NULL) {
@@ -40,6 +40,7 @@ ULS_QUALIFIED_METHOD(uls_init_hash_stat)(uls_hash_stat_ptr_t hs)
 	int i;
 	uls_init_intarray(hs->weight, 3);
 	for (i = 0; i < 3; i++) hs->weight[i] = 1;
+	hs->table_size = ULF_HASH_TABLE_SIZE;
 }
 
 void
@@ -59,6 +60,7 @@ ULS_QUALIFIED_METHOD(uls_copy_hash_stat)(uls_hash_stat_ptr_t hs_src,
 	for (i = 0; i < 3; i++) {
 		weights_dst[i] = weights_src[i];
 	}
+	hs_dst->table_size = hs_src->table_size;
 }
 
 ULS_DECL_STATIC int
@@ -80,10 +82,10 @@ ULS_QUALIFIED_METHOD(__keyw_strncmp_case_sensitive)(const char *str1, const char
 }
 
 ULS_DECL_STATIC int
-ULS_QUALIFIED_METHOD(__keyw_hashfunc_case_sensitive)(uls_hash_stat_ptr_t hs, const char *name)
+ULS_QUALIFIED_METHOD(__keyw_hash)(uls_hash_stat_ptr_t hs, const char *name, int len)
 {
 	uls_ref_intarray(weights, hs->weight);
-	int i, j, len = _uls_tool_(strlen)(name);
+	int i, j;
 	int hash = 0;
 
 	for (i = 0; i < len; i += 3) {
@@ -99,8 +101,14 @@ ULS_QUALIFIED_METHOD(__keyw_hashfunc_case_sensitive)(uls_hash_stat_ptr_t hs, con
 			name[i+2] * weights[2];
 	}
 
-	hash = (hash % ULF_HASH_TABLE_SIZE) + ULF_HASH_TABLE_SIZE;
-	return hash % ULF_HASH_TABLE_SIZE;
+	hash = (hash % hs->table_size) + hs->table_size;
+	return hash % hs->table_size;
+}
+
+ULS_DECL_STATIC int
+ULS_QUALIFIED_METHOD(__keyw_hashfunc_case_sensitive)(uls_hash_stat_ptr_t hs, const char *name)
+{
+	return __keyw_hash(hs, name, _uls_tool_(strlen)(name));
 }
 
 ULS_DECL_STATIC int
@@ -141,8 +149,8 @@ ULS_QUALIFIED_METHOD(__keyw_hashfunc_case_insensitive)(uls_hash_stat_ptr_t hs, c
 			_uls_tool_(toupper)(name[i+2]) * weights[2];
 	}
 
-	hash = (hash % ULF_HASH_TABLE_SIZE) + ULF_HASH_TABLE_SIZE;
-	return hash % ULF_HASH_TABLE_SIZE;
+	hash = (hash % hs->table_size) + hs->table_size;
+	return hash % hs->table_size;
 }
 
 ULS_DECL_STATIC void
@@ -163,7 +171,14 @@ ULS_QUALIFIED_METHOD(__init_kwtable_buckets)(uls_kwtable_ptr_t tbl)
 void
 ULS_QUALIFIED_METHOD(uls_init_kwtable)(uls_kwtable_ptr_t tbl)
 {
+	int i;
+
 	__init_kwtable_buckets(tbl);
+	tbl->stats = nilptr;
+
+	uls_init_bytespool(tbl->casefold, ULS_CASEFOLD_MAPSIZ, 1);
+	for (i = 0; i < ULS_CASEFOLD_MAPSIZ; i++) tbl->casefold[i] = (char) i;
+	tbl->case_insensitive = 0;
 
 	tbl->str_ncmp = uls_ref_callback_this(__keyw_strncmp_case_sensitive);
 	tbl->hashfunc = uls_ref_callback_this(__keyw_hashfunc_case_sensitive);
@@ -172,6 +187,14 @@ ULS_QUALIFIED_METHOD(uls_init_kwtable)(uls_kwtable_ptr_t tbl)
 void
 ULS_QUALIFIED_METHOD(uls_reset_kwtable)(uls_kwtable_ptr_t tbl, int case_insensitive)
 {
+	int i;
+
+	// The keywords are stored in upper case, see check_keyw_str().
+	for (i = 0; i < ULS_CASEFOLD_MAPSIZ; i++) {
+		tbl->casefold[i] = case_insensitive ? _uls_tool_(toupper)(i) : (char) i;
+	}
+	tbl->case_insensitive = case_insensitive ? 1 : 0;
+
 	if (case_insensitive) {
 		tbl->str_ncmp = uls_ref_callback_this(__keyw_strncmp_case_insensitive);
 		tbl->hashfunc = uls_ref_callback_this(__keyw_hashfunc_case_insensitive);
@@ -186,7 +209,22 @@ ULS_QUALIFIED_METHOD(uls_deinit_kwtable)(uls_kwtable_ptr_t tbl)
 {
 	uls_deinit_parray(uls_ptr(tbl->bucket_head));
 	uls_deinit_hash_stat(uls_ptr(tbl->hash_stat));
+	uls_deinit_bytespool(tbl->casefold);
 	tbl->hashfunc = nilptr;
+	tbl->stats = nilptr;
+}
+
+void
+ULS_QUALIFIED_METHOD(uls_stats_add_probes)(uls_stats_ptr_t stats, int n_probes)
+{
+	int k;
+
+	++stats->n_kw_lookups;
+	stats->n_kw_probes += n_probes;
+	if (n_probes > stats->kw_probe_max) stats->kw_probe_max = n_probes;
+
+	if ((k = n_probes) >= ULS_STATS_N_PROBE_BINS) k = ULS_STATS_N_PROBE_BINS - 1;
+	++stats->kw_probe_hist[k];
 }
 
 ULS_QUALIFIED_RETTYP(uls_tokdef_ptr_t)
@@ -194,13 +232,14 @@ ULS_QUALIFIED_METHOD(uls_find_kw)(uls_kwtable_ptr_t tbl, uls_ptrtype_tool(outpar
 {
 	uls_decl_parray_slots_init(slots_bh, tokdef, uls_ptr(tbl->bucket_head));
 	const char *idstr = parms->lptr;
-	int hash_id, l_idstr = parms->len;
+	int hash_id, l_idstr = parms->len, n_probes = 0;
 	uls_tokdef_ptr_t   e, e_found=nilptr;
 
 	hash_id = tbl->hashfunc(uls_ptr(tbl->hash_stat), idstr);
 	parms->n = hash_id;
 
 	for (e = slots_bh[hash_id]; e != nilptr; e = e->link) {
+		++n_probes;
 		if (l_idstr == e->ulen_keyword &&
 			tbl->str_ncmp(idstr, uls_get_namebuf_value(e->keyword), l_idstr) == 0) {
 			e_found = e;
@@ -208,6 +247,37 @@ ULS_QUALIFIED_METHOD(uls_find_kw)(uls_kwtable_ptr_t tbl, uls_ptrtype_tool(outpar
 		}
 	}
 
+	if (tbl->stats != nilptr) {
+		uls_stats_add_probes(tbl->stats, n_probes);
+	}
+
+	return e_found;
+}
+
+/*
+ * Looks up 'idstr' folded by uls_casefold_idstr() if the table is case-insensitive.
+ * As the keywords are stored folded, it's a plain hash and memcmp.
+ */
+ULS_QUALIFIED_RETTYP(uls_tokdef_ptr_t)
+ULS_QUALIFIED_METHOD(uls_find_kw_folded)(uls_kwtable_ptr_t tbl, const char *idstr, int l_idstr)
+{
+	uls_decl_parray_slots_init(slots_bh, tokdef, uls_ptr(tbl->bucket_head));
+	uls_tokdef_ptr_t e, e_found = nilptr;
+	int n_probes = 0;
+
+	for (e = slots_bh[__keyw_hash(uls_ptr(tbl->hash_stat), idstr, l_idstr)]; e != nilptr; e = e->link) {
+		++n_probes;
+		if (l_idstr == e->ulen_keyword &&
+			_uls_tool_(memcmp)(idstr, uls_get_namebuf_value(e->keyword), l_idstr) == 0) {
+			e_found = e;
+			break;
+		}
+	}
+
+	if (tbl->stats != nilptr) {
+		uls_stats_add_probes(tbl->stats, n_probes);
+	}
+
 	return e_found;
 }
 
@@ -233,6 +303,60 @@ ULS_QUALIFIED_METHOD(uls_add_kw)(uls_kwtable_ptr_t tbl, uls_tokdef_ptr_t e)
 	return 0;
 }
 
+/*
+ * Re-buckets the keywords of 'tbl' into a table of 'table_size' chains.
+ * Keywords that shared a chain keep their relative order,
+ * so the most frequent ones (entered last) still come first.
+ */
+int
+ULS_QUALIFIED_METHOD(uls_resize_kwtable)(uls_kwtable_ptr_t tbl, int table_size)
+{
+	uls_decl_parray_slots(slots_bh, tokdef);
+	uls_tokdef_ptr_t e, e_next, *tails, lst_head = nilptr, lst_tail = nilptr;
+	int i, hash_id, n_old;
+
+	if (table_size <= 0 || table_size > ULF_HASH_TABLE_MAXSIZE) {
+		_uls_log(err_log)("%s: invalid hash table size %d", __func__, table_size);
+		return -1;
+	}
+
+	// Unlink all the chains into one list, bucket by bucket.
+	slots_bh = uls_parray_slots(uls_ptr(tbl->bucket_head));
+	n_old = tbl->bucket_head.n;
+	for (i = 0; i < n_old; i++) {
+		for (e = slots_bh[i]; e != nilptr; e = e_next) {
+			e_next = e->link;
+			e->link = nilptr;
+			if (lst_tail == nilptr) lst_head = e;
+			else lst_tail->link = e;
+			lst_tail = e;
+		}
+		slots_bh[i] = nilptr;
+	}
+
+	if (table_size > tbl->bucket_head.n_alloc) {
+		uls_resize_parray(uls_ptr(tbl->bucket_head), tokdef, table_size);
+		slots_bh = uls_parray_slots(uls_ptr(tbl->bucket_head));
+	}
+	for (i = 0; i < table_size; i++) slots_bh[i] = nilptr;
+	tbl->bucket_head.n = table_size;
+	tbl->hash_stat.table_size = table_size;
+
+	tails = (uls_tokdef_ptr_t *) uls_malloc_clear(table_size * sizeof(uls_tokdef_ptr_t));
+	for (e = lst_head; e != nilptr; e = e_next) {
+		e_next = e->link;
+		e->link = nilptr;
+
+		hash_id = tbl->hashfunc(uls_ptr(tbl->hash_stat), uls_get_namebuf_value(e->keyword));
+		if (tails[hash_id] == nilptr) slots_bh[hash_id] = e;
+		else tails[hash_id]->link = e;
+		tails[hash_id] = e;
+	}
+	uls_mfree(tails);
+
+	return table_size;
+}
+
 int
 ULS_QUALIFIED_METHOD(sizeof_kwtable)(uls_kwtable_ptr_t tbl)
 {
@@ -250,15 +374,218 @@ ULS_QUALIFIED_METHOD(sizeof_kwtable)(uls_kwtable_ptr_t tbl)
 	return n;
 }
 
+/*
+ * The simple case folding of the letters out of ASCII, to the upper case
+ *   in Latin-1, Latin Extended-A, Greek and Cyrillic.
+ * The letters whose folding changes the length of utf-8 are left as they are.
+ */
+ULS_QUALIFIED_RETTYP(uls_wch_t)
+ULS_QUALIFIED_METHOD(uls_fold_wch)(uls_wch_t wch)
+{
+	if (wch < 0xE0) {
+		if (wch < 0x80) wch = _uls_tool_(toupper)(wch);
+	} else if (wch <= 0xFE) {
+		if (wch != 0xF7) wch -= 0x20;
+	} else if (wch == 0xFF) {
+		wch = 0x178;
+	} else if (wch <= 0x17E) {
+		// The pairs of upper and lower turn their parity at U+0138 and U+0149.
+		// U+0130 and U+0131 are left as they are, for their pairs 'i' and 'I' of ASCII
+		//   are shorter in utf-8.
+		if ((wch >= 0x100 && wch <= 0x12F) || (wch >= 0x132 && wch <= 0x137) ||
+			(wch >= 0x14A && wch <= 0x177)) {
+			if (wch & 1) wch -= 1;
+		} else if ((wch >= 0x139 && wch <= 0x148) || wch >= 0x179) {
+			if (!(wch & 1)) wch -= 1;
+		}
+	} else if (wch >= 0x3B1 && wch <= 0x3C9) {
+		wch = wch == 0x3C2 ? 0x3A3 : wch - 0x20;
+	} else if (wch >= 0x430 && wch <= 0x44F) {
+		wch -= 0x20;
+	} else if (wch >= 0x450 && wch <= 0x45F) {
+		wch -= 0x50;
+	}
+
+	return wch;
+}
+
+/*
+ * Folds the identifier 'str' into 'buf' of 'siz' bytes.
+ * Returns the length of the folded string, -1 if it's longer than 'siz' - 1,
+ *   where it can't be a keyword.
+ */
+int
+ULS_QUALIFIED_METHOD(uls_casefold_idstr)(uls_kwtable_ptr_t tbl, const char *str, int len, char *buf, int siz)
+{
+	uls_wch_t wch;
+	int i, k = 0, rc, rc2;
+
+	for (i = 0; i < len; i += rc) {
+		if ((unsigned char) str[i] < 0x80) {
+			if (k + 1 >= siz) return -1;
+			buf[k++] = tbl->casefold[(unsigned char) str[i]];
+			rc = 1;
+		} else {
+			if ((rc = _uls_tool_(decode_utf8)(str + i, len - i, &wch)) <= 0 ||
+				(rc2 = _uls_tool_(encode_utf8)(uls_fold_wch(wch), buf + k, siz - 1 - k)) <= 0) {
+				return -1;
+			}
+			k += rc2;
+		}
+	}
+
+	buf[k] = '\0';
+	return k;
+}
+
 ULS_QUALIFIED_RETTYP(uls_tokdef_ptr_t)
 ULS_QUALIFIED_METHOD(is_keyword_idstr)(uls_kwtable_ptr_t tbl, const char *keyw, int l_keyw)
 {
-	uls_type_tool(outparam) parms;
+	char buf[ULS_LEXSTR_MAXSIZ+1];
+
+	if (tbl->case_insensitive) {
+		if ((l_keyw = uls_casefold_idstr(tbl, keyw, l_keyw, buf, sizeof(buf))) < 0) {
+			return nilptr;
+		}
+		keyw = buf;
+	}
+
+	return uls_find_kw_folded(tbl, keyw, l_keyw);
+}
+
+ULS_DECL_STATIC unsigned int
+ULS_QUALIFIED_METHOD(__intern_hash)(const char *str, int len)
+{
+	unsigned int hash = 2166136261U;
+	int i;
+
+	// FNV-1a
+	for (i = 0; i < len; i++) {
+		hash = (hash ^ (unsigned char) str[i]) * 16777619U;
+	}
+
+	return hash;
+}
+
+ULS_DECL_STATIC const char*
+ULS_QUALIFIED_METHOD(__intern_arena_strdup)(uls_intern_table_ptr_t tbl, const char *str, int len)
+{
+	char *ptr;
+	int siz;
+
+	// The blocks are never moved nor freed until the table is, so the strings stay put.
+	if (len + 1 > tbl->arena_left) {
+		if ((siz = ULS_INTERN_ARENA_BLKSIZ) < len + 1) siz = len + 1;
+
+		if (tbl->n_arena_blks >= tbl->n_alloc_arena_blks) {
+			tbl->n_alloc_arena_blks += 16;
+			tbl->arena_blks = (char **) uls_mrealloc(tbl->arena_blks,
+				tbl->n_alloc_arena_blks * sizeof(char *));
+		}
+
+		tbl->arena_ptr = tbl->arena_blks[tbl->n_arena_blks++] = (char *) uls_malloc(siz);
+		tbl->arena_left = siz;
+	}
+
+	ptr = tbl->arena_ptr;
+	_uls_tool_(memcopy)(ptr, str, len);
+	ptr[len] = '\0';
+
+	tbl->arena_ptr += len + 1;
+	tbl->arena_left -= len + 1;
+
+	return ptr;
+}
+
+ULS_DECL_STATIC void
+ULS_QUALIFIED_METHOD(__intern_rehash)(uls_intern_table_ptr_t tbl, int n_slots)
+{
+	uls_intern_slot_ptr_t slots, slot;
+	unsigned int mask = n_slots - 1, h;
+	int i;
+
+	slots = (uls_intern_slot_ptr_t) uls_malloc_clear(n_slots * sizeof(uls_intern_slot_t));
+
+	for (i = 0; i < tbl->n_slots; i++) {
+		slot = tbl->slots + i;
+		if (slot->atom_id == 0) continue;
+
+		for (h = slot->hash & mask; slots[h].atom_id != 0; h = (h + 1) & mask)
+			/* NOTHING */;
+		slots[h] = *slot;
+	}
+
+	uls_mfree(tbl->slots);
+	tbl->slots = slots;
+	tbl->n_slots = n_slots;
+}
+
+void
+ULS_QUALIFIED_METHOD(uls_init_intern_table)(uls_intern_table_ptr_t tbl)
+{
+	uls_initial_zerofy_object(tbl);
+	__intern_rehash(tbl, ULS_INTERN_INIT_SLOTS);
+}
+
+void
+ULS_QUALIFIED_METHOD(uls_deinit_intern_table)(uls_intern_table_ptr_t tbl)
+{
+	int i;
 
-	parms.lptr = keyw;
-	parms.len = l_keyw;
+	for (i = 0; i < tbl->n_arena_blks; i++) {
+		uls_mfree(tbl->arena_blks[i]);
+	}
+	uls_mfree(tbl->arena_blks);
+	tbl->n_arena_blks = tbl->n_alloc_arena_blks = 0;
+	tbl->arena_ptr = NULL;
+	tbl->arena_left = 0;
+
+	uls_mfree(tbl->atoms);
+	tbl->n_atoms = tbl->n_alloc_atoms = 0;
+
+	uls_mfree(tbl->slots);
+	tbl->n_slots = 0;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_intern_id)(uls_intern_table_ptr_t tbl, uls_kwtable_ptr_t kw_tbl,
+	const char *str, int len, int n_wchars)
+{
+	unsigned int hash = __intern_hash(str, len), mask = tbl->n_slots - 1, h;
+	uls_intern_slot_ptr_t slot;
+	uls_atom_ptr_t atom;
+
+	for (h = hash & mask; (slot = tbl->slots + h)->atom_id != 0; h = (h + 1) & mask) {
+		if (slot->hash == hash) {
+			atom = uls_intern_atom(tbl, slot->atom_id);
+			if (atom->len == len && uls_memcmp(atom->str, str, len) == 0) {
+				return slot->atom_id;
+			}
+		}
+	}
+
+	// A new spelling: the keyword-table is looked up only once for it.
+	if (tbl->n_atoms >= tbl->n_alloc_atoms) {
+		tbl->n_alloc_atoms = tbl->n_alloc_atoms > 0 ? 2 * tbl->n_alloc_atoms : 256;
+		tbl->atoms = (uls_atom_ptr_t) uls_mrealloc(tbl->atoms,
+			tbl->n_alloc_atoms * sizeof(uls_atom_t));
+	}
+
+	atom = tbl->atoms + tbl->n_atoms++;
+	atom->str = __intern_arena_strdup(tbl, str, len);
+	atom->len = len;
+	atom->n_wchars = n_wchars;
+	atom->kw = is_keyword_idstr(kw_tbl, atom->str, len);
+
+	slot->hash = hash;
+	slot->atom_id = tbl->n_atoms;
+
+	// Keep the load under a half.
+	if (2 * tbl->n_atoms > tbl->n_slots) {
+		__intern_rehash(tbl, 2 * tbl->n_slots);
+	}
 
-	return uls_find_kw(tbl, uls_ptr(parms));
+	return tbl->n_atoms;
 }
 
 int
@@ -85,7 +85,7 @@ ULS_QUALIFIED_METHOD(uls_deinit_1char_table)(uls_onechar_table_ptr_t tbl)
 		e_etc_next = e_etc->next;
 		e_vx = e_etc->tokdef_vx;
 		uls_destroy_tokdef_vx(e_vx);
-		uls_dealloc_object(e_etc);
+		// e_etc is in the spec-arena.
 	}
 	tbl->tokdefs_etc_list = nilptr;
 
@@ -203,11 +203,12 @@ ULS_QUALIFIED_METHOD(find_1char_tokdef_etc_by_tokid)(uls_onechar_table_ptr_t tbl
 
 void
 ULS_QUALIFIED_METHOD(insert_1char_tokdef_etc)(uls_onechar_table_ptr_t tbl,
-	uls_wch_t wch, uls_tokdef_vx_ptr_t e_vx)
+	uls_spec_arena_ptr_t arena, uls_wch_t wch, uls_tokdef_vx_ptr_t e_vx)
 {
 	uls_onechar_tokdef_etc_ptr_t  e_etc;
 
-	e_etc = uls_alloc_object(uls_onechar_tokdef_etc_t);
+	e_etc = (uls_onechar_tokdef_etc_ptr_t) uls_spec_arena_alloc(arena,
+		ULS_SPEC_ARENA_COLD, sizeof(uls_onechar_tokdef_etc_t));
 	e_etc->wch = wch;
 	e_etc->tokdef_vx = e_vx;
 
@@ -308,6 +308,14 @@ ULS_QUALIFIED_METHOD(uld_prepare_names)(uls_lex_ptr_t uls)
 	uls_tokdef_vx_ptr_t e_vx, e2_vx;
 	uld_names_map_ptr_t names_map;
 
+	if (uls->flags & ULS_FL_SHARED_SPEC) {
+		_uls_log(err_log)("%s: the tokdefs of a shared spec are read-only!", __func__);
+		return nilptr;
+	}
+
+	// The tok-ids will be changed.
+	uls_reset_tokid_map(uls);
+
 	for (n=n_slots_vx,i=k=0; i<n; ) {
 		e_vx = slots_vx[i];
 
@@ -37,9 +37,13 @@
 
 #ifndef ULS_EXCLUDE_HFILES
 #include "uls/uls_lex.h"
+#include "uls/uls_spec_cache.h"
+#include "uls/uls_tokpipe.h"
 #include "uls/uls_istream.h"
 #include "uls/uls_ostream.h"
 #include "uls/uls_util.h"
+#include "uls/uls_relex.h"
+#include "uls/uls_plex.h"
 #include "uls/uls_log.h"
 #endif
 
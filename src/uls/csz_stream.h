@@ -93,6 +93,7 @@ _ULS_DEFINE_STRUCT_BEGIN(csz_global_data)
 	uls_mutex_struct_t  mtx;
 	csz_buf_line_ptr_t  inactive_list;
 	csz_buf_line_ptr_t  active_list;
+	uls_uint64 n_hits, n_misses;
 };
 #endif
 ULS_DEFINE_STRUCT(outbuf)
@@ -131,6 +132,7 @@ ULS_DECL_STATIC _ULS_INLINE void __str_modify(uls_outbuf_ptr_t outbuf, int n_del
 void initialize_csz(void);
 void reset_csz(void);
 void finalize_csz(void);
+void csz_get_pool_stats(uls_uint64 *n_hits, uls_uint64 *n_misses);
 #endif
 
 #ifdef ULS_DECL_PUBLIC_PROC
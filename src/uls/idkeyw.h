@@ -32,12 +32,22 @@
 
 #ifndef ULS_EXCLUDE_HFILES
 #include "uls/uls_tokdef.h"
+#include "uls/uls_stats.h"
 #endif
 
 #ifdef _ULS_CPLUSPLUS
 extern "C" {
 #endif
 
+#ifdef ULS_DECL_GLOBAL_TYPES
+#define ULS_INTERN_ARENA_BLKSIZ  16384
+#define ULS_INTERN_INIT_SLOTS    1024
+
+#define uls_intern_atom(tbl,atom_id) ((tbl)->atoms + (atom_id) - 1)
+
+#define ULS_CASEFOLD_MAPSIZ  256
+#endif
+
 #ifdef ULS_DECL_PUBLIC_TYPE
 ULS_DECLARE_STRUCT(hash_stat);
 ULS_DEFINE_DELEGATE_BEGIN(hashfunc, int)(uls_hash_stat_ptr_t hs, const char *name);
@@ -48,6 +58,7 @@ ULS_DEFINE_DELEGATE_END(hashfunc);
 ULS_DEFINE_STRUCT(hash_stat)
 {
 	uls_def_intarray(weight);
+	int table_size;
 };
 
 ULS_DEFINE_STRUCT(kwtable)
@@ -58,6 +69,39 @@ ULS_DEFINE_STRUCT(kwtable)
 	uls_callback_type_this(hashfunc) hashfunc;
 
 	uls_hash_stat_t hash_stat;
+	uls_stats_ptr_t stats;
+
+	// The bytes folded to the case of the keywords, the identity if case-sensitive.
+	uls_def_bytespool(casefold, ULS_CASEFOLD_MAPSIZ);
+	int case_insensitive;
+};
+
+// The identifiers seen by the lexer, see uls_enable_intern().
+ULS_DEFINE_STRUCT(intern_slot)
+{
+	unsigned int hash;
+	int atom_id; // 0 if the slot is empty
+};
+
+ULS_DEFINE_STRUCT(atom)
+{
+	const char *str; // in the arena, valid while the uls-object lives
+	int len, n_wchars;
+	uls_tokdef_ptr_t kw; // the keyword spelled so, nilptr if it's an ID
+};
+
+ULS_DEFINE_STRUCT(intern_table)
+{
+	uls_intern_slot_ptr_t slots;
+	int n_slots; // a power of 2
+
+	uls_atom_ptr_t atoms; // atoms[k-1] for the atom-id k
+	int n_atoms, n_alloc_atoms;
+
+	char **arena_blks;
+	int n_arena_blks, n_alloc_arena_blks;
+	char *arena_ptr;
+	int arena_left;
 };
 
 ULS_DEFINE_STRUCT(keyw_stat)
@@ -76,11 +120,15 @@ ULS_DEFINE_STRUCT(keyw_stat_list)
 
 #if defined(__ULS_IDKEYW__) || defined(ULS_DECL_PRIVATE_PROC)
 ULS_DECL_STATIC int __keyw_strncmp_case_sensitive(const char *str1, const char *str2, int len);
+ULS_DECL_STATIC int __keyw_hash(uls_hash_stat_ptr_t hs, const char *name, int len);
 ULS_DECL_STATIC int __keyw_hashfunc_case_sensitive(uls_hash_stat_ptr_t hs, const char *name);
 ULS_DECL_STATIC int __keyw_strncmp_case_insensitive(const char *wrd, const char *keyw, int len);
 ULS_DECL_STATIC int __keyw_hashfunc_case_insensitive(uls_hash_stat_ptr_t hs, const char *name);
 ULS_DECL_STATIC void __init_kwtable_buckets(uls_kwtable_ptr_t tbl);
 ULS_DECL_STATIC int __export_kwtable(uls_kwtable_ptr_t tbl, uls_ref_parray(lst,keyw_stat), int n_lst);
+ULS_DECL_STATIC unsigned int __intern_hash(const char *str, int len);
+ULS_DECL_STATIC const char* __intern_arena_strdup(uls_intern_table_ptr_t tbl, const char *str, int len);
+ULS_DECL_STATIC void __intern_rehash(uls_intern_table_ptr_t tbl, int n_slots);
 #endif
 
 #ifdef ULS_DECL_PROTECTED_PROC
@@ -89,10 +137,17 @@ void uls_reset_kwtable(uls_kwtable_ptr_t tbl, int case_insensitive);
 void uls_deinit_kwtable(uls_kwtable_ptr_t tbl);
 
 uls_tokdef_ptr_t uls_find_kw(uls_kwtable_ptr_t tbl, uls_ptrtype_tool(outparam) parms);
+uls_tokdef_ptr_t uls_find_kw_folded(uls_kwtable_ptr_t tbl, const char *idstr, int l_idstr);
 int uls_add_kw(uls_kwtable_ptr_t tbl, uls_tokdef_ptr_t e);
 
 int sizeof_kwtable(uls_kwtable_ptr_t tbl);
 uls_tokdef_ptr_t is_keyword_idstr(uls_kwtable_ptr_t tbl, const char *keyw, int l_keyw);
+uls_wch_t uls_fold_wch(uls_wch_t wch);
+int uls_casefold_idstr(uls_kwtable_ptr_t tbl, const char *str, int len, char *buf, int siz);
+
+void uls_init_intern_table(uls_intern_table_ptr_t tbl);
+void uls_deinit_intern_table(uls_intern_table_ptr_t tbl);
+int uls_intern_id(uls_intern_table_ptr_t tbl, uls_kwtable_ptr_t kw_tbl, const char *str, int len, int n_wchars);
 #endif
 
 #ifdef ULS_DECL_PUBLIC_PROC
@@ -102,6 +157,7 @@ ULS_DLL_EXTERN void uls_init_hash_stat(uls_hash_stat_ptr_t hs);
 ULS_DLL_EXTERN void uls_deinit_hash_stat(uls_hash_stat_ptr_t hs);
 ULS_DLL_EXTERN void uls_copy_hash_stat(uls_hash_stat_ptr_t hs_src,
 	uls_hash_stat_ptr_t hs_dst);
+ULS_DLL_EXTERN int uls_resize_kwtable(uls_kwtable_ptr_t tbl, int table_size);
 
 ULS_DLL_EXTERN uls_hashfunc_t uls_get_hashfunc(const char *hashname, int case_insensitive);
 ULS_DLL_EXTERN uls_keyw_stat_list_ptr_t ulc_export_kwtable(uls_kwtable_ptr_t tbl);
@@ -44,6 +44,10 @@ extern "C" {
 #define ULS_LITPROC_ERROR        -2
 #define ULS_LITPROC_DISMISSQUOTE -1
 #define ULS_LITPROC_ENDOFQUOTE    0
+// input_quote_fragment() only: the literal string goes on after 'maxlen' bytes of it.
+#define ULS_LITPROC_FRAGMENT      1
+// input_quote_fragment() only: the fed bytes run out in the literal string in push-mode.
+#define ULS_LITPROC_STARVED      -3
 #endif
 
 #ifdef ULS_DECL_PUBLIC_TYPE
@@ -58,6 +62,12 @@ extern "C" {
 #define ULS_QSTR_ESC           0x200
 #define ULS_QSTR_ETC           0x400
 
+// The fragments of a literal string cut by uls_set_litstr_chunk()
+#define ULS_LITFRAG_FIRST      0x01
+#define ULS_LITFRAG_MIDDLE     0x02
+#define ULS_LITFRAG_LAST       0x04
+#define ULS_LITFRAG_MINSIZ     64
+
 #define uls_is_quote_symmetric(qmt) (((qmt)->flags & ULS_QSTR_ASYMMETRIC) == 0)
 #define uls_is_quote_userdef(qmt) ((qmt)->flags & ULS_QSTR_USERPROC)
 
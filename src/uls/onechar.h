@@ -81,7 +81,7 @@ void insert_1char_tokdef_map(uls_onechar_tokgrp_ptr_t tokgrp, int ch, uls_tokdef
 
 uls_tokdef_vx_ptr_t find_1char_tokdef_etc(uls_onechar_table_ptr_t tbl, uls_wch_t wch);
 uls_tokdef_vx_ptr_t find_1char_tokdef_etc_by_tokid(uls_onechar_table_ptr_t tbl, int tok_id);
-void insert_1char_tokdef_etc(uls_onechar_table_ptr_t tbl, uls_wch_t wch, uls_tokdef_vx_ptr_t e_vx);
+void insert_1char_tokdef_etc(uls_onechar_table_ptr_t tbl, uls_spec_arena_ptr_t arena, uls_wch_t wch, uls_tokdef_vx_ptr_t e_vx);
 
 uls_tokdef_vx_ptr_t uls_find_1char_tokdef_vx(uls_onechar_table_ptr_t tbl, int ch,
 	uls_tokdef_outparam_ptr_t outparam);
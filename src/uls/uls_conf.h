@@ -69,6 +69,9 @@ extern "C" {
 #define ULS_NAME_SPECNAME     0
 #define ULS_NAME_FILEPATH_ULC 1
 #define ULS_NAME_FILEPATH_ULD 2
+
+// The tok-ids within this span are indexed directly, the rest by hashing.
+#define ULS_TOKID_MAP_MAXSPAN(n_vx) (4*(n_vx) + 256)
 #endif
 
 #ifdef ULS_DEF_PUBLIC_TYPE
@@ -153,12 +156,11 @@ ULS_DECL_STATIC int get_ulf_filepath(const char *dirpath, int len_dirpath,
 
 ULS_DECL_STATIC void _list_searchpath(const char *filename, uls_ptrtype_tool(arglst) title, uls_ptrtype_tool(arglst) searchpath, int n);
 ULS_DECL_STATIC int get_ulc_fileformat_ver(char *linebuff, int linelen, uls_ptrtype_tool(version) ver1);
-ULS_DECL_STATIC int check_ulc_file_magic(FILE* fin, uls_ptrtype_tool(version) sysver, char *ulc_lname);
 ULS_DECL_STATIC int parse_id_ranges_internal(uls_lex_ptr_t uls, uls_ref_parray_tool(wrds_ranges,uch_range), int is_first);
 
 ULS_DECL_STATIC int gen_next_tok_id(ulc_header_ptr_t hdr,
 	uls_tokdef_vx_ptr_t e_vx_grp, const char *tok_idstr, int ch_kwd);
-ULS_DECL_STATIC uls_tokdef_ptr_t __new_regular_tokdef(int keyw_type, const char *keyw, int ulen, int wlen);
+ULS_DECL_STATIC uls_tokdef_ptr_t __new_regular_tokdef(uls_lex_ptr_t uls, int keyw_type, const char *keyw, int ulen, int wlen);
 
 ULS_DECL_STATIC int check_tokid_duplicity(const char *tagstr, int lno,
 	int tok_id, uls_tokdef_vx_ptr_t e_vx_grp, uls_lex_ptr_t uls);
@@ -186,6 +188,8 @@ int check_rsvd_toks(uls_lex_ptr_t uls);
 int uls_is_char_idfirst(uls_lex_ptr_t uls, const char *lptr, uls_wch_t* ptr_wch);
 int uls_is_char_id(uls_lex_ptr_t uls, uls_wch_t wch);
 
+void uls_reset_tokid_map(uls_lex_ptr_t uls);
+void uls_build_tokid_map(uls_lex_ptr_t uls);
 uls_tokdef_vx_ptr_t uls_find_reg_tokdef_vx(uls_lex_ptr_t uls, int t);
 uls_tokdef_vx_ptr_t uls_find_tokdef_vx(uls_lex_ptr_t uls, int t);
 
@@ -197,6 +201,7 @@ int ulc_get_searchpath_by_specpath(int is_abspath, uls_ptrtype_tool(arglst) name
 
 char *is_cnst_suffix_contained(char *cstr_pool, const char *str, int l_str, uls_ptrtype_tool(outparam) parms);
 int check_ulc_fileformat_magic(char *linebuff, int linelen, int ftype);
+int check_ulc_file_magic(FILE* fin, uls_ptrtype_tool(version) sysver, char *ulc_lname);
 
 ulc_fpitem_ptr_t ulc_find_fp_list(ulc_fpitem_ptr_t fp_stack_top, const char *ulc_name);
 ulc_fpitem_ptr_t ulc_fp_push(ulc_fpitem_ptr_t fp_lst, FILE *fp, const char *str);
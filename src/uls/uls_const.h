@@ -61,6 +61,7 @@
 #define ULF_GEN_PROGVER      _T("v1.7.1")
 #define ULS_STREAM_PROGVER   _T("v2.10.0")
 #define ULC2YAML_PROGVER     _T("v1.0.0")
+#define ULS_BENCH_PROGVER    _T("v1.0.0")
 
 #define ULS_INITIAL_NAME     _T("ULS(Unified Lexical Scheme)")
 #define ULS_AUTHOR           _T("Stanley Hong (link2next@gmail.com)")
@@ -187,8 +188,15 @@
 #define ULS_CNST_NILSTR_SIZE       4
 #define ULS_ASCII_TABLE_SIZE       128
 #define ULS_SYNTAX_TABLE_SIZE      128
+#define ULS_MARKMAP_SIZE           256
 #define ULS_TOKTOWER_DFLSIZ        16
 #define ULF_HASH_TABLE_SIZE        37
+#define ULF_HASH_TABLE_MAXSIZE     8191
+#define ULF_N_TABLE_SIZES          11   // the sizes of the hash table searched
+#define ULF_TABLE_SIZE_RATIO       8    // the tables up to 8 times the keywords
+#define ULF_PROBES_SLACK           0.02 // a larger table must save more than 2% of the probes
+#define ULF_O1_WEIGHT_MAX          9    // the grid of weights in [-9,9]
+#define ULF_N_O1_WEIGHTS           (2 * ULF_O1_WEIGHT_MAX + 1)
 
 #define ULC_VERSION_MAJOR          2
 #define ULC_VERSION_MINOR          4
@@ -56,6 +56,15 @@ extern "C" {
 #define ULS_CTX_FL_GETTOK_RAW      0x80
 #define ULS_CTX_FL_FILL_RAW        0x100
 #define ULS_CTX_FL_TOKSTR_AUX      0x200
+#define ULS_CTX_FL_STARVED         0x400
+#define ULS_CTX_FL_INPLACE         0x800
+#define ULS_CTX_FL_LITFRAG         0x1000
+#define ULS_CTX_FL_LXM_INPUT       0x2000 // the lexeme is in the input, not '\0'-terminated
+#define ULS_CTX_FL_COMMFRAG        0x4000
+#define ULS_CTX_FL_LITPEND         0x8000
+
+// the flags of uls_xcontext_t
+#define ULS_XCTX_FL_SHARED_SPEC    0x01
 
 #define uls_ctx_get_tag(ctx) (_uls_tool(csz_text)(uls_ptr((ctx)->tag)))
 #define uls_ctx_get_taglen(ctx) (csz_length(uls_ptr((ctx)->tag)))
@@ -64,6 +73,9 @@ extern "C" {
 #define uls_ctx_set_lineno(ctx,lno) uls_ctx_set_tag(ctx, NULL, lno)
 #define __uls_ctx_set_lineno(ctx,lno) do { (ctx)->lineno = lno; } while(0)
 #define __uls_ctx_inc_lineno(ctx,delta) do { (ctx)->lineno += delta; } while(0)
+
+// A context gets a new serial whenever its buffered text is refilled or edited, invalidating the marks on it.
+#define __uls_ctx_renew_serial(xctx,ctx) do { (ctx)->buf_serial = ++(xctx)->last_buf_serial; } while(0)
 #endif // ULS_DECL_PROTECTED_TYPE
 
 #ifdef ULS_DECL_PUBLIC_TYPE
@@ -99,10 +111,40 @@ ULS_DEFINE_STRUCT(lexseg)
 	int  len_text;
 
 	int  n_lfs_raw;
+	int  frag_flags; // ULS_LITFRAG_*
 	uls_tokdef_vx_ptr_t tokdef_vx;
 };
 ULS_DEF_ARRAY_TYPE10(lexseg);
 
+// A comment or a quote-string spanning line-feeds, recorded by xcontext_raw_filler().
+// The lines from 'lineno'+1 to 'lineno'+'n_lfs' start inside it.
+ULS_DEFINE_STRUCT(linespan)
+{
+	int  lineno, n_lfs;
+	uls_quotetype_ptr_t qmt; // nilptr if it's a comment
+};
+
+// The text put in zbuf1 from 'zpos' is read from 'offset' of the input, recorded by xcontext_raw_filler().
+ULS_DEFINE_STRUCT(zoffset)
+{
+	int  zpos, offset;
+};
+
+// A filling of zbuf1 and zbuf2 kept while a mark is on it, see uls_context_keep_fill().
+ULS_DEFINE_STRUCT(fillgen)
+{
+	unsigned int buf_serial;
+	_uls_type_tool(csz_str)  zbuf1;
+	_uls_type_tool(csz_str)  zbuf2;
+	int        len_line;
+
+	uls_decl_array_type10(lexsegs, lexseg);
+	int        n_lexsegs;
+
+	uls_zoffset_ptr_t zoffsets;
+	int        n_zoffsets, n_alloc_zoffsets;
+};
+
 ULS_DEFINE_STRUCT(userdata)
 {
 	uls_input_ungrabber_t proc;
@@ -127,26 +169,77 @@ ULS_DEFINE_STRUCT(context)
 	uls_decl_array_type10(lexsegs, lexseg);
 	int        i_lexsegs, n_lexsegs;
 
+	// The offsets of the texts in zbuf1 if the input indexes its lines, and the start of the current token.
+	uls_zoffset_ptr_t zoffsets;
+	int        n_zoffsets, n_alloc_zoffsets;
+	const char *tok_lptr;
+
+	// The fillings kept for the marks, from the oldest. The one shown is 'fillgens[i_fillgen]',
+	// whose slot holds the spare buffers while it's in the fields above.
+	uls_fillgen_ptr_t fillgens;
+	int        n_fillgens, n_alloc_fillgens, i_fillgen;
+
 	uls_callback_type_this(gettok)  gettok;
 	uls_callback_type_this(xcontext_filler) fill_proc;
 	uls_callback_type_this(xctx_boundary_checker) record_boundary_checker;
 
 	uls_tmpl_pool_ptr_t tmpls_pool;
+	unsigned int buf_serial;
 
 	int        tok;
 	const char *s_val;
 	int        s_val_len, s_val_wchars;
+	int        atom_id; // of the current ID or keyword, 0 if not interned
+	int        litfrag_flags; // of the current literal string
+
+	// The state of the analyzer on the literal string cut at the end of the last filling.
+	// It's valid while ULS_CTX_FL_LITFRAG is set.
+	uls_litstr_t litfrag;
+
+	// In push-mode, the comment or the literal string the fed bytes ran out in goes on at the next filling.
+	// commfrag is valid while ULS_CTX_FL_COMMFRAG is set. While ULS_CTX_FL_LITPEND is set,
+	//   the analyzer in litfrag puts the literal string in litpend, not in zbuf2, with its line-feeds in litpend_lfs.
+	uls_commtype_ptr_t commfrag;
+	_uls_type_tool(csz_str) litpend;
+	int        litpend_flags, litpend_lfs;
+	int        lit_offset; // of the literal string in the input, recorded in zoffsets
 
 	uls_type_tool(outbuf) tokbuf;
 	uls_type_tool(outbuf) tokbuf_aux;
 	int        l_tokbuf_aux, n_digits, n_expo;
 
+	// The lexeme in wchar_t if the lexer wants it, l_wtokbuf < 0 until it's made for the current token.
+	uls_type_tool(outbuf) wtokbuf;
+	int        l_wtokbuf;
+
+	// The UTF-16 source of the line pushed by uls_push_utf16_source(), and
+	//   the offsets in it and in utf-8 of the end of the last lexeme found in it.
+	const uls_uint16 *wsrc;
+	int        l_wsrc, wsrc_off8, wsrc_off16;
+
 	uls_tokdef_vx_ptr_t anonymous_uchar_vx;
 	uls_userdata_ptr_t user_data;
 
 	uls_context_ptr_t prev;
 };
 
+// A position of the lexer taken by uls_mark(), restorable by uls_rewind().
+// The lexeme of the current token is saved in xcontext.lexmark_lxms from 'lxm_offset'.
+ULS_DEFINE_STRUCT(lexmark)
+{
+	uls_context_ptr_t ctx;
+	unsigned int buf_serial;
+
+	const char *lptr, *line, *line_end, *tok_lptr;
+	int  i_lexsegs, lineno, delta_lineno;
+	uls_flags_t ctx_flags;
+
+	int  tok, atom_id, litfrag_flags;
+	int  s_val_len, s_val_wchars, n_digits, n_expo;
+	int  lxm_offset, lxm_size;
+	uls_tokdef_vx_ptr_t tokdef_vx;
+};
+
 ULS_DEFINE_STRUCT_BEGIN(xcontext)
 {
 	int flags;
@@ -168,6 +261,28 @@ ULS_DEFINE_STRUCT_BEGIN(xcontext)
 
 	uls_ref_parray(quotetypes, quotetype);  // ULS_N_MAX_QUOTETYPES
 
+	// The comment/quote types by the first byte of their start-marks, built by uls_xcontext_build_markmap().
+	// commtype_by_ch[ch] is 1 + the index of the first commtype starting with 'ch', 0 if none.
+	// commtype_next[i] is 1 + the index of the next commtype sharing the first byte with commtypes[i].
+	uls_def_bytespool(commtype_by_ch, ULS_MARKMAP_SIZE);
+	uls_def_bytespool(quotetype_by_ch, ULS_MARKMAP_SIZE);
+	char commtype_next[ULS_N_MAX_COMMTYPES];
+	char quotetype_next[ULS_N_MAX_QUOTETYPES];
+
+	// The multiline comments and quotes met by the raw filler while 'rec_linespans' is set.
+	int rec_linespans;
+	uls_linespan_ptr_t linespans;
+	int n_linespans, n_alloc_linespans;
+
+	// The max length of the fragments of a literal string, 0 if literal strings are not cut.
+	int litstr_chunksiz;
+
+	// The marks of uls_mark() in the order they're taken, and the lexemes they saved.
+	uls_lexmark_ptr_t lexmarks;
+	int n_lexmarks, n_alloc_lexmarks;
+	uls_type_tool(outbuf) lexmark_lxms;
+	unsigned int last_buf_serial;
+
 	int num_unregst_wch_tokens;
 	uls_context_ptr_t context;
 };
@@ -190,6 +305,16 @@ ULS_DECL_STATIC int __check_rec_boundary_reverse_order(uls_xcontext_ptr_t xctx,
 ULS_DECL_STATIC int __check_rec_boundary_bin(uls_xcontext_ptr_t xctx, uls_xctx_boundary_checker2_t checker);
 
 ULS_DECL_STATIC uls_commtype_ptr_t is_commtype_start(uls_xcontext_ptr_t xctx, const char *ptr, int len);
+ULS_DECL_STATIC void __xcontext_put_text(uls_context_ptr_t ctx, const char *lptr, int len);
+ULS_DECL_STATIC void __xcontext_put_comment_lfs(uls_xcontext_ptr_t xctx, int n_lfs, int offset);
+ULS_DECL_STATIC int __xcontext_skip_comment(uls_xcontext_ptr_t xctx, uls_commtype_ptr_t cmt, int offset);
+ULS_DECL_STATIC int __xcontext_quote_proc(uls_xcontext_ptr_t xctx, uls_quotetype_ptr_t qmt,
+	uls_lexseg_ptr_t lexseg, uls_ptrtype_tool(outparam) parms);
+
+ULS_DECL_STATIC void __init_fillgen(uls_fillgen_ptr_t gen);
+ULS_DECL_STATIC void __deinit_fillgen(uls_fillgen_ptr_t gen);
+ULS_DECL_STATIC void __swap_fillgen(uls_context_ptr_t ctx, uls_fillgen_ptr_t gen);
+ULS_DECL_STATIC void __show_fillgen(uls_context_ptr_t ctx, int i_gen);
 #endif
 
 #ifdef ULS_DECL_PROTECTED_PROC
@@ -203,8 +328,18 @@ void uls_reset_lexseg(uls_lexseg_ptr_t lexseg,
 
 void uls_init_context(uls_context_ptr_t ctx, uls_gettok_t gettok, int tok0);
 void uls_deinit_context(uls_context_ptr_t ctx);
+void uls_context_add_zoffset(uls_context_ptr_t ctx, int offset);
+int uls_context_offset(uls_context_ptr_t ctx, const char *ptr);
+
+int uls_context_keep_fill(uls_context_ptr_t ctx, unsigned int buf_serial0);
+int uls_context_next_fill(uls_context_ptr_t ctx);
+int uls_context_show_fill(uls_context_ptr_t ctx, unsigned int buf_serial);
+void uls_context_drop_fills(uls_context_ptr_t ctx);
 
 void uls_xcontext_init(uls_xcontext_ptr_t xctx, uls_gettok_t gettok);
+void uls_xcontext_build_markmap(uls_xcontext_ptr_t xctx);
+void uls_xcontext_rec_linespans(uls_xcontext_ptr_t xctx, int on);
+void uls_xcontext_add_linespan(uls_xcontext_ptr_t xctx, int lineno, int n_lfs, uls_quotetype_ptr_t qmt);
 void uls_xcontext_reset(uls_xcontext_ptr_t xctx);
 void uls_xcontext_deinit(uls_xcontext_ptr_t xctx);
 
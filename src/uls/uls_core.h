@@ -38,6 +38,7 @@
 
 #ifndef ULS_EXCLUDE_HFILES
 #include "uls/uls_conf.h"
+#include "uls/uls_tokpipe.h"
 #endif
 
 #ifdef _ULS_CPLUSPLUS
@@ -148,9 +149,14 @@ extern "C" {
 #define ULS_FL_TAB_CHAR           0x02
 #define ULS_FL_CASE_INSENSITIVE   0x04
 #define ULS_FL_MULTIBYTES_CHRTOK  0x08
+#define ULS_FL_SHARED_SPEC        0x10
+#define ULS_FL_WLEXEME            0x20
+#define ULS_FL_TOKID_ONLY         0x40
+#define ULS_FL_LINEIDX            0x80
 
 #define __uls_tok(uls) ((uls)->xcontext.context->tok)
-#define __uls_lexeme(uls) ((uls)->xcontext.context->s_val)
+#define __uls_lexeme(uls) (((uls)->xcontext.context->flags & ULS_CTX_FL_LXM_INPUT) ? \
+	uls_lexeme_terminated(uls) : (uls)->xcontext.context->s_val)
 #define __uls_lexeme_len(uls) ((uls)->xcontext.context->s_val_len)
 #define __uls_lexeme_wlen(uls) ((uls)->xcontext.context->s_val_wchars)
 
@@ -213,7 +219,13 @@ ULS_DEFINE_STRUCT_BEGIN(lex)
 	uls_decl_parray(tokdef_vx_array, tokdef_vx);
 	uls_decl_parray(tokdef_vx_rsvd, tokdef_vx); // [0,N_RESERVED_TOKS)
 
+	// The index of tokdef_vx_array[] by tok-id, built by uls_build_tokid_map().
+	int tokid_map_min;
+	uls_decl_parray(tokid_map, tokdef_vx); // [tokid_map_min, tokid_map_min + tokid_map.n)
+	uls_decl_parray(tokid_hash, tokdef_vx); // the tok-ids out of tokid_map, the size is a power of 2
+
 	uls_decl_parray(tokdef_array, tokdef); // == str_pool: main memory allocd
+	uls_spec_arena_t spec_arena; // the tokdefs, tokdef_vx's and aliases of the spec
 	uls_tokdef_vx_ptr_t tokdef_vx;
 
 	uls_kwtable_t   idkeyw_table;
@@ -225,7 +237,13 @@ ULS_DEFINE_STRUCT_BEGIN(lex)
 	uls_xcontext_t xcontext;
 	uls_context_ptr_t context_tower;
 
+	uls_stats_ptr_t stats;
+	uls_prof_ptr_t prof;
+	uls_intern_table_ptr_t intern;
+	uls_tokpipe_ptr_t tokpipe; // the stages of uls_add_tokstage()
 	uls_voidptr_t shell;
+
+	uls_lex_ptr_t shared_spec; // the compiled spec whose tables are used, see uls_init_shared()
 };
 #endif // ULS_DEF_PUBLIC_TYPE
 
@@ -233,8 +251,12 @@ ULS_DEFINE_STRUCT_BEGIN(lex)
 ULS_DECL_STATIC _ULS_INLINE void __ready_to_use_lexseg(uls_context_ptr_t ctx);
 ULS_DECL_STATIC int find_prefix_radix(uls_ptrtype_tool(outparam) parms, uls_lex_ptr_t uls, const char *str);
 ULS_DECL_STATIC int get_number(uls_lex_ptr_t uls, uls_context_ptr_t ctx, uls_ptrtype_tool(parm_line) parm_ln);
+ULS_DECL_STATIC int get_number_tokid(uls_lex_ptr_t uls, uls_context_ptr_t ctx, uls_ptrtype_tool(parm_line) parm_ln);
 ULS_DECL_STATIC void make_eof_lexeme(uls_lex_ptr_t uls);
 ULS_DECL_STATIC uls_context_ptr_t make_eoi_lexeme(uls_lex_ptr_t uls);
+ULS_DECL_STATIC uls_input_ptr_t __uls_find_feed_input(uls_lex_ptr_t uls);
+ULS_DECL_STATIC int __uls_put_wch(uls_ptrtype_tool(outbuf) wtokbuf, int k, uls_wch_t wch);
+ULS_DECL_STATIC int __uls_wsrc_offset(uls_context_ptr_t ctx, int offset8);
 
 ULS_DECL_STATIC void __uls_onechar_lexeme_vx(uls_lex_ptr_t uls, uls_tokdef_vx_ptr_t e_vx,
 	const char *lptr, int len);
@@ -247,6 +269,7 @@ ULS_DECL_STATIC uls_uint32 __uls_lexeme_uint32(const char *ptr);
 ULS_DECL_STATIC uls_uint64 __uls_lexeme_uint64(const char *ptr);
 ULS_DECL_STATIC void __uls_change_line(uls_lex_ptr_t uls, const char *line, int len, int flags);
 ULS_DECL_STATIC void __uls_init_fp(uls_lex_ptr_t uls);
+ULS_DECL_STATIC void __uls_share_spec(uls_lex_ptr_t uls, uls_lex_ptr_t spec);
 ULS_DECL_STATIC uls_tokdef_ptr_t get_idtok_list(uls_lex_ptr_t uls, uls_ptrtype_tool(outparam) parms);
 ULS_DECL_STATIC void __filter_1char_toks(uls_lex_ptr_t uls, uls_ptrtype_tool(outparam) parms);
 ULS_DECL_STATIC int __load_ulc_from_config_files(ulc_header_ptr_t hdr, const char *confname);
@@ -275,7 +298,10 @@ int uls_clear_and_fillbuff(uls_lex_ptr_t uls);
 int uls_fillbuff_and_reset(uls_lex_ptr_t uls, const char *str0);
 
 int uls_gettok_raw(uls_lex_ptr_t uls);
+int __uls_get_tok(uls_lex_ptr_t uls);
 uls_context_ptr_t uls_push(uls_lex_ptr_t uls);
+void uls_stats_count_tok(uls_lex_ptr_t uls, uls_tokdef_vx_ptr_t e_vx);
+int uls_make_wlexeme(uls_lex_ptr_t uls);
 
 int uls_get_1char_charset(char *buff);
 #endif // ULS_DECL_PROTECTED_PROC
@@ -301,11 +327,60 @@ ULS_DLL_EXTERN void _uls_put_tokid_list_2(uls_tokid_simple_list_ptr_t lst);
 
 ULS_DLL_EXTERN uls_lex_ptr_t uls_create(const char *confname);
 ULS_DLL_EXTERN int uls_init(uls_lex_ptr_t uls, const char *confname);
+ULS_DLL_EXTERN uls_lex_ptr_t uls_create_shared(const char *confname);
+ULS_DLL_EXTERN int uls_init_shared(uls_lex_ptr_t uls, const char *confname);
 ULS_DLL_EXTERN void uls_reset(uls_lex_ptr_t uls);
 ULS_DLL_EXTERN int uls_destroy(uls_lex_ptr_t uls);
 
 ULS_DLL_EXTERN int uls_skip_blanks(uls_lex_ptr_t uls);
 
+ULS_DLL_EXTERN int uls_enable_stats(uls_lex_ptr_t uls, int on);
+ULS_DLL_EXTERN void uls_reset_stats(uls_lex_ptr_t uls);
+ULS_DLL_EXTERN int uls_get_stats(uls_lex_ptr_t uls, uls_stats_ptr_t stats);
+
+// The hits of the keywords, two-plus and one-char tokens, dumped as a ulf-file with the hashcode searched again.
+ULS_DLL_EXTERN int uls_enable_profile(uls_lex_ptr_t uls, int on);
+ULS_DLL_EXTERN void uls_reset_profile(uls_lex_ptr_t uls);
+ULS_DLL_EXTERN int uls_merge_profile(uls_lex_ptr_t uls, uls_lex_ptr_t uls_src);
+ULS_DLL_EXTERN int uls_dump_profile_ulf(uls_lex_ptr_t uls, const char *filepath);
+
+ULS_DLL_EXTERN int uls_enable_intern(uls_lex_ptr_t uls, int on);
+ULS_DLL_EXTERN int uls_tok_atom(uls_lex_ptr_t uls);
+ULS_DLL_EXTERN const char* uls_atom_str(uls_lex_ptr_t uls, int atom_id, int *ptr_len);
+ULS_DLL_EXTERN int uls_num_atoms(uls_lex_ptr_t uls);
+
+// In the wide mode, the lexeme in wchar_t is made while scanning the token.
+// uls_wlexeme() returns it with its length, or NULL if the mode is off.
+ULS_DLL_EXTERN int uls_want_wlexeme(uls_lex_ptr_t uls, int on);
+ULS_DLL_EXTERN const wchar_t *uls_wlexeme(uls_lex_ptr_t uls, int *ptr_wlen);
+
+// The lexer scans utf-8 only. A UTF-16 input is transcoded to utf-8 once as it's read.
+// Puts the lexeme in UTF-16 into 'wbuf' in one pass, returning the # of its code units.
+// Only the first siz_wbuf of them are put if wbuf is short, so wbuf=NULL just gets the size needed.
+ULS_DLL_EXTERN int uls_lexeme_utf16(uls_lex_ptr_t uls, uls_uint16 *wbuf, int siz_wbuf);
+
+// The lexeme as the span of the UTF-16 source given by uls_push_utf16_source(), not copied.
+// NULL if it isn't the very text there, like the literal strings, then use uls_lexeme_utf16().
+ULS_DLL_EXTERN const uls_uint16 *uls_lexeme_utf16_span(uls_lex_ptr_t uls, int *ptr_wlen);
+
+// A literal string longer than 'siz' bytes comes as a sequence of tokens of the fragments of it, siz=0 to turn off.
+// uls_litstr_fragment() tells which fragment the current token is by ULS_LITFRAG_FIRST, _MIDDLE and _LAST.
+ULS_DLL_EXTERN int uls_set_litstr_chunk(uls_lex_ptr_t uls, int siz);
+ULS_DLL_EXTERN int uls_litstr_fragment(uls_lex_ptr_t uls);
+
+// In the tokid-only mode, the tokens are classified without copying their lexemes into the token buffer.
+// The lexeme of an identifier, a keyword or an operator is left in the input, to be copied only if uls_lexeme() is called.
+ULS_DLL_EXTERN int uls_want_tokid_only(uls_lex_ptr_t uls, int on);
+ULS_DLL_EXTERN const char* uls_lexeme_terminated(uls_lex_ptr_t uls);
+
+// With the line index, the starts of the lines are recorded as the input is read, and the tokens know their offsets.
+// The offsets are in bytes from the start of the input, in UTF-8 for the UTF-16/32 files, and the columns are from 1.
+// The line numbers of the index are those of the input, not changed by the line-number directives.
+ULS_DLL_EXTERN int uls_want_lineidx(uls_lex_ptr_t uls, int on);
+ULS_DLL_EXTERN int uls_tok_offset(uls_lex_ptr_t uls, int *ptr_column);
+ULS_DLL_EXTERN int uls_offset_lineno(uls_lex_ptr_t uls, int offset, int *ptr_column);
+ULS_DLL_EXTERN int uls_lineno_offset(uls_lex_ptr_t uls, int lineno);
+
 ULS_DLL_EXTERN int uls_get_tok(uls_lex_ptr_t uls);
 ULS_DLL_EXTERN void uls_set_tok(uls_lex_ptr_t uls, int tokid, const char *lexeme, int l_lexeme);
 ULS_DLL_EXTERN void uls_expect(uls_lex_ptr_t uls, int value);
@@ -321,6 +396,13 @@ ULS_DLL_EXTERN int uls_set_isrc(uls_lex_ptr_t uls,
 ULS_DLL_EXTERN int uls_push_line(uls_lex_ptr_t uls, const char *line, int len, int flags);
 ULS_DLL_EXTERN int uls_set_line(uls_lex_ptr_t uls, const char *line, int len, int flags);
 
+// push-mode: uls_get_tok() returns the NONE-token and uls_is_starved() is true until more bytes are fed.
+ULS_DLL_EXTERN int uls_push_feed(uls_lex_ptr_t uls, int flags);
+ULS_DLL_EXTERN int uls_set_feed(uls_lex_ptr_t uls, int flags);
+ULS_DLL_EXTERN int uls_feed(uls_lex_ptr_t uls, const char *bytes, int len);
+ULS_DLL_EXTERN int uls_feed_end(uls_lex_ptr_t uls);
+ULS_DLL_EXTERN int uls_is_starved(uls_lex_ptr_t uls);
+
 ULS_DLL_EXTERN int uls_cardinal_toknam(char *toknam, uls_lex_ptr_t uls, int tok_id, const char *tokstr);
 ULS_DLL_EXTERN int uls_cardinal_toknam_deco(char *toknam_buff, const char *toknam);
 ULS_DLL_EXTERN int uls_cardinal_toknam_deco_lxmpfx(char *toknam_buff, char *lxmpfx, uls_lex_ptr_t uls,
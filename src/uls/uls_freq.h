@@ -50,6 +50,7 @@ _ULS_DEFINE_STRUCT(ulf_header)
 	uls_type_tool(version) filever;
 	uls_def_namebuf(hash_algorithm, ULS_LEXSTR_MAXSIZ);
 	uls_def_intarray(weights);
+	int hash_table_size;
 };
 #endif
 
@@ -74,6 +75,14 @@ int keyw_stat_comp_by_freq(uls_const_voidptr_t a, uls_const_voidptr_t b);
 ULS_DLL_EXTERN int ulf_create_file(uls_hash_stat_ptr_t hs, uls_keyw_stat_list_ptr_t kwslst, FILE* fout);
 ULS_DLL_EXTERN uls_keyw_stat_ptr_t ulf_search_kwstat_list(
 	uls_keyw_stat_list_ptr_t kwslst, const char *str);
+ULS_DLL_EXTERN void ulf_sort_kwstat_by_keyw(uls_keyw_stat_list_ptr_t kwslst);
+ULS_DLL_EXTERN void ulf_sort_kwstat_by_chain(uls_keyw_stat_list_ptr_t kwslst);
+ULS_DLL_EXTERN int ulf_table_size(int i, int n_keyws);
+ULS_DLL_EXTERN void ulf_set_o1_weights(uls_hash_stat_ptr_t hs, int idx);
+ULS_DLL_EXTERN double ulf_hash_probes(uls_hash_stat_ptr_t hs, uls_hashfunc_t hashfunc,
+	uls_keyw_stat_list_ptr_t kwslst, double n_misses, int *buckets);
+ULS_DLL_EXTERN double ulf_search_hashcode(uls_hash_stat_ptr_t hs, uls_hashfunc_t hashfunc,
+	uls_keyw_stat_list_ptr_t kwslst, double n_misses);
 #endif
 
 #ifdef _ULS_CPLUSPLUS
@@ -38,6 +38,7 @@
 #ifndef ULS_EXCLUDE_HFILES
 #include "uls/csz_stream.h"
 #include "uls/litstr.h"
+#include "uls/uls_stats.h"
 #endif
 
 #ifdef _ULS_CPLUSPLUS
@@ -97,6 +98,8 @@ ULS_DEFINE_STRUCT_BEGIN(source)
 };
 
 #define ULS_INP_FL_REFILL_NULL 0x0100
+#define ULS_INP_FL_FEED        0x0200
+#define ULS_INP_FL_LINEIDX     0x0400
 ULS_DEFINE_STRUCT_BEGIN(input)
 {
 	uls_flags_t flags;
@@ -107,12 +110,31 @@ ULS_DEFINE_STRUCT_BEGIN(input)
 	int  rawbuf_bytes;
 	int line_num;
 
+	// The offset of the end of the bytes read, which is that of rawbuf_ptr + rawbuf_bytes.
+	// With ULS_INP_FL_LINEIDX, linestarts[i] is the offset of the line i+1 of the input.
+	int  offset_read;
+	int  *linestarts;
+	int  n_linestarts, n_alloc_linestarts;
+
 	uls_callback_type_this(input_refill) refill;
+	uls_stats_ptr_t stats;
+};
+
+// The source of the input in push-mode, the bytes given by uls_feed().
+// Only the complete lines are exposed to the filler until the feed is ended.
+ULS_DEFINE_STRUCT(feed)
+{
+	_uls_type_tool(csz_str) buf;
+	int  n_consumed;  // the bytes read into the rawbuf
+	int  n_committed; // the bytes the filler is done with
+	int  n_ready;     // the bytes up to the last line-feed
+	int  ended;
 };
 #endif // ULS_DEF_PUBLIC_TYPE
 
 #ifdef ULS_DECL_PRIVATE_PROC
 ULS_DECL_STATIC _ULS_INLINE int __input_space_proc(const char *ch_ctx, _uls_ptrtype_tool(csz_str) ss_dst, uls_ptrtype_tool(outparam) parms);
+ULS_DECL_STATIC void __uls_input_add_linestart(uls_input_ptr_t inp, int offset);
 #endif
 
 #ifdef ULS_DECL_PROTECTED_PROC
@@ -120,6 +142,8 @@ void uls_init_commtype(uls_commtype_ptr_t qmt);
 void uls_deinit_commtype(uls_commtype_ptr_t qmt);
 
 int input_skip_comment(uls_commtype_ptr_t cmt, uls_input_ptr_t inp, uls_ptrtype_tool(outparam) parms);
+void input_quote_begin(uls_litstr_ptr_t lit, uls_quotetype_ptr_t qmt, _uls_ptrtype_tool(csz_str) ss_dst);
+int input_quote_fragment(uls_input_ptr_t inp, uls_litstr_ptr_t lit, int maxlen, uls_ptrtype_tool(outparam) parms);
 int input_quote_proc(uls_input_ptr_t inp, uls_quotetype_ptr_t qmt, _uls_ptrtype_tool(csz_str) ss_dst, uls_ptrtype_tool(outparam) parms);
 int input_space_proc(const char *ch_ctx, uls_input_ptr_t inp, _uls_ptrtype_tool(csz_str) ss_dst, uls_ptrtype_tool(outparam) parms0);
 
@@ -135,6 +159,11 @@ uls_input_ptr_t uls_create_input(void);
 void uls_destroy_input(uls_input_ptr_t inp);
 
 void uls_input_reset_cursor(uls_input_ptr_t inp);
+void uls_input_reset_offset(uls_input_ptr_t inp);
+void uls_input_index_lines(uls_input_ptr_t inp, const char *buf, int n);
+#define uls_input_offset(inp,ptr) ((inp)->offset_read - (int) ((inp)->rawbuf_ptr + (inp)->rawbuf_bytes - (ptr)))
+int uls_input_offset_lineno(uls_input_ptr_t inp, int offset, int *ptr_column);
+int uls_input_lineno_offset(uls_input_ptr_t inp, int lineno);
 void uls_input_reset(uls_input_ptr_t inp, int bufsiz, int flags);
 
 void uls_input_change_filler_null(uls_input_ptr_t inp);
@@ -156,6 +185,15 @@ void uls_ungrab_null_source(uls_source_ptr_t isrc);
 
 int uls_fill_fd_isrc_utf8(uls_source_ptr_t isrc, char *buf, int buflen, int bufsiz);
 
+void uls_input_change_filler_feed(uls_input_ptr_t inp);
+int uls_input_feed(uls_input_ptr_t inp, const char *bytes, int len);
+int uls_input_feed_end(uls_input_ptr_t inp);
+int uls_input_is_starving(uls_input_ptr_t inp);
+void uls_input_feed_commit(uls_input_ptr_t inp);
+
+int uls_fill_feed_source(uls_source_ptr_t isrc, char *buf, int buflen, int bufsiz);
+void uls_ungrab_feed_source(uls_source_ptr_t isrc);
+
 #endif // ULS_DECL_PROTECTED_PROC
 
 #ifdef _ULS_CPLUSPLUS
@@ -34,6 +34,7 @@
 #include "uls/uls_core.h"
 #include "uls/uls_stream.h"
 #include "uls/uls_fileio.h"
+#include "uls/uls_zsrc.h"
 #ifdef ULS_FDF_SUPPORT
 #include "uls/fdfilter.h"
 #endif
@@ -57,9 +58,12 @@ ULS_DEFINE_STRUCT(istream)
 #ifdef ULS_FDF_SUPPORT
 	fdf_t   *fdf; // fd ---> fdf --->
 #endif
+	uls_zsrc_ptr_t zsrc; // fd ---> zsrc ---> if the file is compressed
 	char    *firstline;
 	int     len_firstline;
 	int     start_off;
+	char    *map_base; // the whole file if it's mapped by uls_map_istream()
+	int     map_size;
 
 	uls_lex_ptr_t uls;
 	uls_type_tool(tempfile) uld_file;
@@ -74,7 +78,10 @@ ULS_DECL_STATIC int make_tokpkt_seqence(uls_lex_ptr_t uls, const char *line, uls
 ULS_DECL_STATIC void make_eoif_lexeme_bin(uls_context_ptr_t ctx, int tok_id, const char *txt, int txtlen);
 
 ULS_DECL_STATIC int uls_readline_buffer(char *buf, int bufsiz);
-ULS_DECL_STATIC int parse_uls_hdr(char *line, int fd_in, uls_istream_ptr_t istr);
+ULS_DECL_STATIC int __istr_readn(uls_istream_ptr_t istr, char *buf, int n);
+ULS_DECL_STATIC int __uls_take_bin_record(uls_lex_ptr_t uls, int tok_id, int txtlen, const char *lptr);
+ULS_DECL_STATIC int __uls_gettok_bin_inplace(uls_lex_ptr_t uls, int reverse);
+ULS_DECL_STATIC int parse_uls_hdr(char *line, uls_istream_ptr_t istr);
 #endif
 
 #ifdef ULS_DECL_PROTECTED_PROC
@@ -95,6 +102,11 @@ int uls_fill_fd_stream(uls_source_ptr_t isrc, char *buf, int buflen, int bufsiz)
 void uls_ungrab_fd_stream(uls_source_ptr_t isrc);
 
 int uls_gettok_bin(uls_lex_ptr_t uls);
+
+int uls_map_istream(uls_istream_ptr_t istr);
+int xcontext_binmap_filler(uls_xcontext_ptr_t xctx);
+int uls_gettok_bin_inplace_host_order(uls_lex_ptr_t uls);
+int uls_gettok_bin_inplace_reverse_order(uls_lex_ptr_t uls);
 #endif
 
 #ifdef ULS_DECL_PUBLIC_PROC
@@ -43,6 +43,7 @@ extern "C" {
 
 #if defined(__ULS_LEX__) || defined(ULS_DECL_PRIVATE_PROC)
 ULS_DECL_STATIC int __uls_change_stream_hdr(uls_lex_ptr_t uls, uls_istream_ptr_t istr, int flags);
+ULS_DECL_STATIC void __uls_select_inplace_filler(uls_lex_ptr_t uls, uls_istream_ptr_t istr);
 ULS_DECL_STATIC void uls_fd_ungrabber(uls_voidptr_t data);
 ULS_DECL_STATIC int __check_fd_dup(int fd, int flags);
 #endif
@@ -72,6 +73,8 @@ ULS_DLL_EXTERN int uls_register_ungrabber(uls_lex_ptr_t uls, int at_tail,
 
 ULS_DLL_EXTERN void uls_push_utf16_line(uls_lex_ptr_t uls, uls_uint16* wline, int wlen);
 ULS_DLL_EXTERN void uls_set_utf16_line(uls_lex_ptr_t uls, uls_uint16* wline, int wlen);
+// Like uls_push_utf16_line() but 'wline' must be kept while the lexemes are got by uls_lexeme_utf16_span().
+ULS_DLL_EXTERN int uls_push_utf16_source(uls_lex_ptr_t uls, const uls_uint16* wline, int wlen);
 
 ULS_DLL_EXTERN void uls_push_utf32_line(uls_lex_ptr_t uls, uls_uint32* wline, int wlen);
 ULS_DLL_EXTERN void uls_set_utf32_line(uls_lex_ptr_t uls, uls_uint32* wline, int wlen);
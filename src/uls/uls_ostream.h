@@ -33,6 +33,7 @@
 #ifndef ULS_EXCLUDE_HFILES
 #include "uls/uld_conf.h"
 #include "uls/csz_stream.h"
+#include "uls/uls_zsrc.h"
 #endif
 
 #ifdef _ULS_CPLUSPLUS
@@ -52,6 +53,7 @@ ULS_DEFINE_STRUCT(ostream)
 	int     ref_cnt;
 
 	int     fd; /* write-only */
+	uls_zsrc_ptr_t zsrc; // ---> zsrc ---> fd if compressing
 
 	uls_wr_packet_t pktbuf;
 	_uls_type_tool(csz_str) out_fd_csz;
@@ -80,11 +82,14 @@ ULS_DECL_STATIC uls_ostream_ptr_t __create_ostream(int fd);
 ULS_DECL_STATIC void __destroy_ostream(uls_ostream_ptr_t ostr);
 ULS_DECL_STATIC void __bind_ostream_callbacks(uls_ostream_ptr_t ostr, int stream_type);
 ULS_DECL_STATIC int write_uld_to_ostream(uls_xcontext_ptr_t xctx,
-	uls_ptrtype_tool(outparam) parms, int fd_out);
+	uls_ptrtype_tool(outparam) parms, uls_ostream_ptr_t ostr);
 ULS_DECL_STATIC int write_ostream_header(uls_ostream_ptr_t ostr, uls_xcontext_ptr_t xctx);
 ULS_DECL_STATIC void __uls_bind_ostream(uls_ostream_ptr_t ostr, uls_lex_ptr_t uls);
 ULS_DECL_STATIC void __uls_unbind_ostream(uls_ostream_ptr_t ostr);
-ULS_DECL_STATIC int __flush_uls_stream_buffer(_uls_ptrtype_tool(csz_str) outbuf, int fd, int force);
+ULS_DECL_STATIC uls_ostream_ptr_t __uls_create_ostream_2(int fd_out, uls_lex_ptr_t uls,
+	int stream_type, const char *subname, int zformat);
+ULS_DECL_STATIC int __ostr_writen(uls_ostream_ptr_t ostr, char *buf, int n);
+ULS_DECL_STATIC int __flush_uls_stream_buffer(uls_ostream_ptr_t ostr, _uls_ptrtype_tool(csz_str) outbuf, int force);
 ULS_DECL_STATIC int __uls_finalize_ostream(uls_ostream_ptr_t ostr);
 ULS_DECL_STATIC int __uls_make_packet_linenum(uls_ostream_ptr_t ostr, int lno, const char *tag, int tag_len);
 ULS_DECL_STATIC int __uls_make_packet(uls_ostream_ptr_t ostr, int tokid, const char *tokstr, int l_tokstr);
@@ -112,8 +117,11 @@ int save_istr_hdrbuf(char *ulshdr, int buflen, int fd);
 #ifdef ULS_DECL_PUBLIC_PROC
 ULS_DLL_EXTERN uls_ostream_ptr_t __uls_create_ostream(int fd_out, uls_lex_ptr_t uls, int stream_type, const char *subname);
 ULS_DLL_EXTERN uls_ostream_ptr_t uls_create_ostream(int fd_out, uls_lex_ptr_t uls, const char *subname);
+ULS_DLL_EXTERN uls_ostream_ptr_t uls_create_ostream_2(int fd_out, uls_lex_ptr_t uls, const char *subname, int zformat);
 ULS_DLL_EXTERN uls_ostream_ptr_t uls_create_ostream_file(const char *filepath, uls_lex_ptr_t uls, const char *subname);
 ULS_DLL_EXTERN int uls_destroy_ostream(uls_ostream_ptr_t ostr);
+ULS_DLL_EXTERN uls_ostream_ptr_t uls_create_ostream_seg(uls_ostream_ptr_t ostr, uls_lex_ptr_t uls);
+ULS_DLL_EXTERN int uls_append_ostream_seg(uls_ostream_ptr_t ostr, uls_ostream_ptr_t seg);
 #define uls_close_ostream uls_destroy_ostream
 
 ULS_DLL_EXTERN int __uls_print_tok(uls_ostream_ptr_t ostr, int tokid, const char *tokstr, int l_tokstr);
@@ -0,0 +1,132 @@
+/*
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * uls_plex.h -- lexing a large text in parallel by speculative chunks --
+ *     written by Stanley Hong <link2next@gmail.com>, October 2026.
+ *
+ *  This file is part of ULS, Unified Lexical Scheme.
+ */
+#ifndef __ULS_PLEX_H__
+#define __ULS_PLEX_H__
+
+#ifndef ULS_EXCLUDE_HFILES
+#include "uls/uls_core.h"
+#endif
+
+#ifdef _ULS_CPLUSPLUS
+extern "C" {
+#endif
+
+#ifdef ULS_DECL_GLOBAL_TYPES
+#define ULS_PLEX_MAX_CHUNKS  64
+#endif
+
+#ifdef ULS_DECL_PUBLIC_TYPE
+ULS_DECLARE_STRUCT(plex);
+#endif
+
+#ifdef ULS_DEF_PUBLIC_TYPE
+ULS_DEFINE_STRUCT(plex_tok)
+{
+	int  tok_id, lineno;
+	int  i_pool; // the chunk whose pool has the lexeme, n_chunks for 'fix'
+	int  lxm_offset, lxm_len;
+};
+
+ULS_DEFINE_STRUCT(plex_line)
+{
+	int  offset; // the offset of the line in the text
+	int  i_tok;  // the first token at or after the line
+	int  safe;   // the line starts outside comments and quote-strings
+};
+
+// A chunk is lexed from its first line as if it starts outside comments and quote-strings.
+// The run goes over the end of the chunk up to the first safe line, 'lines[stop_line]'.
+// A wrong guess may end in an ERR-token (and its log), which is recovered by re-lexing in 'fix'.
+ULS_DEFINE_STRUCT(plex_chunk)
+{
+	uls_plex_ptr_t plx;
+	uls_lex_ptr_t uls;
+	int  offset, end;
+
+	uls_plex_tok_ptr_t toks;
+	int  n_toks, n_alloc_toks;
+
+	uls_plex_line_ptr_t lines;
+	int  n_lines, n_alloc_lines;
+	int  stop_line, err;
+
+	_uls_type_tool(csz_str) lxm_pool;
+};
+
+ULS_DEFINE_STRUCT(plex)
+{
+	const char *text;
+	int  text_len;
+
+	uls_plex_chunk_ptr_t chunks;
+	int  n_chunks, n_active_chunks;
+
+	// the re-lexing from a safe line where the guess of a chunk was wrong
+	uls_plex_chunk_t fix;
+	int  n_fixes;
+
+	// the stitched token stream
+	uls_plex_tok_ptr_t toks;
+	int  n_toks, n_alloc_toks;
+};
+#endif
+
+#if defined(__ULS_PLEX__) || defined(ULS_DECL_PRIVATE_PROC)
+ULS_DECL_STATIC void __plex_init_chunk(uls_plex_ptr_t plx, uls_plex_chunk_ptr_t chk, uls_lex_ptr_t uls);
+ULS_DECL_STATIC void __plex_deinit_chunk(uls_plex_chunk_ptr_t chk);
+ULS_DECL_STATIC void __plex_add_line(uls_plex_chunk_ptr_t chk, int offset, int safe);
+ULS_DECL_STATIC void __plex_add_tok(uls_plex_chunk_ptr_t chk, int tok_id, int lineno, const char *lxm, int lxm_len);
+ULS_DECL_STATIC const char* __plex_next_line(const char *lptr, const char *lptr_end);
+ULS_DECL_STATIC int __plex_find_line(uls_plex_chunk_ptr_t chk, int offset);
+ULS_DECL_STATIC int __plex_can_join(uls_plex_ptr_t plx, int offset);
+ULS_DECL_STATIC void __plex_run(uls_plex_ptr_t plx, uls_plex_chunk_ptr_t chk, int offset);
+ULS_DECL_STATIC void* __plex_run_chunk(void *arg);
+ULS_DECL_STATIC void __plex_run_chunks(uls_plex_ptr_t plx);
+ULS_DECL_STATIC void __plex_append(uls_plex_ptr_t plx, uls_plex_chunk_ptr_t chk, int i_pool, int j, int i_end, int lineno);
+ULS_DECL_STATIC int __plex_stitch(uls_plex_ptr_t plx);
+#endif
+
+#ifdef ULS_DECL_PUBLIC_PROC
+ULS_DLL_EXTERN uls_plex_ptr_t uls_create_plex(const char *confname, int n_chunks);
+ULS_DLL_EXTERN void uls_destroy_plex(uls_plex_ptr_t plx);
+
+ULS_DLL_EXTERN int uls_plex_lex_text(uls_plex_ptr_t plx, const char *text, int len);
+ULS_DLL_EXTERN int uls_plex_lex_file(uls_plex_ptr_t plx, const char *filepath);
+
+ULS_DLL_EXTERN int uls_plex_num_tokens(uls_plex_ptr_t plx);
+ULS_DLL_EXTERN int uls_plex_num_fixes(uls_plex_ptr_t plx);
+ULS_DLL_EXTERN int uls_plex_get_tok(uls_plex_ptr_t plx, int i, uls_ptrtype_tool(outparam) parms);
+#endif
+
+#ifdef _ULS_CPLUSPLUS
+}
+#endif
+
+#endif // __ULS_PLEX_H__
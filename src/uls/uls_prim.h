@@ -336,6 +336,7 @@ ULS_DLL_EXTERN void *__uls_mfree(void *ptr);
 ULS_DLL_EXTERN char *uls_strdup(const char *str, int len);
 ULS_DLL_EXTERN void* uls_memcopy(void *dst, const void *src, int n);
 ULS_DLL_EXTERN void* uls_memmove(void *dst, const void *src, int n);
+ULS_DLL_EXTERN const char *uls_memchr(const char *str, char ch, int n);
 
 ULS_DLL_EXTERN int uls_strlen(const char *str);
 ULS_DLL_EXTERN int uls_strcpy(char *bufptr, const char *str);
@@ -0,0 +1,116 @@
+/*
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * uls_relex.h -- re-lexing the edited text incrementally --
+ *     written by Stanley Hong <link2next@gmail.com>, October 2026.
+ *
+ *  This file is part of ULS, Unified Lexical Scheme.
+ */
+#ifndef __ULS_RELEX_H__
+#define __ULS_RELEX_H__
+
+#ifndef ULS_EXCLUDE_HFILES
+#include "uls/uls_core.h"
+#endif
+
+#ifdef _ULS_CPLUSPLUS
+extern "C" {
+#endif
+
+#ifdef ULS_DECL_PUBLIC_TYPE
+ULS_DECLARE_STRUCT(relex);
+#endif
+
+#ifdef ULS_DEF_PUBLIC_TYPE
+ULS_DEFINE_STRUCT(relex_tok)
+{
+	int  tok_id, lineno;
+	int  lxm_offset, lxm_len; // the lexeme in 'lxm_pool'
+};
+
+// The state of the lexer at the start of a line.
+// The line is a safe point to restart from if 'n_lfs_pending' is 0.
+ULS_DEFINE_STRUCT(relex_ckpt)
+{
+	int  offset;        // the offset of the line in the text
+	int  i_tok;         // the first token at or after the line
+	int  n_lfs_pending; // the line-feeds left to the end of the comment or quote-string the line starts in
+	uls_quotetype_ptr_t qmt; // the quote-type if the line starts inside a quote-string
+};
+
+ULS_DEFINE_STRUCT(relex)
+{
+	uls_lex_ptr_t uls;
+	const char *text;
+	int  text_len;
+
+	uls_relex_tok_ptr_t toks;
+	int  n_toks, n_alloc_toks;
+
+	uls_relex_ckpt_ptr_t ckpts; // a checkpoint per line
+	int  n_lines, n_alloc_lines;
+
+	_uls_type_tool(csz_str) lxm_pool;
+	int  lxm_garbage;
+
+	// the tokens and lines re-lexed, not yet spliced into 'toks' and 'ckpts'
+	uls_relex_tok_ptr_t new_toks;
+	int  n_new_toks, n_alloc_new_toks;
+	uls_relex_ckpt_ptr_t new_ckpts;
+	int  n_new_lines, n_alloc_new_lines;
+};
+#endif
+
+#if defined(__ULS_RELEX__) || defined(ULS_DECL_PRIVATE_PROC)
+ULS_DECL_STATIC uls_voidptr_t __relex_grow(uls_voidptr_t ary, int *ptr_n_alloc, int n, int elem_size);
+ULS_DECL_STATIC const char* __relex_next_line(const char *lptr, const char *lptr_end);
+ULS_DECL_STATIC void __relex_add_line(uls_relex_ptr_t rlx, int offset);
+ULS_DECL_STATIC void __relex_add_tok(uls_relex_ptr_t rlx, int tok_id, int lineno, const char *lxm, int lxm_len);
+ULS_DECL_STATIC int __relex_is_inside_span(uls_xcontext_ptr_t xctx, int r, int j);
+ULS_DECL_STATIC int __relex_find_line(uls_relex_ptr_t rlx, int offset);
+ULS_DECL_STATIC int __relex_can_converge(uls_relex_ptr_t rlx, int r, int j, int new_offset, int byte_delta);
+ULS_DECL_STATIC int __relex_run(uls_relex_ptr_t rlx, int r, int conv_offset, int byte_delta);
+ULS_DECL_STATIC void __relex_splice(uls_relex_ptr_t rlx, int r, int j_old, int byte_delta);
+ULS_DECL_STATIC void __relex_compact_pool(uls_relex_ptr_t rlx);
+ULS_DECL_STATIC void __relex_reset(uls_relex_ptr_t rlx);
+#endif
+
+#ifdef ULS_DECL_PUBLIC_PROC
+ULS_DLL_EXTERN uls_relex_ptr_t uls_create_relex(uls_lex_ptr_t uls);
+ULS_DLL_EXTERN void uls_destroy_relex(uls_relex_ptr_t rlx);
+
+ULS_DLL_EXTERN int uls_relex_set_text(uls_relex_ptr_t rlx, const char *text, int len);
+ULS_DLL_EXTERN int uls_relex_edit(uls_relex_ptr_t rlx, const char *text, int len,
+	int edit_offset, int old_len, int new_len, uls_ptrtype_tool(outparam) parms);
+
+ULS_DLL_EXTERN int uls_relex_num_tokens(uls_relex_ptr_t rlx);
+ULS_DLL_EXTERN int uls_relex_num_lines(uls_relex_ptr_t rlx);
+ULS_DLL_EXTERN int uls_relex_get_tok(uls_relex_ptr_t rlx, int i, uls_ptrtype_tool(outparam) parms);
+#endif
+
+#ifdef _ULS_CPLUSPLUS
+}
+#endif
+
+#endif // __ULS_RELEX_H__
@@ -0,0 +1,97 @@
+/*
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * uls_spec_cache.h -- the compiled specs shared by the lexers in the process --
+ *     written by Stanley Hong <link2next@gmail.com>, October 2026.
+ *
+ *  This file is part of ULS, Unified Lexical Scheme.
+ */
+#ifndef __ULS_SPEC_CACHE_H__
+#define __ULS_SPEC_CACHE_H__
+
+#ifndef ULS_EXCLUDE_HFILES
+#include "uls/uls_core.h"
+#endif
+
+#ifdef _ULS_CPLUSPLUS
+extern "C" {
+#endif
+
+#ifdef ULS_DECL_PUBLIC_TYPE
+ULS_DECLARE_STRUCT(spec_cache_ent);
+ULS_DECLARE_STRUCT(spec_cache);
+#endif
+
+#ifdef ULS_DEF_PUBLIC_TYPE
+#define ULS_SPEC_CACHE_MAX_PARENTS 16
+
+// A spec compiled once by uls_create() and shared by uls_create_shared().
+// The spec-file, ulc or uld, is identified by (dev, ino).
+// The 'sig' is of the (dev, ino, mtime, size) of the files the spec is compiled from,
+//   the uld-file, the ulc-file, its ulf-file and the ulc-files it inherits from.
+// The spec is recompiled if any of them changes.
+ULS_DEFINE_STRUCT(spec_cache_ent)
+{
+	char   *confname;
+	uls_uint64 dev, ino, sig;
+
+	uls_lex_ptr_t spec; // never lexes, grabbed once by the cache and once by each sharer
+	uls_spec_cache_ent_ptr_t next;
+};
+
+ULS_DEFINE_STRUCT(spec_cache)
+{
+	uls_mutex_struct_t  mtx;
+	uls_spec_cache_ent_ptr_t ent_list;
+	int    n_ents;
+};
+#endif // ULS_DEF_PUBLIC_TYPE
+
+#if defined(__ULS_SPEC_CACHE__) || defined(ULS_DEF_PRIVATE_DATA)
+ULS_DECL_STATIC uls_spec_cache_ptr_t uls_spec_cache;
+#endif
+
+#if defined(__ULS_SPEC_CACHE__) || defined(ULS_DECL_PRIVATE_PROC)
+ULS_DECL_STATIC void __sign_spec_file(uls_spec_cache_ent_ptr_t ent, FILE *fp);
+ULS_DECL_STATIC int __stat_spec_file(const char *confname, uls_spec_cache_ent_ptr_t ent);
+ULS_DECL_STATIC void __destroy_spec_cache_ent(uls_spec_cache_ent_ptr_t ent);
+#endif
+
+#ifdef ULS_DECL_PROTECTED_PROC
+void initialize_uls_spec_cache(void);
+void finalize_uls_spec_cache(void);
+
+uls_lex_ptr_t uls_grab_shared_spec(const char *confname);
+void uls_ungrab_shared_spec(uls_lex_ptr_t spec);
+#endif
+
+#ifdef ULS_DECL_PUBLIC_PROC
+ULS_DLL_EXTERN void uls_flush_spec_cache(void);
+#endif
+
+#ifdef _ULS_CPLUSPLUS
+}
+#endif
+
+#endif // __ULS_SPEC_CACHE_H__
@@ -0,0 +1,109 @@
+/*
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * uls_stats.h -- the optional counters of the lexical analyzer --
+ *     written by Stanley Hong <link2next@gmail.com>, October 2026.
+ *
+ *  This file is part of ULS, Unified Lexical Scheme.
+ */
+#ifndef __ULS_STATS_H__
+#define __ULS_STATS_H__
+
+#ifndef ULS_EXCLUDE_HFILES
+#include "uls/uls_prim.h"
+#endif
+
+#ifdef _ULS_CPLUSPLUS
+extern "C" {
+#endif
+
+#ifdef ULS_DECL_GLOBAL_TYPES
+// kw_probe_hist[k] counts the lookups probing k entries, the last bin the rest.
+#define ULS_STATS_N_PROBE_BINS 8
+
+// The counters are updated only if 'stats' is not null, i.e. uls_enable_stats() is called.
+#define uls_stats_inc(stats,fld) do { \
+		if ((stats) != nilptr) ++(stats)->fld; \
+	} while (0)
+
+#define uls_stats_add(stats,fld,n) do { \
+		if ((stats) != nilptr) (stats)->fld += (n); \
+	} while (0)
+
+// The hits are counted only if 'prof' is not null, i.e. uls_enable_profile() is called.
+#define uls_prof_hit(prof,e) do { \
+		if ((prof) != nilptr && (unsigned int) (e)->i_tokdef < (unsigned int) (prof)->n_tokdefs) \
+			++(prof)->tokdef_hits[(e)->i_tokdef]; \
+	} while (0)
+#endif
+
+#ifdef ULS_DECL_PUBLIC_TYPE
+ULS_DECLARE_STRUCT(stats);
+ULS_DECLARE_STRUCT(prof);
+#endif
+
+#ifdef ULS_DEF_PUBLIC_TYPE
+ULS_DEFINE_STRUCT(stats)
+{
+	// the tokens by class
+	uls_uint64 n_toks_id, n_toks_keyw, n_toks_number;
+	uls_uint64 n_toks_1char, n_toks_2plus, n_toks_quote;
+
+	// uls_fillbuff() and the bytes it copied into zbuf1, zbuf2
+	uls_uint64 n_fillbuff;
+	uls_uint64 n_bytes_zbuf1, n_bytes_zbuf2;
+
+	uls_uint64 n_push, n_pop;
+
+	// uls_input_refill_buffer() and the bytes it read
+	uls_uint64 n_refill_reads, n_refill_sleeps, n_refill_bytes;
+
+	// the hash-chain probes of uls_find_kw()
+	uls_uint64 n_kw_lookups, n_kw_probes;
+	int kw_probe_max;
+	uls_uint64 kw_probe_hist[ULS_STATS_N_PROBE_BINS];
+
+	// The csz-pool is shared by all the uls-objects in the process.
+	uls_uint64 n_csz_pool_hits, n_csz_pool_misses;
+};
+
+// The hits of the keywords, two-plus and one-char tokens of a lexer.
+// Each lexer counts in its own array, so the lexers sharing a spec needn't lock.
+ULS_DEFINE_STRUCT(prof)
+{
+	uls_uint64 *tokdef_hits; // by uls_tokdef_t.i_tokdef
+	int n_tokdefs;
+	uls_uint64 n_ids; // the identifiers that aren't keywords
+};
+#endif // ULS_DEF_PUBLIC_TYPE
+
+#ifdef ULS_DECL_PROTECTED_PROC
+void uls_stats_add_probes(uls_stats_ptr_t stats, int n_probes);
+#endif
+
+#ifdef _ULS_CPLUSPLUS
+}
+#endif
+
+#endif // __ULS_STATS_H__
@@ -52,6 +52,7 @@ extern "C" {
 #ifdef ULS_DECL_PROTECTED_TYPE
 #define ULS_STREAM_ERR         0x01
 #define ULS_STREAM_FDCLOSE     0x02
+#define ULS_STREAM_SEGMENT     0x04
 
 #define ULS_RSVD_TOKS_MAXSIZ (63+(2+N_MAX_DIGITS_INT)*N_RESERVED_TOKS)
 #define ULS_TMPLS_DUP 0x01
@@ -51,9 +51,16 @@ extern "C" {
 #define ULS_VX_ANONYMOUS         0x08
 #define ULS_VX_CHRMAP            0x10
 #define ULS_VX_REFERRED          0x20
+// The object is in the spec-arena, and also marks the aliases(tokdef_name).
+#define ULS_VX_ARENA             0x40
+
+#define ULS_SPEC_ARENA_BLKSIZ    16384
+#define ULS_SPEC_ARENA_HOT       0
+#define ULS_SPEC_ARENA_COLD      1
 
 ULS_DECLARE_STRUCT(tokdef_vx);
 ULS_DECLARE_STRUCT(tokdef);
+ULS_DECLARE_STRUCT(spec_arena_blk);
 #endif
 
 #ifdef ULS_DECL_PUBLIC_TYPE
@@ -70,36 +77,58 @@ ULS_DEFINE_STRUCT(tokdef_name)
 };
 ULS_DEF_PARRAY(tokdef_name);
 
+// The fields used in lexing come first, the names at the tail.
 ULS_DEFINE_STRUCT_BEGIN(tokdef_vx)
 {
 	uls_flags_t flags;
 	int  tok_id; // primary
+	uls_tokdef_ptr_t base; // list of tokdef
 
-	uls_def_namebuf(name, ULS_TOKNAM_MAXSIZ);
 	int  l_name;
+	uls_def_namebuf(name, ULS_TOKNAM_MAXSIZ);
 
 	uls_voidptr_t extra_tokdef;
-	uls_tokdef_ptr_t base; // list of tokdef
 	uls_tokdef_name_ptr_t tokdef_names; // list of aliases
 };
 ULS_DEF_PARRAY(tokdef_vx);
 
+// The keyword bytes are at the tail, compared only if ulen_keyword matches.
 ULS_DEFINE_STRUCT_BEGIN(tokdef)
 {
-	uls_def_namebuf(keyword, ULS_TWOPLUS_WMAXLEN*ULS_UTF8_CH_MAXLEN); // primary
 	int  ulen_keyword, wlen_keyword;
 	int  keyw_type;
-
-	uls_tokdef_vx_ptr_t view;
+	int  i_tokdef; // the index in tokdef_array[] of the spec, -1 if not there
 
 	// Hash link for same hash-value(keyword,ulen_keyword)
 	uls_tokdef_ptr_t link;
 
+	uls_tokdef_vx_ptr_t view;
+
 	// The link for grounping the elements with same view->tok_id via tokdef_vx.base.
 	uls_tokdef_ptr_t next;
+
+	uls_def_namebuf(keyword, ULS_TWOPLUS_WMAXLEN*ULS_UTF8_CH_MAXLEN); // primary
 };
 ULS_DEF_PARRAY(tokdef);
 
+/*
+ * The objects of a lexical spec are bump-allocated from the blocks of the arena
+ *   and released all at once with the spec.
+ * The tokdefs and tokdef_vx's go to the hot region, being packed in the order of ulc-file.
+ * The aliases and the one-char entries not in the maps go to the cold region.
+ */
+ULS_DEFINE_STRUCT_BEGIN(spec_arena_blk)
+{
+	uls_spec_arena_blk_ptr_t prev;
+	int n_used, n_alloc;
+};
+
+ULS_DEFINE_STRUCT(spec_arena)
+{
+	uls_spec_arena_blk_ptr_t regions[2];
+	int n_bytes;
+};
+
 #endif // ULS_DEF_PUBLIC_TYPE
 
 #if defined(__ULS_TOKDEF__) || defined(ULS_DECL_PRIVATE_PROC)
@@ -109,6 +138,15 @@ ULS_DECL_STATIC void insert_tokdef_name_to_group(uls_tokdef_vx_ptr_t e_vx, uls_t
 #ifdef ULS_DECL_PROTECTED_PROC
 void uls_init_tokdef_vx(uls_tokdef_vx_ptr_t e_vx, int tok_id, const char *name, uls_tokdef_ptr_t e);
 void uls_deinit_tokdef_vx(uls_tokdef_vx_ptr_t e_vx);
+
+void uls_init_spec_arena(uls_spec_arena_ptr_t arena);
+void uls_deinit_spec_arena(uls_spec_arena_ptr_t arena);
+uls_voidptr_t uls_spec_arena_alloc(uls_spec_arena_ptr_t arena, int region, int n_bytes);
+
+uls_tokdef_ptr_t uls_arena_create_tokdef(uls_spec_arena_ptr_t arena);
+void uls_deinit_tokdef(uls_tokdef_ptr_t e);
+uls_tokdef_vx_ptr_t uls_arena_create_tokdef_vx(uls_spec_arena_ptr_t arena, int tok_id, const char *name, uls_tokdef_ptr_t e);
+int uls_add_tokdef_vx_name_2(uls_spec_arena_ptr_t arena, uls_tokdef_vx_ptr_t e_vx, const char *name);
 #endif
 
 #ifdef ULS_DECL_PUBLIC_PROC
@@ -121,7 +159,7 @@ uls_tokdef_vx_ptr_t uls_create_tokdef_vx(int tok_id, const char *name, uls_tokde
 void uls_destroy_tokdef_vx(uls_tokdef_vx_ptr_t e_vx);
 
 int canbe_tokname(const char *str);
-uls_tokdef_name_ptr_t alloc_tokdef_name(const char *name);
+uls_tokdef_name_ptr_t alloc_tokdef_name(uls_spec_arena_ptr_t arena, const char *name);
 void dealloc_tokdef_name(uls_tokdef_name_ptr_t e_nam);
 uls_tokdef_name_ptr_t find_tokdef_alias(uls_tokdef_vx_ptr_t e_vx, const char *name);
 int uls_add_tokdef_vx_name(uls_tokdef_vx_ptr_t e_vx, const char *name);
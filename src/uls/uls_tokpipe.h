@@ -0,0 +1,146 @@
+/*
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * uls_tokpipe.h -- the stages filtering the tokens before uls_get_tok() returns them --
+ *     written by Stanley Hong <link2next@gmail.com>, October 2026.
+ *
+ *  This file is part of ULS, Unified Lexical Scheme.
+ */
+#ifndef __ULS_TOKPIPE_H__
+#define __ULS_TOKPIPE_H__
+
+#ifndef ULS_EXCLUDE_HFILES
+#include "uls/uls_context.h"
+#endif
+
+#ifdef _ULS_CPLUSPLUS
+extern "C" {
+#endif
+
+#ifdef ULS_DECL_GLOBAL_TYPES
+// the return values of a stage
+#define ULS_TOKSTAGE_PASS  0
+#define ULS_TOKSTAGE_DROP  1
+#endif
+
+#ifdef ULS_DECL_PUBLIC_TYPE
+ULS_DECLARE_STRUCT(tokrec);
+ULS_DECLARE_STRUCT(tokpipe);
+
+// A stage gets the tokens one by one and may rewrite the record in place.
+// It returns ULS_TOKSTAGE_DROP to drop the token, ULS_TOKSTAGE_PASS to pass it to the next stage.
+ULS_DEFINE_DELEGATE_BEGIN(tokstage, int)(uls_lex_ptr_t uls, uls_tokrec_ptr_t rec, uls_voidptr_t data);
+ULS_DEFINE_DELEGATE_END(tokstage);
+#endif
+
+#ifdef ULS_DEF_PUBLIC_TYPE
+// The token given to the stages.
+// A stage that rewrites 'lxm' keeps the string valid until it's called again.
+ULS_DEFINE_STRUCT(tokrec)
+{
+	int  tok_id;
+	const char *lxm;
+	int  l_lxm;
+	int  lineno;
+	uls_tokdef_vx_ptr_t tokdef_vx;
+};
+
+ULS_DEFINE_STRUCT(tokq_ent)
+{
+	uls_tokrec_t rec;
+	int  lxm_off; // in the pool of the queue, -1 if 'rec.lxm' is the lexeme of the lexer
+};
+
+ULS_DEFINE_STRUCT(tokq)
+{
+	uls_tokq_ent_ptr_t ents;
+	int  i_head, n_ents, n_alloc_ents;
+
+	uls_type_tool(outbuf) pool;
+	int  l_pool;
+};
+
+ULS_DEFINE_STRUCT(tokstage_slot)
+{
+	uls_callback_type_this(tokstage) proc;
+	uls_voidptr_t data;
+};
+
+ULS_DEFINE_STRUCT(tokpipe)
+{
+	uls_tokstage_slot_ptr_t stages;
+	int  n_stages, n_alloc_stages;
+
+	// The tokens of the current raw token pass through the stages from one queue to the other.
+	// After the last stage, the tokens are given out from 'qout'.
+	uls_tokq_t  queues[2];
+	uls_tokq_ptr_t qout;
+
+	// the queue to which uls_emit_tok() appends, set while a stage is called
+	uls_tokq_ptr_t q_emit;
+	int  lineno_emit;
+
+	// The line number of the raw token, given back to the lexer when 'qout' is used up.
+	int  lineno_raw;
+	int  eoi_passed;
+};
+#endif // ULS_DEF_PUBLIC_TYPE
+
+#if defined(__ULS_TOKPIPE__) || defined(ULS_DECL_PRIVATE_PROC)
+ULS_DECL_STATIC void __init_tokq(uls_tokq_ptr_t q);
+ULS_DECL_STATIC void __deinit_tokq(uls_tokq_ptr_t q);
+ULS_DECL_STATIC void __reset_tokq(uls_tokq_ptr_t q);
+ULS_DECL_STATIC uls_tokq_ent_ptr_t __append_tokq(uls_tokq_ptr_t q,
+	uls_tokrec_ptr_t rec, const char *lxm_raw);
+ULS_DECL_STATIC int __run_tokstages(uls_lex_ptr_t uls, uls_tokpipe_ptr_t pipe);
+#endif
+
+#ifdef ULS_DECL_PROTECTED_PROC
+void uls_destroy_tokpipe(uls_tokpipe_ptr_t pipe);
+int uls_tokpipe_get_tok(uls_lex_ptr_t uls);
+void uls_tokpipe_drop(uls_tokpipe_ptr_t pipe);
+#endif
+
+#ifdef ULS_DECL_PUBLIC_PROC
+// The stages run in the order they're added, inside uls_get_tok().
+// The EOI token is given to the stages once, for them to emit the tokens held back.
+// It's passed on as it is even if a stage drops or rewrites it. The ERR and NONE tokens bypass the stages.
+// The line number of a record, as rewritten by the stages, is that of uls_get_lineno() when it's given out.
+// The text ungot by uls_unget_str() is lexed again and passes the stages after the tokens pending in the pipe.
+// The tokens pending are dropped when the input is pushed or popped and by uls_rewind().
+ULS_DLL_EXTERN int uls_add_tokstage(uls_lex_ptr_t uls, uls_tokstage_t proc, uls_voidptr_t data);
+
+// uls_clear_tokstages() fails with -1 if called from a stage.
+ULS_DLL_EXTERN int uls_clear_tokstages(uls_lex_ptr_t uls);
+
+// Called from a stage, uls_emit_tok() queues a token for the next stages ahead of the current one.
+// Emitting pieces and dropping the current token splits it.
+ULS_DLL_EXTERN int uls_emit_tok(uls_lex_ptr_t uls, int tok_id, const char *lxm, int l_lxm);
+#endif
+
+#ifdef _ULS_CPLUSPLUS
+}
+#endif
+
+#endif // __ULS_TOKPIPE_H__
@@ -0,0 +1,110 @@
+/*
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * uls_zsrc.h -- reading and writing compressed files in-process --
+ *     written by Stanley Hong <link2next@gmail.com>, October 2026.
+ *
+ *  This file is part of ULS, Unified Lexical Scheme.
+ */
+#ifndef __ULS_ZSRC_H__
+#define __ULS_ZSRC_H__
+
+#ifndef ULS_EXCLUDE_HFILES
+#include "uls/uls_prim.h"
+#endif
+
+#ifdef _ULS_CPLUSPLUS
+extern "C" {
+#endif
+
+#ifdef ULS_DECL_GLOBAL_TYPES
+#define ULS_ZSRC_NONE  0
+#define ULS_ZSRC_GZIP  1
+
+// The longest magic bytes of the formats above
+#define ULS_ZSRC_MAGIC_MAXLEN 2
+#endif
+
+#ifdef ULS_DECL_PROTECTED_TYPE
+#define ULS_ZSRC_FL_WRITE  0x01
+#define ULS_ZSRC_FL_EOF    0x02
+#define ULS_ZSRC_FL_ERR    0x04
+#define ULS_ZSRC_FL_INSTRM 0x08
+
+// The window of compressed bytes between the fd and the codec
+#define ULS_ZSRC_WINDOW_SIZ (256*1024)
+#endif
+
+#ifdef ULS_DECL_PUBLIC_TYPE
+ULS_DECLARE_STRUCT(zsrc);
+#endif
+
+#ifdef ULS_DEF_PUBLIC_TYPE
+// A compressed byte stream over the file descriptor 'fd'.
+// The fd itself is neither opened nor closed here.
+ULS_DEFINE_STRUCT_BEGIN(zsrc)
+{
+	uls_flags_t flags;
+	int    fd, format;
+
+	char   *window;
+	int    window_siz;
+	int    i_window, n_window; // the bytes pending for the codec (reader) or the fd (writer)
+
+	char   *pushback; // the decompressed bytes to be read again first
+	int    i_pushback, n_pushback;
+
+	uls_voidptr_t zstrm; // z_stream
+};
+#endif // ULS_DEF_PUBLIC_TYPE
+
+#if defined(__ULS_ZSRC__) || defined(ULS_DECL_PRIVATE_PROC)
+ULS_DECL_STATIC uls_zsrc_ptr_t __zsrc_create(int fd, int format, int flags);
+ULS_DECL_STATIC void __zsrc_destroy(uls_zsrc_ptr_t zs);
+ULS_DECL_STATIC int __zsrc_fill_window(uls_zsrc_ptr_t zs);
+ULS_DECL_STATIC int __zsrc_flush_window(uls_zsrc_ptr_t zs);
+ULS_DECL_STATIC int __zsrc_decode(uls_zsrc_ptr_t zs, char *buf, int bufsiz);
+ULS_DECL_STATIC int __zsrc_encode(uls_zsrc_ptr_t zs, const char *buf, int len, int finish);
+#endif
+
+#ifdef ULS_DECL_PUBLIC_PROC
+ULS_DLL_EXTERN int uls_zsrc_probe(const char *buf, int len);
+ULS_DLL_EXTERN int uls_zsrc_supported(int format);
+ULS_DLL_EXTERN int uls_zsrc_format_of_path(const char *filepath);
+
+ULS_DLL_EXTERN uls_zsrc_ptr_t uls_zsrc_open(int fd, int format, const char *prefix, int len_prefix);
+ULS_DLL_EXTERN int uls_zsrc_readn(uls_zsrc_ptr_t zs, uls_native_vptr_t ptr, int n);
+ULS_DLL_EXTERN int uls_zsrc_unread(uls_zsrc_ptr_t zs, const char *buf, int len);
+
+ULS_DLL_EXTERN uls_zsrc_ptr_t uls_zsrc_create(int fd, int format);
+ULS_DLL_EXTERN int uls_zsrc_writen(uls_zsrc_ptr_t zs, uls_native_vptr_t ptr, int n);
+
+ULS_DLL_EXTERN int uls_zsrc_close(uls_zsrc_ptr_t zs);
+#endif
+
+#ifdef _ULS_CPLUSPLUS
+}
+#endif
+
+#endif // __ULS_ZSRC_H__
@@ -59,6 +59,12 @@ ULS_DECL_STATIC int __advance_upto_nonspace(uls_context_ptr_t ctx);
 ULS_DECL_STATIC uls_context_ptr_t __uls_unget_str(uls_lex_ptr_t uls, const char *str, int len);
 ULS_DECL_STATIC uls_context_ptr_t __uls_unget_quote(uls_lex_ptr_t uls,
 	const char *qstr, int qlen, uls_tokdef_vx_ptr_t e_vx, int lf_delta);
+ULS_DECL_STATIC const char* __scan_span_in_line(const char *lptr, const char *charset_map, int until,
+	const char *delim, uls_ptrtype_tool(outparam) parms);
+ULS_DECL_STATIC const char* __scan_class_in_line(uls_lex_ptr_t uls, const char *lptr, int ch_mask,
+	uls_ptrtype_tool(outparam) parms);
+ULS_DECL_STATIC int __uls_scan_span(uls_lex_ptr_t uls, const char *charset, int ch_mask, int until,
+	const char *delim, uls_ptrtype_tool(outparam) parms);
 #endif
 
 #ifdef ULS_DECL_PROTECTED_PROC
@@ -75,6 +81,27 @@ ULS_DLL_EXTERN int uls_unget_ch(uls_lex_ptr_t uls, uls_wch_t wch);
 ULS_DLL_EXTERN uls_wch_t uls_peek_ch(uls_lex_ptr_t uls, uls_nextch_detail_ptr_t detail_ch);
 ULS_DLL_EXTERN uls_wch_t uls_get_ch(uls_lex_ptr_t uls, uls_nextch_detail_ptr_t detail_ch);
 
+// The span-APIs consume in bulk the filtered text that the tokenizer reads, not the raw input.
+// The comments are already removed from it and a run of spaces is collapsed into one.
+// They stop before the next quote-string or at EOF.
+// On return, parms->lptr, parms->len is the span, parms->n the number of line feeds in it,
+//   and parms->flags is 1 if the span was ended by 'ch_mask', 'charset' or 'delim'.
+// The span stays valid until the next call to the uls-object.
+// The 'ch_mask' is of ULS_CH_ID, ULS_CH_IDFIRST, ..., the classes of chars in the spec.
+//   The span goes on while the chars have one of them, or are spaces if 'ch_mask' is 0.
+// The 'charset' is a set of ASCII chars. The 'delim' shouldn't contain line feeds.
+ULS_DLL_EXTERN int uls_scan_filtered_while(uls_lex_ptr_t uls, int ch_mask, uls_ptrtype_tool(outparam) parms);
+ULS_DLL_EXTERN int uls_scan_filtered_until(uls_lex_ptr_t uls, const char *charset, uls_ptrtype_tool(outparam) parms);
+ULS_DLL_EXTERN int uls_take_filtered_until(uls_lex_ptr_t uls, const char *delim, uls_ptrtype_tool(outparam) parms);
+
+// uls_mark() takes the current position with the current token and returns the id of the mark.
+// The text read on from the first mark of the input is kept across the refills of the buffer until it's released.
+// uls_rewind() goes back to the mark, or returns -1 if the mark is dropped, its input popped or its text changed by an unget.
+// Rewinding to a mark drops the marks taken after it. uls_release_mark() drops the mark and the later ones.
+ULS_DLL_EXTERN int uls_mark(uls_lex_ptr_t uls);
+ULS_DLL_EXTERN int uls_rewind(uls_lex_ptr_t uls, int mark_id);
+ULS_DLL_EXTERN void uls_release_mark(uls_lex_ptr_t uls, int mark_id);
+
 ULS_DLL_EXTERN int ulsjava_unget_str(uls_lex_ptr_t uls, const uls_native_vptr_t str, int len_str);
 ULS_DLL_EXTERN int ulsjava_unget_lexeme(uls_lex_ptr_t uls, int tok_id, const uls_native_vptr_t lxm, int len_lxm);
 
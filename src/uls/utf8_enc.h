@@ -37,6 +37,7 @@
 
 #ifndef ULS_EXCLUDE_HFILES
 #include "uls/uls_prim.h"
+#include "uls/uls_zsrc.h"
 #endif
 
 #ifdef _ULS_CPLUSPLUS
@@ -64,6 +65,9 @@ ULS_DEFINE_DELEGATE_END(fill_utf_rawbuf);
 
 ULS_DEFINE_DELEGATE_BEGIN(dec_utf_rawbuf, int)(uls_utf_inbuf_ptr_t inp, uls_wch_t* out_buf, int out_bufsiz);
 ULS_DEFINE_DELEGATE_END(dec_utf_rawbuf);
+
+ULS_DEFINE_DELEGATE_BEGIN(enc_utf_rawbuf, int)(uls_utf_inbuf_ptr_t inp, char *utf8buf, int siz_utf8buf);
+ULS_DEFINE_DELEGATE_END(enc_utf_rawbuf);
 #endif
 
 #ifdef ULS_DEF_PUBLIC_TYPE
@@ -78,21 +82,26 @@ ULS_DEFINE_STRUCT_BEGIN(utf_inbuf)
 	uls_wch_t wch_buffered;
 
 	int    fd;
+	uls_zsrc_ptr_t zsrc; // read through it instead of fd if not nil
 	int    is_eof;
 	uls_voidptr_t data;
 
 	uls_callback_type_this(fill_utf_rawbuf) fill_rawbuf;
 	uls_callback_type_this(dec_utf_rawbuf)  dec_rawbuf;
+	uls_callback_type_this(enc_utf_rawbuf)  enc_rawbuf; // straight into utf-8, nilptr if not supported
 	int    reverse;
 };
 #endif // ULS_DEF_PUBLIC_TYPE
 
 #if defined(__ULS_UTF8_ENC__) || defined(ULS_DECL_PRIVATE_PROC)
+ULS_DECL_STATIC int __utf_readn_inbuf(uls_utf_inbuf_ptr_t inp, uls_native_vptr_t ptr, int n);
+
 ULS_DECL_STATIC int fill_utf8_buf(uls_utf_inbuf_ptr_t inp);
 ULS_DECL_STATIC int dec_utf8_buf(uls_utf_inbuf_ptr_t inp, uls_wch_t* out_buf, int out_bufsiz);
 
 ULS_DECL_STATIC int fill_utf16_buf(uls_utf_inbuf_ptr_t inp);
 ULS_DECL_STATIC int dec_utf16_buf(uls_utf_inbuf_ptr_t inp, uls_wch_t* out_buf, int out_bufsiz);
+ULS_DECL_STATIC int enc_utf16_buf(uls_utf_inbuf_ptr_t inp, char *utf8buf, int siz_utf8buf);
 
 ULS_DECL_STATIC int fill_utf32_buf(uls_utf_inbuf_ptr_t inp);
 ULS_DECL_STATIC int dec_utf32_buf(uls_utf_inbuf_ptr_t inp, uls_wch_t* out_buf, int out_bufsiz);
@@ -109,6 +118,9 @@ int uls_fill_utf8str(uls_wch_t *uchs, int n_uchs,
 	char *utf8buf, int siz_utf8buf, int *p_len_utf8buf);
 int uls_fill_utf8buf(uls_utf_inbuf_ptr_t inp, char *utf8buf, int len_utf8buf, int siz_utf8buf);
 
+int uls_utf16_to_utf8buf(const uls_uint16 *wstr, int l_wstr, char *utf8buf, int siz_utf8buf, int *p_l_wstr);
+int uls_utf8_to_utf16buf(const char *str, int len, uls_uint16 *wbuf, int siz_wbuf);
+
 char *uls_enc_utf16str_to_utf8str(uls_uint16 *wstr1, int l_wstr1, uls_outparam_ptr_t parms);
 char *uls_enc_utf32str_to_utf8str(uls_uint32 *wstr1, int l_wstr1, uls_outparam_ptr_t parms);
 
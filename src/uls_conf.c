@@ -128,6 +128,8 @@ ULS_QUALIFIED_METHOD(check_keyw_str)(int lno, const char *str, uls_ptrtype_tool(
 				if (case_insensitive) {
 					wch = _uls_tool_(toupper)(wch);
 				}
+			} else if (case_insensitive && uls_is_char_id(uls, wch)) {
+				wch = uls_fold_wch(wch);
 			}
 
 			if ((rc = _uls_tool_(encode_utf8)(wch, buf + ulen, ULS_LEXSTR_MAXSIZ - ulen)) <= 0) {
@@ -145,7 +147,17 @@ ULS_QUALIFIED_METHOD(check_keyw_str)(int lno, const char *str, uls_ptrtype_tool(
 			}
 
 			if (rc > 1) {
-				for (j=0; j < rc; j++) buf[ulen++] = *ptr++;
+				if (case_insensitive && uls_is_char_id(uls, wch)) {
+					// folded as the identifiers are, see uls_casefold_idstr()
+					ptr += rc;
+					if ((rc = _uls_tool_(encode_utf8)(uls_fold_wch(wch), buf + ulen, ULS_LEXSTR_MAXSIZ - ulen)) <= 0) {
+						_uls_log(err_log)("#%d: encoding error!", lno);
+						return -1;
+					}
+					ulen += rc;
+				} else {
+					for (j=0; j < rc; j++) buf[ulen++] = *ptr++;
+				}
 			} else {
 				if (!_uls_tool_(isgraph)(ch)) ++n_ch_ascii_ctrls;
 				if (case_insensitive) ch = _uls_tool_(toupper)(ch);
@@ -388,7 +400,7 @@ ULS_QUALIFIED_METHOD(make_tokdef_for_quotetype)(uls_lex_ptr_t uls, uls_quotetype
 		return -1;
 	}
 
-	e = uls_create_tokdef();
+	e = uls_arena_create_tokdef(uls_ptr(uls->spec_arena));
 	e->keyw_type = ULS_KEYW_TYPE_LITERAL;
 
 	uls_set_namebuf_value(e->keyword, uls_get_namebuf_value(qmt->start_mark));
@@ -400,7 +412,7 @@ ULS_QUALIFIED_METHOD(make_tokdef_for_quotetype)(uls_lex_ptr_t uls, uls_quotetype
 	slots_keyw = uls_parray_slots(uls_ptr(uls->tokdef_array));
 	slots_keyw[uls->tokdef_array.n++] = e;
 
-	e_vx = uls_create_tokdef_vx(tok_id, qmt_name, e);
+	e_vx = uls_arena_create_tokdef_vx(uls_ptr(uls->spec_arena), tok_id, qmt_name, e);
 	slots_vx = uls_parray_slots(uls_ptr(uls->tokdef_vx_array));
 	slots_vx[uls->tokdef_vx_array.n++] = e_vx;
 
@@ -1819,13 +1831,100 @@ ULS_QUALIFIED_METHOD(srch_vx_by_id)(uls_const_voidptr_t a, uls_const_voidptr_t b
 	return e1_vx->tok_id - e2_vx->tok_id;
 }
 
+void
+ULS_QUALIFIED_METHOD(uls_reset_tokid_map)(uls_lex_ptr_t uls)
+{
+	uls_deinit_parray(uls_ptr(uls->tokid_map));
+	uls_deinit_parray(uls_ptr(uls->tokid_hash));
+	uls->tokid_map_min = 0;
+}
+
+void
+ULS_QUALIFIED_METHOD(uls_build_tokid_map)(uls_lex_ptr_t uls)
+{
+	uls_decl_parray_slots_init(slots_vx, tokdef_vx, uls_ptr(uls->tokdef_vx_array));
+	uls_decl_parray_slots(slots_map, tokdef_vx);
+	uls_decl_parray_slots(slots_hash, tokdef_vx);
+	int n_slots_vx = uls->tokdef_vx_array.n, max_span = ULS_TOKID_MAP_MAXSPAN(n_slots_vx);
+	int i, j, i0, j0, k, n, mask;
+	uls_tokdef_vx_ptr_t e_vx;
+
+	uls_reset_tokid_map(uls);
+	if (n_slots_vx <= 0) return;
+
+	// tokdef_vx_array[] is sorted by tok-id.
+	// Find the window having the most tok-ids within the span 'max_span'.
+	for (i0 = j0 = i = j = 0; j < n_slots_vx; j++) {
+		while ((uls_int64) slots_vx[j]->tok_id - slots_vx[i]->tok_id >= max_span) ++i;
+		if (j - i > j0 - i0) {
+			i0 = i;
+			j0 = j;
+		}
+	}
+
+	uls->tokid_map_min = slots_vx[i0]->tok_id;
+	n = slots_vx[j0]->tok_id - uls->tokid_map_min + 1;
+	uls_init_parray(uls_ptr(uls->tokid_map), tokdef_vx, n);
+	uls->tokid_map.n = n;
+
+	slots_map = uls_parray_slots(uls_ptr(uls->tokid_map));
+	for (i = i0; i <= j0; i++) {
+		e_vx = slots_vx[i];
+		k = e_vx->tok_id - uls->tokid_map_min;
+		if (slots_map[k] == nilptr) slots_map[k] = e_vx;
+	}
+
+	if ((n = n_slots_vx - (j0 - i0 + 1)) <= 0) return;
+
+	for (k = 8; k < 2 * n; k *= 2)
+		/* NOTHING */;
+	uls_init_parray(uls_ptr(uls->tokid_hash), tokdef_vx, k);
+	uls->tokid_hash.n = n;
+	mask = k - 1;
+
+	slots_hash = uls_parray_slots(uls_ptr(uls->tokid_hash));
+	for (i = 0; i < n_slots_vx; i++) {
+		if (i == i0) {
+			i = j0;
+			continue;
+		}
+
+		e_vx = slots_vx[i];
+		for (k = e_vx->tok_id & mask; slots_hash[k] != nilptr; k = (k + 1) & mask) {
+			if (slots_hash[k]->tok_id == e_vx->tok_id) break;
+		}
+		if (slots_hash[k] == nilptr) slots_hash[k] = e_vx;
+	}
+}
+
 ULS_QUALIFIED_RETTYP(uls_tokdef_vx_ptr_t)
 ULS_QUALIFIED_METHOD(uls_find_reg_tokdef_vx)(uls_lex_ptr_t uls, int t)
 {
 	uls_decl_parray_slots_init(slots_vx, tokdef_vx, uls_ptr(uls->tokdef_vx_array));
+	uls_decl_parray_slots(slots_map, tokdef_vx);
 	uls_tokdef_vx_t e0_vx;
 	uls_tokdef_vx_ptr_t e_vx;
+	int k, mask;
+
+	if (uls->tokid_map.n > 0) {
+		k = (int) ((unsigned int) t - (unsigned int) uls->tokid_map_min);
+		if ((unsigned int) k < (unsigned int) uls->tokid_map.n) {
+			slots_map = uls_parray_slots(uls_ptr(uls->tokid_map));
+			return slots_map[k];
+		}
+
+		if (uls->tokid_hash.n > 0) {
+			slots_map = uls_parray_slots(uls_ptr(uls->tokid_hash));
+			mask = uls->tokid_hash.n_alloc - 1;
+			for (k = t & mask; (e_vx = slots_map[k]) != nilptr; k = (k + 1) & mask) {
+				if (e_vx->tok_id == t) return e_vx;
+			}
+		}
+
+		return nilptr;
+	}
 
+	// Not indexed yet, while loading the config-file.
 	e0_vx.tok_id = t;
 	e_vx = (uls_tokdef_vx_ptr_t) uls_bi_search_vptr(uls_ptr(e0_vx),
 		(_uls_type_array(uls_voidptr_t)) slots_vx, uls->tokdef_vx_array.n,
@@ -2204,10 +2303,9 @@ ULS_QUALIFIED_METHOD(init_reserved_toks)(uls_lex_ptr_t uls)
 	int i;
 
 	for (i = 0; i < N_RESERVED_TOKS; i++) {
-		e_vx = uls_alloc_object(uls_tokdef_vx_t);
+		e_vx = uls_arena_create_tokdef_vx(uls_ptr(uls->spec_arena), 0, NULL, nilptr);
 		slots_rsv[i] = slots_vx[i] = e_vx;
-		__init_tokdef_vx(e_vx);
-		e_vx->flags = ULS_VX_RSVD;
+		e_vx->flags |= ULS_VX_RSVD;
 	}
 
 	// tokdef_vx_rsvd[0..N_RESERVED_TOKS-1] is shared by tokdef_vx_array[]
@@ -2364,6 +2462,7 @@ ULS_QUALIFIED_METHOD(reset_context_ready)(uls_lex_ptr_t uls)
 	ctx->tokbuf.buf[0] = '\0';
 	ctx->s_val = ctx->tokbuf.buf;
 	ctx->s_val_len = ctx->s_val_wchars = 0;
+	ctx->l_wtokbuf = -1;
 }
 
 void
@@ -2457,6 +2556,7 @@ ULS_QUALIFIED_METHOD(uls_classify_tok_group)(uls_lex_ptr_t uls)
 {
 	uls_xcontext_ptr_t xctx = uls_ptr(uls->xcontext);
 	uls_decl_parray_slots(slots_vx, tokdef_vx);
+	uls_decl_parray_slots(slots_keyw, tokdef);
 	uls_decl_parray_slots(slots_qmt, quotetype);
 	uls_quotetype_ptr_t qmt;
 	uls_tokdef_vx_ptr_t e_vx;
@@ -2471,6 +2571,12 @@ ULS_QUALIFIED_METHOD(uls_classify_tok_group)(uls_lex_ptr_t uls)
 		uls_resize_parray(uls_ptr(uls->tokdef_array), tokdef, n);
 	}
 
+	// The hits of the tokdefs are counted by this index, see uls_enable_profile().
+	slots_keyw = uls_parray_slots(uls_ptr(uls->tokdef_array));
+	for (i = 0; i < uls->tokdef_array.n; i++) {
+		slots_keyw[i]->i_tokdef = i;
+	}
+
 	if ((n=uls->tokdef_vx_array.n) < uls->tokdef_vx_array.n_alloc) {
 		// shrink the size of uls->tokdef_vx_array to the compact size.
 		uls_resize_parray(uls_ptr(uls->tokdef_vx_array), tokdef_vx, n);
@@ -2478,6 +2584,7 @@ ULS_QUALIFIED_METHOD(uls_classify_tok_group)(uls_lex_ptr_t uls)
 
 	slots_vx = uls_parray_slots(uls_ptr(uls->tokdef_vx_array));
 	_uls_quicksort_vptr(slots_vx, uls->tokdef_vx_array.n, comp_vx_by_tokid);
+	uls_build_tokid_map(uls);
 
 	reset_xcontext_tokid(uls);
 
@@ -2499,6 +2606,7 @@ ULS_QUALIFIED_METHOD(uls_classify_tok_group)(uls_lex_ptr_t uls)
 	xctx->commtypes = uls_ptr(uls->commtypes);
 	xctx->n_commtypes = uls->n_commtypes;
 	xctx->quotetypes = uls_ptr(uls->quotetypes);
+	uls_xcontext_build_markmap(xctx);
 
 	reset_context_ready(uls);
 
@@ -2787,7 +2895,7 @@ ULS_QUALIFIED_METHOD(get_ulc_fileformat_ver)(char *linebuff, int linelen, uls_pt
 	return 0;
 }
 
-ULS_DECL_STATIC int
+int
 ULS_QUALIFIED_METHOD(check_ulc_file_magic)(FILE* fin, uls_ptrtype_tool(version) sysver, char *ulc_lname)
 {
 	int  linelen, len1, len2, magic_code_len;
@@ -2955,9 +3063,9 @@ ULS_QUALIFIED_METHOD(gen_next_tok_id)(ulc_header_ptr_t hdr,
 }
 
 ULS_DECL_STATIC ULS_QUALIFIED_RETTYP(uls_tokdef_ptr_t)
-ULS_QUALIFIED_METHOD(__new_regular_tokdef)(int keyw_type, const char *keyw, int ulen, int wlen)
+ULS_QUALIFIED_METHOD(__new_regular_tokdef)(uls_lex_ptr_t uls, int keyw_type, const char *keyw, int ulen, int wlen)
 {
-	uls_tokdef_ptr_t e = uls_create_tokdef();
+	uls_tokdef_ptr_t e = uls_arena_create_tokdef(uls_ptr(uls->spec_arena));
 
 	e->keyw_type = keyw_type;
 	uls_set_namebuf_value(e->keyword, keyw);
@@ -3024,7 +3132,7 @@ ULS_QUALIFIED_METHOD(__ulc_proc_line__1char)(ulc_header_ptr_t hdr,
 		tok_id = gen_next_tok_id(hdr, nilptr, tok_idstr, ch_kwd);
 
 		if ((e_vx = __find_vx_by_tokid(uls, tok_id, TOKDEF_AREA_REGULAR)) == nilptr) {
-			e_vx = uls_create_tokdef_vx(tok_id, NULL, nilptr);
+			e_vx = uls_arena_create_tokdef_vx(uls_ptr(uls->spec_arena), tok_id, NULL, nilptr);
 			if (ch_kwd == tok_id) {
 				e_vx->flags |= ULS_VX_CHRMAP;
 			} else {
@@ -3038,14 +3146,14 @@ ULS_QUALIFIED_METHOD(__ulc_proc_line__1char)(ulc_header_ptr_t hdr,
 			if (!(e_vx->flags & ULS_VX_REFERRED)) e_vx->flags |= ULS_VX_REFERRED;
 		}
 
-		uls_add_tokdef_vx_name(e_vx, tok_nam);
+		uls_add_tokdef_vx_name_2(uls_ptr(uls->spec_arena), e_vx, tok_nam);
 	}
 
 	if ((e2_vx = uls_find_1char_tokdef_vx(tbl, ch_kwd, uls_ptr(parms2))) == nilptr) {
 		if (parms2.tokgrp != nilptr) {
 			insert_1char_tokdef_map(parms2.tokgrp, ch_kwd, e_vx);
 		} else {
-			insert_1char_tokdef_etc(tbl, ch_kwd, e_vx);
+			insert_1char_tokdef_etc(tbl, uls_ptr(uls->spec_arena), ch_kwd, e_vx);
 		}
 
 	} else if (e2_vx->tok_id != e_vx->tok_id || e2_vx != e_vx) {
@@ -3111,12 +3219,12 @@ ULS_QUALIFIED_METHOD(__ulc_proc_line__userdef)(ulc_header_ptr_t hdr,
 		tok_id = gen_next_tok_id(hdr, nilptr, tok_idstr, 0);
 		e_vx = __find_vx_by_tokid(uls, tok_id, TOKDEF_AREA_BOTH);
 		if (e_vx == nilptr) {
-			e_vx = uls_create_tokdef_vx(tok_id, tok_nam, nilptr);
+			e_vx = uls_arena_create_tokdef_vx(uls_ptr(uls->spec_arena), tok_id, tok_nam, nilptr);
 			realloc_tokdef_array(uls, 1, 0);
 			slots_vx = uls_parray_slots(uls_ptr(uls->tokdef_vx_array));
 			slots_vx[uls->tokdef_vx_array.n++] = e_vx;
 		} else {
-			uls_add_tokdef_vx_name(e_vx, tok_nam);
+			uls_add_tokdef_vx_name_2(uls_ptr(uls->spec_arena), e_vx, tok_nam);
 		}
 	}
 
@@ -3173,11 +3281,11 @@ ULS_QUALIFIED_METHOD(__ulc_proc_line__regular)(ulc_header_ptr_t hdr,
 			slots_vx = uls_parray_slots(uls_ptr(uls->tokdef_vx_array));
 			slots_keyw = uls_parray_slots(uls_ptr(uls->tokdef_array));
 
-			e = __new_regular_tokdef(keyw_type, keyw, ulen, wlen);
+			e = __new_regular_tokdef(uls, keyw_type, keyw, ulen, wlen);
 			slots_keyw[uls->tokdef_array.n++] = e;
 
 			if (e_vx == nilptr) {
-				e_vx = e_vx_grp = uls_create_tokdef_vx(tok_id, tok_nam, e);
+				e_vx = e_vx_grp = uls_arena_create_tokdef_vx(uls_ptr(uls->spec_arena), tok_id, tok_nam, e);
 				slots_vx[uls->tokdef_vx_array.n++] = e_vx;
 			} else {
 				append_tokdef_to_group(e_vx, e);
@@ -3188,7 +3296,7 @@ ULS_QUALIFIED_METHOD(__ulc_proc_line__regular)(ulc_header_ptr_t hdr,
 	}
 
 	if (e_vx_grp == nilptr) { // name-group
-		uls_add_tokdef_vx_name(e_vx, tok_nam);
+		uls_add_tokdef_vx_name_2(uls_ptr(uls->spec_arena), e_vx, tok_nam);
 	}
 
 	if (keyw_type == ULS_KEYW_TYPE_TWOPLUS) {
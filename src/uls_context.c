@@ -398,18 +398,16 @@ ULS_QUALIFIED_METHOD(is_commtype_start)(uls_xcontext_ptr_t xctx, const char *ptr
 {
 	uls_commtype_ptr_t cmt;
 	const char *str;
-	int i;
+	int k;
 
-	for (i=0; i<xctx->n_commtypes; i++) {
-		cmt = uls_get_array_slot_type01(xctx->commtypes, i);
+	for (k = xctx->commtype_by_ch[(unsigned char) ptr[0]]; k > 0; k = xctx->commtype_next[k-1]) {
+		cmt = uls_get_array_slot_type01(xctx->commtypes, k-1);
 
 		if (len < cmt->len_start_mark) continue;
 
 		str = uls_get_namebuf_value(cmt->start_mark);
-		if (ptr[0] == str[0]) {
-			if (cmt->len_start_mark == 1 || !_uls_tool_(strncmp)(ptr+1,str+1, cmt->len_start_mark-1)) {
-				return cmt;
-			}
+		if (cmt->len_start_mark == 1 || !_uls_tool_(strncmp)(ptr+1,str+1, cmt->len_start_mark-1)) {
+			return cmt;
 		}
 	}
 
@@ -435,24 +433,73 @@ ULS_QUALIFIED_METHOD(uls_xcontext_find_quotetype)(uls_xcontext_ptr_t xctx, const
 	uls_decl_parray_slots_init(slots_qmt, quotetype, xctx->quotetypes);
 	uls_quotetype_ptr_t qmt;
 	const char *str;
-	int i;
+	int k;
 
-	for (i=0; i<xctx->quotetypes->n; i++) {
-		qmt = slots_qmt[i];
+	for (k = xctx->quotetype_by_ch[(unsigned char) ptr[0]]; k > 0; k = xctx->quotetype_next[k-1]) {
+		qmt = slots_qmt[k-1];
 
 		if (len < qmt->len_start_mark) continue;
 
 		str = uls_get_namebuf_value(qmt->start_mark);
-		if (ptr[0] == str[0]) {
-			if (qmt->len_start_mark == 1 || !_uls_tool_(strncmp)(ptr+1,str+1, qmt->len_start_mark-1)) {
-				return qmt;
-			}
+		if (qmt->len_start_mark == 1 || !_uls_tool_(strncmp)(ptr+1,str+1, qmt->len_start_mark-1)) {
+			return qmt;
 		}
 	}
 
 	return nilptr;
 }
 
+void
+ULS_QUALIFIED_METHOD(uls_xcontext_build_markmap)(uls_xcontext_ptr_t xctx)
+{
+	uls_decl_parray_slots_init(slots_qmt, quotetype, xctx->quotetypes);
+	uls_commtype_ptr_t cmt;
+	uls_quotetype_ptr_t qmt;
+	int i, ch;
+
+	uls_bzero(xctx->commtype_by_ch, ULS_MARKMAP_SIZE);
+	uls_bzero(xctx->quotetype_by_ch, ULS_MARKMAP_SIZE);
+
+	// Prepend them in reverse order to keep the order of the definitions in the chains.
+	for (i = xctx->n_commtypes - 1; i >= 0; i--) {
+		cmt = uls_get_array_slot_type01(xctx->commtypes, i);
+		ch = (unsigned char) uls_get_namebuf_value(cmt->start_mark)[0];
+		xctx->commtype_next[i] = xctx->commtype_by_ch[ch];
+		xctx->commtype_by_ch[ch] = (char) (i + 1);
+	}
+
+	for (i = xctx->quotetypes->n - 1; i >= 0; i--) {
+		qmt = slots_qmt[i];
+		ch = (unsigned char) uls_get_namebuf_value(qmt->start_mark)[0];
+		xctx->quotetype_next[i] = xctx->quotetype_by_ch[ch];
+		xctx->quotetype_by_ch[ch] = (char) (i + 1);
+	}
+}
+
+void
+ULS_QUALIFIED_METHOD(uls_xcontext_rec_linespans)(uls_xcontext_ptr_t xctx, int on)
+{
+	xctx->rec_linespans = on;
+	xctx->n_linespans = 0;
+}
+
+void
+ULS_QUALIFIED_METHOD(uls_xcontext_add_linespan)(uls_xcontext_ptr_t xctx, int lineno, int n_lfs, uls_quotetype_ptr_t qmt)
+{
+	uls_linespan_ptr_t span;
+
+	if (xctx->n_linespans >= xctx->n_alloc_linespans) {
+		xctx->n_alloc_linespans = xctx->n_alloc_linespans > 0 ? 2 * xctx->n_alloc_linespans : 64;
+		xctx->linespans = (uls_linespan_ptr_t) uls_mrealloc(xctx->linespans,
+			xctx->n_alloc_linespans * sizeof(uls_linespan_t));
+	}
+
+	span = xctx->linespans + xctx->n_linespans++;
+	span->lineno = lineno;
+	span->n_lfs = n_lfs;
+	span->qmt = qmt;
+}
+
 int
 ULS_QUALIFIED_METHOD(check_rec_boundary_null)(uls_xcontext_ptr_t xctx, uls_ptrtype_tool(parm_line) parm_ln)
 {
@@ -491,6 +538,7 @@ ULS_QUALIFIED_METHOD(uls_reset_lexseg)(uls_lexseg_ptr_t lexseg,
 
 	lexseg->tokdef_vx = e_vx;
 	lexseg->n_lfs_raw = 0;
+	lexseg->frag_flags = ULS_LITFRAG_FIRST | ULS_LITFRAG_LAST;
 }
 
 void
@@ -524,12 +572,30 @@ ULS_QUALIFIED_METHOD(uls_init_context)(uls_context_ptr_t ctx, uls_gettok_t getto
 	lexseg = uls_get_array_slot_type10(uls_ptr(ctx->lexsegs), 0);
 	uls_reset_lexseg(lexseg, 0, 0, -1, -1, nilptr);
 
+	ctx->zoffsets = nilptr;
+	ctx->n_zoffsets = ctx->n_alloc_zoffsets = 0;
+	ctx->tok_lptr = NULL;
+
+	ctx->wsrc = NULL;
+	ctx->l_wsrc = ctx->wsrc_off8 = ctx->wsrc_off16 = 0;
+
+	ctx->fillgens = nilptr;
+	ctx->n_fillgens = ctx->n_alloc_fillgens = ctx->i_fillgen = 0;
+
 	ctx->gettok = gettok;
 	ctx->fill_proc = uls_ref_callback_this(xcontext_raw_filler);
 	ctx->flags |= ULS_CTX_FL_FILL_RAW;
 	ctx->record_boundary_checker = uls_ref_callback_this(check_rec_boundary_null);
 
 	ctx->tmpls_pool = nilptr;
+	ctx->buf_serial = 0;
+	ctx->atom_id = 0;
+	ctx->litfrag_flags = 0;
+
+	ctx->commfrag = nilptr;
+	_uls_tool(csz_init)(uls_ptr(ctx->litpend), 0);
+	ctx->litpend_flags = ctx->litpend_lfs = 0;
+	ctx->lit_offset = 0;
 
 	ctx->tok = tok0;
 	ctx->s_val = ctx->tokbuf.buf;
@@ -542,6 +608,9 @@ ULS_QUALIFIED_METHOD(uls_init_context)(uls_context_ptr_t ctx, uls_gettok_t getto
 	_uls_tool(str_init)(uls_ptr(ctx->tokbuf_aux), n);
 	ctx->l_tokbuf_aux = -1;
 
+	_uls_tool(str_init)(uls_ptr(ctx->wtokbuf), 0);
+	ctx->l_wtokbuf = -1;
+
 	ctx->anonymous_uchar_vx = uls_create_tokdef_vx(0, NULL, nilptr); // 0: nonsense
 	ctx->anonymous_uchar_vx->flags |= ULS_VX_ANONYMOUS;
 	ctx->user_data = nilptr;
@@ -554,8 +623,10 @@ ULS_QUALIFIED_METHOD(uls_deinit_context)(uls_context_ptr_t ctx)
 	uls_destroy_input(ctx->input);
 	ctx->input = nilptr;
 
+	uls_context_drop_fills(ctx);
 	_uls_tool(csz_deinit)(uls_ptr(ctx->zbuf1));
 	_uls_tool(csz_deinit)(uls_ptr(ctx->zbuf2));
+	_uls_tool(csz_deinit)(uls_ptr(ctx->litpend));
 
 	ctx->fill_proc = uls_ref_callback_this(xcontext_raw_filler);
 	ctx->flags |= ULS_CTX_FL_FILL_RAW;
@@ -564,6 +635,8 @@ ULS_QUALIFIED_METHOD(uls_deinit_context)(uls_context_ptr_t ctx)
 	_uls_tool(csz_deinit)(uls_ptr(ctx->tag));
 	_uls_tool(str_free)(uls_ptr(ctx->tokbuf));
 	_uls_tool(str_free)(uls_ptr(ctx->tokbuf_aux));
+	_uls_tool(str_free)(uls_ptr(ctx->wtokbuf));
+	ctx->l_wtokbuf = -1;
 	ctx->gettok = nilptr;
 	ctx->prev = nilptr;
 
@@ -578,12 +651,228 @@ ULS_QUALIFIED_METHOD(uls_deinit_context)(uls_context_ptr_t ctx)
 	uls_deinit_array_type10(uls_ptr(ctx->lexsegs), lexseg);
 	ctx->i_lexsegs =  ctx->n_lexsegs =  0;
 
+	uls_mfree(ctx->zoffsets);
+	ctx->n_zoffsets = ctx->n_alloc_zoffsets = 0;
+	ctx->tok_lptr = NULL;
+
 	uls_destroy_tmpl_pool(ctx->tmpls_pool);
 	ctx->tmpls_pool = nilptr;
 
 	uls_deinit_bytespool(ctx->cnst_nilstr);
 }
 
+void
+ULS_QUALIFIED_METHOD(uls_context_add_zoffset)(uls_context_ptr_t ctx, int offset)
+{
+	uls_zoffset_ptr_t zoff;
+
+	if (ctx->n_zoffsets >= ctx->n_alloc_zoffsets) {
+		ctx->n_alloc_zoffsets = ctx->n_alloc_zoffsets > 0 ? 2 * ctx->n_alloc_zoffsets : 256;
+		ctx->zoffsets = (uls_zoffset_ptr_t) uls_mrealloc(ctx->zoffsets,
+			ctx->n_alloc_zoffsets * sizeof(uls_zoffset_t));
+	}
+
+	zoff = ctx->zoffsets + ctx->n_zoffsets++;
+	zoff->zpos = csz_length(uls_ptr(ctx->zbuf1));
+	zoff->offset = offset;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_context_offset)(uls_context_ptr_t ctx, const char *ptr)
+{
+	const char *zbuf = csz_data_ptr(uls_ptr(ctx->zbuf1));
+	uls_zoffset_ptr_t zoff;
+	int zpos, lo, hi, mid;
+
+	if (ctx->n_zoffsets <= 0 || ptr == NULL || ptr < zbuf || ptr >= zbuf + csz_length(uls_ptr(ctx->zbuf1))) {
+		return -1;
+	}
+
+	zpos = (int) (ptr - zbuf);
+	if (zpos < ctx->zoffsets[0].zpos) {
+		return -1; // the text not from the input
+	}
+
+	// The token is in the text from the last zoffset before it, as the spaces and comments are never its start.
+	for (lo = 0, hi = ctx->n_zoffsets - 1; lo < hi; ) {
+		mid = (lo + hi + 1) >> 1;
+		if (ctx->zoffsets[mid].zpos <= zpos) lo = mid;
+		else hi = mid - 1;
+	}
+
+	zoff = ctx->zoffsets + lo;
+	if (zoff->offset < 0) {
+		return -1;
+	}
+
+	return zoff->offset + (zpos - zoff->zpos);
+}
+
+ULS_DECL_STATIC void
+ULS_QUALIFIED_METHOD(__init_fillgen)(uls_fillgen_ptr_t gen)
+{
+	uls_lexseg_ptr_t lexseg;
+	int i;
+
+	gen->buf_serial = 0;
+	_uls_tool(csz_init)(uls_ptr(gen->zbuf1), ULS_ZBUF1_INITSIZE);
+	_uls_tool(csz_init)(uls_ptr(gen->zbuf2), ULS_ZBUF1_INITSIZE);
+	gen->len_line = 0;
+
+	uls_init_array_type10(uls_ptr(gen->lexsegs), lexseg, ULS_LEXSEGS_MAX + 1);
+	for (i=0; i < gen->lexsegs.n_alloc; i++) {
+		uls_alloc_array_slot_type10(uls_ptr(gen->lexsegs), lexseg, i);
+	}
+	gen->lexsegs.n = gen->lexsegs.n_alloc;
+
+	gen->n_lexsegs = 0;
+	lexseg = uls_get_array_slot_type10(uls_ptr(gen->lexsegs), 0);
+	uls_reset_lexseg(lexseg, 0, 0, -1, -1, nilptr);
+
+	gen->zoffsets = nilptr;
+	gen->n_zoffsets = gen->n_alloc_zoffsets = 0;
+}
+
+ULS_DECL_STATIC void
+ULS_QUALIFIED_METHOD(__deinit_fillgen)(uls_fillgen_ptr_t gen)
+{
+	_uls_tool(csz_deinit)(uls_ptr(gen->zbuf1));
+	_uls_tool(csz_deinit)(uls_ptr(gen->zbuf2));
+	gen->len_line = 0;
+
+	uls_deinit_array_type10(uls_ptr(gen->lexsegs), lexseg);
+	gen->n_lexsegs = 0;
+
+	uls_mfree(gen->zoffsets);
+	gen->n_zoffsets = gen->n_alloc_zoffsets = 0;
+}
+
+ULS_DECL_STATIC void
+ULS_QUALIFIED_METHOD(__swap_fillgen)(uls_context_ptr_t ctx, uls_fillgen_ptr_t gen)
+{
+	uls_fillgen_t tmp = *gen;
+
+	gen->buf_serial = ctx->buf_serial;
+	gen->zbuf1 = ctx->zbuf1;
+	gen->zbuf2 = ctx->zbuf2;
+	gen->len_line = (int) (ctx->line_end - ctx->line);
+	gen->lexsegs = ctx->lexsegs;
+	gen->n_lexsegs = ctx->n_lexsegs;
+	gen->zoffsets = ctx->zoffsets;
+	gen->n_zoffsets = ctx->n_zoffsets;
+	gen->n_alloc_zoffsets = ctx->n_alloc_zoffsets;
+
+	ctx->buf_serial = tmp.buf_serial;
+	ctx->zbuf1 = tmp.zbuf1;
+	ctx->zbuf2 = tmp.zbuf2;
+	ctx->lexsegs = tmp.lexsegs;
+	ctx->n_lexsegs = tmp.n_lexsegs;
+	ctx->zoffsets = tmp.zoffsets;
+	ctx->n_zoffsets = tmp.n_zoffsets;
+	ctx->n_alloc_zoffsets = tmp.n_alloc_zoffsets;
+
+	ctx->lptr = ctx->line = _uls_tool(csz_text)(uls_ptr(ctx->zbuf1));
+	ctx->line_end = ctx->line + tmp.len_line;
+	ctx->i_lexsegs = 0;
+}
+
+ULS_DECL_STATIC void
+ULS_QUALIFIED_METHOD(__show_fillgen)(uls_context_ptr_t ctx, int i_gen)
+{
+	// The one shown goes back to its slot taking the spare buffers, which then go to the slot of 'i_gen'.
+	__swap_fillgen(ctx, ctx->fillgens + ctx->i_fillgen);
+	__swap_fillgen(ctx, ctx->fillgens + i_gen);
+	ctx->i_fillgen = i_gen;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_context_keep_fill)(uls_context_ptr_t ctx, unsigned int buf_serial0)
+{
+	int i, k;
+
+	// Keep the filling shown, with the ones from that of 'buf_serial0', and give the spare buffers to the next filling.
+	if ((ctx->flags & ULS_CTX_FL_INPLACE) || ctx->line_end <= ctx->line) {
+		return 0;
+	}
+
+	if (ctx->n_fillgens + 2 > ctx->n_alloc_fillgens) {
+		ctx->n_alloc_fillgens = ctx->n_fillgens + 8;
+		ctx->fillgens = (uls_fillgen_ptr_t) uls_mrealloc(ctx->fillgens,
+			ctx->n_alloc_fillgens * sizeof(uls_fillgen_t));
+	}
+
+	if (ctx->n_fillgens == 0) {
+		__init_fillgen(ctx->fillgens);
+		ctx->n_fillgens = 1;
+		ctx->i_fillgen = 0;
+	}
+
+	for (k=0; k < ctx->i_fillgen; k++) {
+		if (ctx->fillgens[k].buf_serial == buf_serial0) break;
+	}
+
+	if (k > 0) {
+		for (i=0; i<k; i++) {
+			__deinit_fillgen(ctx->fillgens + i);
+		}
+		for (i=k; i < ctx->n_fillgens; i++) {
+			ctx->fillgens[i - k] = ctx->fillgens[i];
+		}
+		ctx->n_fillgens -= k;
+		ctx->i_fillgen -= k;
+	}
+
+	__swap_fillgen(ctx, ctx->fillgens + ctx->i_fillgen);
+
+	ctx->i_fillgen = ctx->n_fillgens++;
+	__init_fillgen(ctx->fillgens + ctx->i_fillgen);
+
+	return 1;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_context_next_fill)(uls_context_ptr_t ctx)
+{
+	if (ctx->i_fillgen + 1 >= ctx->n_fillgens) {
+		return 0;
+	}
+
+	__show_fillgen(ctx, ctx->i_fillgen + 1);
+	return 1;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_context_show_fill)(uls_context_ptr_t ctx, unsigned int buf_serial)
+{
+	int i;
+
+	if (ctx->buf_serial == buf_serial) {
+		return 0;
+	}
+
+	for (i=0; i < ctx->n_fillgens; i++) {
+		if (i != ctx->i_fillgen && ctx->fillgens[i].buf_serial == buf_serial) {
+			__show_fillgen(ctx, i);
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
+void
+ULS_QUALIFIED_METHOD(uls_context_drop_fills)(uls_context_ptr_t ctx)
+{
+	int i;
+
+	for (i=0; i < ctx->n_fillgens; i++) {
+		__deinit_fillgen(ctx->fillgens + i);
+	}
+
+	uls_mfree(ctx->fillgens);
+	ctx->n_fillgens = ctx->n_alloc_fillgens = ctx->i_fillgen = 0;
+}
+
 void
 ULS_QUALIFIED_METHOD(uls_xcontext_init)(uls_xcontext_ptr_t xctx, uls_gettok_t gettok)
 {
@@ -600,6 +889,10 @@ ULS_QUALIFIED_METHOD(uls_xcontext_init)(uls_xcontext_ptr_t xctx, uls_gettok_t ge
 	xctx->toknum_NONE = -7;
 	xctx->toknum_ERR = -8;
 
+	uls_init_bytespool(xctx->commtype_by_ch, ULS_MARKMAP_SIZE, 0);
+	uls_init_bytespool(xctx->quotetype_by_ch, ULS_MARKMAP_SIZE, 0);
+	_uls_tool(str_init)(uls_ptr(xctx->lexmark_lxms), 0);
+
 	xctx->context = uls_alloc_object(uls_context_t); // initial-context
 	uls_init_context(xctx->context, gettok, xctx->toknum_NONE);
 }
@@ -626,6 +919,17 @@ ULS_QUALIFIED_METHOD(uls_xcontext_deinit)(uls_xcontext_ptr_t xctx)
 	uls_mfree(xctx->uldfile_buf);
 	xctx->uldfile_buflen = 0;
 
+	uls_deinit_bytespool(xctx->commtype_by_ch);
+	uls_deinit_bytespool(xctx->quotetype_by_ch);
+
+	uls_mfree(xctx->linespans);
+	xctx->n_linespans = xctx->n_alloc_linespans = 0;
+	xctx->rec_linespans = 0;
+
+	uls_mfree(xctx->lexmarks);
+	xctx->n_lexmarks = xctx->n_alloc_lexmarks = 0;
+	_uls_tool(str_free)(uls_ptr(xctx->lexmark_lxms));
+
 	uls_deinit_context(xctx->context);
 	uls_dealloc_object(xctx->context);
 	xctx->context = nilptr;
@@ -659,6 +963,161 @@ ULS_QUALIFIED_METHOD(check_rec_boundary_reverse_order)(uls_xcontext_ptr_t xctx,
 	return rc;
 }
 
+ULS_DECL_STATIC int
+ULS_QUALIFIED_METHOD(__xcontext_quote_proc)(uls_xcontext_ptr_t xctx, uls_quotetype_ptr_t qmt,
+	uls_lexseg_ptr_t lexseg, uls_ptrtype_tool(outparam) parms)
+{
+	uls_context_ptr_t ctx = xctx->context;
+	uls_input_ptr_t inp = ctx->input;
+	_uls_ptrtype_tool(csz_str) ss_dst2 = uls_ptr(ctx->zbuf2);
+	_uls_ptrtype_tool(csz_str) ss_pend = uls_ptr(ctx->litpend);
+	uls_litstr_context_ptr_t lit_ctx = uls_ptr(ctx->litfrag.context);
+	int rc, k2, n_lfs, maxlen;
+
+	// qmt == nilptr to go on with the literal string in ctx->litfrag.
+	if (qmt != nilptr) {
+		input_quote_begin(uls_ptr(ctx->litfrag), qmt, ss_dst2);
+		lexseg->frag_flags = ULS_LITFRAG_FIRST;
+	} else {
+		qmt = lit_ctx->qmt;
+		lexseg->frag_flags = (ctx->flags & ULS_CTX_FL_LITPEND) ? ctx->litpend_flags : 0;
+	}
+
+	lexseg->tokdef_vx = qmt->tokdef_vx;
+	lexseg->offset2 = k2 = csz_length(ss_dst2);
+
+	if ((maxlen = xctx->litstr_chunksiz) > 0 && (ctx->flags & ULS_CTX_FL_LITPEND)) {
+		// The bytes put in litpend count in the fragment.
+		if ((maxlen -= csz_length(ss_pend)) <= 0) maxlen = 1;
+	}
+
+	rc = input_quote_fragment(inp, uls_ptr(ctx->litfrag), maxlen, parms);
+	n_lfs = parms->n;
+
+	if (rc == ULS_LITPROC_STARVED) {
+		// It goes on from here at the next filling, after more bytes are fed.
+		if (!(ctx->flags & ULS_CTX_FL_LITPEND)) {
+			_uls_tool(csz_append)(ss_pend, csz_data_ptr(ss_dst2) + k2, csz_length(ss_dst2) - k2);
+			csz_truncate(ss_dst2, k2);
+			lit_ctx->ss_dst = ss_pend;
+			ctx->litpend_flags = lexseg->frag_flags;
+			ctx->litpend_lfs = 0;
+			ctx->flags |= ULS_CTX_FL_LITPEND;
+		}
+		ctx->litpend_lfs += n_lfs;
+		return rc;
+	}
+
+	if (ctx->flags & ULS_CTX_FL_LITPEND) {
+		_uls_tool(csz_append)(ss_dst2, csz_data_ptr(ss_pend), csz_length(ss_pend));
+		_uls_tool(csz_reset)(ss_pend);
+		lit_ctx->ss_dst = ss_dst2;
+		n_lfs += ctx->litpend_lfs;
+		ctx->flags &= ~ULS_CTX_FL_LITPEND;
+		// The bytes of it are consumed in the last fillings.
+		if (rc == ULS_LITPROC_DISMISSQUOTE) rc = ULS_LITPROC_ENDOFQUOTE;
+	}
+	lexseg->n_lfs_raw = n_lfs;
+
+	// The fragments given already can't be dismissed.
+	if (rc == ULS_LITPROC_DISMISSQUOTE && lexseg->frag_flags == 0) {
+		rc = ULS_LITPROC_ENDOFQUOTE;
+	}
+
+	if (rc == ULS_LITPROC_ENDOFQUOTE || rc == ULS_LITPROC_FRAGMENT) {
+		lexseg->len_text = csz_length(ss_dst2) - k2;
+		// put '\0' at the end of literal string
+		_uls_tool(csz_add_eos)(ss_dst2);
+
+		if (rc == ULS_LITPROC_FRAGMENT) {
+			if (lexseg->frag_flags == 0) lexseg->frag_flags = ULS_LITFRAG_MIDDLE;
+			ctx->flags |= ULS_CTX_FL_LITFRAG;
+		} else {
+			lexseg->frag_flags |= ULS_LITFRAG_LAST;
+			ctx->flags &= ~ULS_CTX_FL_LITFRAG;
+		}
+
+	} else if (rc == ULS_LITPROC_DISMISSQUOTE) {
+		csz_truncate(ss_dst2, k2);
+
+	} else {
+		return rc;
+	}
+
+	if (xctx->rec_linespans && n_lfs > 0) {
+		uls_xcontext_add_linespan(xctx, inp->line_num, n_lfs, qmt);
+	}
+	inp->line_num += n_lfs;
+
+	return rc;
+}
+
+ULS_DECL_STATIC void
+ULS_QUALIFIED_METHOD(__xcontext_put_text)(uls_context_ptr_t ctx, const char *lptr, int len)
+{
+	uls_input_ptr_t inp = ctx->input;
+
+	if (uls_input_isset_fl(inp, ULS_INP_FL_LINEIDX)) {
+		uls_context_add_zoffset(ctx, uls_input_offset(inp, lptr));
+	}
+
+	_uls_tool(csz_append)(uls_ptr(ctx->zbuf1), lptr, len);
+}
+
+ULS_DECL_STATIC void
+ULS_QUALIFIED_METHOD(__xcontext_put_comment_lfs)(uls_xcontext_ptr_t xctx, int n_lfs, int offset)
+{
+	uls_context_ptr_t ctx = xctx->context;
+	uls_input_ptr_t inp = ctx->input;
+	int i, lno = 0;
+
+	// If the line-feed is a token, those of the comment at 'offset' are found in the line index.
+	if (uls_input_isset_fl(inp, ULS_INP_FL_LINEIDX) && xctx->ch_context['\n'] != 0 && n_lfs > 0) {
+		if ((lno = uls_input_offset_lineno(inp, offset, NULL)) <= 0 || lno + n_lfs > inp->n_linestarts) {
+			uls_context_add_zoffset(ctx, -1);
+			lno = 0;
+		}
+	}
+
+	for (i=0; i < n_lfs; i++) {
+		if (lno > 0) uls_context_add_zoffset(ctx, inp->linestarts[lno + i] - 1);
+		_uls_tool(csz_putc)(uls_ptr(ctx->zbuf1), '\n');
+	}
+}
+
+// Skips the comment at the cursor, putting in zbuf1 the line-feeds read from 'offset'.
+// It returns 0 with ULS_CTX_FL_COMMFRAG set if the fed bytes run out in the comment.
+ULS_DECL_STATIC int
+ULS_QUALIFIED_METHOD(__xcontext_skip_comment)(uls_xcontext_ptr_t xctx, uls_commtype_ptr_t cmt, int offset)
+{
+	uls_context_ptr_t ctx = xctx->context;
+	uls_input_ptr_t inp = ctx->input;
+	uls_type_tool(outparam) parms1;
+	int rc, n_lfs;
+
+	rc = input_skip_comment(cmt, inp, uls_ptr(parms1));
+	n_lfs = parms1.n;
+
+	if (rc > 0) {
+		n_lfs += cmt->n_lfs;
+		ctx->flags &= ~ULS_CTX_FL_COMMFRAG;
+	} else if (rc == 0 && uls_input_is_starving(inp)) {
+		ctx->commfrag = cmt;
+		ctx->flags |= ULS_CTX_FL_COMMFRAG;
+	} else {
+		_uls_log(err_log)("[%s:%d] Unterminated comment at EOF!", uls_ctx_get_tag(ctx), inp->line_num);
+		return -1;
+	}
+
+	__xcontext_put_comment_lfs(xctx, n_lfs, offset);
+	if (xctx->rec_linespans && n_lfs > 0) {
+		uls_xcontext_add_linespan(xctx, inp->line_num, n_lfs, nilptr);
+	}
+	inp->line_num += n_lfs;
+
+	return rc;
+}
+
 int
 ULS_QUALIFIED_METHOD(xcontext_raw_filler)(uls_xcontext_ptr_t xctx)
 {
@@ -667,25 +1126,68 @@ ULS_QUALIFIED_METHOD(xcontext_raw_filler)(uls_xcontext_ptr_t xctx)
 	const char    *ch_ctx = xctx->ch_context;
 
 	_uls_ptrtype_tool(csz_str) ss_dst1 = uls_ptr(ctx->zbuf1);
-	_uls_ptrtype_tool(csz_str) ss_dst2 = uls_ptr(ctx->zbuf2);
 	uls_lexseg_ptr_t  lexseg;
 	const char  *lptr1, *lptr, *lptr_end;
-	int   n_segs = 0, k2, offset1, rc;
+	int   n_segs = 0, offset1, rc;
 	char  ch, ch_grp;
 
 	uls_commtype_ptr_t cmt;
 	uls_quotetype_ptr_t qmt;
-	int i, n_lfs;
+	int n_lfs, offset_cmt, len1_start;
 	uls_type_tool(outparam) parms1;
 
 	offset1 = 0;
 	lptr1 = lptr = inp->rawbuf_ptr;
 	lptr_end = lptr + inp->rawbuf_bytes;
 
+	// In push-mode, the comment or the quote-string the fed bytes run out in goes on at the next filling.
+	ctx->flags &= ~ULS_CTX_FL_STARVED;
+	len1_start = csz_length(ss_dst1);
+
+	if (ctx->flags & ULS_CTX_FL_COMMFRAG) {
+		// The comment the fed bytes ran out in at the last filling goes on first.
+		rc = __xcontext_skip_comment(xctx, ctx->commfrag, uls_input_offset(inp, lptr));
+		if (rc < 0) return -1;
+
+		lptr1 = lptr = inp->rawbuf_ptr;
+		lptr_end = lptr + inp->rawbuf_bytes;
+		if (rc == 0) goto starved;
+
+	} else if (ctx->flags & (ULS_CTX_FL_LITFRAG | ULS_CTX_FL_LITPEND)) {
+		// The literal string cut at the last filling goes on first.
+		lexseg = uls_get_array_slot_type10(uls_ptr(ctx->lexsegs), 0);
+		lexseg->offset1 = 0;
+		lexseg->len1 = csz_length(ss_dst1);
+		if (uls_input_isset_fl(inp, ULS_INP_FL_LINEIDX)) {
+			if (!(ctx->flags & ULS_CTX_FL_LITPEND)) ctx->lit_offset = uls_input_offset(inp, lptr);
+			uls_context_add_zoffset(ctx, ctx->lit_offset);
+		}
+		_uls_tool(csz_add_eos)(ss_dst1);
+		offset1 = csz_length(ss_dst1);
+
+		if ((rc = __xcontext_quote_proc(xctx, nilptr, lexseg, uls_ptr(parms1))) < 0) {
+			if (rc == ULS_LITPROC_STARVED) {
+				csz_truncate(ss_dst1, lexseg->len1);
+				if (uls_input_isset_fl(inp, ULS_INP_FL_LINEIDX)) --ctx->n_zoffsets;
+				offset1 = 0;
+				lptr1 = lptr = inp->rawbuf_ptr;
+				lptr_end = lptr + inp->rawbuf_bytes;
+				goto starved;
+			}
+			_uls_log(err_log)("[%s:%d] Unterminated literal string at EOF!", uls_ctx_get_tag(ctx), inp->line_num);
+			return -1;
+		}
+		n_segs = 1;
+
+		lptr1 = lptr = inp->rawbuf_ptr;
+		lptr_end = lptr + inp->rawbuf_bytes;
+		if (rc == ULS_LITPROC_FRAGMENT) goto end_of_scan;
+	}
+
 	for ( ; ; ) {
 		if (lptr_end < lptr + ULS_LEN_SURPLUS) {
 			if ((rc = (int) (lptr-lptr1)) > 0) {
-				_uls_tool(csz_append)(ss_dst1, lptr1, rc);
+				__xcontext_put_text(ctx, lptr1, rc);
 			}
 
 			inp->rawbuf_ptr = lptr;
@@ -701,7 +1203,13 @@ ULS_QUALIFIED_METHOD(xcontext_raw_filler)(uls_xcontext_ptr_t xctx)
 			lptr_end = lptr + inp->rawbuf_bytes;
 
 			if (inp->rawbuf_bytes == 0) {
-				ctx->flags |= ULS_CTX_FL_EOF;
+				if (uls_input_is_starving(inp)) {
+					if (n_segs == 0 && csz_length(ss_dst1) == len1_start) {
+						ctx->flags |= ULS_CTX_FL_STARVED;
+					}
+				} else {
+					ctx->flags |= ULS_CTX_FL_EOF;
+				}
 				break;
 			}
 		}
@@ -709,11 +1217,18 @@ ULS_QUALIFIED_METHOD(xcontext_raw_filler)(uls_xcontext_ptr_t xctx)
 		if ((ch=*lptr) < ULS_SYNTAX_TABLE_SIZE) {
 			ch_grp = ch_ctx[ch];
 		} else {
-			ch_grp = ULS_CH_COMM | ULS_CH_QUOTE;
+			// A non-ASCII byte, which is plain text unless a start-mark begins with it.
+			ch_grp = 0;
+			if (xctx->commtype_by_ch[(unsigned char) ch] != 0) ch_grp |= ULS_CH_COMM;
+			if (xctx->quotetype_by_ch[(unsigned char) ch] != 0) ch_grp |= ULS_CH_QUOTE;
+			if (ch_grp == 0) {
+				++lptr;
+				continue;
+			}
 		}
 
 		if (ch_grp == 0) {
-			if ((rc = (int) (lptr-lptr1)) > 0) _uls_tool(csz_append)(ss_dst1, lptr1, rc);
+			if ((rc = (int) (lptr-lptr1)) > 0) __xcontext_put_text(ctx, lptr1, rc);
 			if (csz_length(ss_dst1) >= ULS_ZBUF1_ROUGHSIZE) break;
 
 			inp->rawbuf_ptr = lptr;
@@ -732,38 +1247,37 @@ ULS_QUALIFIED_METHOD(xcontext_raw_filler)(uls_xcontext_ptr_t xctx)
 
 		} else if ((ch_grp & ULS_CH_COMM) &&
 			(cmt = is_commtype_start(xctx, lptr, (int) (lptr_end - lptr))) != nilptr) {
-			if ((rc = (int) (lptr - lptr1)) > 0) _uls_tool(csz_append)(ss_dst1, lptr1, rc);
+			if ((rc = (int) (lptr - lptr1)) > 0) __xcontext_put_text(ctx, lptr1, rc);
+			offset_cmt = uls_input_offset(inp, lptr);
 			lptr += cmt->len_start_mark;
 
 			inp->rawbuf_ptr = lptr;
 			inp->rawbuf_bytes = (int) (lptr_end - lptr);
 
-			rc = input_skip_comment(cmt, inp, uls_ptr(parms1));
-			n_lfs = parms1.n;
-
-			lptr1 = lptr = inp->rawbuf_ptr;
-			lptr_end = lptr + inp->rawbuf_bytes;
-
-			if (rc <= 0) {
-				_uls_log(err_log)("[%s:%d] Unterminated comment at EOF!", uls_ctx_get_tag(ctx), inp->line_num);
+			if ((rc = __xcontext_skip_comment(xctx, cmt, offset_cmt)) < 0) {
 				return -1;
 			}
 
-			n_lfs += cmt->n_lfs;
-			for (i=0; i < n_lfs; i++) _uls_tool(csz_putc)(ss_dst1, '\n');
-			inp->line_num += n_lfs;
+			lptr1 = lptr = inp->rawbuf_ptr;
+			lptr_end = lptr + inp->rawbuf_bytes;
+			if (rc == 0) goto starved;
 
 		} else if ((ch_grp & ULS_CH_QUOTE) &&
 			(qmt = uls_xcontext_find_quotetype(xctx, lptr, (int) (lptr_end - lptr))) != nilptr) {
-			if ((rc = (int) (lptr - lptr1)) > 0) _uls_tool(csz_append)(ss_dst1, lptr1, rc);
+			if ((rc = (int) (lptr - lptr1)) > 0) __xcontext_put_text(ctx, lptr1, rc);
 
 			if (n_segs + 1 >= ctx->lexsegs.n) {
 				break;
 			}
 
+			// The literal string is at the '\0' put before it in zbuf1.
+			if (uls_input_isset_fl(inp, ULS_INP_FL_LINEIDX)) {
+				ctx->lit_offset = uls_input_offset(inp, lptr);
+				uls_context_add_zoffset(ctx, ctx->lit_offset);
+			}
+
 			lptr += qmt->len_start_mark;
 			lexseg = uls_get_array_slot_type10(uls_ptr(ctx->lexsegs), n_segs);
-			lexseg->tokdef_vx = qmt->tokdef_vx;
 
 			lexseg->offset1 = offset1;
 			lexseg->len1 = csz_length(ss_dst1) - offset1;
@@ -771,33 +1285,30 @@ ULS_QUALIFIED_METHOD(xcontext_raw_filler)(uls_xcontext_ptr_t xctx)
 			_uls_tool(csz_add_eos)(ss_dst1);
 			offset1 = csz_length(ss_dst1);
 
-			lexseg->offset2 = k2 = csz_length(ss_dst2);
-
 			inp->rawbuf_ptr = lptr;
 			inp->rawbuf_bytes = (int) (lptr_end - lptr);
 
-			rc = input_quote_proc(inp, qmt, ss_dst2, uls_ptr(parms1));
-			n_lfs = parms1.n;
-
-			if (rc == ULS_LITPROC_ENDOFQUOTE) {
-				lexseg->n_lfs_raw = n_lfs;
-				lexseg->len_text = csz_length(ss_dst2) - lexseg->offset2;
-				// put '\0' at the end of literal string
-				_uls_tool(csz_add_eos)(ss_dst2);
-				++n_segs;
-
-			} else if (rc == ULS_LITPROC_DISMISSQUOTE) {
-				lexseg->n_lfs_raw = n_lfs;
-				csz_truncate(ss_dst2, k2);
-
-			} else {
+			if ((rc = __xcontext_quote_proc(xctx, qmt, lexseg, uls_ptr(parms1))) < 0 &&
+				rc != ULS_LITPROC_DISMISSQUOTE) {
+				if (rc == ULS_LITPROC_STARVED) {
+					// The text before it is given in this filling.
+					csz_truncate(ss_dst1, lexseg->offset1 + lexseg->len1);
+					if (uls_input_isset_fl(inp, ULS_INP_FL_LINEIDX)) --ctx->n_zoffsets;
+					offset1 = lexseg->offset1;
+					lptr1 = lptr = inp->rawbuf_ptr;
+					lptr_end = lptr + inp->rawbuf_bytes;
+					goto starved;
+				}
 				_uls_log(err_log)("[%s:%d] Unterminated literal string at EOF!", uls_ctx_get_tag(ctx), inp->line_num);
 				return -1;
 			}
+			if (rc != ULS_LITPROC_DISMISSQUOTE) ++n_segs;
 
 			lptr1 = lptr = inp->rawbuf_ptr;
 			lptr_end = lptr + inp->rawbuf_bytes;
-			inp->line_num += n_lfs;
+
+			// The rest of a long literal string is left to the next filling.
+			if (rc == ULS_LITPROC_FRAGMENT) break;
 
 		} else {
 			if (ch == '\n') ++inp->line_num;
@@ -805,8 +1316,11 @@ ULS_QUALIFIED_METHOD(xcontext_raw_filler)(uls_xcontext_ptr_t xctx)
 		}
 	}
 
+ end_of_scan:
 	inp->rawbuf_ptr = lptr;
 	inp->rawbuf_bytes = (int) (lptr_end - lptr);
+	uls_input_feed_commit(inp);
+
 	_uls_tool(csz_text)(ss_dst1);
 
 	lexseg = uls_get_array_slot_type10(uls_ptr(ctx->lexsegs), n_segs);
@@ -816,6 +1330,13 @@ ULS_QUALIFIED_METHOD(xcontext_raw_filler)(uls_xcontext_ptr_t xctx)
 	lexseg = uls_get_array_slot_type10(uls_ptr(ctx->lexsegs), 0);
 
 	return lexseg->len1;
+
+ starved:
+	// Wait for more bytes to go on with the comment or the literal string.
+	if (n_segs == 0 && csz_length(ss_dst1) == len1_start) {
+		ctx->flags |= ULS_CTX_FL_STARVED;
+	}
+	goto end_of_scan;
 }
 
 int
@@ -891,6 +1412,11 @@ ULS_QUALIFIED_METHOD(uls_xcontext_delete_litstr_analyzer)(uls_xcontext_ptr_t xct
 	uls_quotetype_ptr_t qmt;
 	int i, j;
 
+	if (xctx->flags & ULS_XCTX_FL_SHARED_SPEC) {
+		_uls_log(err_log)("%s: the quote-types of a shared spec are read-only!", __func__);
+		return -1;
+	}
+
 	for (i=0; ; i++) {
 		if (i >= xctx->quotetypes->n) {
 			return -1;
@@ -924,6 +1450,11 @@ ULS_QUALIFIED_METHOD(uls_xcontext_change_litstr_analyzer)(uls_xcontext_ptr_t xct
 	uls_quotetype_ptr_t qmt;
 	int i, stat = -1, is_userproc = 1;
 
+	if (xctx->flags & ULS_XCTX_FL_SHARED_SPEC) {
+		_uls_log(err_log)("%s: the quote-types of a shared spec are read-only!", __func__);
+		return -1;
+	}
+
 	if (lit_analyzer == nilptr) {
 		lit_analyzer = uls_ref_callback_this(dfl_lit_analyzer_escape0);
 		is_userproc = 0;
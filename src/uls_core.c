@@ -36,8 +36,10 @@
 #include "uls/uls_core.h"
 #include "uls/uls_freq.h"
 #include "uls/uld_conf.h"
+#include "uls/uls_spec_cache.h"
 #include "uls/uls_num.h"
 #include "uls/uls_misc.h"
+#include "uls/utf8_enc.h"
 #include "uls/uls_fileio.h"
 #include "uls/uls_log.h"
 #endif
@@ -55,6 +57,28 @@ ULS_QUALIFIED_METHOD(__ready_to_use_lexseg)(uls_context_ptr_t ctx)
 	ctx->i_lexsegs = 0;
 }
 
+ULS_DECL_STATIC int
+ULS_QUALIFIED_METHOD(__uls_put_wch)(uls_ptrtype_tool(outbuf) wtokbuf, int k, uls_wch_t wch)
+{
+	wchar_t *wbuf;
+
+	// room for a surrogate pair and the '\0'
+	if ((k + 3) * (int) sizeof(wchar_t) > wtokbuf->siz) {
+		_uls_tool(str_modify)(wtokbuf, 0, NULL, (k + 3) * (int) sizeof(wchar_t));
+	}
+	wbuf = (wchar_t *) wtokbuf->buf;
+
+	if (sizeof(wchar_t) < 4 && wch >= 0x10000) {
+		wch -= 0x10000;
+		wbuf[k++] = (wchar_t) (0xD800 + (wch >> 10));
+		wbuf[k++] = (wchar_t) (0xDC00 + (wch & 0x3FF));
+	} else {
+		wbuf[k++] = (wchar_t) wch;
+	}
+
+	return k;
+}
+
 ULS_DECL_STATIC int
 ULS_QUALIFIED_METHOD(find_prefix_radix)(uls_ptrtype_tool(outparam) parms, uls_lex_ptr_t uls, const char *str)
 {
@@ -138,6 +162,40 @@ ULS_QUALIFIED_METHOD(get_number)(uls_lex_ptr_t uls, uls_context_ptr_t ctx, uls_p
 	return l_tokstr;
 }
 
+ULS_DECL_STATIC int
+ULS_QUALIFIED_METHOD(get_number_tokid)(uls_lex_ptr_t uls, uls_context_ptr_t ctx, uls_ptrtype_tool(parm_line) parm_ln)
+{
+	uls_ptrtype_tool(outbuf) tokbuf = uls_ptr(ctx->tokbuf);
+	const char *lptr0 = parm_ln->lptr, *lptr;
+	uls_type_tool(outparam) parms1;
+	int k;
+	char ch;
+
+	// A plain run of decimal digits is already in the normal form, skipping extract_number().
+	if (*lptr0 < '1' || *lptr0 > '9' || find_prefix_radix(uls_ptr(parms1), uls, lptr0) > 0) {
+		return get_number(uls, ctx, parm_ln);
+	}
+
+	for (lptr = lptr0 + 1; _uls_tool_(isdigit)(*lptr); lptr++)
+		/* NOTHING */;
+
+	if ((ch=*lptr) >= ULS_SYNTAX_TABLE_SIZE || _uls_tool_(isalnum)(ch) || ch == '_' || ch == '.' ||
+		(uls_wch_t) ch == uls->numcnst_separator ||
+		(ch != '\0' && is_cnst_suffix_contained(uls->numcnst_suffixes, lptr, -1, nilptr) != NULL)) {
+		return get_number(uls, ctx, parm_ln);
+	}
+
+	k = (int) (lptr - lptr0);
+	_uls_tool(str_append)(tokbuf, 0, lptr0, k);
+	str_putc(tokbuf, k + 1, '\0'); // no suffix
+
+	ctx->n_expo = 0;
+	ctx->n_digits = k;
+
+	parm_ln->lptr = lptr;
+	return k;
+}
+
 ULS_DECL_STATIC void
 ULS_QUALIFIED_METHOD(make_eof_lexeme)(uls_lex_ptr_t uls)
 {
@@ -171,6 +229,7 @@ ULS_QUALIFIED_METHOD(make_eoi_lexeme)(uls_lex_ptr_t uls)
 	str_putc(uls_ptr(ctx->tokbuf), 0, '\0');
 	ctx->s_val = ctx->tokbuf.buf;
 	ctx->s_val_len = ctx->s_val_wchars = 0;
+	ctx->l_wtokbuf = -1;
 
 	return ctx;
 }
@@ -267,7 +326,7 @@ ULS_QUALIFIED_METHOD(__uls_change_line)(uls_lex_ptr_t uls, const char *line, int
 	uls_xcontext_ptr_t xctx = uls_ptr(uls->xcontext);
 	uls_context_ptr_t ctx = uls->xcontext.context;
 	uls_input_ptr_t   inp = ctx->input;
-	int start_lno = 1;
+	int start_lno = 1, n_prepended = 0;
 	uls_ptrtype_tool(outparam) parm;
 	char *ptr;
 
@@ -293,6 +352,7 @@ ULS_QUALIFIED_METHOD(__uls_change_line)(uls_lex_ptr_t uls, const char *line, int
 		inp->isource.usrc_ungrab = uls_ref_callback_this(uls_ungrab_linecheck);
 
 		start_lno -= xctx->lfs_prepended_input;
+		n_prepended = xctx->len_prepended_input;
 
 	} else if (flags & (ULS_DO_DUP|ULS_MEMFREE_LINE)) {
 		parm = uls_alloc_object(uls_type_tool(outparam));
@@ -312,6 +372,8 @@ ULS_QUALIFIED_METHOD(__uls_change_line)(uls_lex_ptr_t uls, const char *line, int
 	inp->rawbuf_ptr = line;
 	inp->rawbuf_bytes = len;
 	inp->isource.flags |= ULS_ISRC_FL_EOF;
+	// The offsets are counted from the line, after the prepended text.
+	uls_input_index_lines(inp, line + n_prepended, len - n_prepended);
 
 	ctx->line = ctx->line_end = inp->rawbuf_ptr;
 	ctx->lptr = ctx->line;
@@ -370,7 +432,7 @@ ULS_QUALIFIED_METHOD(free_tokdef_array)(uls_lex_ptr_t uls)
 	slots_keyw = uls_parray_slots(uls_ptr(uls->tokdef_array));
 	for (i=0; i<uls->tokdef_array.n; i++) {
 		e = slots_keyw[i];
-		uls_destroy_tokdef(e);
+		uls_deinit_tokdef(e);
 	}
 	uls_deinit_parray(uls_ptr(uls->tokdef_array));
 
@@ -384,6 +446,7 @@ ULS_QUALIFIED_METHOD(free_tokdef_array)(uls_lex_ptr_t uls)
 //		slots_vx[i] = nilptr;
 	}
 
+	uls_reset_tokid_map(uls);
 	uls_deinit_parray(uls_ptr(uls->tokdef_vx_array));
 	uls_deinit_parray(uls_ptr(uls->tokdef_vx_rsvd));
 }
@@ -526,11 +589,19 @@ ULS_QUALIFIED_METHOD(ulc_load)(ulc_header_ptr_t uls_config, FILE *fin_ulc,
 			kw_tbl->hash_stat.weight[i] = ulf_hdr.weights[i];
 		}
 
+		if (ulf_hdr.hash_table_size != kw_tbl->hash_stat.table_size &&
+			uls_resize_kwtable(kw_tbl, ulf_hdr.hash_table_size) < 0) {
+			ulc_free_kwstat_list(keyw_stat_list);
+			ulf_deinit_header(uls_ptr(ulf_hdr));
+			_uls_tool_(fp_close)(fin_ulf);
+			return -1;
+		}
+
 		lst = uls_ptr(keyw_stat_list->lst);
 		n_lst = keyw_stat_list->lst.n;
 
 		slots_lst = uls_parray_slots(lst);
-		_uls_quicksort_vptr(slots_lst, n_lst, keyw_stat_comp_by_freq);
+		ulf_sort_kwstat_by_chain(keyw_stat_list);
 
 		for (i=0; i < n_lst; i++) {
 			e = slots_lst[i]->keyw_info;
@@ -600,11 +671,20 @@ ULS_QUALIFIED_METHOD(__uls_init_fp)(uls_lex_ptr_t uls)
 	uls_init_parray(uls_ptr(uls->tokdef_vx_rsvd), tokdef_vx, N_RESERVED_TOKS);
 	uls->tokdef_vx = nilptr;
 
+	uls->tokid_map_min = 0;
+	uls_init_parray(uls_ptr(uls->tokid_map), tokdef_vx, 0);
+	uls_init_parray(uls_ptr(uls->tokid_hash), tokdef_vx, 0);
+
 	uls_init_kwtable(uls_ptr(uls->idkeyw_table));
 	uls_init_1char_table(uls_ptr(uls->onechar_table));
 	uls_init_2char_table(uls_ptr(uls->twoplus_table));
+	uls_init_spec_arena(uls_ptr(uls->spec_arena));
 
 	uls_init_escmap_pool(uls_ptr(uls->escstr_pool));
+	uls->stats = nilptr;
+	uls->prof = nilptr;
+	uls->intern = nilptr;
+	uls->tokpipe = nilptr;
 
 	uls_xcontext_init(uls_ptr(uls->xcontext), uls_ref_callback_this(uls_gettok_raw));
 	uls->xcontext.context->flags |= ULS_CTX_FL_EOF | ULS_CTX_FL_GETTOK_RAW;
@@ -620,7 +700,34 @@ ULS_QUALIFIED_METHOD(uls_dealloc_lex)(uls_lex_ptr_t uls)
 	uls_number_prefix_ptr_t numpfx;
 	int i;
 
+	if (uls->shared_spec != nilptr) {
+		// The prepended input is of the spec, too.
+		uls->xcontext.prepended_input = NULL;
+	}
+
 	uls_xcontext_deinit(uls_ptr(uls->xcontext));
+	uls_clear_tokstages(uls);
+
+	if (uls->stats != nilptr) {
+		uls_dealloc_object(uls->stats);
+		uls->stats = nilptr;
+	}
+
+	uls_enable_profile(uls, 0);
+	uls_enable_intern(uls, 0);
+
+	if (uls->shared_spec != nilptr) {
+		// The tables are released with the last lexer sharing them.
+		uls_ungrab_shared_spec(uls->shared_spec);
+		uls->shared_spec = nilptr;
+
+		if (uls->flags & ULS_FL_STATIC) {
+			uls->shell = nilptr;
+		} else {
+			uls_dealloc_object(uls);
+		}
+		return;
+	}
 
 	uls_deinit_2char_table(uls_ptr(uls->twoplus_table));
 	uls_deinit_kwtable(uls_ptr(uls->idkeyw_table));
@@ -628,6 +735,7 @@ ULS_QUALIFIED_METHOD(uls_dealloc_lex)(uls_lex_ptr_t uls)
 
 	// 1char tokens
 	uls_deinit_1char_table(uls_ptr(uls->onechar_table));
+	uls_deinit_spec_arena(uls_ptr(uls->spec_arena));
 
 	// idfirst_charsets
 	uls_deinit_array_tool_type01(uls_ptr(uls->idfirst_charset), uch_range);
@@ -695,16 +803,26 @@ ULS_QUALIFIED_METHOD(uls_fillbuff)(uls_lex_ptr_t uls)
 	uls_context_ptr_t ctx = uls->xcontext.context;
 	uls_input_ptr_t   inp = ctx->input;
 	const char *line;
-	int rc;
+	int rc, len1, len2;
 
 	if ((ctx->flags & ULS_CTX_FL_ERR) || (inp->isource.flags & ULS_ISRC_FL_ERR)) {
 		_uls_log(err_log)("%s: called again after I/O failed!", __func__);
 		return -1;
 	}
 
+	__uls_ctx_renew_serial(uls_ptr(uls->xcontext), ctx);
 	if (ctx->flags & ULS_CTX_FL_EOF) return 0;
 
+	len1 = csz_length(uls_ptr(ctx->zbuf1));
+	len2 = csz_length(uls_ptr(ctx->zbuf2));
+
 	rc = ctx->fill_proc(uls_ptr(uls->xcontext));
+
+	if (uls->stats != nilptr) {
+		++uls->stats->n_fillbuff;
+		uls->stats->n_bytes_zbuf1 += csz_length(uls_ptr(ctx->zbuf1)) - len1;
+		uls->stats->n_bytes_zbuf2 += csz_length(uls_ptr(ctx->zbuf2)) - len2;
+	}
 	if (rc < 0 || (rc == 0 && ctx->n_lexsegs == 0)) {
 		if (rc < 0) {
 			uls->tokdef_vx = set_err_tok(uls, "failed to fill buffer!");
@@ -716,7 +834,13 @@ ULS_QUALIFIED_METHOD(uls_fillbuff)(uls_lex_ptr_t uls)
 		return rc;
 	}
 
-	ctx->lptr = ctx->line = line = _uls_tool(csz_text)(uls_ptr(ctx->zbuf1));
+	if (ctx->flags & ULS_CTX_FL_INPLACE) {
+		line = inp->rawbuf_ptr; // the records of a mapped stream
+	} else {
+		line = _uls_tool(csz_text)(uls_ptr(ctx->zbuf1));
+	}
+
+	ctx->lptr = ctx->line = line;
 	if ((ctx->line_end=line+rc) < line) {
 		_uls_log(err_panic)("%s: invalid string length, %d.", __func__, rc);
 		return -1;
@@ -730,10 +854,34 @@ ULS_QUALIFIED_METHOD(uls_fillbuff)(uls_lex_ptr_t uls)
 int
 ULS_QUALIFIED_METHOD(uls_clear_and_fillbuff)(uls_lex_ptr_t uls)
 {
-	uls_context_ptr_t ctx = uls->xcontext.context;
+	uls_xcontext_ptr_t xctx = uls_ptr(uls->xcontext);
+	uls_context_ptr_t ctx = xctx->context;
+	uls_lexmark_ptr_t mark;
+	int i;
+
+	// After a rewind, the fillings kept are read again before the input.
+	if (uls_context_next_fill(ctx) > 0) {
+		return 1;
+	}
+
+	// Keep the text of the exhausted input so that the marks on it stay usable.
+	if (ctx->flags & ULS_CTX_FL_EOF) return 0;
+
+	// The text is kept from the filling of the first mark on the context.
+	for (i=0; i < xctx->n_lexmarks; i++) {
+		mark = xctx->lexmarks + i;
+		if (mark->ctx == ctx) break;
+	}
+
+	if (i < xctx->n_lexmarks) {
+		uls_context_keep_fill(ctx, mark->buf_serial);
+	} else if (ctx->n_fillgens > 0) {
+		uls_context_drop_fills(ctx);
+	}
 
 	_uls_tool(csz_reset)(uls_ptr(ctx->zbuf1));
 	_uls_tool(csz_reset)(uls_ptr(ctx->zbuf2));
+	ctx->n_zoffsets = 0;
 
 	return uls_fillbuff(uls);
 }
@@ -744,8 +892,10 @@ ULS_QUALIFIED_METHOD(uls_fillbuff_and_reset)(uls_lex_ptr_t uls, const char *str0
 	uls_context_ptr_t ctx = uls->xcontext.context;
 	int rc;
 
+	uls_context_drop_fills(ctx);
 	_uls_tool(csz_reset)(uls_ptr(ctx->zbuf1));
 	_uls_tool(csz_reset)(uls_ptr(ctx->zbuf2));
+	ctx->n_zoffsets = 0;
 
 	if (str0 != NULL) {
 		_uls_tool(csz_puts)(uls_ptr(ctx->zbuf1), str0);
@@ -757,6 +907,7 @@ ULS_QUALIFIED_METHOD(uls_fillbuff_and_reset)(uls_lex_ptr_t uls, const char *str0
 		ctx->tokbuf.buf[0] = '\0';
 		ctx->s_val = ctx->tokbuf.buf;
 		ctx->s_val_len = 0;
+		ctx->l_wtokbuf = -1;
 	}
 
 	return rc;
@@ -823,6 +974,7 @@ ULS_QUALIFIED_METHOD(set_err_tok)(uls_lex_ptr_t uls, const char *errmsg)
 	ctx->s_val = ctx->tokbuf.buf;
 	ctx->s_val_len = k;
 	ctx->s_val_wchars += k - k1;
+	ctx->l_wtokbuf = -1;
 	ctx->flags |= ULS_CTX_FL_ERR;
 
 	return slots_rsv[ERR_TOK_IDX];
@@ -871,14 +1023,20 @@ ULS_QUALIFIED_METHOD(uls_gettok_raw)(uls_lex_ptr_t uls)
 	uls_tokdef_vx_ptr_t e_vx;
 	uls_tokdef_ptr_t e;
 	uls_type_tool(parm_line) parm_ln;
+	int tokid_only = uls->flags & ULS_FL_TOKID_ONLY;
+	int wide = !tokid_only && (uls->flags & ULS_FL_WLEXEME), l_wlxm;
+	char foldbuf[ULS_LEXSTR_MAXSIZ+1];
+	int fold, l_fold, too_long;
+	const char *lxm;
 
+	ctx->flags &= ~ULS_CTX_FL_LXM_INPUT;
 	if (ctx->delta_lineno != 0) {
 		__uls_ctx_inc_lineno(ctx, ctx->delta_lineno);
 		ctx->delta_lineno = 0;
 	}
 
  next_loop:
-	lptr = skip_white_spaces(uls);
+	ctx->tok_lptr = lptr = skip_white_spaces(uls);
 
 	if ((ch=*lptr) < ULS_SYNTAX_TABLE_SIZE) {
 		ch_grp = ch_ctx[ch];
@@ -890,7 +1048,8 @@ ULS_QUALIFIED_METHOD(uls_gettok_raw)(uls_lex_ptr_t uls)
 	rc = 1;
 
 	if ((_uls_tool_(isdigit)(ch) || ch == '.') &&
-		(parm_ln.lptr=lptr, k=get_number(uls, ctx, uls_ptr(parm_ln)), lptr=parm_ln.lptr, k > 0)) {
+		(parm_ln.lptr=lptr, k=tokid_only ? get_number_tokid(uls, ctx, uls_ptr(parm_ln)) : get_number(uls, ctx, uls_ptr(parm_ln)),
+		lptr=parm_ln.lptr, k > 0)) {
 		/*
 			The lexeme of NUMBER token does not include the minus sign.
 				i.e., The token string represents non-negative number.
@@ -902,11 +1061,34 @@ ULS_QUALIFIED_METHOD(uls_gettok_raw)(uls_lex_ptr_t uls)
 		ctx->s_val = ctx->tokbuf.buf;
 		ctx->s_val_len = ctx->s_val_wchars = k;
 		ctx->tok = e_vx->tok_id;
+		uls_stats_inc(uls->stats, n_toks_number);
 
 	} else if ((ch_grp & ULS_CH_IDFIRST) || (rc = uls_is_char_idfirst(uls, lptr, &wch)) > 0) {
-		for (n_wchars = k = 0; ; ) {
-			for (j=0; j<rc; j++) {
-				str_putc(uls_ptr(ctx->tokbuf), k++, *lptr++);
+		// The identifier is folded as it's scanned, being looked up in the keyword table once.
+		fold = uls->idkeyw_table.case_insensitive && uls->intern == nilptr;
+		lxm = lptr;
+
+		for (n_wchars = k = l_wlxm = l_fold = 0; ; ) {
+			if (tokid_only) {
+				lptr += rc;
+				k += rc;
+			} else {
+				for (j=0; j<rc; j++) {
+					str_putc(uls_ptr(ctx->tokbuf), k++, *lptr++);
+				}
+			}
+			if (fold && l_fold >= 0) {
+				if (rc == 1 && l_fold < ULS_LEXSTR_MAXSIZ) {
+					foldbuf[l_fold++] = uls->idkeyw_table.casefold[wch];
+				} else if ((j = _uls_tool_(encode_utf8)(uls_fold_wch(wch),
+					foldbuf + l_fold, ULS_LEXSTR_MAXSIZ - l_fold)) > 0) {
+					l_fold += j;
+				} else {
+					l_fold = -1; // too long to be a keyword
+				}
+			}
+			if (wide) {
+				l_wlxm = __uls_put_wch(uls_ptr(ctx->wtokbuf), l_wlxm, wch);
 			}
 			++n_wchars;
 
@@ -919,24 +1101,51 @@ ULS_QUALIFIED_METHOD(uls_gettok_raw)(uls_lex_ptr_t uls)
 				if (!uls_is_char_id(uls, wch)) break;
 			}
 		}
-		str_putc(uls_ptr(ctx->tokbuf), k, '\0');
+		if (!tokid_only) {
+			str_putc(uls_ptr(ctx->tokbuf), k, '\0');
+			lxm = ctx->tokbuf.buf;
+		}
+
+		if (wide) {
+			((wchar_t *) ctx->wtokbuf.buf)[l_wlxm] = L'\0';
+			ctx->l_wtokbuf = l_wlxm;
+		}
+
+		too_long = n_wchars > uls->id_max_uchars || k > uls->id_max_bytes;
+
+		if (uls->intern != nilptr && !too_long) {
+			// The keyword-table is consulted only at the first occurrence of each spelling.
+			// An over-long identifier is an error and never goes into the intern-table.
+			ctx->atom_id = uls_intern_id(uls->intern, uls_ptr(uls->idkeyw_table), lxm, k, n_wchars);
+			e = uls_intern_atom(uls->intern, ctx->atom_id)->kw;
+		} else if (fold) {
+			e = l_fold >= 0 ? uls_find_kw_folded(uls_ptr(uls->idkeyw_table), foldbuf, l_fold) : nilptr;
+		} else {
+			e = is_keyword_idstr(uls_ptr(uls->idkeyw_table), lxm, k);
+		}
 
-		if ((e = is_keyword_idstr(uls_ptr(uls->idkeyw_table), ctx->tokbuf.buf, k)) != nilptr) {
+		if (e != nilptr) {
 			e_vx = e->view;
 			ctx->tok = e_vx->tok_id;
-			ctx->s_val = ctx->tokbuf.buf;
+			ctx->s_val = lxm;
 			ctx->s_val_len = k;
 			ctx->s_val_wchars = n_wchars;
-		} else if (n_wchars > uls->id_max_uchars || k > uls->id_max_bytes ) {
+			uls_stats_inc(uls->stats, n_toks_keyw);
+			uls_prof_hit(uls->prof, e);
+		} else if (too_long) {
 			e_vx = set_err_tok(uls, "Too long identifier!");
 		} else {
-			str_putc(uls_ptr(ctx->tokbuf), k, '\0');
-
 			e_vx = slots_rsv[ID_TOK_IDX];
-			ctx->s_val = ctx->tokbuf.buf;
+			ctx->s_val = lxm;
 			ctx->s_val_len = k;
 			ctx->s_val_wchars = n_wchars;
 			ctx->tok = e_vx->tok_id;
+			uls_stats_inc(uls->stats, n_toks_id);
+			uls_stats_inc(uls->prof, n_ids);
+		}
+
+		if (tokid_only && ctx->s_val == lxm) {
+			ctx->flags |= ULS_CTX_FL_LXM_INPUT;
 		}
 
 	} else if ((ch_grp & ULS_CH_2PLUS) &&
@@ -946,12 +1155,19 @@ ULS_QUALIFIED_METHOD(uls_gettok_raw)(uls_lex_ptr_t uls)
 		ctx->tok = e_vx->tok_id;
 
 		rc = e->ulen_keyword;
-		_uls_tool(str_append)(uls_ptr(ctx->tokbuf), 0, lptr, rc);
+		if (tokid_only) {
+			ctx->s_val = lptr;
+			ctx->flags |= ULS_CTX_FL_LXM_INPUT;
+		} else {
+			_uls_tool(str_append)(uls_ptr(ctx->tokbuf), 0, lptr, rc);
+			ctx->s_val = ctx->tokbuf.buf;
+		}
 
-		ctx->s_val = ctx->tokbuf.buf;
 		ctx->s_val_len = rc;
-		ctx->s_val_wchars = _uls_tool(ustr_num_wchars)(ctx->s_val, rc, nilptr);
+		ctx->s_val_wchars = e->wlen_keyword;
 		lptr += rc;
+		uls_stats_inc(uls->stats, n_toks_2plus);
+		uls_prof_hit(uls->prof, e);
 
 	} else if (ch == '\0') {
 		if (ctx->i_lexsegs >= ctx->n_lexsegs) {
@@ -964,6 +1180,16 @@ ULS_QUALIFIED_METHOD(uls_gettok_raw)(uls_lex_ptr_t uls)
 				goto next_loop; // normal case
 			}
 
+			if (ctx->flags & ULS_CTX_FL_STARVED) {
+				// push-mode: no token until uls_feed() gives more bytes.
+				ctx->tok = uls->xcontext.toknum_NONE;
+				uls->tokdef_vx = slots_rsv[NONE_TOK_IDX];
+				ctx->tokbuf.buf[0] = '\0';
+				ctx->s_val = ctx->tokbuf.buf;
+				ctx->s_val_len = ctx->s_val_wchars = 0;
+				return 0;
+			}
+
 			// EOF
 			make_eof_lexeme(uls);
 			return 1;
@@ -996,6 +1222,8 @@ ULS_QUALIFIED_METHOD(uls_gettok_raw)(uls_lex_ptr_t uls)
 
 		ctx->s_val_wchars = _uls_tool(ustr_num_wchars)(ctx->s_val, ctx->s_val_len, nilptr);
 		ctx->delta_lineno = lexseg->n_lfs_raw;
+		ctx->litfrag_flags = lexseg->frag_flags;
+		uls_stats_inc(uls->stats, n_toks_quote);
 
 	} else {
 		if (ch < ULS_SYNTAX_TABLE_SIZE) {
@@ -1016,9 +1244,12 @@ ULS_QUALIFIED_METHOD(uls_gettok_raw)(uls_lex_ptr_t uls)
 				ctx->delta_lineno =  1;
 			}
 			__uls_onechar_lexeme_vx(uls, e_vx, lptr, rc);
+			uls_stats_inc(uls->stats, n_toks_1char);
+			if (e_vx->base != nilptr) uls_prof_hit(uls->prof, e_vx->base);
 
 		} else if (_uls_tool_(isgraph)(wch) || (uls->flags & ULS_FL_MULTIBYTES_CHRTOK)) {
 			e_vx = __uls_onechar_lexeme(uls, wch, lptr, rc);
+			uls_stats_inc(uls->stats, n_toks_1char);
 
 		} else {
 			if (_uls_tool_(isgraph)(wch)) {
@@ -1050,6 +1281,8 @@ ULS_QUALIFIED_METHOD(__uls_change_isrc)(uls_lex_ptr_t uls, uls_voidptr_t usrc,
 
 	uls_input_reset(inp, ULS_INPUT_BUFSIZ, -1);
 	uls_input_change_filler(inp, usrc, fill_rawbuf, ungrab_proc);
+	ctx->flags &= ~(ULS_CTX_FL_LITFRAG | ULS_CTX_FL_COMMFRAG | ULS_CTX_FL_LITPEND);
+	_uls_tool(csz_reset)(uls_ptr(ctx->litpend));
 
 	start_lno = 1;
 	if (xctx->len_prepended_input > 0) {
@@ -1075,6 +1308,10 @@ ULS_QUALIFIED_METHOD(uls_push)(uls_lex_ptr_t uls)
 	uls_flags_t  mask_want_eof = ctx->flags & ULS_CTX_FL_WANT_EOFTOK;
 	uls_context_ptr_t ctx_new;
 
+	if (uls->tokpipe != nilptr) {
+		uls_tokpipe_drop(uls->tokpipe);
+	}
+
 	ctx_new = uls_alloc_object(uls_context_t);
 	uls_init_context(ctx_new, uls_ref_callback_this(uls_gettok_raw), uls->xcontext.toknum_NONE);
 
@@ -1082,10 +1319,16 @@ ULS_QUALIFIED_METHOD(uls_push)(uls_lex_ptr_t uls)
 	if (mask_want_eof)
 		ctx_new->flags |= ULS_CTX_FL_WANT_EOFTOK;
 
+	if (uls->flags & ULS_FL_LINEIDX) {
+		uls_input_set_fl(ctx_new->input, ULS_INP_FL_LINEIDX);
+	}
 	uls_input_reset(ctx_new->input, -1, 0);
+	ctx_new->input->stats = uls->stats;
+	__uls_ctx_renew_serial(uls_ptr(uls->xcontext), ctx_new);
 
 	ctx_new->prev = ctx;
 	uls->xcontext.context = ctx_new;
+	uls_stats_inc(uls->stats, n_push);
 
 	return ctx_new;
 }
@@ -1458,7 +1701,7 @@ ULS_QUALIFIED_METHOD(__rearrange_1char_toks)(uls_lex_ptr_t uls, const char *char
 	for (cptr = char_tokens; (ch = *cptr) != '\0'; cptr++) {
 		// ch not in { '\n', '\t' }
 		if (find_1char_tokdef_map(tbl, ch, uls_ptr(parms2)) == nilptr && parms2.tokgrp != nilptr) {
-			e_vx = uls_create_tokdef_vx(ch, NULL, nilptr);
+			e_vx = uls_arena_create_tokdef_vx(uls_ptr(uls->spec_arena), ch, NULL, nilptr);
 			e_vx->flags |= ULS_VX_CHRMAP;
 			insert_1char_tokdef_map(parms2.tokgrp, ch, e_vx);
 		}
@@ -1583,6 +1826,92 @@ ULS_QUALIFIED_METHOD(uls_create)(const char *confname)
 	return uls;
 }
 
+ULS_DECL_STATIC void
+ULS_QUALIFIED_METHOD(__uls_share_spec)(uls_lex_ptr_t uls, uls_lex_ptr_t spec)
+{
+	uls_xcontext_ptr_t xctx = uls_ptr(uls->xcontext);
+	uls_xcontext_ptr_t xctx_spec = uls_ptr(spec->xcontext);
+
+	// The members of the spec are copied as they are, pointing to the tables of 'spec'.
+	_uls_tool_(memcopy)(uls, spec, sizeof(uls_lex_t));
+	uls->flags = spec->flags | ULS_FL_STATIC | ULS_FL_SHARED_SPEC;
+	uls->ref_cnt = 0;
+	uls->tokdef_vx = nilptr;
+	uls->idkeyw_table.stats = nilptr;
+	uls->stats = nilptr;
+	uls->prof = nilptr;
+	uls->intern = nilptr;
+	uls->tokpipe = nilptr;
+	uls->shell = nilptr;
+	uls->shared_spec = spec;
+
+	// The state of lexing is of its own.
+	uls_xcontext_init(xctx, uls_ref_callback_this(uls_gettok_raw));
+	xctx->context->flags |= ULS_CTX_FL_EOF | ULS_CTX_FL_GETTOK_RAW;
+	xctx->flags |= ULS_XCTX_FL_SHARED_SPEC;
+
+	xctx->toknum_EOI = xctx_spec->toknum_EOI;
+	xctx->toknum_EOF = xctx_spec->toknum_EOF;
+	xctx->toknum_ID = xctx_spec->toknum_ID;
+	xctx->toknum_NUMBER = xctx_spec->toknum_NUMBER;
+	xctx->toknum_LINENUM = xctx_spec->toknum_LINENUM;
+	xctx->toknum_TMPL = xctx_spec->toknum_TMPL;
+	xctx->toknum_LINK = xctx_spec->toknum_LINK;
+	xctx->toknum_NONE = xctx_spec->toknum_NONE;
+	xctx->toknum_ERR = xctx_spec->toknum_ERR;
+
+	xctx->prepended_input = xctx_spec->prepended_input;
+	xctx->len_prepended_input = xctx_spec->len_prepended_input;
+	xctx->lfs_prepended_input = xctx_spec->lfs_prepended_input;
+
+	xctx->ch_context = uls->ch_context;
+	xctx->commtypes = uls_ptr(uls->commtypes);
+	xctx->n_commtypes = uls->n_commtypes;
+	xctx->quotetypes = uls_ptr(uls->quotetypes);
+
+	_uls_tool_(memcopy)(xctx->commtype_by_ch, xctx_spec->commtype_by_ch, ULS_MARKMAP_SIZE);
+	_uls_tool_(memcopy)(xctx->quotetype_by_ch, xctx_spec->quotetype_by_ch, ULS_MARKMAP_SIZE);
+	_uls_tool_(memcopy)(xctx->commtype_next, xctx_spec->commtype_next, ULS_N_MAX_COMMTYPES);
+	_uls_tool_(memcopy)(xctx->quotetype_next, xctx_spec->quotetype_next, ULS_N_MAX_QUOTETYPES);
+
+	xctx->context->tok = xctx->toknum_NONE;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_init_shared)(uls_lex_ptr_t uls, const char *confname)
+{
+	uls_lex_ptr_t spec;
+
+	if (uls == nilptr || confname == NULL) {
+		_uls_log(err_log)("%s: invalid parameter!", __func__);
+		return -1;
+	}
+
+	if ((spec = uls_grab_shared_spec(confname)) == nilptr) {
+		return -1;
+	}
+
+	__uls_share_spec(uls, spec);
+	uls_grab(uls);
+
+	return 0;
+}
+
+ULS_QUALIFIED_RETTYP(uls_lex_ptr_t)
+ULS_QUALIFIED_METHOD(uls_create_shared)(const char *confname)
+{
+	uls_lex_ptr_t uls;
+
+	uls = uls_alloc_object(uls_lex_t);
+	if (uls_init_shared(uls, confname) < 0) {
+		uls_dealloc_object(uls);
+		return nilptr;
+	}
+
+	uls->flags &= ~ULS_FL_STATIC;
+	return uls;
+}
+
 void
 ULS_QUALIFIED_METHOD(uls_reset)(uls_lex_ptr_t uls)
 {
@@ -1625,6 +1954,505 @@ ULS_QUALIFIED_METHOD(uls_skip_blanks)(uls_lex_ptr_t uls)
 	return stat;
 }
 
+int
+ULS_QUALIFIED_METHOD(uls_enable_stats)(uls_lex_ptr_t uls, int on)
+{
+	uls_stats_ptr_t stats;
+	uls_context_ptr_t ctx;
+
+	if (on) {
+		if ((stats = uls->stats) == nilptr) {
+			stats = uls_alloc_object(uls_stats_t);
+			uls->stats = stats;
+			uls_reset_stats(uls);
+		}
+	} else {
+		stats = nilptr;
+	}
+
+	uls->idkeyw_table.stats = stats;
+	for (ctx = uls->xcontext.context; ctx != nilptr; ctx = ctx->prev) {
+		ctx->input->stats = stats;
+	}
+
+	if (stats == nilptr && uls->stats != nilptr) {
+		uls_dealloc_object(uls->stats);
+		uls->stats = nilptr;
+	}
+
+	return 0;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_enable_profile)(uls_lex_ptr_t uls, int on)
+{
+	uls_prof_ptr_t prof = uls->prof;
+
+	if (on) {
+		if (prof == nilptr) {
+			prof = uls_alloc_object(uls_prof_t);
+			prof->n_tokdefs = uls->tokdef_array.n;
+			prof->tokdef_hits = (uls_uint64 *) _uls_tool_(malloc)((prof->n_tokdefs + 1) * sizeof(uls_uint64));
+			uls->prof = prof;
+			uls_reset_profile(uls);
+		}
+	} else if (prof != nilptr) {
+		uls_mfree(prof->tokdef_hits);
+		uls_dealloc_object(prof);
+		uls->prof = nilptr;
+	}
+
+	return 0;
+}
+
+void
+ULS_QUALIFIED_METHOD(uls_reset_profile)(uls_lex_ptr_t uls)
+{
+	uls_prof_ptr_t prof = uls->prof;
+
+	if (prof == nilptr) return;
+
+	uls_bzero(prof->tokdef_hits, prof->n_tokdefs * sizeof(uls_uint64));
+	prof->n_ids = 0;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_merge_profile)(uls_lex_ptr_t uls, uls_lex_ptr_t uls_src)
+{
+	uls_prof_ptr_t prof = uls->prof, prof_src = uls_src->prof;
+	int i;
+
+	if (prof == nilptr || prof_src == nilptr ||
+		prof->n_tokdefs != prof_src->n_tokdefs ||
+		uls_parray_slots(uls_ptr(uls->tokdef_array)) != uls_parray_slots(uls_ptr(uls_src->tokdef_array))) {
+		_uls_log(err_log)("%s: the profiles aren't of the same spec!", __func__);
+		return -1;
+	}
+
+	for (i = 0; i < prof->n_tokdefs; i++) {
+		prof->tokdef_hits[i] += prof_src->tokdef_hits[i];
+	}
+	prof->n_ids += prof_src->n_ids;
+
+	return 0;
+}
+
+/*
+ * Writes the hits of the keywords as a ulf-file of the spec.
+ * The hashcode is searched again for the hits, so that the next lexer loading the file
+ *   probes the keyword table least for the input profiled.
+ * The hits of the two-plus and one-char tokens follow as comments.
+ */
+int
+ULS_QUALIFIED_METHOD(uls_dump_profile_ulf)(uls_lex_ptr_t uls, const char *filepath)
+{
+	uls_prof_ptr_t prof = uls->prof;
+	uls_decl_parray_slots_init(slots_keyw, tokdef, uls_ptr(uls->tokdef_array));
+	uls_keyw_stat_list_ptr_t kwslst;
+	uls_decl_parray_slots(slots_lst, keyw_stat);
+	uls_keyw_stat_ptr_t kwstat;
+	uls_hash_stat_t hs;
+	uls_tokdef_ptr_t e;
+	uls_uint64 hits;
+	FILE *fout;
+	int i, stat;
+
+	if (prof == nilptr) {
+		_uls_log(err_log)("%s: the profile isn't enabled!", __func__);
+		return -1;
+	}
+
+	if ((fout = _uls_tool_(fp_open)(filepath, ULS_FIO_WRITE)) == NULL) {
+		_uls_log(err_log)("%s: can't create '%s'", __func__, filepath);
+		return -1;
+	}
+
+	kwslst = ulc_export_kwtable(uls_ptr(uls->idkeyw_table));
+	slots_lst = uls_parray_slots(uls_ptr(kwslst->lst));
+
+	for (i = 0; i < kwslst->lst.n; i++) {
+		kwstat = slots_lst[i];
+		e = kwstat->keyw_info;
+		hits = (unsigned int) e->i_tokdef < (unsigned int) prof->n_tokdefs ?
+			prof->tokdef_hits[e->i_tokdef] : 0;
+		kwstat->freq = hits > ULS_INT_MAX ? ULS_INT_MAX : (int) hits;
+	}
+
+	uls_init_hash_stat(uls_ptr(hs));
+	ulf_sort_kwstat_by_chain(kwslst);
+	ulf_search_hashcode(uls_ptr(hs), uls->idkeyw_table.hashfunc, kwslst, (double) prof->n_ids);
+
+	ulf_sort_kwstat_by_keyw(kwslst);
+	stat = ulf_create_file(uls_ptr(hs), kwslst, fout);
+
+	uls_deinit_hash_stat(uls_ptr(hs));
+	ulc_free_kwstat_list(kwslst);
+
+	if (stat < 0 || _uls_log_(sysprn_open)(fout, nilptr) < 0) {
+		_uls_tool_(fp_close)(fout);
+		return -1;
+	}
+
+	_uls_log_(sysprn)("\n# the hits of the other tokens\n");
+	for (i = 0; i < uls->tokdef_array.n && i < prof->n_tokdefs; i++) {
+		e = slots_keyw[i];
+		if ((e->keyw_type == ULS_KEYW_TYPE_TWOPLUS || e->keyw_type == ULS_KEYW_TYPE_1CHAR) &&
+			prof->tokdef_hits[i] > 0) {
+			_uls_log_(sysprn)("# %-22s %llu\n", uls_get_namebuf_value(e->keyword), prof->tokdef_hits[i]);
+		}
+	}
+
+	_uls_log_(sysprn_close)();
+	_uls_tool_(fp_close)(fout);
+
+	return 0;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_enable_intern)(uls_lex_ptr_t uls, int on)
+{
+	uls_context_ptr_t ctx;
+
+	if (on) {
+		if (uls->intern == nilptr) {
+			uls->intern = uls_alloc_object(uls_intern_table_t);
+			uls_init_intern_table(uls->intern);
+		}
+	} else if (uls->intern != nilptr) {
+		uls_deinit_intern_table(uls->intern);
+		uls_dealloc_object(uls->intern);
+		uls->intern = nilptr;
+
+		for (ctx = uls->xcontext.context; ctx != nilptr; ctx = ctx->prev) {
+			ctx->atom_id = 0;
+		}
+	}
+
+	return 0;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_tok_atom)(uls_lex_ptr_t uls)
+{
+	return uls->xcontext.context->atom_id;
+}
+
+const char*
+ULS_QUALIFIED_METHOD(uls_atom_str)(uls_lex_ptr_t uls, int atom_id, int *ptr_len)
+{
+	uls_atom_ptr_t atom;
+
+	if (uls->intern == nilptr || atom_id <= 0 || atom_id > uls->intern->n_atoms) {
+		if (ptr_len != NULL) *ptr_len = -1;
+		return NULL;
+	}
+
+	atom = uls_intern_atom(uls->intern, atom_id);
+	if (ptr_len != NULL) *ptr_len = atom->len;
+
+	return atom->str;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_num_atoms)(uls_lex_ptr_t uls)
+{
+	return uls->intern != nilptr ? uls->intern->n_atoms : 0;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_make_wlexeme)(uls_lex_ptr_t uls)
+{
+	uls_context_ptr_t ctx = uls->xcontext.context;
+	const char *lptr = ctx->s_val, *lptr_end = lptr + ctx->s_val_len;
+	uls_wch_t wch;
+	int k = 0, rc;
+
+	// The wchar_t's of a lexeme are no more than its bytes.
+	_uls_tool(str_modify)(uls_ptr(ctx->wtokbuf), 0, NULL, (ctx->s_val_len + 3) * (int) sizeof(wchar_t));
+
+	while (lptr < lptr_end) {
+		if ((rc = _uls_tool_(decode_utf8)(lptr, (int) (lptr_end - lptr), &wch)) <= 0) {
+			return -1;
+		}
+		k = __uls_put_wch(uls_ptr(ctx->wtokbuf), k, wch);
+		lptr += rc;
+	}
+
+	((wchar_t *) ctx->wtokbuf.buf)[k] = L'\0';
+	ctx->l_wtokbuf = k;
+
+	return k;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_want_wlexeme)(uls_lex_ptr_t uls, int on)
+{
+	int on0 = (uls->flags & ULS_FL_WLEXEME) ? 1 : 0;
+
+	if (on) {
+		uls->flags |= ULS_FL_WLEXEME;
+	} else {
+		uls->flags &= ~ULS_FL_WLEXEME;
+	}
+
+	return on0;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_want_tokid_only)(uls_lex_ptr_t uls, int on)
+{
+	int on0 = (uls->flags & ULS_FL_TOKID_ONLY) ? 1 : 0;
+
+	if (on) {
+		uls->flags |= ULS_FL_TOKID_ONLY;
+	} else {
+		uls->flags &= ~ULS_FL_TOKID_ONLY;
+	}
+
+	return on0;
+}
+
+const char*
+ULS_QUALIFIED_METHOD(uls_lexeme_terminated)(uls_lex_ptr_t uls)
+{
+	uls_context_ptr_t ctx = uls->xcontext.context;
+
+	// The lexeme left in the input by the tokid-only mode is copied at the first request.
+	if (ctx->s_val != ctx->tokbuf.buf) {
+		_uls_tool(str_append)(uls_ptr(ctx->tokbuf), 0, ctx->s_val, ctx->s_val_len);
+		ctx->s_val = ctx->tokbuf.buf;
+	}
+
+	ctx->flags &= ~ULS_CTX_FL_LXM_INPUT;
+	return ctx->s_val;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_want_lineidx)(uls_lex_ptr_t uls, int on)
+{
+	int on0 = (uls->flags & ULS_FL_LINEIDX) ? 1 : 0;
+	uls_context_ptr_t ctx;
+
+	if (on) {
+		uls->flags |= ULS_FL_LINEIDX;
+	} else {
+		uls->flags &= ~ULS_FL_LINEIDX;
+	}
+
+	// The lines of an input are indexed from the start of it, the next one if it's already open.
+	for (ctx = uls->xcontext.context; ctx != nilptr; ctx = ctx->prev) {
+		if (on) {
+			uls_input_set_fl(ctx->input, ULS_INP_FL_LINEIDX);
+		} else {
+			uls_input_clear_fl(ctx->input, ULS_INP_FL_LINEIDX);
+		}
+	}
+
+	return on0;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_tok_offset)(uls_lex_ptr_t uls, int *ptr_column)
+{
+	uls_context_ptr_t ctx = uls->xcontext.context;
+	int offset;
+
+	if (ptr_column != NULL) *ptr_column = -1;
+
+	if ((offset = uls_context_offset(ctx, ctx->tok_lptr)) < 0) {
+		return -1;
+	}
+
+	if (ptr_column != NULL) {
+		uls_input_offset_lineno(ctx->input, offset, ptr_column);
+	}
+
+	return offset;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_offset_lineno)(uls_lex_ptr_t uls, int offset, int *ptr_column)
+{
+	return uls_input_offset_lineno(uls->xcontext.context->input, offset, ptr_column);
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_lineno_offset)(uls_lex_ptr_t uls, int lineno)
+{
+	return uls_input_lineno_offset(uls->xcontext.context->input, lineno);
+}
+
+const wchar_t*
+ULS_QUALIFIED_METHOD(uls_wlexeme)(uls_lex_ptr_t uls, int *ptr_wlen)
+{
+	uls_context_ptr_t ctx = uls->xcontext.context;
+
+	if (!(uls->flags & ULS_FL_WLEXEME)) {
+		return NULL;
+	}
+
+	if (ctx->l_wtokbuf < 0 && uls_make_wlexeme(uls) < 0) {
+		return NULL;
+	}
+
+	if (ptr_wlen != NULL) *ptr_wlen = ctx->l_wtokbuf;
+	return (const wchar_t *) ctx->wtokbuf.buf;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_lexeme_utf16)(uls_lex_ptr_t uls, uls_uint16 *wbuf, int siz_wbuf)
+{
+	uls_context_ptr_t ctx = uls->xcontext.context;
+	return _uls_tool_(utf8_to_utf16buf)(ctx->s_val, ctx->s_val_len, wbuf, siz_wbuf);
+}
+
+ULS_DECL_STATIC int
+ULS_QUALIFIED_METHOD(__uls_wsrc_offset)(uls_context_ptr_t ctx, int offset8)
+{
+	const uls_uint16 *wstr = ctx->wsrc;
+	int i = ctx->wsrc_off16, k = ctx->wsrc_off8, rc;
+	uls_uint16 wch;
+
+	if (offset8 < k) i = k = 0;
+
+	// The utf-8 bytes of each code unit as uls_utf16_to_utf8buf() put them in the line.
+	for ( ; k < offset8 && i < ctx->l_wsrc; i += rc) {
+		if ((wch = wstr[i]) < 0x80) {
+			k += 1;
+			rc = 1;
+		} else if (wch < 0x800) {
+			k += 2;
+			rc = 1;
+		} else if ((wch & 0xFC00) == 0xD800 && i + 1 < ctx->l_wsrc) {
+			k += 4;
+			rc = 2;
+		} else {
+			k += 3;
+			rc = 1;
+		}
+	}
+
+	if (k != offset8) return -1;
+
+	ctx->wsrc_off8 = k;
+	ctx->wsrc_off16 = i;
+	return i;
+}
+
+const uls_uint16*
+ULS_QUALIFIED_METHOD(uls_lexeme_utf16_span)(uls_lex_ptr_t uls, int *ptr_wlen)
+{
+	uls_context_ptr_t ctx = uls->xcontext.context;
+	const char *lptr = ctx->tok_lptr;
+	int len = ctx->s_val_len, offset, i0, i1;
+
+	if (ptr_wlen != NULL) *ptr_wlen = -1;
+
+	if (ctx->wsrc == NULL || len <= 0 || (offset = uls_context_offset(ctx, lptr)) < 0) {
+		return NULL;
+	}
+
+	// The lexeme is a span of the source if it's the text of the token in one piece.
+	if (lptr + len > csz_data_ptr(uls_ptr(ctx->zbuf1)) + csz_length(uls_ptr(ctx->zbuf1)) ||
+		_uls_tool_(memcmp)(lptr, ctx->s_val, len) != 0 ||
+		uls_context_offset(ctx, lptr + len - 1) != offset + len - 1) {
+		return NULL;
+	}
+
+	if ((i0 = __uls_wsrc_offset(ctx, offset)) < 0 || (i1 = __uls_wsrc_offset(ctx, offset + len)) < 0) {
+		return NULL;
+	}
+
+	if (ptr_wlen != NULL) *ptr_wlen = i1 - i0;
+	return ctx->wsrc + i0;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_set_litstr_chunk)(uls_lex_ptr_t uls, int siz)
+{
+	uls_xcontext_ptr_t xctx = uls_ptr(uls->xcontext);
+	int siz0 = xctx->litstr_chunksiz;
+
+	if (siz <= 0) {
+		siz = 0;
+	} else if (siz < ULS_LITFRAG_MINSIZ) {
+		siz = ULS_LITFRAG_MINSIZ;
+	}
+
+	xctx->litstr_chunksiz = siz;
+	return siz0;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_litstr_fragment)(uls_lex_ptr_t uls)
+{
+	uls_context_ptr_t ctx = uls->xcontext.context;
+
+	if (!(ctx->flags & ULS_CTX_FL_QTOK)) {
+		return 0;
+	}
+
+	return ctx->litfrag_flags;
+}
+
+void
+ULS_QUALIFIED_METHOD(uls_reset_stats)(uls_lex_ptr_t uls)
+{
+	uls_stats_ptr_t stats = uls->stats;
+	uls_uint64 n_hits, n_misses;
+
+	if (stats == nilptr) return;
+
+	uls_initial_zerofy_object(stats);
+
+	// The csz-pool counters are process-wide. Keep the negated values at this moment
+	//   so that uls_get_stats() reports the amounts since then.
+	csz_get_pool_stats(&n_hits, &n_misses);
+	stats->n_csz_pool_hits = 0 - n_hits;
+	stats->n_csz_pool_misses = 0 - n_misses;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_get_stats)(uls_lex_ptr_t uls, uls_stats_ptr_t stats)
+{
+	uls_uint64 n_hits, n_misses;
+
+	if (uls->stats == nilptr) {
+		uls_bzero(stats, sizeof(uls_stats_t));
+		return -1;
+	}
+
+	uls_memcopy(stats, uls->stats, sizeof(uls_stats_t));
+
+	csz_get_pool_stats(&n_hits, &n_misses);
+	stats->n_csz_pool_hits += n_hits;
+	stats->n_csz_pool_misses += n_misses;
+
+	return 0;
+}
+
+void
+ULS_QUALIFIED_METHOD(uls_stats_count_tok)(uls_lex_ptr_t uls, uls_tokdef_vx_ptr_t e_vx)
+{
+	uls_stats_ptr_t stats = uls->stats;
+	int tok_id = e_vx->tok_id;
+	uls_tokdef_ptr_t e;
+
+	if (tok_id == uls->xcontext.toknum_ID) {
+		++stats->n_toks_id;
+	} else if (tok_id == uls->xcontext.toknum_NUMBER) {
+		++stats->n_toks_number;
+	} else if (uls_find_quotetype_by_tokid(uls_ptr(uls->quotetypes), uls->quotetypes.n, tok_id) != nilptr) {
+		++stats->n_toks_quote;
+	} else if ((e = e_vx->base) != nilptr && e->keyw_type == ULS_KEYW_TYPE_IDSTR) {
+		++stats->n_toks_keyw;
+	} else if (e != nilptr && e->keyw_type == ULS_KEYW_TYPE_TWOPLUS) {
+		++stats->n_toks_2plus;
+	} else {
+		++stats->n_toks_1char;
+	}
+}
+
 ULS_QUALIFIED_RETTYP(uls_quotetype_ptr_t)
 ULS_QUALIFIED_METHOD(uls_get_quote)(uls_lex_ptr_t uls, int tok_id)
 {
@@ -1657,13 +2485,18 @@ ULS_QUALIFIED_METHOD(uls_set_extra_tokdef_vx)(uls_lex_ptr_t uls, int tok_id, uls
 	uls_wch_t wch;
 	int rc;
 
+	if (uls->flags & ULS_FL_SHARED_SPEC) {
+		_uls_log(err_log)("%s: the tokdefs of a shared spec are read-only!", __func__);
+		return nilptr;
+	}
+
 	if ((e_vx = uls_find_tokdef_vx(uls, tok_id)) == nilptr) {
 		if ((uls->flags & ULS_FL_MULTIBYTES_CHRTOK) && tok_id > 0 && xctx->num_unregst_wch_tokens < 100) {
 			wch = tok_id;
 
 			if ((rc = _uls_tool_(encode_utf8)(wch, buff, -1)) > 0) {
-				e_vx = uls_create_tokdef_vx(wch, NULL, nilptr);
-				insert_1char_tokdef_etc(uls_ptr(uls->onechar_table), wch, e_vx);
+				e_vx = uls_arena_create_tokdef_vx(uls_ptr(uls->spec_arena), wch, NULL, nilptr);
+				insert_1char_tokdef_etc(uls_ptr(uls->onechar_table), uls_ptr(uls->spec_arena), wch, e_vx);
 				__uls_onechar_lexeme_vx(uls, e_vx, buff, rc);
 				++xctx->num_unregst_wch_tokens;
 			}
@@ -1704,6 +2537,11 @@ ULS_QUALIFIED_METHOD(uls_set_current_extra_tokdef)(uls_lex_ptr_t uls, uls_voidpt
 {
 	uls_tokdef_vx_ptr_t e_vx = uls->tokdef_vx;
 
+	if (uls->flags & ULS_FL_SHARED_SPEC) {
+		_uls_log(err_log)("%s: the tokdefs of a shared spec are read-only!", __func__);
+		return;
+	}
+
 	if (e_vx->flags & ULS_VX_ANONYMOUS) {
 		e_vx = uls_set_extra_tokdef_vx(uls, __uls_tok(uls), extra_tokdef);
 	} else {
@@ -1712,7 +2550,7 @@ ULS_QUALIFIED_METHOD(uls_set_current_extra_tokdef)(uls_lex_ptr_t uls, uls_voidpt
 }
 
 int
-ULS_QUALIFIED_METHOD(uls_get_tok)(uls_lex_ptr_t uls)
+ULS_QUALIFIED_METHOD(__uls_get_tok)(uls_lex_ptr_t uls)
 {
 	uls_context_ptr_t ctx = uls->xcontext.context;
 
@@ -1737,8 +2575,11 @@ ULS_QUALIFIED_METHOD(uls_get_tok)(uls_lex_ptr_t uls)
 	}
 
 	while (1) {
+		ctx->atom_id = 0;
+		ctx->l_wtokbuf = -1;
 		if (ctx->gettok(uls) == 0) {
 			if (ctx->tok == uls->xcontext.toknum_NONE) {
+				if (ctx->flags & ULS_CTX_FL_STARVED) break;
 				continue;
 			}
 			break;
@@ -1759,6 +2600,17 @@ ULS_QUALIFIED_METHOD(uls_get_tok)(uls_lex_ptr_t uls)
 	return ctx->tok;
 }
 
+int
+ULS_QUALIFIED_METHOD(uls_get_tok)(uls_lex_ptr_t uls)
+{
+	// The token ungot is given out as it is, it has passed the stages.
+	if (uls->tokpipe != nilptr && !(uls->xcontext.context->flags & ULS_CTX_FL_TOKEN_UNGOT)) {
+		return uls_tokpipe_get_tok(uls);
+	}
+
+	return __uls_get_tok(uls);
+}
+
 void
 ULS_QUALIFIED_METHOD(uls_set_tok)(uls_lex_ptr_t uls, int tokid, const char *lexeme, int l_lexeme)
 {
@@ -1779,6 +2631,8 @@ ULS_QUALIFIED_METHOD(uls_set_tok)(uls_lex_ptr_t uls, int tokid, const char *lexe
 	ctx->s_val_len = l_lexeme;
 	ctx->s_val_wchars = _uls_tool(ustr_num_wchars)(ctx->s_val, l_lexeme, nilptr);
 	ctx->l_tokbuf_aux = -1;
+	ctx->l_wtokbuf = -1;
+	ctx->atom_id = 0;
 }
 
 void
@@ -1828,6 +2682,10 @@ ULS_QUALIFIED_METHOD(uls_pop)(uls_lex_ptr_t uls)
 	uls_context_ptr_t ctx = uls->xcontext.context, ctx_prev;
 	uls_userdata_ptr_t ud, ud_inner;
 
+	if (uls->tokpipe != nilptr) {
+		uls_tokpipe_drop(uls->tokpipe);
+	}
+
 	if (ctx == nilptr || (ctx_prev=ctx->prev) == nilptr) {
 		return nilptr;
 	}
@@ -1846,6 +2704,7 @@ ULS_QUALIFIED_METHOD(uls_pop)(uls_lex_ptr_t uls)
 	uls_dealloc_object(ctx);
 
 	uls->xcontext.context = ctx_prev;
+	uls_stats_inc(uls->stats, n_pop);
 
 	return ctx_prev;
 }
@@ -1879,6 +2738,81 @@ ULS_QUALIFIED_METHOD(uls_push_line)(uls_lex_ptr_t uls, const char *line, int len
 	return 0;
 }
 
+int
+ULS_QUALIFIED_METHOD(uls_push_feed)(uls_lex_ptr_t uls, int flags)
+{
+	uls_context_ptr_t ctx;
+
+	ctx = uls_push(uls);
+
+	if (flags & ULS_WANT_EOFTOK) uls_want_eof(uls);
+	else uls_unwant_eof(uls);
+
+	uls_input_reset(ctx->input, ULS_INPUT_BUFSIZ, 0);
+	uls_input_change_filler_feed(ctx->input);
+	ctx->input->line_num = 1;
+	__uls_ctx_set_lineno(ctx, 1);
+
+	return 0;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_set_feed)(uls_lex_ptr_t uls, int flags)
+{
+	uls_pop(uls);
+	return uls_push_feed(uls, flags);
+}
+
+ULS_DECL_STATIC ULS_QUALIFIED_RETTYP(uls_input_ptr_t)
+ULS_QUALIFIED_METHOD(__uls_find_feed_input)(uls_lex_ptr_t uls)
+{
+	uls_context_ptr_t ctx;
+
+	for (ctx = uls->xcontext.context; ctx != nilptr; ctx = ctx->prev) {
+		if (uls_input_isset_fl(ctx->input, ULS_INP_FL_FEED)) return ctx->input;
+	}
+
+	return nilptr;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_feed)(uls_lex_ptr_t uls, const char *bytes, int len)
+{
+	uls_input_ptr_t inp;
+
+	if (bytes == NULL || len < 0) {
+		_uls_log(err_log)("%s: invalid parameter!", __func__);
+		return -1;
+	}
+
+	if ((inp = __uls_find_feed_input(uls)) == nilptr || uls_input_feed(inp, bytes, len) < 0) {
+		_uls_log(err_log)("%s: no input in push-mode or it's already ended!", __func__);
+		return -1;
+	}
+
+	return len;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_feed_end)(uls_lex_ptr_t uls)
+{
+	uls_input_ptr_t inp;
+
+	if ((inp = __uls_find_feed_input(uls)) == nilptr) {
+		_uls_log(err_log)("%s: no input in push-mode!", __func__);
+		return -1;
+	}
+
+	return uls_input_feed_end(inp);
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_is_starved)(uls_lex_ptr_t uls)
+{
+	uls_context_ptr_t ctx = uls->xcontext.context;
+	return (ctx->flags & ULS_CTX_FL_STARVED) ? 1 : 0;
+}
+
 int
 ULS_QUALIFIED_METHOD(uls_set_line)(uls_lex_ptr_t uls, const char *line, int len, int flags)
 {
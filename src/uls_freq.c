@@ -73,6 +73,14 @@ ULS_QUALIFIED_METHOD(ulf_read_config_var)(int lno, char *lptr, ulf_header_ptr_t
 
 	} else if (uls_streql(wrd, "HASH_VERSION:")) {
 	} else if (uls_streql(wrd, "HASH_TABLE_SIZE:")) {
+		wrd = __uls_tool_(splitstr)(uls_ptr(wrdx));
+		if (_uls_tool(is_pure_integer)(wrd, uls_ptr(parms)) <= 0 ||
+			parms.n <= 0 || parms.n > ULF_HASH_TABLE_MAXSIZE) {
+			_uls_log(err_log)("%s: invalid HASH_TABLE_SIZE in ULF", wrd);
+			stat = -1;
+		} else {
+			hdr->hash_table_size = parms.n;
+		}
 	} else {
 		_uls_log(err_log)("%s: unknown attribute in ULF", wrd);
 		stat = -1;
@@ -176,6 +184,7 @@ ULS_QUALIFIED_METHOD(ulf_init_header)(ulf_header_ptr_t hdr)
 
 	uls_init_intarray(hdr->weights, 3);
 	for (i = 0; i < 3; i++) hdr->weights[i] = 1;
+	hdr->hash_table_size = ULF_HASH_TABLE_SIZE;
 
 	uls_init_namebuf(hdr->hash_algorithm, ULS_LEXSTR_MAXSIZ);
 	uls_set_namebuf_value(hdr->hash_algorithm, ULS_HASH_ALGORITHM);
@@ -325,7 +334,7 @@ ULS_QUALIFIED_METHOD(ulf_create_file_header)(uls_hash_stat_ptr_t hs)
 	_uls_log_(sysprn)("HASH_ALGORITHM: %s\n", ULS_HASH_ALGORITHM);
 	_uls_log_(sysprn)("HASH_VERSION: %d.%d", ULF_VERSION_HASHFUNC_MAJOR, ULF_VERSION_HASHFUNC_MINOR);
 	_uls_log_(sysprn)(".%d\n", ULF_VERSION_HASHFUNC_DEBUG);
-	_uls_log_(sysprn)("HASH_TABLE_SIZE: %d\n", ULF_HASH_TABLE_SIZE);
+	_uls_log_(sysprn)("HASH_TABLE_SIZE: %d\n", hs->table_size);
 	_uls_log_(sysprn)("INITIAL_HASHCODE: %d %d", weights[0], weights[1]);
 	_uls_log_(sysprn)(" %d\n", weights[2]);
 
@@ -357,3 +366,177 @@ ULS_QUALIFIED_METHOD(ulf_create_file)(uls_hash_stat_ptr_t hs, uls_keyw_stat_list
 	_uls_log_(sysprn_close)();
 	return 0;
 }
+
+void
+ULS_QUALIFIED_METHOD(ulf_sort_kwstat_by_keyw)(uls_keyw_stat_list_ptr_t kwslst)
+{
+	uls_decl_parray_slots_init(slots_lst, keyw_stat, uls_ptr(kwslst->lst));
+
+	_uls_quicksort_vptr(slots_lst, kwslst->lst.n, keyw_stat_comp_by_keyw);
+}
+
+/*
+ * Sorts 'kwslst' in the reverse order of the chains of the keyword table built from the ulf-file,
+ *   the most frequent keyword, chained first, coming last.
+ * Like ulf_load(), the keywords not appearing in the samples are placed
+ *   as if they had the average frequency, keeping their frequency.
+ * The ties are broken by the keywords, so the order doesn't depend on the sort.
+ */
+void
+ULS_QUALIFIED_METHOD(ulf_sort_kwstat_by_chain)(uls_keyw_stat_list_ptr_t kwslst)
+{
+	uls_decl_parray_slots_init(slots_lst, keyw_stat, uls_ptr(kwslst->lst));
+	uls_keyw_stat_ptr_t kwstat, e;
+	int i, j, n = 0, avg, ord, ord_e, n_lst = kwslst->lst.n;
+	double sum = 0.;
+
+	for (i = 0; i < n_lst; i++) {
+		if (slots_lst[i]->freq > 0) {
+			sum += slots_lst[i]->freq;
+			++n;
+		}
+	}
+	avg = n > 0 ? (int) (sum / n) : 1;
+
+	for (i = 1; i < n_lst; i++) {
+		kwstat = slots_lst[i];
+		ord = kwstat->freq > 0 ? kwstat->freq : avg;
+
+		for (j = i - 1; j >= 0; j--) {
+			e = slots_lst[j];
+			ord_e = e->freq > 0 ? e->freq : avg;
+			if (ord_e < ord || (ord_e == ord && _uls_tool_(strcmp)(e->keyw, kwstat->keyw) > 0))
+				break;
+			slots_lst[j + 1] = e;
+		}
+		slots_lst[j + 1] = kwstat;
+	}
+}
+
+/*
+ * The 'i'-th size of the hash table to be searched for 'n_keyws' keywords, -1 if no more.
+ * The first one is always tried, the others up to ULF_TABLE_SIZE_RATIO times the keywords.
+ */
+int
+ULS_QUALIFIED_METHOD(ulf_table_size)(int i, int n_keyws)
+{
+	static const int tblsiz_list[ULF_N_TABLE_SIZES] = {
+		37, 53, 79, 97, 131, 193, 257, 389, 521, 769, 1031
+	};
+
+	if (i < 0 || i >= ULF_N_TABLE_SIZES) return -1;
+	if (i > 0 && tblsiz_list[i] > ULF_TABLE_SIZE_RATIO * n_keyws) return -1;
+
+	return tblsiz_list[i];
+}
+
+/*
+ * Sets the weights of 'hs' to the 'idx'-th of the grid of [-ULF_O1_WEIGHT_MAX, ULF_O1_WEIGHT_MAX]^3,
+ *   'idx' being less than ULF_N_O1_WEIGHTS^3.
+ */
+void
+ULS_QUALIFIED_METHOD(ulf_set_o1_weights)(uls_hash_stat_ptr_t hs, int idx)
+{
+	uls_ref_intarray(weights, hs->weight);
+
+	weights[0] = idx / (ULF_N_O1_WEIGHTS * ULF_N_O1_WEIGHTS) - ULF_O1_WEIGHT_MAX;
+	weights[1] = (idx / ULF_N_O1_WEIGHTS) % ULF_N_O1_WEIGHTS - ULF_O1_WEIGHT_MAX;
+	weights[2] = idx % ULF_N_O1_WEIGHTS - ULF_O1_WEIGHT_MAX;
+}
+
+/*
+ * The expected number of probes per identifier looking up the keywords of 'kwslst'
+ *   in the table of 'hs', 'kwslst' being sorted by ulf_sort_kwstat_by_chain().
+ * A keyword costs its position in the chain weighted by its frequency, and
+ *   an identifier not being a keyword, 'n_misses' of them, probes a whole chain.
+ * Without samples, all the keywords are equally likely.
+ * 'buckets' of hs->table_size gets the lengths of the chains.
+ */
+double
+ULS_QUALIFIED_METHOD(ulf_hash_probes)(uls_hash_stat_ptr_t hs, uls_hashfunc_t hashfunc,
+	uls_keyw_stat_list_ptr_t kwslst, double n_misses, int *buckets)
+{
+	uls_decl_parray_slots_init(slots_lst, keyw_stat, uls_ptr(kwslst->lst));
+	double hit_probes = 0., n_hits = 0., sum2 = 0.;
+	int i, hash, n_lst = kwslst->lst.n;
+
+	_uls_tool_(memset)(buckets, 0x00, hs->table_size * sizeof(int));
+
+	for (i = n_lst - 1; i >= 0; i--) {
+		hash = hashfunc(hs, slots_lst[i]->keyw);
+		if (buckets[hash] < ULS_INT_MAX) ++buckets[hash];
+		hit_probes += (double) slots_lst[i]->freq * buckets[hash];
+		n_hits += slots_lst[i]->freq;
+	}
+
+	if (n_hits + n_misses > 0.) {
+		return (hit_probes + n_misses * n_lst / hs->table_size) / (n_hits + n_misses);
+	}
+
+	for (hash = 0; hash < hs->table_size; hash++) {
+		sum2 += (double) buckets[hash] * buckets[hash];
+	}
+
+	return n_lst > 0 ? sum2 / n_lst : 0.;
+}
+
+/*
+ * Searches the weights and the size of the hash table for the keywords of 'kwslst',
+ *   trying { 1, 1, 1 } and the grid of ulf_set_o1_weights() for the sizes of ulf_table_size().
+ * The smallest table within ULF_PROBES_SLACK of the least probes is chosen.
+ * 'kwslst' must be sorted by ulf_sort_kwstat_by_chain().
+ * ulf_gen searches the same, adding the candidates of its optimizing levels.
+ */
+double
+ULS_QUALIFIED_METHOD(ulf_search_hashcode)(uls_hash_stat_ptr_t hs, uls_hashfunc_t hashfunc,
+	uls_keyw_stat_list_ptr_t kwslst, double n_misses)
+{
+	uls_hash_stat_t hs_cand, hs_size[ULF_N_TABLE_SIZES];
+	uls_def_intarray(weights);
+	double probes, probes_size[ULF_N_TABLE_SIZES], least_probes = 0.;
+	int *buckets = nilptr, i, k, n_sizes, table_size;
+	int n_cands = 1 + ULF_N_O1_WEIGHTS * ULF_N_O1_WEIGHTS * ULF_N_O1_WEIGHTS;
+
+	uls_init_hash_stat(uls_ptr(hs_cand));
+	weights = hs_cand.weight;
+
+	for (n_sizes = 0; (table_size = ulf_table_size(n_sizes, kwslst->lst.n)) > 0; n_sizes++) {
+		uls_init_hash_stat(uls_ptr(hs_size[n_sizes]));
+		hs_cand.table_size = table_size;
+		buckets = (int *) uls_mrealloc(buckets, table_size * sizeof(int));
+
+		// { 1, 1, 1 } first, the default of the ulf-file.
+		for (k = 0; k < n_cands; k++) {
+			if (k == 0) {
+				weights[0] = weights[1] = weights[2] = 1;
+			} else {
+				ulf_set_o1_weights(uls_ptr(hs_cand), k - 1);
+			}
+
+			probes = ulf_hash_probes(uls_ptr(hs_cand), hashfunc, kwslst, n_misses, buckets);
+			if (k == 0 || probes < probes_size[n_sizes]) {
+				uls_copy_hash_stat(uls_ptr(hs_cand), uls_ptr(hs_size[n_sizes]));
+				probes_size[n_sizes] = probes;
+			}
+		}
+
+		if (n_sizes == 0 || probes_size[n_sizes] < least_probes)
+			least_probes = probes_size[n_sizes];
+	}
+
+	for (i = 0; i < n_sizes; i++) {
+		if (probes_size[i] <= least_probes * (1. + ULF_PROBES_SLACK)) {
+			uls_copy_hash_stat(uls_ptr(hs_size[i]), hs);
+			least_probes = probes_size[i];
+			break;
+		}
+	}
+
+	for (i = 0; i < n_sizes; i++) {
+		uls_deinit_hash_stat(uls_ptr(hs_size[i]));
+	}
+	uls_deinit_hash_stat(uls_ptr(hs_cand));
+	uls_mfree(buckets);
+
+	return least_probes;
+}
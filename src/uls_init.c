@@ -36,6 +36,7 @@
 #include "uls/uls_init.h"
 #include "uls/uls_lex.h"
 #include "uls/uls_conf.h"
+#include "uls/uls_spec_cache.h"
 #include "uls/uls_sysprops.h"
 #include "uls/uls_langs.h"
 #include "uls/utf_file.h"
@@ -47,6 +48,7 @@
 ULS_DECL_STATIC void
 ULS_QUALIFIED_METHOD(__finalize_uls)(void)
 {
+	finalize_uls_spec_cache();
 	finalize_uls_litesc();
 
 	if (uls_langs != nilptr) {
@@ -91,6 +93,7 @@ ULS_QUALIFIED_METHOD(__initialize_uls)(void)
 	}
 
 	initialize_uls_litesc();
+	initialize_uls_spec_cache();
 
 	_uls_sysinfo_(initialized) = 1;
 	return 0;
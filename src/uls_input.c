@@ -122,6 +122,13 @@ ULS_QUALIFIED_METHOD(input_skip_comment)(uls_commtype_ptr_t cmt, uls_input_ptr_t
 
 			if ((rc = inp->refill(inp, len_mark)) < len_mark) {
 //				_uls_log(err_log)("%s: I/O error", __func__);
+				if (rc >= 0 && uls_input_is_starving(inp)) {
+					// In push-mode, the comment goes on from here after more bytes are fed.
+					lptr = inp->rawbuf_ptr;
+					lptr_end = lptr + inp->rawbuf_bytes;
+					stat = 0;
+					break;
+				}
 				uls_input_reset_cursor(inp);
 				lptr = lptr_end = inp->rawbuf.buf;
 				stat = (rc < 0) ? -1 : 0;
@@ -150,20 +157,32 @@ ULS_QUALIFIED_METHOD(input_skip_comment)(uls_commtype_ptr_t cmt, uls_input_ptr_t
 	return stat;
 }
 
-int
-ULS_QUALIFIED_METHOD(input_quote_proc)(uls_input_ptr_t inp, uls_quotetype_ptr_t qmt, _uls_ptrtype_tool(csz_str) ss_dst, uls_ptrtype_tool(outparam) parms)
+void
+ULS_QUALIFIED_METHOD(input_quote_begin)(uls_litstr_ptr_t lit, uls_quotetype_ptr_t qmt, _uls_ptrtype_tool(csz_str) ss_dst)
 {
-	uls_litstr_t lit;
-	uls_litstr_context_ptr_t lit_ctx = uls_ptr(lit.context);
-
-	int len_emark = qmt->len_end_mark, n_qmt_lines = qmt->n_lfs;
-	const char *lptr, *lptr_end;
-	int   stat, n_bytes_req;
+	uls_litstr_context_ptr_t lit_ctx = uls_ptr(lit->context);
 
 	lit_ctx->qmt = qmt;
 	lit_ctx->litstr_proc = qmt->litstr_analyzer;
 	lit_ctx->n_lfs = 0;
 	lit_ctx->ss_dst = ss_dst;
+}
+
+// Analyzes the literal string from the cursor of 'inp' with the state in 'lit'.
+// If maxlen > 0, it stops with ULS_LITPROC_FRAGMENT after about 'maxlen' bytes are put in ss_dst.
+// Since the state of the analyzer stays in 'lit', it can go on where it stopped even in an escape sequence.
+int
+ULS_QUALIFIED_METHOD(input_quote_fragment)(uls_input_ptr_t inp, uls_litstr_ptr_t lit, int maxlen, uls_ptrtype_tool(outparam) parms)
+{
+	uls_litstr_context_ptr_t lit_ctx = uls_ptr(lit->context);
+	uls_quotetype_ptr_t qmt = lit_ctx->qmt;
+
+	int len_emark = qmt->len_end_mark, n_qmt_lines = 0;
+	const char *lptr, *lptr_end;
+	int   stat, n_bytes_req, len0, n;
+
+	lit_ctx->n_lfs = 0;
+	len0 = csz_length(lit_ctx->ss_dst);
 
 	lptr = inp->rawbuf_ptr;
 	lptr_end = lptr + inp->rawbuf_bytes;
@@ -187,16 +206,28 @@ ULS_QUALIFIED_METHOD(input_quote_proc)(uls_input_ptr_t inp, uls_quotetype_ptr_t
 		}
 
 		if (lptr_end < lptr + len_emark) {
-			stat = ULS_LITPROC_ERROR;
+			stat = uls_input_is_starving(inp) ? ULS_LITPROC_STARVED : ULS_LITPROC_ERROR;
 			break;
 		}
 
-		lit.lptr = lptr;
-		lit.lptr_end = lptr_end;
-		n_bytes_req = lit_ctx->litstr_proc(uls_ptr(lit));
-		lptr = lit.lptr;
+		lit->lptr = lptr;
+		lit->lptr_end = lptr_end;
+
+		if (maxlen > 0) {
+			if ((n = maxlen - (csz_length(lit_ctx->ss_dst) - len0)) <= 0) {
+				stat = ULS_LITPROC_FRAGMENT;
+				break;
+			}
+			// Show the analyzer no more than it may put in this fragment.
+			if (n < n_bytes_req) n = n_bytes_req;
+			if (lptr + n < lptr_end) lit->lptr_end = lptr + n;
+		}
+
+		n_bytes_req = lit_ctx->litstr_proc(lit);
+		lptr = lit->lptr;
 
 		if (n_bytes_req <= 0) {
+			n_qmt_lines = qmt->n_lfs;
 			if (n_bytes_req == ULS_LITPROC_ENDOFQUOTE && (qmt->flags & ULS_QSTR_R_EXCLUSIVE)) {
 				lptr -= len_emark;
 				n_qmt_lines = qmt->n_left_lfs;
@@ -214,6 +245,15 @@ ULS_QUALIFIED_METHOD(input_quote_proc)(uls_input_ptr_t inp, uls_quotetype_ptr_t
 	return stat;
 }
 
+int
+ULS_QUALIFIED_METHOD(input_quote_proc)(uls_input_ptr_t inp, uls_quotetype_ptr_t qmt, _uls_ptrtype_tool(csz_str) ss_dst, uls_ptrtype_tool(outparam) parms)
+{
+	uls_litstr_t lit;
+
+	input_quote_begin(uls_ptr(lit), qmt, ss_dst);
+	return input_quote_fragment(inp, uls_ptr(lit), -1, parms);
+}
+
 int
 ULS_QUALIFIED_METHOD(input_space_proc)(const char *ch_ctx, uls_input_ptr_t inp,
 	_uls_ptrtype_tool(csz_str) ss_dst, uls_ptrtype_tool(outparam) parms0)
@@ -276,6 +316,7 @@ ULS_QUALIFIED_METHOD(uls_init_line_in_input)(uls_input_ptr_t inp, const char *li
 
 	_uls_tool(str_modify)(uls_ptr(inp->rawbuf), ipos, line, n_bytes);
 	inp->rawbuf_ptr = inp->rawbuf.buf;
+	uls_input_index_lines(inp, line, n_bytes);
 
 	if ((ipos2=ipos + n_bytes) > inp->rawbuf_bytes)
 		inp->rawbuf_bytes = ipos2;
@@ -290,6 +331,77 @@ ULS_QUALIFIED_METHOD(uls_input_reset_cursor)(uls_input_ptr_t inp)
 	inp->rawbuf_bytes = 0;
 }
 
+ULS_DECL_STATIC void
+ULS_QUALIFIED_METHOD(__uls_input_add_linestart)(uls_input_ptr_t inp, int offset)
+{
+	if (inp->n_linestarts >= inp->n_alloc_linestarts) {
+		inp->n_alloc_linestarts = inp->n_alloc_linestarts > 0 ? 2 * inp->n_alloc_linestarts : 256;
+		inp->linestarts = (int *) uls_mrealloc(inp->linestarts, inp->n_alloc_linestarts * sizeof(int));
+	}
+
+	inp->linestarts[inp->n_linestarts++] = offset;
+}
+
+void
+ULS_QUALIFIED_METHOD(uls_input_reset_offset)(uls_input_ptr_t inp)
+{
+	inp->offset_read = 0;
+	inp->n_linestarts = 0;
+
+	if (uls_input_isset_fl(inp, ULS_INP_FL_LINEIDX)) {
+		__uls_input_add_linestart(inp, 0);
+	}
+}
+
+void
+ULS_QUALIFIED_METHOD(uls_input_index_lines)(uls_input_ptr_t inp, const char *buf, int n)
+{
+	const char *lptr = buf, *lptr_end = buf + n;
+	int offset0 = inp->offset_read;
+
+	inp->offset_read += n;
+	// The index is started only at the start of an input.
+	if (!uls_input_isset_fl(inp, ULS_INP_FL_LINEIDX) || inp->n_linestarts <= 0) {
+		return;
+	}
+
+	// memchr() goes through the bytes between the line-feeds a word at a time.
+	while ((lptr = _uls_tool_(memchr)(lptr, '\n', (int) (lptr_end - lptr))) != NULL) {
+		++lptr;
+		__uls_input_add_linestart(inp, offset0 + (int) (lptr - buf));
+	}
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_input_offset_lineno)(uls_input_ptr_t inp, int offset, int *ptr_column)
+{
+	int lo, hi, mid;
+
+	if (inp->n_linestarts <= 0 || offset < 0 || offset > inp->offset_read) {
+		return -1;
+	}
+
+	// the last line starting at or before 'offset'
+	for (lo = 0, hi = inp->n_linestarts - 1; lo < hi; ) {
+		mid = (lo + hi + 1) >> 1;
+		if (inp->linestarts[mid] <= offset) lo = mid;
+		else hi = mid - 1;
+	}
+
+	if (ptr_column != NULL) *ptr_column = offset - inp->linestarts[lo] + 1;
+	return lo + 1;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_input_lineno_offset)(uls_input_ptr_t inp, int lineno)
+{
+	if (lineno < 1 || lineno > inp->n_linestarts) {
+		return -1;
+	}
+
+	return inp->linestarts[lineno - 1];
+}
+
 void
 ULS_QUALIFIED_METHOD(uls_input_reset)(uls_input_ptr_t inp, int bufsiz, int flags)
 {
@@ -307,6 +419,7 @@ ULS_QUALIFIED_METHOD(uls_input_reset)(uls_input_ptr_t inp, int bufsiz, int flags
 	}
 
 	uls_input_reset_cursor(inp);
+	uls_input_reset_offset(inp);
 
 	if (flags >= 0) {
 		if (flags & ULS_INP_FL_REFILL_NULL) {
@@ -331,6 +444,7 @@ ULS_QUALIFIED_METHOD(uls_input_change_filler)(uls_input_ptr_t inp,
 	inp->isource.usrc_fillbuff = fill_rawbuf;
 	inp->isource.usrc_ungrab = ungrab_proc;
 	inp->isource.flags = 0;
+	uls_input_clear_fl(inp, ULS_INP_FL_FEED);
 }
 
 void
@@ -354,6 +468,7 @@ ULS_QUALIFIED_METHOD(uls_init_input)(uls_input_ptr_t inp)
 
 	uls_input_change_filler(inp, nilptr, nilptr, nilptr);
 	inp->line_num = 1;
+	inp->stats = nilptr;
 }
 
 void
@@ -362,6 +477,9 @@ ULS_QUALIFIED_METHOD(uls_deinit_input)(uls_input_ptr_t inp)
 	uls_input_reset(inp, 0, ULS_INP_FL_REFILL_NULL);
 	uls_input_change_filler(inp, nilptr, nilptr, nilptr);
 	uls_deinit_isource(uls_ptr(inp->isource));
+
+	uls_mfree(inp->linestarts);
+	inp->n_linestarts = inp->n_alloc_linestarts = 0;
 }
 
 ULS_QUALIFIED_RETTYP(uls_input_ptr_t)
@@ -430,11 +548,19 @@ ULS_QUALIFIED_METHOD(uls_input_refill_buffer)(uls_input_ptr_t inp, int n_req_byt
 			inp->rawbuf.buf, inp->rawbuf_bytes, inp->rawbuf.siz)) < 0) {
 			return -1;
 		}
+		uls_stats_inc(inp->stats, n_refill_reads);
+		uls_stats_add(inp->stats, n_refill_bytes, rc);
+
+		uls_input_index_lines(inp, inp->rawbuf.buf + inp->rawbuf_bytes, rc);
 
 		if (rc == 0 || (inp->rawbuf_bytes += rc) >= n_req_bytes) {
 			break;
 		}
 
+		// In push-mode, the filler rolls back instead of waiting.
+		if (uls_input_isset_fl(inp, ULS_INP_FL_FEED)) break;
+
+		uls_stats_inc(inp->stats, n_refill_sleeps);
 		_uls_tool_(msleep)(15);
 	}
 
@@ -516,3 +642,119 @@ ULS_QUALIFIED_METHOD(uls_fill_fd_isrc_utf8)(uls_source_ptr_t isrc, char *buf, in
 
 	return rc;
 }
+
+void
+ULS_QUALIFIED_METHOD(uls_input_change_filler_feed)(uls_input_ptr_t inp)
+{
+	uls_feed_ptr_t feed;
+
+	feed = uls_alloc_object(uls_feed_t);
+	uls_initial_zerofy_object(feed);
+	_uls_tool(csz_init)(uls_ptr(feed->buf), ULS_INPUT_BUFSIZ);
+
+	uls_input_change_filler(inp, (uls_voidptr_t) feed,
+		uls_ref_callback_this(uls_fill_feed_source), uls_ref_callback_this(uls_ungrab_feed_source));
+	uls_input_set_fl(inp, ULS_INP_FL_FEED);
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_input_feed)(uls_input_ptr_t inp, const char *bytes, int len)
+{
+	uls_feed_ptr_t feed;
+	int i, n;
+
+	if (!uls_input_isset_fl(inp, ULS_INP_FL_FEED)) return -1;
+	feed = (uls_feed_ptr_t) inp->isource.usrc;
+	if (feed->ended) return -1;
+
+	// Drop the bytes the filler is done with.
+	if ((n = feed->n_committed) >= ULS_INPUT_BUFSIZ && n >= csz_length(uls_ptr(feed->buf)) / 2) {
+		_uls_tool_(memmove)(csz_data_ptr(uls_ptr(feed->buf)), csz_data_ptr(uls_ptr(feed->buf)) + n,
+			csz_length(uls_ptr(feed->buf)) - n);
+		csz_truncate(uls_ptr(feed->buf), csz_length(uls_ptr(feed->buf)) - n);
+		feed->n_consumed -= n;
+		feed->n_ready -= n;
+		feed->n_committed = 0;
+	}
+
+	n = csz_length(uls_ptr(feed->buf));
+	_uls_tool(csz_append)(uls_ptr(feed->buf), bytes, len);
+
+	for (i = len - 1; i >= 0; i--) {
+		if (bytes[i] == '\n') {
+			feed->n_ready = n + i + 1;
+			break;
+		}
+	}
+
+	return len;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_input_feed_end)(uls_input_ptr_t inp)
+{
+	uls_feed_ptr_t feed;
+
+	if (!uls_input_isset_fl(inp, ULS_INP_FL_FEED)) return -1;
+	feed = (uls_feed_ptr_t) inp->isource.usrc;
+
+	feed->ended = 1;
+	feed->n_ready = csz_length(uls_ptr(feed->buf));
+
+	return 0;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_input_is_starving)(uls_input_ptr_t inp)
+{
+	uls_feed_ptr_t feed;
+
+	if (!uls_input_isset_fl(inp, ULS_INP_FL_FEED)) return 0;
+	feed = (uls_feed_ptr_t) inp->isource.usrc;
+
+	return !feed->ended;
+}
+
+void
+ULS_QUALIFIED_METHOD(uls_input_feed_commit)(uls_input_ptr_t inp)
+{
+	uls_feed_ptr_t feed;
+
+	if (!uls_input_isset_fl(inp, ULS_INP_FL_FEED)) return;
+	feed = (uls_feed_ptr_t) inp->isource.usrc;
+
+	// The rest of rawbuf is the tail of the bytes consumed.
+	feed->n_committed = feed->n_consumed - inp->rawbuf_bytes;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_fill_feed_source)(uls_source_ptr_t isrc, char *buf, int buflen, int bufsiz)
+{
+	uls_feed_ptr_t feed = (uls_feed_ptr_t) isrc->usrc;
+	int n;
+
+	if ((n = feed->n_ready - feed->n_consumed) > bufsiz - buflen) {
+		n = bufsiz - buflen;
+	}
+
+	if (n <= 0) {
+		if (feed->ended && feed->n_consumed >= csz_length(uls_ptr(feed->buf))) {
+			isrc->flags |= ULS_ISRC_FL_EOF;
+		}
+		return 0;
+	}
+
+	_uls_tool_(memcopy)(buf + buflen, csz_data_ptr(uls_ptr(feed->buf)) + feed->n_consumed, n);
+	feed->n_consumed += n;
+
+	return n;
+}
+
+void
+ULS_QUALIFIED_METHOD(uls_ungrab_feed_source)(uls_source_ptr_t isrc)
+{
+	uls_feed_ptr_t feed = (uls_feed_ptr_t) isrc->usrc;
+
+	_uls_tool(csz_deinit)(uls_ptr(feed->buf));
+	uls_dealloc_object(feed);
+}
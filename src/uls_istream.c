@@ -36,6 +36,10 @@
 #include "uls/uls_log.h"
 
 #include <sys/types.h>
+#ifndef __ULS_WINDOWS__
+#include <sys/stat.h>
+#include <sys/mman.h>
+#endif
 #endif
 
 ULS_DECL_STATIC void
@@ -74,6 +78,16 @@ ULS_QUALIFIED_METHOD(__destroy_istream)(uls_istream_ptr_t istr)
 {
 	istr->ref_cnt = 0;
 	istr->fd = -1;
+	if (istr->zsrc != nilptr) {
+		_uls_tool_(zsrc_close)(istr->zsrc);
+		istr->zsrc = nilptr;
+	}
+#ifndef __ULS_WINDOWS__
+	if (istr->map_base != NULL) {
+		munmap(istr->map_base, istr->map_size);
+		istr->map_base = NULL;
+	}
+#endif
 	uls_mfree(istr->firstline);
 
 	_uls_tool_(deinit_tempfile)(uls_ptr(istr->uld_file));
@@ -361,7 +375,7 @@ ULS_QUALIFIED_METHOD(uls_fill_fd_stream)(uls_source_ptr_t isrc, char *buf, int b
 	uls_istream_ptr_t istr = (uls_istream_ptr_t) isrc->usrc;
 	int rc;
 
-	rc = _uls_tool_(readn)(istr->fd, buf + buflen, bufsiz - buflen);
+	rc = __istr_readn(istr, buf + buflen, bufsiz - buflen);
 	if (rc == 0) {
 		isrc->flags |= ULS_ISRC_FL_EOF;
 	}
@@ -376,42 +390,15 @@ ULS_QUALIFIED_METHOD(uls_ungrab_fd_stream)(uls_source_ptr_t isrc)
 	uls_destroy_istream(istr);
 }
 
-int
-ULS_QUALIFIED_METHOD(uls_gettok_bin)(uls_lex_ptr_t uls)
+ULS_DECL_STATIC int
+ULS_QUALIFIED_METHOD(__uls_take_bin_record)(uls_lex_ptr_t uls, int tok_id, int txtlen, const char *lptr)
 {
 	uls_context_ptr_t ctx = uls->xcontext.context;
 	uls_decl_parray_slots_init(slots_rsv, tokdef_vx, uls_ptr(uls->tokdef_vx_rsvd));
 	uls_tokdef_vx_ptr_t e_vx;
-
-	const char     *lptr, *pckptr;
-	char *lptr2;
-	int    tok_id, rc, txtlen;
-	uls_uint32  *hdrbuf;
 	uls_type_tool(outparam) parms;
-
- next_loop:
-	lptr = ctx->lptr;
-
-	if (lptr >= ctx->line_end) {
-		if ((rc=uls_clear_and_fillbuff(uls)) < 0) {
-			return 0;
-		} else if (rc > 0) {
-			goto next_loop; // normal case
-		}
-
-		uls->tokdef_vx = set_err_tok(uls, "NO-EOI");
-		return 0;
-	}
-
-	pckptr = lptr;
-	ctx->lptr += ULS_RDPKT_SIZE;
-
-	hdrbuf = (uls_uint32 *) pckptr;
-	tok_id = hdrbuf[0];
-	txtlen = hdrbuf[1];
-
-	pckptr += 2 * sizeof(uls_uint32);
-	lptr = *((char **) pckptr);
+	char *lptr2;
+	int rc;
 
 	if (tok_id == uls->xcontext.toknum_EOF) {
 		make_eoif_lexeme_bin(ctx, tok_id, lptr, txtlen);
@@ -433,7 +420,7 @@ ULS_QUALIFIED_METHOD(uls_gettok_bin)(uls_lex_ptr_t uls)
 		else ++lptr; // skip the ' '
 
 		uls_ctx_set_tag(ctx, lptr, rc);
-		goto next_loop;
+		return -1;
 	}
 
 	ctx->flags |= ULS_CTX_FL_EXTERN_TOKBUF;
@@ -455,12 +442,168 @@ ULS_QUALIFIED_METHOD(uls_gettok_bin)(uls_lex_ptr_t uls)
 
 	if ((e_vx = uls_find_tokdef_vx(uls, tok_id)) == nilptr) {
 		e_vx = set_err_tok(uls, "Unknown token-id!");
+	} else if (uls->stats != nilptr) {
+		uls_stats_count_tok(uls, e_vx);
 	}
 
 	uls->tokdef_vx = e_vx;
 	return 0;
 }
 
+int
+ULS_QUALIFIED_METHOD(uls_gettok_bin)(uls_lex_ptr_t uls)
+{
+	uls_context_ptr_t ctx = uls->xcontext.context;
+	const char     *lptr, *pckptr;
+	int    tok_id, rc, txtlen;
+	uls_uint32  *hdrbuf;
+
+ next_loop:
+	lptr = ctx->lptr;
+
+	if (lptr >= ctx->line_end) {
+		if ((rc=uls_clear_and_fillbuff(uls)) < 0) {
+			return 0;
+		} else if (rc > 0) {
+			goto next_loop; // normal case
+		}
+
+		uls->tokdef_vx = set_err_tok(uls, "NO-EOI");
+		return 0;
+	}
+
+	pckptr = lptr;
+	ctx->lptr += ULS_RDPKT_SIZE;
+
+	hdrbuf = (uls_uint32 *) pckptr;
+	tok_id = hdrbuf[0];
+	txtlen = hdrbuf[1];
+
+	pckptr += 2 * sizeof(uls_uint32);
+	lptr = *((char **) pckptr);
+
+	if ((rc = __uls_take_bin_record(uls, tok_id, txtlen, lptr)) < 0) {
+		goto next_loop;
+	}
+
+	return rc;
+}
+
+ULS_DECL_STATIC int
+ULS_QUALIFIED_METHOD(__uls_gettok_bin_inplace)(uls_lex_ptr_t uls, int reverse)
+{
+	uls_context_ptr_t ctx = uls->xcontext.context;
+	const char *lptr;
+	int    tok_id, rc, txtlen, n;
+
+ next_loop:
+	lptr = ctx->lptr;
+
+	if (lptr >= ctx->line_end) {
+		if ((rc=uls_clear_and_fillbuff(uls)) < 0) {
+			return 0;
+		} else if (rc > 0) {
+			goto next_loop; // normal case
+		}
+
+		uls->tokdef_vx = set_err_tok(uls, "NO-EOI");
+		return 0;
+	}
+
+	// The records are read right in the mapped file.
+	if ((n = (int) (ctx->line_end - lptr)) < ULS_BIN_RECHDR_SZ) {
+		goto corrupt;
+	}
+
+	tok_id = ((uls_int32 *) lptr)[0];
+	txtlen = ((uls_int32 *) lptr)[1];
+	if (reverse) {
+		_uls_tool_(reverse_bytes)((char *) &tok_id, sizeof(uls_int32));
+		_uls_tool_(reverse_bytes)((char *) &txtlen, sizeof(uls_int32));
+	}
+
+	if (txtlen < 0 || txtlen >= n - ULS_BIN_RECHDR_SZ || ULS_BIN_REC_SZ(txtlen) > n) {
+		goto corrupt;
+	}
+
+	ctx->lptr += ULS_BIN_REC_SZ(txtlen);
+	lptr += ULS_BIN_RECHDR_SZ;
+
+	if ((rc = __uls_take_bin_record(uls, tok_id, txtlen, lptr)) < 0) {
+		goto next_loop;
+	}
+
+	return rc;
+
+ corrupt:
+	ctx->lptr = ctx->line_end;
+	uls->tokdef_vx = set_err_tok(uls, "corrupt stream!");
+	return 0;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_gettok_bin_inplace_host_order)(uls_lex_ptr_t uls)
+{
+	return __uls_gettok_bin_inplace(uls, 0);
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_gettok_bin_inplace_reverse_order)(uls_lex_ptr_t uls)
+{
+	return __uls_gettok_bin_inplace(uls, 1);
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_map_istream)(uls_istream_ptr_t istr)
+{
+#ifndef __ULS_WINDOWS__
+	struct stat statbuff;
+	char *addr;
+
+	if (istr->map_base != NULL) {
+		return istr->map_size;
+	}
+
+	if (istr->zsrc != nilptr || istr->fd < 0 || istr->start_off < 0 ||
+		fstat(istr->fd, uls_ptr(statbuff)) < 0 || !S_ISREG(statbuff.st_mode)) {
+		return 0;
+	}
+
+	// The records are addressed by int as in the buffered path.
+	if (statbuff.st_size <= istr->start_off || statbuff.st_size > ULS_INT_MAX) {
+		return 0;
+	}
+
+	// Private and writable, the suffix of a number is cut off in its record.
+	addr = (char *) mmap(NULL, (size_t) statbuff.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, istr->fd, 0);
+	if (addr == (char *) MAP_FAILED) {
+		return 0;
+	}
+
+	istr->map_base = addr;
+	istr->map_size = (int) statbuff.st_size;
+
+	return istr->map_size;
+#else
+	return 0;
+#endif
+}
+
+int
+ULS_QUALIFIED_METHOD(xcontext_binmap_filler)(uls_xcontext_ptr_t xctx)
+{
+	uls_context_ptr_t ctx = xctx->context;
+	uls_input_ptr_t inp = ctx->input;
+	uls_istream_ptr_t istr = (uls_istream_ptr_t) inp->isource.usrc;
+
+	// The whole records are handed over at once.
+	inp->rawbuf_ptr = istr->map_base + istr->start_off;
+	inp->rawbuf_bytes = 0;
+	ctx->flags |= ULS_CTX_FL_EOF;
+
+	return istr->map_size - istr->start_off;
+}
+
 ULS_DECL_STATIC int
 ULS_QUALIFIED_METHOD(uls_readline_buffer)(char *buf, int bufsiz)
 {
@@ -476,7 +619,17 @@ ULS_QUALIFIED_METHOD(uls_readline_buffer)(char *buf, int bufsiz)
 }
 
 ULS_DECL_STATIC int
-ULS_QUALIFIED_METHOD(parse_uls_hdr)(char *line, int fd_in, uls_istream_ptr_t istr)
+ULS_QUALIFIED_METHOD(__istr_readn)(uls_istream_ptr_t istr, char *buf, int n)
+{
+	if (istr->zsrc != nilptr) {
+		return _uls_tool_(zsrc_readn)(istr->zsrc, buf, n);
+	}
+
+	return _uls_tool_(readn)(istr->fd, buf, n);
+}
+
+ULS_DECL_STATIC int
+ULS_QUALIFIED_METHOD(parse_uls_hdr)(char *line, uls_istream_ptr_t istr)
 {
 	uls_type_tool(wrd) wrdx;
 	char *wrd, filepath_buf[ULS_TEMP_FILEPATH_MAXSIZ + 5];
@@ -545,7 +698,8 @@ ULS_QUALIFIED_METHOD(parse_uls_hdr)(char *line, int fd_in, uls_istream_ptr_t ist
 
 		remap_size = remap_n_blocks << ULS_BIN_BLKSIZ_LOG2;
 		remap_buff = (char *) _uls_tool_(malloc)(remap_size + 1);
-		if (uls_fd_read(fd_in, remap_buff, remap_size) < remap_size) {
+		if (__istr_readn(istr, remap_buff, remap_size) < remap_size) {
+			uls_mfree(remap_buff);
 			return -1;
 		}
 		remap_buff[remap_size] = '\0';
@@ -604,7 +758,7 @@ ULS_QUALIFIED_METHOD(uls_open_istream)(int fd)
 	const char *magic_code = "#34183847-D64D-C131-D754-577215664901-ULS-STREAM\n";
 	const char *spec_name;
 	int  magic_code_len = _uls_tool_(strlen)(magic_code);
-	int  len, fpos;
+	int  len, fpos, zfmt;
 	uls_istream_ptr_t istr;
 	uls_type_tool(outparam) parms;
 
@@ -628,6 +782,17 @@ ULS_QUALIFIED_METHOD(uls_open_istream)(int fd)
 		return nilptr;
 	}
 
+	// A compressed file is read through zsrc from the beginning again.
+	if ((zfmt = _uls_tool_(zsrc_probe)(linebuff, len)) != ULS_ZSRC_NONE) {
+		if ((istr->zsrc = _uls_tool_(zsrc_open)(fd, zfmt, linebuff, len)) == nilptr ||
+			(len = _uls_tool_(zsrc_readn)(istr->zsrc, linebuff, magic_code_len)) < 0) {
+			_uls_log(err_log)("%s: can't read the compressed file!", __func__);
+			__destroy_istream(istr);
+			return nilptr;
+		}
+		linebuff[len] = '\0';
+	}
+
 	if (len < magic_code_len || !uls_streql(linebuff, magic_code)) { // including EOF(len==0)
 		_uls_tool_(memcopy)(istr->firstline, linebuff, len);
 		istr->firstline[len] = '\0';
@@ -637,7 +802,13 @@ ULS_QUALIFIED_METHOD(uls_open_istream)(int fd)
 		istr->header.subtype = parms.n1;
 		istr->header.reverse = parms.n2;
 
-		if (uls_fd_seek(istr->fd, fpos, SEEK_SET) == fpos) {
+		if (istr->zsrc != nilptr) {
+			// No seek in the compressed, give back the bytes after the BOM.
+			_uls_tool_(zsrc_unread)(istr->zsrc, istr->firstline + fpos, len - fpos);
+			istr->firstline[0] = '\0';
+			istr->len_firstline = 0;
+
+		} else if (uls_fd_seek(istr->fd, fpos, SEEK_SET) == fpos) {
 			// Invalidate the firstline[] read in the file.
 			istr->firstline[0] = '\0';
 			istr->len_firstline = 0;
@@ -649,7 +820,7 @@ ULS_QUALIFIED_METHOD(uls_open_istream)(int fd)
 	bufptr = ulshdr + magic_code_len;
 	bufsiz = ULS_BIN_HDR_SZ - magic_code_len;
 
-	if (uls_fd_read(fd, bufptr, bufsiz) < bufsiz) {
+	if (__istr_readn(istr, bufptr, bufsiz) < bufsiz) {
 		__destroy_istream(istr);
 		return nilptr;
 	}
@@ -682,7 +853,7 @@ ULS_QUALIFIED_METHOD(uls_open_istream)(int fd)
 			continue;
 		}
 
-		if (parse_uls_hdr(line, fd, istr) < 0) {
+		if (parse_uls_hdr(line, istr) < 0) {
 			__destroy_istream(istr);
 			istr = nilptr;
 			break;
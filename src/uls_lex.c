@@ -52,6 +52,7 @@ ULS_QUALIFIED_METHOD(__uls_change_stream_hdr)(uls_lex_ptr_t uls, uls_istream_ptr
 	if (xctx->len_prepended_input > 0 && (ctx->flags & ULS_CTX_FL_FILL_RAW)) {
 		ipos = uls_init_line_in_input(inp, xctx->prepended_input, xctx->len_prepended_input, ipos);
 		start_lno = 1 - xctx->lfs_prepended_input;
+		uls_input_reset_offset(inp); // the offsets are counted after the prepended text
 	} else {
 		start_lno = 1;
 	}
@@ -63,6 +64,39 @@ ULS_QUALIFIED_METHOD(__uls_change_stream_hdr)(uls_lex_ptr_t uls, uls_istream_ptr
 	return 0;
 }
 
+ULS_DECL_STATIC void
+ULS_QUALIFIED_METHOD(__uls_select_inplace_filler)(uls_lex_ptr_t uls, uls_istream_ptr_t istr)
+{
+	uls_context_ptr_t ctx = uls->xcontext.context;
+	int subtype = istr->header.subtype, reverse;
+
+	// The templates are expanded into packets, so only the plain binary streams are walked in place.
+	if (istr->header.filetype != ULS_STREAM_ULS || ctx->tmpls_pool != nilptr) {
+		return;
+	}
+
+	if (subtype == ULS_STREAM_BIN_LE) {
+		reverse = _uls_sysinfo_(ULS_BYTE_ORDER) != ULS_LITTLE_ENDIAN;
+	} else if (subtype == ULS_STREAM_BIN_BE) {
+		reverse = _uls_sysinfo_(ULS_BYTE_ORDER) == ULS_LITTLE_ENDIAN;
+	} else {
+		return;
+	}
+
+	if (uls_map_istream(istr) <= 0) {
+		return;
+	}
+
+	if (reverse) {
+		ctx->gettok = uls_ref_callback_this(uls_gettok_bin_inplace_reverse_order);
+	} else {
+		ctx->gettok = uls_ref_callback_this(uls_gettok_bin_inplace_host_order);
+	}
+
+	ctx->fill_proc = uls_ref_callback_this(xcontext_binmap_filler);
+	ctx->flags |= ULS_CTX_FL_INPLACE;
+}
+
 ULS_DECL_STATIC void
 ULS_QUALIFIED_METHOD(uls_fd_ungrabber)(uls_voidptr_t data)
 {
@@ -106,6 +140,7 @@ ULS_QUALIFIED_METHOD(uls_select_isrc_filler)(uls_context_ptr_t ctx, uls_istream_
 		utf_inp = _uls_tool_(utf_create_inbuf)(NULL, UTF_INPUT_BUFSIZ, mode);
 
 		_uls_tool_(utf_set_inbuf)(utf_inp, istr->fd);
+		utf_inp->zsrc = istr->zsrc;
 		utf_inp->data = (uls_voidptr_t) istr;
 
 		dat = (uls_voidptr_t) utf_inp;
@@ -247,6 +282,8 @@ ULS_QUALIFIED_METHOD(uls_push_istream)(uls_lex_ptr_t uls, uls_istream_ptr_t istr
 		stat = -5; goto end_1;
 	}
 
+	__uls_select_inplace_filler(uls, istr);
+
 	if (uls_fillbuff_and_reset(uls, NULL) < 0) {
 		_uls_log(err_log)("%s: failed to fillbuff", __func__);
 		stat = -6; goto end_1;
@@ -316,6 +353,8 @@ ULS_QUALIFIED_METHOD(uls_push_istream_2)(uls_lex_ptr_t uls, uls_istream_ptr_t is
 		stat = -5; goto end_1;
 	}
 
+	__uls_select_inplace_filler(uls, istr);
+
 	if (uls_fillbuff_and_reset(uls, NULL) < 0) {
 		stat = -6; goto end_1;
 	}
@@ -554,6 +593,43 @@ ULS_QUALIFIED_METHOD(uls_set_utf16_line)(uls_lex_ptr_t uls, uls_uint16* wline, i
 	uls_set_line(uls, line, len, ULS_MEMFREE_LINE);
 }
 
+int
+ULS_QUALIFIED_METHOD(uls_push_utf16_source)(uls_lex_ptr_t uls, const uls_uint16* wline, int wlen)
+{
+	uls_flags_t lineidx = uls->flags & ULS_FL_LINEIDX;
+	uls_context_ptr_t ctx;
+	char  *line;
+	int len, rc;
+	uls_type_tool(outparam) parms;
+
+	if (wline == NULL || wlen < 0) {
+		_uls_log(err_log)("%s: fail to set utf16 string", __func__);
+		return -1;
+	}
+
+	if (wlen == 0) {
+		line = NULL;
+		len = 0;
+	} else if ((line = _uls_tool_(enc_utf16str_to_utf8str)((uls_uint16 *) wline, wlen, uls_ptr(parms))) == NULL) {
+		_uls_log(err_log)("%s: fail to set utf16 string", __func__);
+		return -1;
+	} else {
+		len = parms.len;
+	}
+
+	// The offsets of the tokens in the line, indexed, are mapped to those in 'wline'.
+	uls->flags |= ULS_FL_LINEIDX;
+	rc = uls_push_line(uls, line, len, line != NULL ? ULS_MEMFREE_LINE : 0);
+	if (!lineidx) uls->flags &= ~ULS_FL_LINEIDX;
+
+	ctx = uls->xcontext.context;
+	ctx->wsrc = wline;
+	ctx->l_wsrc = wlen;
+	ctx->wsrc_off8 = ctx->wsrc_off16 = 0;
+
+	return rc;
+}
+
 void
 ULS_QUALIFIED_METHOD(uls_push_utf32_line)(uls_lex_ptr_t uls, uls_uint32* wline, int wlen)
 {
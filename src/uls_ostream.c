@@ -226,6 +226,10 @@ ULS_QUALIFIED_METHOD(__destroy_ostream)(uls_ostream_ptr_t ostr)
 {
 	ostr->ref_cnt = 0;
 	ostr->fd = -1;
+	if (ostr->zsrc != nilptr) {
+		_uls_tool_(zsrc_close)(ostr->zsrc);
+		ostr->zsrc = nilptr;
+	}
 	__deinit_ostream(ostr);
 	uls_dealloc_object(ostr);
 }
@@ -320,7 +324,7 @@ ULS_QUALIFIED_METHOD(fill_uls_redundant_lines)(char *buff, int buflen, int len1,
 
 ULS_DECL_STATIC int
 ULS_QUALIFIED_METHOD(write_uld_to_ostream)(uls_xcontext_ptr_t xctx,
-	uls_ptrtype_tool(outparam) parms, int fd_out)
+	uls_ptrtype_tool(outparam) parms, uls_ostream_ptr_t ostr)
 {
 	char *remap_buf = parms->line;
 	int k, len, len1;
@@ -342,12 +346,17 @@ ULS_QUALIFIED_METHOD(write_uld_to_ostream)(uls_xcontext_ptr_t xctx,
 	remap_buf[len1] = remap_buf[len1 + 1] = '%';
 	remap_buf[len1 + 2] = '\n';
 
+	if (ostr->zsrc != nilptr) {
+		// written after the header by the caller
+		return 0;
+	}
+
 	fpos = ULS_BIN_BLKSIZ;
-	if (uls_fd_seek(fd_out, fpos, SEEK_SET) != fpos) {
+	if (uls_fd_seek(ostr->fd, fpos, SEEK_SET) != fpos) {
 		return -2;
 	}
 
-	if (_uls_tool_(writen)(fd_out, remap_buf, len) < len) {
+	if (_uls_tool_(writen)(ostr->fd, remap_buf, len) < len) {
 		stat = -3;
 	}
 
@@ -475,9 +484,9 @@ ULS_QUALIFIED_METHOD(write_ostream_header)(uls_ostream_ptr_t ostr, uls_xcontext_
 		parms1.line = remap_buff;
 		parms1.n1 = remap_size >> ULS_BIN_BLKSIZ_LOG2;
 
-		rc = write_uld_to_ostream(xctx, uls_ptr(parms1), ostr->fd);
-		uls_mfree(remap_buff);
+		rc = write_uld_to_ostream(xctx, uls_ptr(parms1), ostr);
 		if (rc < 0) {
+			uls_mfree(remap_buff);
 			return -1;
 		}
 
@@ -485,13 +494,31 @@ ULS_QUALIFIED_METHOD(write_ostream_header)(uls_ostream_ptr_t ostr, uls_xcontext_
 		len = _uls_log_(snprintf)(linebuff, sizeof(linebuff), "TOKEN_REMAP: %d %d",
 			xctx->uldfile_nlines, n_blocks);
 		if ((k = writeline_istr_hdr(ulshdr, ULS_BIN_HDR_SZ, k, linebuff, len)) < 0) {
+			uls_mfree(remap_buff);
 			return -1;
 		}
 
 	} else {
+		remap_buff = NULL;
 		n_blocks = 0;
 	}
 
+	if (ostr->zsrc != nilptr) {
+		// No seek in the compressed, the header and the remap blocks go in order.
+		rc = 0;
+		if (do_end_of_uls_hdr(ulshdr, k) < 0 ||
+			__ostr_writen(ostr, ulshdr, ULS_BIN_HDR_SZ) < 0) {
+			rc = -2;
+		} else if (n_blocks > 0 &&
+			__ostr_writen(ostr, remap_buff, n_blocks << ULS_BIN_BLKSIZ_LOG2) < 0) {
+			rc = -3;
+		}
+
+		uls_mfree(remap_buff);
+		return rc;
+	}
+
+	uls_mfree(remap_buff);
 	if (save_istr_hdrbuf(ulshdr, k, ostr->fd) < 0) {
 		return -2;
 	}
@@ -524,12 +551,27 @@ ULS_QUALIFIED_METHOD(__uls_unbind_ostream)(uls_ostream_ptr_t ostr)
 }
 
 ULS_DECL_STATIC int
-ULS_QUALIFIED_METHOD(__flush_uls_stream_buffer)(_uls_ptrtype_tool(csz_str) outbuf, int fd, int force)
+ULS_QUALIFIED_METHOD(__ostr_writen)(uls_ostream_ptr_t ostr, char *buf, int n)
+{
+	if (ostr->zsrc != nilptr) {
+		return _uls_tool_(zsrc_writen)(ostr->zsrc, buf, n);
+	}
+
+	return _uls_tool_(writen)(ostr->fd, buf, n);
+}
+
+ULS_DECL_STATIC int
+ULS_QUALIFIED_METHOD(__flush_uls_stream_buffer)(uls_ostream_ptr_t ostr, _uls_ptrtype_tool(csz_str) outbuf, int force)
 {
 	int k;
 
+	// A segment keeps all its packets until appended to a stream.
+	if (ostr->flags & ULS_STREAM_SEGMENT) {
+		return 0;
+	}
+
 	if ((k=csz_length(outbuf)) > 1024 || force) {
-		if (_uls_tool_(writen)(fd, csz_data_ptr(outbuf), k) < k) {
+		if (__ostr_writen(ostr, csz_data_ptr(outbuf), k) < k) {
 			_uls_log(err_log)("I/O error");
 			return -1;
 		}
@@ -555,7 +597,7 @@ ULS_QUALIFIED_METHOD(__uls_finalize_ostream)(uls_ostream_ptr_t ostr)
 		ostr->make_packet_token(uls_ptr(ostr->pktbuf), outbuf);
 	}
 
-	if (__flush_uls_stream_buffer(outbuf, ostr->fd, 1) < 0) {
+	if (__flush_uls_stream_buffer(ostr, outbuf, 1) < 0) {
 		_uls_log(err_log)("I/O error");
 		return -1;
 	}
@@ -642,9 +684,9 @@ ULS_QUALIFIED_METHOD(uls_print_tok_eoi)(uls_ostream_ptr_t ostr)
 	return __uls_print_tok(ostr, uls_toknum_eoi(uls), "", 0);
 }
 
-ULS_QUALIFIED_RETTYP(uls_ostream_ptr_t)
-ULS_QUALIFIED_METHOD(__uls_create_ostream)
-	(int fd_out, uls_lex_ptr_t uls, int stream_type, const char *subname)
+ULS_DECL_STATIC ULS_QUALIFIED_RETTYP(uls_ostream_ptr_t)
+ULS_QUALIFIED_METHOD(__uls_create_ostream_2)
+	(int fd_out, uls_lex_ptr_t uls, int stream_type, const char *subname, int zformat)
 {
 	uls_ostream_ptr_t ostr;
 	int  rc;
@@ -659,6 +701,12 @@ ULS_QUALIFIED_METHOD(__uls_create_ostream)
 		return nilptr;
 	}
 
+	if (zformat != ULS_ZSRC_NONE &&
+		(ostr->zsrc = _uls_tool_(zsrc_create)(fd_out, zformat)) == nilptr) {
+		__destroy_ostream(ostr);
+		return nilptr;
+	}
+
 	__bind_ostream_callbacks(ostr, stream_type);
 
 	if (stream_type == ULS_STREAM_BIN_LE) { // LITTLE-ENDIAN
@@ -689,7 +737,14 @@ ULS_QUALIFIED_METHOD(__uls_create_ostream)
 }
 
 ULS_QUALIFIED_RETTYP(uls_ostream_ptr_t)
-ULS_QUALIFIED_METHOD(uls_create_ostream)(int fd_out, uls_lex_ptr_t uls, const char *subname)
+ULS_QUALIFIED_METHOD(__uls_create_ostream)
+	(int fd_out, uls_lex_ptr_t uls, int stream_type, const char *subname)
+{
+	return __uls_create_ostream_2(fd_out, uls, stream_type, subname, ULS_ZSRC_NONE);
+}
+
+ULS_QUALIFIED_RETTYP(uls_ostream_ptr_t)
+ULS_QUALIFIED_METHOD(uls_create_ostream_2)(int fd_out, uls_lex_ptr_t uls, const char *subname, int zformat)
 {
 	int stream_type;
 
@@ -699,7 +754,13 @@ ULS_QUALIFIED_METHOD(uls_create_ostream)(int fd_out, uls_lex_ptr_t uls, const ch
 		stream_type = ULS_STREAM_BIN_LE;
 	}
 
-	return __uls_create_ostream(fd_out, uls, stream_type, subname);
+	return __uls_create_ostream_2(fd_out, uls, stream_type, subname, zformat);
+}
+
+ULS_QUALIFIED_RETTYP(uls_ostream_ptr_t)
+ULS_QUALIFIED_METHOD(uls_create_ostream)(int fd_out, uls_lex_ptr_t uls, const char *subname)
+{
+	return uls_create_ostream_2(fd_out, uls, subname, ULS_ZSRC_NONE);
 }
 
 ULS_QUALIFIED_RETTYP(uls_ostream_ptr_t)
@@ -713,7 +774,8 @@ ULS_QUALIFIED_METHOD(uls_create_ostream_file)(const char *filepath, uls_lex_ptr_
 		return nilptr;
 	}
 
-	if ((ostr = uls_create_ostream(fd, uls, subname)) == nilptr) {
+	// The file named '*.gz' is written compressed.
+	if ((ostr = uls_create_ostream_2(fd, uls, subname, _uls_tool_(zsrc_format_of_path)(filepath))) == nilptr) {
 		_uls_log(err_log)("fail to create out-stream for '%s'.", filepath);
 		_uls_tool_(fd_close)(fd);
 		return nilptr;
@@ -723,6 +785,64 @@ ULS_QUALIFIED_METHOD(uls_create_ostream_file)(const char *filepath, uls_lex_ptr_
 	return ostr;
 }
 
+/*
+ * A segment is an out-stream of the same type as 'ostr' without header and fd.
+ * The packets printed to it are kept in memory till uls_append_ostream_seg().
+ * It may be bound to another lexer of the same spec, to be filled in another thread.
+ */
+ULS_QUALIFIED_RETTYP(uls_ostream_ptr_t)
+ULS_QUALIFIED_METHOD(uls_create_ostream_seg)(uls_ostream_ptr_t ostr, uls_lex_ptr_t uls)
+{
+	uls_ostream_ptr_t seg;
+
+	if (ostr == nilptr || uls == nilptr) {
+		_uls_log(err_log)("%s: invalid parameter!", __func__);
+		return nilptr;
+	}
+
+	seg = uls_alloc_object_clear(uls_ostream_t);
+	__init_ostream(seg);
+
+	seg->flags |= ULS_STREAM_SEGMENT;
+	_uls_tool_(version_make)(uls_ptr(seg->header.filever),
+		ULS_VERSION_STREAM_MAJOR, ULS_VERSION_STREAM_MINOR,
+		ULS_VERSION_STREAM_DEBUG);
+	seg->header.filetype = ostr->header.filetype;
+	seg->header.subtype = ostr->header.subtype;
+	__bind_ostream_callbacks(seg, seg->header.subtype);
+
+	seg->ref_cnt = 1;
+	__uls_bind_ostream(seg, uls);
+
+	return seg;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_append_ostream_seg)(uls_ostream_ptr_t ostr, uls_ostream_ptr_t seg)
+{
+	_uls_ptrtype_tool(csz_str) outbuf;
+	int k;
+
+	if (ostr == nilptr || seg == nilptr || (seg->flags & ULS_STREAM_SEGMENT) == 0 ||
+		seg->header.subtype != ostr->header.subtype) {
+		_uls_log(err_log)("%s: invalid parameter!", __func__);
+		return -1;
+	}
+
+	if (__flush_uls_stream_buffer(ostr, uls_ptr(ostr->out_fd_csz), 1) < 0) {
+		return -1;
+	}
+
+	outbuf = uls_ptr(seg->out_fd_csz);
+	if ((k = csz_length(outbuf)) > 0 && __ostr_writen(ostr, csz_data_ptr(outbuf), k) < k) {
+		_uls_log(err_log)("I/O error");
+		return -1;
+	}
+
+	_uls_tool(csz_reset)(outbuf);
+	return k;
+}
+
 int
 ULS_QUALIFIED_METHOD(uls_destroy_ostream)(uls_ostream_ptr_t ostr)
 {
@@ -733,12 +853,21 @@ ULS_QUALIFIED_METHOD(uls_destroy_ostream)(uls_ostream_ptr_t ostr)
 
 	if (--ostr->ref_cnt > 0) return ostr->ref_cnt;
 
-	if (uls_print_tok_eof(ostr) < 0 || uls_print_tok_eoi(ostr) < 0) {
-		return -1;
+	// The packets of a segment not appended anywhere are just dropped.
+	if ((ostr->flags & ULS_STREAM_SEGMENT) == 0) {
+		if (uls_print_tok_eof(ostr) < 0 || uls_print_tok_eoi(ostr) < 0) {
+			return -1;
+		}
+
+		if ((ostr->flags & ULS_STREAM_ERR) == 0)
+			__uls_finalize_ostream(ostr);
 	}
 
-	if ((ostr->flags & ULS_STREAM_ERR) == 0)
-		__uls_finalize_ostream(ostr);
+	if (ostr->zsrc != nilptr) {
+		if (_uls_tool_(zsrc_close)(ostr->zsrc) < 0)
+			_uls_log(err_log)("%s: fail to finish the compressed output.", __func__);
+		ostr->zsrc = nilptr;
+	}
 
 	if (ostr->flags & ULS_STREAM_FDCLOSE) {
 		_uls_tool_(fd_close)(ostr->fd);
@@ -763,7 +892,7 @@ ULS_QUALIFIED_METHOD(__uls_print_tok)(uls_ostream_ptr_t ostr, int tokid, const c
 		return -1;
 	}
 
-	if (__flush_uls_stream_buffer(uls_ptr(ostr->out_fd_csz), ostr->fd, 0) < 0) {
+	if (__flush_uls_stream_buffer(ostr, uls_ptr(ostr->out_fd_csz), 0) < 0) {
 		return -1;
 	}
 
@@ -779,7 +908,7 @@ ULS_QUALIFIED_METHOD(__uls_print_tok_linenum)(uls_ostream_ptr_t ostr, int lno, c
 		return -1;
 	}
 
-	if (__flush_uls_stream_buffer(uls_ptr(ostr->out_fd_csz), ostr->fd, 0) < 0) {
+	if (__flush_uls_stream_buffer(ostr, uls_ptr(ostr->out_fd_csz), 0) < 0) {
 		return -1;
 	}
 
@@ -853,7 +982,7 @@ ULS_QUALIFIED_METHOD(uls_start_stream)(uls_ostream_ptr_t ostr, int flags)
 {
 	_uls_ptrtype_tool(csz_str) outbuf;
 	_uls_type_tool(csz_str) tag_buf;
-	int  lno=-1, tok_id, stat=0, fd, numbering;
+	int  lno=-1, tok_id, stat=0, numbering;
 	uls_lex_ptr_t uls;
 
 	numbering = flags & ULS_LINE_NUMBERING;
@@ -862,7 +991,6 @@ ULS_QUALIFIED_METHOD(uls_start_stream)(uls_ostream_ptr_t ostr, int flags)
 		return -1;
 	}
 
-	fd = ostr->fd;
 	outbuf = uls_ptr(ostr->out_fd_csz);
 	_uls_tool(csz_reset)(outbuf);
 
@@ -880,7 +1008,7 @@ ULS_QUALIFIED_METHOD(uls_start_stream)(uls_ostream_ptr_t ostr, int flags)
 			stat = -2;
 			break;
 		} else if (tok_id == uls->xcontext.toknum_EOI) {
-			if (__flush_uls_stream_buffer(outbuf, fd, 1) < 0) {
+			if (__flush_uls_stream_buffer(ostr, outbuf, 1) < 0) {
 				stat = -1;
 			}
 			uls_pop(uls);
@@ -902,7 +1030,7 @@ ULS_QUALIFIED_METHOD(uls_start_stream)(uls_ostream_ptr_t ostr, int flags)
 		}
 
 		__uls_make_packet(ostr, __uls_tok(uls), __uls_lexeme(uls), __uls_lexeme_len(uls));
-		if (__flush_uls_stream_buffer(outbuf, fd, 0) < 0) {
+		if (__flush_uls_stream_buffer(ostr, outbuf, 0) < 0) {
 			stat = -1;
 			break;
 		}
@@ -0,0 +1,523 @@
+/*
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * uls_plex.c -- lexing a large text in parallel by speculative chunks --
+ *     written by Stanley Hong <link2next@gmail.com>, October 2026.
+ *
+ *  This file is part of ULS, Unified Lexical Scheme.
+ */
+#ifndef ULS_EXCLUDE_HFILES
+#define __ULS_PLEX__
+#include "uls/uls_plex.h"
+#include "uls/uls_fileio.h"
+#include "uls/uls_misc.h"
+#include "uls/uls_log.h"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifndef __ULS_WINDOWS__
+#include <sys/mman.h>
+#endif
+#endif
+
+ULS_DECL_STATIC void
+ULS_QUALIFIED_METHOD(__plex_init_chunk)(uls_plex_ptr_t plx, uls_plex_chunk_ptr_t chk, uls_lex_ptr_t uls)
+{
+	uls_initial_zerofy_object(chk);
+	chk->plx = plx;
+	chk->uls = uls;
+	_uls_tool(csz_init)(uls_ptr(chk->lxm_pool), 4096);
+}
+
+ULS_DECL_STATIC void
+ULS_QUALIFIED_METHOD(__plex_deinit_chunk)(uls_plex_chunk_ptr_t chk)
+{
+	uls_mfree(chk->toks);
+	uls_mfree(chk->lines);
+	chk->n_toks = chk->n_alloc_toks = 0;
+	chk->n_lines = chk->n_alloc_lines = 0;
+	_uls_tool(csz_deinit)(uls_ptr(chk->lxm_pool));
+}
+
+ULS_DECL_STATIC void
+ULS_QUALIFIED_METHOD(__plex_add_line)(uls_plex_chunk_ptr_t chk, int offset, int safe)
+{
+	uls_plex_line_ptr_t line;
+
+	if (chk->n_lines >= chk->n_alloc_lines) {
+		chk->n_alloc_lines = chk->n_alloc_lines > 0 ? 2 * chk->n_alloc_lines : 1024;
+		chk->lines = (uls_plex_line_ptr_t) uls_mrealloc(chk->lines,
+			chk->n_alloc_lines * sizeof(uls_plex_line_t));
+	}
+
+	line = chk->lines + chk->n_lines++;
+	line->offset = offset;
+	line->i_tok = chk->n_toks;
+	line->safe = safe;
+}
+
+ULS_DECL_STATIC void
+ULS_QUALIFIED_METHOD(__plex_add_tok)(uls_plex_chunk_ptr_t chk, int tok_id, int lineno, const char *lxm, int lxm_len)
+{
+	uls_plex_tok_ptr_t tok;
+
+	if (chk->n_toks >= chk->n_alloc_toks) {
+		chk->n_alloc_toks = chk->n_alloc_toks > 0 ? 2 * chk->n_alloc_toks : 4096;
+		chk->toks = (uls_plex_tok_ptr_t) uls_mrealloc(chk->toks,
+			chk->n_alloc_toks * sizeof(uls_plex_tok_t));
+	}
+
+	tok = chk->toks + chk->n_toks++;
+	tok->tok_id = tok_id;
+	tok->lineno = lineno;
+	tok->i_pool = 0;
+	tok->lxm_offset = csz_length(uls_ptr(chk->lxm_pool));
+	tok->lxm_len = lxm_len;
+
+	_uls_tool(csz_append)(uls_ptr(chk->lxm_pool), lxm, lxm_len);
+	_uls_tool(csz_add_eos)(uls_ptr(chk->lxm_pool));
+}
+
+ULS_DECL_STATIC const char*
+ULS_QUALIFIED_METHOD(__plex_next_line)(const char *lptr, const char *lptr_end)
+{
+	for ( ; lptr < lptr_end; lptr++) {
+		if (*lptr == '\n') return lptr + 1;
+	}
+
+	return NULL;
+}
+
+ULS_DECL_STATIC int
+ULS_QUALIFIED_METHOD(__plex_find_line)(uls_plex_chunk_ptr_t chk, int offset)
+{
+	int low = 0, high = chk->stop_line - 1, mid;
+
+	// the line at 'offset' before the stop-line, -1 if none
+	while (low <= high) {
+		mid = (low + high) / 2;
+		if (chk->lines[mid].offset == offset) return mid;
+		if (chk->lines[mid].offset < offset) low = mid + 1;
+		else high = mid - 1;
+	}
+
+	return -1;
+}
+
+ULS_DECL_STATIC int
+ULS_QUALIFIED_METHOD(__plex_can_join)(uls_plex_ptr_t plx, int offset)
+{
+	uls_plex_chunk_ptr_t chk;
+	int k, j;
+
+	// Has the chunk covering 'offset' started at it outside comments and quote-strings too?
+	for (k = plx->n_active_chunks - 1; k > 0; k--) {
+		if (plx->chunks[k].offset <= offset) break;
+	}
+	chk = plx->chunks + k;
+
+	if ((j = __plex_find_line(chk, offset)) < 0) return 0;
+	return chk->lines[j].safe;
+}
+
+ULS_DECL_STATIC void
+ULS_QUALIFIED_METHOD(__plex_run)(uls_plex_ptr_t plx, uls_plex_chunk_ptr_t chk, int offset)
+{
+	uls_lex_ptr_t uls = chk->uls;
+	uls_xcontext_ptr_t xctx = uls_ptr(uls->xcontext);
+	const char *lptr, *lptr1, *lptr_end = plx->text + plx->text_len;
+	uls_linespan_ptr_t span;
+	int tok_id, lno = 0, j, j0, off_j, safe, i_span = 0, stopped = 0;
+
+	chk->n_toks = chk->n_lines = 0;
+	chk->stop_line = chk->err = 0;
+	__plex_add_line(chk, offset, 1);
+
+	// If the initial filling fails, uls_get_tok() gives the ERR-token as the sequential lexing does.
+	uls_xcontext_rec_linespans(xctx, 1);
+	uls_push_line(uls, plx->text + offset, plx->text_len - offset, 0);
+
+	lptr = plx->text + offset;
+	j = 0; // the last line in 'lines'
+
+	while (!stopped) {
+		tok_id = uls_get_tok(uls);
+		if (tok_id == xctx->toknum_EOI) break;
+
+		if (tok_id == xctx->toknum_ERR) {
+			chk->err = 1;
+			break;
+		}
+
+		lno = __uls_get_lineno(uls) - 1;
+
+		while (j < lno && (lptr1 = __plex_next_line(lptr, lptr_end)) != NULL) {
+			lptr = lptr1;
+			off_j = (int) (lptr - plx->text);
+			++j;
+
+			// The spans are in the order of lines, so is 'j'.
+			for ( ; i_span < xctx->n_linespans; i_span++) {
+				span = xctx->linespans + i_span;
+				if (span->lineno - 1 + span->n_lfs >= j) break;
+			}
+
+			safe = 1;
+			if (i_span < xctx->n_linespans) {
+				span = xctx->linespans + i_span;
+				j0 = span->lineno - 1;
+				if (j0 < j && j <= j0 + span->n_lfs) safe = 0;
+			}
+
+			__plex_add_line(chk, off_j, safe);
+
+			if (safe && (chk == uls_ptr(plx->fix) ? __plex_can_join(plx, off_j) : off_j >= chk->end)) {
+				stopped = 1;
+				break;
+			}
+		}
+
+		if (!stopped) {
+			__plex_add_tok(chk, tok_id, lno, __uls_lexeme(uls), __uls_lexeme_len(uls));
+		}
+	}
+
+	if (chk->err) {
+		if (chk == uls_ptr(plx->fix)) {
+			// the error is real as the run started from a safe line
+			__plex_add_tok(chk, tok_id, lno, __uls_lexeme(uls), __uls_lexeme_len(uls));
+		}
+		for (chk->stop_line = j; chk->stop_line > 0; chk->stop_line--) {
+			if (chk->lines[chk->stop_line].safe) break;
+		}
+
+	} else if (stopped) {
+		chk->stop_line = j;
+
+	} else {
+		// EOI, the lines without tokens are left to the end.
+		if (chk->lines[j].offset < plx->text_len) {
+			__plex_add_line(chk, plx->text_len, 1);
+			++j;
+		}
+		chk->stop_line = j;
+	}
+
+	uls_pop(uls);
+	uls_xcontext_rec_linespans(xctx, 0);
+}
+
+ULS_DECL_STATIC void*
+ULS_QUALIFIED_METHOD(__plex_run_chunk)(void *arg)
+{
+	uls_plex_chunk_ptr_t chk = (uls_plex_chunk_ptr_t) arg;
+
+	_uls_tool(csz_reset)(uls_ptr(chk->lxm_pool));
+	__plex_run(chk->plx, chk, chk->offset);
+
+	return NULL;
+}
+
+ULS_DECL_STATIC void
+ULS_QUALIFIED_METHOD(__plex_run_chunks)(uls_plex_ptr_t plx)
+{
+#ifdef HAVE_PTHREAD
+	pthread_t tids[ULS_PLEX_MAX_CHUNKS];
+	int started[ULS_PLEX_MAX_CHUNKS];
+	int k;
+
+	// Each chunk has its own lexer, so the threads share nothing but the text.
+	for (k = 1; k < plx->n_active_chunks; k++) {
+		started[k] = pthread_create(tids + k, NULL, __plex_run_chunk, plx->chunks + k) == 0;
+	}
+
+	__plex_run_chunk(plx->chunks);
+
+	for (k = 1; k < plx->n_active_chunks; k++) {
+		if (started[k]) pthread_join(tids[k], NULL);
+		else __plex_run_chunk(plx->chunks + k);
+	}
+#else
+	int k;
+
+	for (k = 0; k < plx->n_active_chunks; k++) {
+		__plex_run_chunk(plx->chunks + k);
+	}
+#endif
+}
+
+ULS_DECL_STATIC void
+ULS_QUALIFIED_METHOD(__plex_append)(uls_plex_ptr_t plx, uls_plex_chunk_ptr_t chk, int i_pool, int j, int i_end, int lineno)
+{
+	uls_plex_tok_ptr_t tok;
+	int i;
+
+	if (plx->n_toks + i_end - chk->lines[j].i_tok > plx->n_alloc_toks) {
+		plx->n_alloc_toks = uls_roundup(plx->n_toks + i_end - chk->lines[j].i_tok, 4096);
+		plx->toks = (uls_plex_tok_ptr_t) uls_mrealloc(plx->toks,
+			plx->n_alloc_toks * sizeof(uls_plex_tok_t));
+	}
+
+	// The line-numbers of the chunk are the indices of 'lines'.
+	for (i = chk->lines[j].i_tok; i < i_end; i++) {
+		tok = plx->toks + plx->n_toks++;
+		*tok = chk->toks[i];
+		tok->lineno = lineno + tok->lineno - j;
+		tok->i_pool = i_pool;
+	}
+}
+
+ULS_DECL_STATIC int
+ULS_QUALIFIED_METHOD(__plex_stitch)(uls_plex_ptr_t plx)
+{
+	uls_plex_chunk_ptr_t chk, fix = uls_ptr(plx->fix);
+	int offset = 0, lineno = 1, k = 0, j;
+
+	plx->n_toks = plx->n_fixes = 0;
+	_uls_tool(csz_reset)(uls_ptr(fix->lxm_pool));
+
+	// 'offset' is always at a line which the sequential lexing would start outside comments and quote-strings.
+	while (offset < plx->text_len) {
+		while (k + 1 < plx->n_active_chunks && plx->chunks[k + 1].offset <= offset) {
+			++k;
+		}
+		chk = plx->chunks + k;
+
+		if ((j = __plex_find_line(chk, offset)) >= 0 && chk->lines[j].safe) {
+			// The guess of the chunk is right from 'offset' to its stop-line.
+			__plex_append(plx, chk, k, j, chk->lines[chk->stop_line].i_tok, lineno);
+			lineno += chk->stop_line - j;
+			offset = chk->lines[chk->stop_line].offset;
+			continue;
+		}
+
+		// Re-lex from 'offset' till the streams of the chunks can be joined again.
+		__plex_run(plx, fix, offset);
+		++plx->n_fixes;
+
+		if (fix->err) {
+			__plex_append(plx, fix, plx->n_chunks, 0, fix->n_toks, lineno);
+			return -1;
+		}
+
+		__plex_append(plx, fix, plx->n_chunks, 0, fix->lines[fix->stop_line].i_tok, lineno);
+		lineno += fix->stop_line;
+		offset = fix->lines[fix->stop_line].offset;
+	}
+
+	return 0;
+}
+
+ULS_QUALIFIED_RETTYP(uls_plex_ptr_t)
+ULS_QUALIFIED_METHOD(uls_create_plex)(const char *confname, int n_chunks)
+{
+	uls_plex_ptr_t plx;
+	uls_lex_ptr_t uls;
+	int k;
+
+	if (n_chunks <= 0) n_chunks = 1;
+	else if (n_chunks > ULS_PLEX_MAX_CHUNKS) n_chunks = ULS_PLEX_MAX_CHUNKS;
+
+	plx = uls_alloc_object(uls_plex_t);
+	uls_initial_zerofy_object(plx);
+
+	plx->text = "";
+	plx->chunks = (uls_plex_chunk_ptr_t) uls_malloc(n_chunks * sizeof(uls_plex_chunk_t));
+
+	for (k = 0; k < n_chunks; k++) {
+		// The chunks lex with the same tables.
+		if ((uls = uls_create_shared(confname)) == nilptr) {
+			_uls_log(err_log)("%s: can't create the lexer for '%s'", __func__, confname);
+			uls_destroy_plex(plx);
+			return nilptr;
+		}
+		__plex_init_chunk(plx, plx->chunks + k, uls);
+		++plx->n_chunks;
+	}
+
+	// The chunks are done when 'fix' runs.
+	__plex_init_chunk(plx, uls_ptr(plx->fix), plx->chunks[0].uls);
+
+	return plx;
+}
+
+void
+ULS_QUALIFIED_METHOD(uls_destroy_plex)(uls_plex_ptr_t plx)
+{
+	int k;
+
+	if (plx == nilptr) return;
+
+	if (plx->fix.uls != nilptr) {
+		__plex_deinit_chunk(uls_ptr(plx->fix));
+	}
+
+	for (k = 0; k < plx->n_chunks; k++) {
+		uls_destroy(plx->chunks[k].uls);
+		__plex_deinit_chunk(plx->chunks + k);
+	}
+
+	uls_mfree(plx->chunks);
+	uls_mfree(plx->toks);
+	uls_dealloc_object(plx);
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_plex_lex_text)(uls_plex_ptr_t plx, const char *text, int len)
+{
+	uls_plex_chunk_ptr_t chk;
+	const char *lptr;
+	int k, offset, target;
+
+	if (text == NULL) {
+		text = "";
+		len = 0;
+	} else if (len < 0) {
+		len = _uls_tool_(strlen)(text);
+	}
+
+	plx->text = text;
+	plx->text_len = len;
+
+	// Split the text at the line-feeds nearest to the even points.
+	for (offset = k = 0; k < plx->n_chunks && offset < len; k++) {
+		chk = plx->chunks + k;
+		chk->offset = offset;
+
+		target = (k + 1 < plx->n_chunks) ? len / plx->n_chunks * (k + 1) : len;
+		if (target <= offset) target = offset + 1;
+
+		lptr = __plex_next_line(text + target - 1, text + len);
+		chk->end = offset = (lptr != NULL) ? (int) (lptr - text) : len;
+	}
+	plx->n_active_chunks = k;
+
+	__plex_run_chunks(plx);
+
+	if (__plex_stitch(plx) < 0) {
+		return -1;
+	}
+
+	return plx->n_toks;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_plex_lex_file)(uls_plex_ptr_t plx, const char *filepath)
+{
+	struct stat statbuff;
+	char *text = NULL;
+	int len, rc, mapped = 0;
+	FILE *fp;
+
+	if ((fp = uls_fp_open(filepath, ULS_FIO_READ)) == NULL) {
+		_uls_log(err_log)("%s: can't open '%s'", __func__, filepath);
+		return -1;
+	}
+
+	if (fstat(fileno(fp), uls_ptr(statbuff)) < 0) {
+		_uls_log(err_log)("%s: can't get the size of '%s'", __func__, filepath);
+		uls_fp_close(fp);
+		return -1;
+	}
+
+	// The offsets of the tokens and lines are int, so is the text lexed at once.
+	if (statbuff.st_size < 0 || statbuff.st_size > ULS_INT_MAX) {
+		_uls_log(err_log)("%s: '%s' is larger than %d bytes", __func__, filepath, ULS_INT_MAX);
+		uls_fp_close(fp);
+		return -1;
+	}
+
+	if ((len = (int) statbuff.st_size) == 0) {
+		uls_fp_close(fp);
+		return uls_plex_lex_text(plx, "", 0);
+	}
+
+#ifndef __ULS_WINDOWS__
+	// The chunks are read straight from the page-cache.
+	text = (char *) mmap(NULL, (size_t) len, PROT_READ, MAP_PRIVATE, fileno(fp), 0);
+	if (text == (char *) MAP_FAILED) text = NULL;
+	else mapped = 1;
+#endif
+
+	if (text == NULL) {
+		text = (char *) uls_malloc(len);
+		if ((int) fread(text, 1, len, fp) != len) {
+			_uls_log(err_log)("%s: can't read '%s'", __func__, filepath);
+			uls_fp_close(fp);
+			uls_mfree(text);
+			return -1;
+		}
+	}
+
+	uls_fp_close(fp);
+
+	// The lexemes are copied into the pools of the chunks, so the text is not needed after this.
+	rc = uls_plex_lex_text(plx, text, len);
+	plx->text = "";
+	plx->text_len = 0;
+
+#ifndef __ULS_WINDOWS__
+	if (mapped) {
+		munmap(text, len);
+		text = NULL;
+	}
+#endif
+	uls_mfree(text);
+
+	return rc;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_plex_num_tokens)(uls_plex_ptr_t plx)
+{
+	return plx->n_toks;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_plex_num_fixes)(uls_plex_ptr_t plx)
+{
+	return plx->n_fixes;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_plex_get_tok)(uls_plex_ptr_t plx, int i, uls_ptrtype_tool(outparam) parms)
+{
+	uls_plex_tok_ptr_t tok;
+	_uls_ptrtype_tool(csz_str) pool;
+
+	if (i < 0 || i >= plx->n_toks) {
+		return plx->chunks[0].uls->xcontext.toknum_NONE;
+	}
+
+	tok = plx->toks + i;
+	if (parms != nilptr) {
+		pool = (tok->i_pool < plx->n_chunks) ?
+			uls_ptr(plx->chunks[tok->i_pool].lxm_pool) : uls_ptr(plx->fix.lxm_pool);
+		parms->lptr = csz_data_ptr(pool) + tok->lxm_offset;
+		parms->len = tok->lxm_len;
+		parms->n = tok->lineno;
+	}
+
+	return tok->tok_id;
+}
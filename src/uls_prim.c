@@ -1446,6 +1446,13 @@ ULS_QUALIFIED_METHOD(uls_memmove)(void *dst, const void* src, int n)
 	return ptr;
 }
 
+const char*
+ULS_QUALIFIED_METHOD(uls_memchr)(const char *str, char ch, int n)
+{
+	if (n <= 0) return NULL;
+	return (const char *) memchr(str, ch, n);
+}
+
 int
 ULS_QUALIFIED_METHOD(uls_strlen)(const char *str)
 {
@@ -0,0 +1,441 @@
+/*
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * uls_relex.c -- re-lexing the edited text incrementally --
+ *     written by Stanley Hong <link2next@gmail.com>, October 2026.
+ *
+ *  This file is part of ULS, Unified Lexical Scheme.
+ */
+#ifndef ULS_EXCLUDE_HFILES
+#define __ULS_RELEX__
+#include "uls/uls_relex.h"
+#include "uls/uls_misc.h"
+#include "uls/uls_log.h"
+#endif
+
+ULS_DECL_STATIC uls_voidptr_t
+ULS_QUALIFIED_METHOD(__relex_grow)(uls_voidptr_t ary, int *ptr_n_alloc, int n, int elem_size)
+{
+	int n_alloc = *ptr_n_alloc;
+
+	if (n > n_alloc) {
+		n_alloc = n_alloc > 0 ? 2 * n_alloc : 256;
+		if (n_alloc < n) n_alloc = n;
+		ary = uls_mrealloc(ary, n_alloc * elem_size);
+		*ptr_n_alloc = n_alloc;
+	}
+
+	return ary;
+}
+
+ULS_DECL_STATIC const char*
+ULS_QUALIFIED_METHOD(__relex_next_line)(const char *lptr, const char *lptr_end)
+{
+	for ( ; lptr < lptr_end; lptr++) {
+		if (*lptr == '\n') return lptr + 1;
+	}
+
+	return NULL;
+}
+
+ULS_DECL_STATIC void
+ULS_QUALIFIED_METHOD(__relex_add_line)(uls_relex_ptr_t rlx, int offset)
+{
+	uls_relex_ckpt_ptr_t ckpt;
+
+	rlx->new_ckpts = (uls_relex_ckpt_ptr_t) __relex_grow(rlx->new_ckpts,
+		&rlx->n_alloc_new_lines, rlx->n_new_lines + 1, sizeof(uls_relex_ckpt_t));
+
+	ckpt = rlx->new_ckpts + rlx->n_new_lines++;
+	ckpt->offset = offset;
+	ckpt->i_tok = rlx->n_new_toks;
+	ckpt->n_lfs_pending = 0;
+	ckpt->qmt = nilptr;
+}
+
+ULS_DECL_STATIC void
+ULS_QUALIFIED_METHOD(__relex_add_tok)(uls_relex_ptr_t rlx, int tok_id, int lineno, const char *lxm, int lxm_len)
+{
+	uls_relex_tok_ptr_t tok;
+
+	rlx->new_toks = (uls_relex_tok_ptr_t) __relex_grow(rlx->new_toks,
+		&rlx->n_alloc_new_toks, rlx->n_new_toks + 1, sizeof(uls_relex_tok_t));
+
+	tok = rlx->new_toks + rlx->n_new_toks++;
+	tok->tok_id = tok_id;
+	tok->lineno = lineno;
+	tok->lxm_offset = csz_length(uls_ptr(rlx->lxm_pool));
+	tok->lxm_len = lxm_len;
+
+	_uls_tool(csz_append)(uls_ptr(rlx->lxm_pool), lxm, lxm_len);
+	_uls_tool(csz_add_eos)(uls_ptr(rlx->lxm_pool));
+}
+
+ULS_DECL_STATIC int
+ULS_QUALIFIED_METHOD(__relex_is_inside_span)(uls_xcontext_ptr_t xctx, int r, int j)
+{
+	uls_linespan_ptr_t span;
+	int i, j0;
+
+	// The line-numbers of the spans are 1-based from the line 'r'.
+	for (i = 0; i < xctx->n_linespans; i++) {
+		span = xctx->linespans + i;
+		j0 = r + span->lineno - 1;
+		if (j0 < j && j <= j0 + span->n_lfs) return 1;
+	}
+
+	return 0;
+}
+
+ULS_DECL_STATIC int
+ULS_QUALIFIED_METHOD(__relex_find_line)(uls_relex_ptr_t rlx, int offset)
+{
+	int low = 0, high = rlx->n_lines - 1, mid;
+
+	// the last line starting at or before 'offset'
+	while (low < high) {
+		mid = (low + high + 1) / 2;
+		if (rlx->ckpts[mid].offset <= offset) low = mid;
+		else high = mid - 1;
+	}
+
+	return low;
+}
+
+ULS_DECL_STATIC int
+ULS_QUALIFIED_METHOD(__relex_can_converge)(uls_relex_ptr_t rlx, int r, int j, int new_offset, int byte_delta)
+{
+	uls_xcontext_ptr_t xctx = uls_ptr(rlx->uls->xcontext);
+	int j_old, old_offset = new_offset - byte_delta;
+
+	if (__relex_is_inside_span(xctx, r, j)) return -1;
+
+	j_old = __relex_find_line(rlx, old_offset);
+	if (rlx->ckpts[j_old].offset != old_offset || rlx->ckpts[j_old].n_lfs_pending > 0) {
+		return -1;
+	}
+
+	return j_old;
+}
+
+ULS_DECL_STATIC int
+ULS_QUALIFIED_METHOD(__relex_run)(uls_relex_ptr_t rlx, int r, int conv_offset, int byte_delta)
+{
+	uls_lex_ptr_t uls = rlx->uls;
+	uls_xcontext_ptr_t xctx = uls_ptr(uls->xcontext);
+	const char *text = rlx->text, *lptr, *lptr1, *lptr_end = text + rlx->text_len;
+	uls_relex_ckpt_ptr_t ckpt;
+	uls_linespan_ptr_t span;
+	int off_r, tok_id, lno, j, j_old = -1, i, k;
+
+	off_r = r > 0 ? rlx->ckpts[r].offset : 0;
+	rlx->n_new_toks = rlx->n_new_lines = 0;
+	__relex_add_line(rlx, off_r);
+
+	uls_xcontext_rec_linespans(xctx, 1);
+	if (uls_push_line(uls, text + off_r, rlx->text_len - off_r, 0) < 0) {
+		// The context is pushed even if its first fill fails, e.g. at an open quote-string.
+		uls_pop(uls);
+		uls_xcontext_rec_linespans(xctx, 0);
+		return -2;
+	}
+
+	lptr = text + off_r;
+	j = r; // the last line in 'new_ckpts'
+
+	for ( ; ; ) {
+		tok_id = uls_get_tok(uls);
+		if (tok_id == xctx->toknum_EOI) break;
+
+		if (tok_id == xctx->toknum_ERR) {
+			j_old = -2;
+			break;
+		}
+
+		lno = r + __uls_get_lineno(uls) - 1;
+
+		while (j < lno && (lptr1 = __relex_next_line(lptr, lptr_end)) != NULL) {
+			lptr = lptr1;
+			++j;
+			// The text after the edit is the same as before, so is the token stream from
+			//   the line both of the old and the new streams start outside comments and quote-strings.
+			if (conv_offset >= 0 && (int) (lptr - text) > conv_offset &&
+				(j_old = __relex_can_converge(rlx, r, j, (int) (lptr - text), byte_delta)) >= 0) {
+				break;
+			}
+			__relex_add_line(rlx, (int) (lptr - text));
+		}
+
+		if (j_old >= 0) break;
+		__relex_add_tok(rlx, tok_id, lno + 1, __uls_lexeme(uls), __uls_lexeme_len(uls));
+	}
+
+	uls_pop(uls);
+
+	if (j_old == -1) {
+		// to the end of the text
+		while ((lptr1 = __relex_next_line(lptr, lptr_end)) != NULL) {
+			lptr = lptr1;
+			__relex_add_line(rlx, (int) (lptr - text));
+		}
+		j_old = rlx->n_lines;
+	}
+
+	for (i = 0; i < xctx->n_linespans; i++) {
+		span = xctx->linespans + i;
+		for (k = 1; k <= span->n_lfs; k++) {
+			j = span->lineno - 1 + k;
+			if (j >= rlx->n_new_lines) break;
+			ckpt = rlx->new_ckpts + j;
+			ckpt->n_lfs_pending = span->n_lfs - k + 1;
+			ckpt->qmt = span->qmt;
+		}
+	}
+
+	uls_xcontext_rec_linespans(xctx, 0);
+	return j_old;
+}
+
+ULS_DECL_STATIC void
+ULS_QUALIFIED_METHOD(__relex_splice)(uls_relex_ptr_t rlx, int r, int j_old, int byte_delta)
+{
+	int i0, i1, n_tail, line_delta, tok_delta, i;
+
+	// the old tokens [i0, i1) and the old lines [r, j_old) are replaced.
+	i0 = r < rlx->n_lines ? rlx->ckpts[r].i_tok : rlx->n_toks;
+	i1 = j_old < rlx->n_lines ? rlx->ckpts[j_old].i_tok : rlx->n_toks;
+
+	line_delta = r + rlx->n_new_lines - j_old;
+	tok_delta = rlx->n_new_toks - (i1 - i0);
+
+	for (i = i0; i < i1; i++) {
+		rlx->lxm_garbage += rlx->toks[i].lxm_len + 1;
+	}
+
+	n_tail = rlx->n_toks - i1;
+	for (i = i1; i < rlx->n_toks; i++) {
+		rlx->toks[i].lineno += line_delta;
+	}
+
+	rlx->toks = (uls_relex_tok_ptr_t) __relex_grow(rlx->toks,
+		&rlx->n_alloc_toks, rlx->n_toks + tok_delta, sizeof(uls_relex_tok_t));
+	if (tok_delta != 0 && n_tail > 0) {
+		uls_memmove(rlx->toks + i1 + tok_delta, rlx->toks + i1, n_tail * sizeof(uls_relex_tok_t));
+	}
+	if (rlx->n_new_toks > 0) {
+		uls_memcopy(rlx->toks + i0, rlx->new_toks, rlx->n_new_toks * sizeof(uls_relex_tok_t));
+	}
+	rlx->n_toks += tok_delta;
+
+	n_tail = rlx->n_lines - j_old;
+	for (i = j_old; i < rlx->n_lines; i++) {
+		rlx->ckpts[i].offset += byte_delta;
+		rlx->ckpts[i].i_tok += tok_delta;
+	}
+	for (i = 0; i < rlx->n_new_lines; i++) {
+		rlx->new_ckpts[i].i_tok += i0;
+	}
+
+	rlx->ckpts = (uls_relex_ckpt_ptr_t) __relex_grow(rlx->ckpts,
+		&rlx->n_alloc_lines, rlx->n_lines + line_delta, sizeof(uls_relex_ckpt_t));
+	if (line_delta != 0 && n_tail > 0) {
+		uls_memmove(rlx->ckpts + j_old + line_delta, rlx->ckpts + j_old, n_tail * sizeof(uls_relex_ckpt_t));
+	}
+	uls_memcopy(rlx->ckpts + r, rlx->new_ckpts, rlx->n_new_lines * sizeof(uls_relex_ckpt_t));
+	rlx->n_lines += line_delta;
+
+	rlx->n_new_toks = rlx->n_new_lines = 0;
+}
+
+ULS_DECL_STATIC void
+ULS_QUALIFIED_METHOD(__relex_compact_pool)(uls_relex_ptr_t rlx)
+{
+	_uls_type_tool(csz_str) pool;
+	uls_relex_tok_ptr_t tok;
+	int i;
+
+	_uls_tool(csz_init)(uls_ptr(pool), csz_length(uls_ptr(rlx->lxm_pool)) - rlx->lxm_garbage + 1);
+
+	for (i = 0; i < rlx->n_toks; i++) {
+		tok = rlx->toks + i;
+		_uls_tool(csz_append)(uls_ptr(pool), csz_data_ptr(uls_ptr(rlx->lxm_pool)) + tok->lxm_offset, tok->lxm_len);
+		tok->lxm_offset = csz_length(uls_ptr(pool)) - tok->lxm_len;
+		_uls_tool(csz_add_eos)(uls_ptr(pool));
+	}
+
+	_uls_tool(csz_deinit)(uls_ptr(rlx->lxm_pool));
+	rlx->lxm_pool = pool;
+	rlx->lxm_garbage = 0;
+}
+
+ULS_DECL_STATIC void
+ULS_QUALIFIED_METHOD(__relex_reset)(uls_relex_ptr_t rlx)
+{
+	rlx->n_toks = rlx->n_lines = 0;
+	_uls_tool(csz_reset)(uls_ptr(rlx->lxm_pool));
+	rlx->lxm_garbage = 0;
+}
+
+ULS_QUALIFIED_RETTYP(uls_relex_ptr_t)
+ULS_QUALIFIED_METHOD(uls_create_relex)(uls_lex_ptr_t uls)
+{
+	uls_relex_ptr_t rlx;
+
+	rlx = uls_alloc_object(uls_relex_t);
+	uls_initial_zerofy_object(rlx);
+
+	rlx->uls = uls;
+	rlx->text = "";
+	_uls_tool(csz_init)(uls_ptr(rlx->lxm_pool), 4096);
+
+	return rlx;
+}
+
+void
+ULS_QUALIFIED_METHOD(uls_destroy_relex)(uls_relex_ptr_t rlx)
+{
+	if (rlx == nilptr) return;
+
+	uls_mfree(rlx->toks);
+	uls_mfree(rlx->ckpts);
+	uls_mfree(rlx->new_toks);
+	uls_mfree(rlx->new_ckpts);
+	_uls_tool(csz_deinit)(uls_ptr(rlx->lxm_pool));
+
+	uls_dealloc_object(rlx);
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_relex_set_text)(uls_relex_ptr_t rlx, const char *text, int len)
+{
+	if (text == NULL) {
+		text = "";
+		len = 0;
+	} else if (len < 0) {
+		len = _uls_tool_(strlen)(text);
+	}
+
+	rlx->text = text;
+	rlx->text_len = len;
+	__relex_reset(rlx);
+
+	if (__relex_run(rlx, 0, -1, 0) < -1) {
+		_uls_log(err_log)("%s: failed to tokenize the text", __func__);
+		rlx->n_new_toks = rlx->n_new_lines = 0;
+		return -1;
+	}
+
+	__relex_splice(rlx, 0, 0, 0);
+	return rlx->n_toks;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_relex_edit)(uls_relex_ptr_t rlx, const char *text, int len,
+	int edit_offset, int old_len, int new_len, uls_ptrtype_tool(outparam) parms)
+{
+	int a, r, i0, j_old, n_old_toks, n_new_toks;
+
+	if (len < 0) len = _uls_tool_(strlen)(text);
+
+	if (edit_offset < 0 || old_len < 0 || new_len < 0 || edit_offset + old_len > rlx->text_len ||
+		len != rlx->text_len - old_len + new_len) {
+		_uls_log(err_log)("%s: invalid edit range", __func__);
+		return -1;
+	}
+
+	if (rlx->n_lines == 0) {
+		if (uls_relex_set_text(rlx, text, len) < 0) return -1;
+		if (parms != nilptr) {
+			parms->n1 = 0;
+			parms->n2 = rlx->n_toks;
+			parms->n = 0;
+		}
+		return rlx->n_toks;
+	}
+
+	// Restart from the nearest line outside comments and quote-strings.
+	a = __relex_find_line(rlx, edit_offset);
+	for (r = a; r > 0 && rlx->ckpts[r].n_lfs_pending > 0; r--)
+		/* NOTHING */;
+
+	rlx->text = text;
+	rlx->text_len = len;
+
+	if ((j_old = __relex_run(rlx, r, edit_offset + new_len, new_len - old_len)) < -1) {
+		_uls_log(err_log)("%s: failed to tokenize the text", __func__);
+		// The tokens and lines are of the old text, so the next edit tokenizes the whole text again.
+		__relex_reset(rlx);
+		rlx->n_new_toks = rlx->n_new_lines = 0;
+		return -1;
+	}
+
+	i0 = rlx->ckpts[r].i_tok;
+	n_old_toks = (j_old < rlx->n_lines ? rlx->ckpts[j_old].i_tok : rlx->n_toks) - i0;
+
+	if (parms != nilptr) {
+		parms->n1 = i0;
+		parms->n2 = i0 + rlx->n_new_toks;
+		parms->n = n_old_toks;
+	}
+
+	n_new_toks = rlx->n_new_toks;
+	__relex_splice(rlx, r, j_old, new_len - old_len);
+
+	if (rlx->lxm_garbage > 4096 && rlx->lxm_garbage > csz_length(uls_ptr(rlx->lxm_pool)) / 2) {
+		__relex_compact_pool(rlx);
+	}
+
+	return n_new_toks;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_relex_num_tokens)(uls_relex_ptr_t rlx)
+{
+	return rlx->n_toks;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_relex_num_lines)(uls_relex_ptr_t rlx)
+{
+	return rlx->n_lines;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_relex_get_tok)(uls_relex_ptr_t rlx, int i, uls_ptrtype_tool(outparam) parms)
+{
+	uls_relex_tok_ptr_t tok;
+
+	if (i < 0 || i >= rlx->n_toks) {
+		return rlx->uls->xcontext.toknum_NONE;
+	}
+
+	tok = rlx->toks + i;
+	if (parms != nilptr) {
+		parms->lptr = csz_data_ptr(uls_ptr(rlx->lxm_pool)) + tok->lxm_offset;
+		parms->len = tok->lxm_len;
+		parms->n = tok->lineno;
+	}
+
+	return tok->tok_id;
+}
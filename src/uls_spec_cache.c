@@ -0,0 +1,263 @@
+/*
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * uls_spec_cache.c -- the compiled specs shared by the lexers in the process --
+ *     written by Stanley Hong <link2next@gmail.com>, October 2026.
+ *
+ *  This file is part of ULS, Unified Lexical Scheme.
+ */
+#ifndef ULS_EXCLUDE_HFILES
+#define __ULS_SPEC_CACHE__
+#include "uls/uls_spec_cache.h"
+#include "uls/uls_fileio.h"
+#include "uls/uls_misc.h"
+#include "uls/uls_log.h"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#endif
+
+ULS_DECL_STATIC void
+ULS_QUALIFIED_METHOD(__sign_spec_file)(uls_spec_cache_ent_ptr_t ent, FILE *fp)
+{
+	// The prime of the 64-bit FNV-1a hash
+	uls_uint64 prime = ((uls_uint64) 0x100 << 32) | 0x1B3;
+	uls_uint64 vals[4];
+	struct stat statbuff;
+	int i;
+
+	if (fp != NULL && fstat(fileno(fp), uls_ptr(statbuff)) == 0) {
+		vals[0] = (uls_uint64) statbuff.st_dev;
+		vals[1] = (uls_uint64) statbuff.st_ino;
+		vals[2] = (uls_uint64) statbuff.st_mtime;
+		vals[3] = (uls_uint64) statbuff.st_size;
+	} else {
+		// The ulf-file may not exist, which is also a state of the spec.
+		for (i = 0; i < 4; i++) vals[i] = 0;
+	}
+
+	for (i = 0; i < 4; i++) {
+		ent->sig = (ent->sig ^ vals[i]) * prime;
+	}
+}
+
+ULS_DECL_STATIC int
+ULS_QUALIFIED_METHOD(__stat_spec_file)(const char *confname, uls_spec_cache_ent_ptr_t ent)
+{
+	char specname[ULC_LONGNAME_MAXSIZ+1], ulc_lname[ULC_LONGNAME_MAXSIZ+1];
+	char linebuff[ULS_LINEBUFF_SIZ__ULD+1];
+	struct stat statbuff;
+	uls_type_tool(outparam) parms1;
+	uls_type_tool(version) sysver;
+	FILE *fp, *fp_uld = NULL;
+	int typ_fpath, len_basedir, len_specname, n, rc;
+
+	ent->sig = ((uls_uint64) 0xCBF29CE4 << 32) | 0x84222325;
+
+	parms1.line = specname;
+	if ((typ_fpath = uls_get_spectype(confname, uls_ptr(parms1))) < 0) {
+		return -1;
+	}
+	len_basedir = parms1.n;
+	len_specname = parms1.len;
+
+	if (typ_fpath == ULS_NAME_FILEPATH_ULD) {
+		if ((fp_uld = _uls_tool_(fp_open)(confname, ULS_FIO_READ)) == NULL) {
+			return -1;
+		}
+		__sign_spec_file(ent, fp_uld);
+
+		// The uld-file names its base spec at the first line, as '#@<specname>'.
+		rc = _uls_tool_(fp_gets)(fp_uld, linebuff, sizeof(linebuff), 0);
+		if (rc < 3 || !(linebuff[0] == '#' && linebuff[1] == '@')) {
+			_uls_tool_(fp_close)(fp_uld);
+			return -1;
+		}
+
+		_uls_tool(str_trim_end)(linebuff, rc);
+		confname = linebuff + 2;
+
+		parms1.line = specname;
+		if ((typ_fpath = uls_get_spectype(confname, uls_ptr(parms1))) != ULS_NAME_SPECNAME) {
+			_uls_tool_(fp_close)(fp_uld);
+			return -1;
+		}
+		len_basedir = parms1.n;
+		len_specname = parms1.len;
+	}
+
+	// The same search as uls_create() does to find the ulc-file and its ulf-file.
+	if ((fp = uls_get_ulc_path(typ_fpath, confname, len_basedir, specname, len_specname, uls_ptr(parms1))) == NULL) {
+		_uls_tool_(fp_close)(fp_uld);
+		return -1;
+	}
+
+	rc = fstat(fileno(fp_uld != NULL ? fp_uld : fp), uls_ptr(statbuff));
+	_uls_tool_(fp_close)(fp_uld);
+
+	__sign_spec_file(ent, fp);
+	__sign_spec_file(ent, (FILE *) parms1.native_data);
+	_uls_tool_(fp_close)((FILE *) parms1.native_data);
+
+	if (rc < 0) {
+		_uls_tool_(fp_close)(fp);
+		return -1;
+	}
+
+	ent->dev = (uls_uint64) statbuff.st_dev;
+	ent->ino = (uls_uint64) statbuff.st_ino;
+
+	// The ulc-files it inherits from, in the order that uls_create() reads them.
+	_uls_tool_(version_make)(uls_ptr(sysver), ULC_VERSION_MAJOR, ULC_VERSION_MINOR, ULC_VERSION_DEBUG);
+
+	for (n = 0; (rc = check_ulc_file_magic(fp, uls_ptr(sysver), ulc_lname)) > 0; n++) {
+		_uls_tool_(fp_close)(fp);
+
+		parms1.line = specname;
+		if (n >= ULS_SPEC_CACHE_MAX_PARENTS ||
+			uls_get_spectype(ulc_lname, uls_ptr(parms1)) != ULS_NAME_SPECNAME ||
+			(fp = uls_get_ulc_path(ULS_NAME_SPECNAME, ulc_lname, parms1.n, specname, parms1.len, nilptr)) == NULL) {
+			return -1;
+		}
+		__sign_spec_file(ent, fp);
+	}
+
+	_uls_tool_(fp_close)(fp);
+	return rc < 0 ? -1 : 0;
+}
+
+ULS_DECL_STATIC void
+ULS_QUALIFIED_METHOD(__destroy_spec_cache_ent)(uls_spec_cache_ent_ptr_t ent)
+{
+	// The lexers sharing the spec still hold it.
+	uls_destroy(ent->spec);
+	uls_mfree(ent->confname);
+	uls_dealloc_object(ent);
+}
+
+void
+ULS_QUALIFIED_METHOD(initialize_uls_spec_cache)(void)
+{
+	uls_spec_cache = uls_alloc_object_clear(uls_spec_cache_t);
+	uls_init_mutex(uls_ptr(uls_spec_cache->mtx));
+	uls_spec_cache->ent_list = nilptr;
+	uls_spec_cache->n_ents = 0;
+}
+
+void
+ULS_QUALIFIED_METHOD(finalize_uls_spec_cache)(void)
+{
+	if (uls_spec_cache == nilptr) return;
+
+	uls_flush_spec_cache();
+
+	uls_deinit_mutex(uls_ptr(uls_spec_cache->mtx));
+	uls_dealloc_object(uls_spec_cache);
+	uls_spec_cache = nilptr;
+}
+
+ULS_QUALIFIED_RETTYP(uls_lex_ptr_t)
+ULS_QUALIFIED_METHOD(uls_grab_shared_spec)(const char *confname)
+{
+	uls_spec_cache_ent_ptr_t ent, ent_prev;
+	uls_spec_cache_ent_t ent1;
+	uls_lex_ptr_t spec;
+
+	if (uls_spec_cache == nilptr || __stat_spec_file(confname, uls_ptr(ent1)) < 0) {
+		_uls_log(err_log)("%s: can't find the spec '%s'", __func__, confname);
+		return nilptr;
+	}
+
+	uls_lock_mutex(uls_ptr(uls_spec_cache->mtx));
+
+	for (ent_prev = nilptr, ent = uls_spec_cache->ent_list; ent != nilptr; ent_prev = ent, ent = ent->next) {
+		if (ent->dev == ent1.dev && ent->ino == ent1.ino) break;
+	}
+
+	if (ent != nilptr && ent->sig != ent1.sig) {
+		// A file of the spec has been modified since it's compiled.
+		if (ent_prev != nilptr) ent_prev->next = ent->next;
+		else uls_spec_cache->ent_list = ent->next;
+		--uls_spec_cache->n_ents;
+
+		__destroy_spec_cache_ent(ent);
+		ent = nilptr;
+	}
+
+	if (ent == nilptr) {
+		if ((spec = uls_create(confname)) == nilptr) {
+			uls_unlock_mutex(uls_ptr(uls_spec_cache->mtx));
+			return nilptr;
+		}
+
+		ent = uls_alloc_object(uls_spec_cache_ent_t);
+		*ent = ent1;
+		ent->confname = _uls_tool_(strdup)(confname, -1);
+		ent->spec = spec;
+
+		ent->next = uls_spec_cache->ent_list;
+		uls_spec_cache->ent_list = ent;
+		++uls_spec_cache->n_ents;
+	}
+
+	spec = ent->spec;
+	uls_grab(spec);
+
+	uls_unlock_mutex(uls_ptr(uls_spec_cache->mtx));
+
+	return spec;
+}
+
+void
+ULS_QUALIFIED_METHOD(uls_ungrab_shared_spec)(uls_lex_ptr_t spec)
+{
+	if (uls_spec_cache == nilptr) {
+		uls_destroy(spec);
+		return;
+	}
+
+	uls_lock_mutex(uls_ptr(uls_spec_cache->mtx));
+	uls_destroy(spec);
+	uls_unlock_mutex(uls_ptr(uls_spec_cache->mtx));
+}
+
+void
+ULS_QUALIFIED_METHOD(uls_flush_spec_cache)(void)
+{
+	uls_spec_cache_ent_ptr_t ent, ent_next;
+
+	if (uls_spec_cache == nilptr) return;
+
+	uls_lock_mutex(uls_ptr(uls_spec_cache->mtx));
+
+	for (ent = uls_spec_cache->ent_list; ent != nilptr; ent = ent_next) {
+		ent_next = ent->next;
+		__destroy_spec_cache_ent(ent);
+	}
+
+	uls_spec_cache->ent_list = nilptr;
+	uls_spec_cache->n_ents = 0;
+
+	uls_unlock_mutex(uls_ptr(uls_spec_cache->mtx));
+}
@@ -50,6 +50,7 @@ ULS_QUALIFIED_METHOD(uls_create_tokdef)(void)
 	uls_tokdef_ptr_t e;
 
 	e = uls_alloc_object_clear(uls_tokdef_t);
+	e->i_tokdef = -1;
 	uls_init_namebuf(e->keyword, ULS_TOKNAM_MAXSIZ);
 
 	return e;
@@ -58,10 +59,79 @@ ULS_QUALIFIED_METHOD(uls_create_tokdef)(void)
 void
 ULS_QUALIFIED_METHOD(uls_destroy_tokdef)(uls_tokdef_ptr_t e)
 {
-	uls_deinit_namebuf(e->keyword);
+	uls_deinit_tokdef(e);
 	uls_dealloc_object(e);
 }
 
+void
+ULS_QUALIFIED_METHOD(uls_deinit_tokdef)(uls_tokdef_ptr_t e)
+{
+	uls_deinit_namebuf(e->keyword);
+}
+
+void
+ULS_QUALIFIED_METHOD(uls_init_spec_arena)(uls_spec_arena_ptr_t arena)
+{
+	arena->regions[ULS_SPEC_ARENA_HOT] = nilptr;
+	arena->regions[ULS_SPEC_ARENA_COLD] = nilptr;
+	arena->n_bytes = 0;
+}
+
+void
+ULS_QUALIFIED_METHOD(uls_deinit_spec_arena)(uls_spec_arena_ptr_t arena)
+{
+	uls_spec_arena_blk_ptr_t blk, blk_prev;
+	int i;
+
+	for (i = 0; i < 2; i++) {
+		for (blk = arena->regions[i]; blk != nilptr; blk = blk_prev) {
+			blk_prev = blk->prev;
+			uls_mfree(blk);
+		}
+		arena->regions[i] = nilptr;
+	}
+
+	arena->n_bytes = 0;
+}
+
+uls_voidptr_t
+ULS_QUALIFIED_METHOD(uls_spec_arena_alloc)(uls_spec_arena_ptr_t arena, int region, int n_bytes)
+{
+	uls_spec_arena_blk_ptr_t blk = arena->regions[region];
+	int siz, siz_hdr = uls_roundup(sizeof(uls_spec_arena_blk_t), sizeof(double));
+	char *ptr;
+
+	n_bytes = uls_roundup(n_bytes, sizeof(double));
+
+	if (blk == nilptr || blk->n_used + n_bytes > blk->n_alloc) {
+		siz = n_bytes > ULS_SPEC_ARENA_BLKSIZ ? n_bytes : ULS_SPEC_ARENA_BLKSIZ;
+		blk = (uls_spec_arena_blk_ptr_t) uls_malloc(siz_hdr + siz);
+		blk->n_used = 0;
+		blk->n_alloc = siz;
+		blk->prev = arena->regions[region];
+		arena->regions[region] = blk;
+	}
+
+	ptr = (char *) blk + siz_hdr + blk->n_used;
+	blk->n_used += n_bytes;
+	arena->n_bytes += n_bytes;
+
+	uls_bzero(ptr, n_bytes);
+	return (uls_voidptr_t) ptr;
+}
+
+ULS_QUALIFIED_RETTYP(uls_tokdef_ptr_t)
+ULS_QUALIFIED_METHOD(uls_arena_create_tokdef)(uls_spec_arena_ptr_t arena)
+{
+	uls_tokdef_ptr_t e;
+
+	e = (uls_tokdef_ptr_t) uls_spec_arena_alloc(arena, ULS_SPEC_ARENA_HOT, sizeof(uls_tokdef_t));
+	e->i_tokdef = -1;
+	uls_init_namebuf(e->keyword, ULS_TOKNAM_MAXSIZ);
+
+	return e;
+}
+
 void
 ULS_QUALIFIED_METHOD(__init_tokdef_vx)(uls_tokdef_vx_ptr_t e_vx)
 {
@@ -95,6 +165,7 @@ ULS_QUALIFIED_METHOD(uls_deinit_tokdef_vx)(uls_tokdef_vx_ptr_t e_vx)
 {
 	uls_tokdef_name_ptr_t e_nam, e_nam_next;
 
+	// the aliases in the arena are left to it.
 	for (e_nam=e_vx->tokdef_names; e_nam != nilptr; e_nam = e_nam_next) {
 		e_nam_next = e_nam->next;
 		dealloc_tokdef_name(e_nam);
@@ -116,19 +187,39 @@ ULS_QUALIFIED_METHOD(uls_create_tokdef_vx)(int tok_id, const char *name, uls_tok
 	return e_vx;
 }
 
+ULS_QUALIFIED_RETTYP(uls_tokdef_vx_ptr_t)
+ULS_QUALIFIED_METHOD(uls_arena_create_tokdef_vx)(uls_spec_arena_ptr_t arena, int tok_id, const char *name, uls_tokdef_ptr_t e)
+{
+	uls_tokdef_vx_ptr_t e_vx;
+
+	if (name == NULL) name = "";
+	e_vx = (uls_tokdef_vx_ptr_t) uls_spec_arena_alloc(arena, ULS_SPEC_ARENA_HOT, sizeof(uls_tokdef_vx_t));
+	uls_init_tokdef_vx(e_vx, tok_id, name, e);
+	e_vx->flags = ULS_VX_ARENA;
+
+	return e_vx;
+}
+
 void
 ULS_QUALIFIED_METHOD(uls_destroy_tokdef_vx)(uls_tokdef_vx_ptr_t e_vx)
 {
 	uls_deinit_tokdef_vx(e_vx);
-	uls_dealloc_object(e_vx);
+	if (!(e_vx->flags & ULS_VX_ARENA)) {
+		uls_dealloc_object(e_vx);
+	}
 }
 
 ULS_QUALIFIED_RETTYP(uls_tokdef_name_ptr_t)
-ULS_QUALIFIED_METHOD(alloc_tokdef_name)(const char *name)
+ULS_QUALIFIED_METHOD(alloc_tokdef_name)(uls_spec_arena_ptr_t arena, const char *name)
 {
 	uls_tokdef_name_ptr_t e_nam;
 
-	e_nam = uls_alloc_object_clear(uls_tokdef_name_t);
+	if (arena != nilptr) {
+		e_nam = (uls_tokdef_name_ptr_t) uls_spec_arena_alloc(arena, ULS_SPEC_ARENA_COLD, sizeof(uls_tokdef_name_t));
+		e_nam->flags = ULS_VX_ARENA;
+	} else {
+		e_nam = uls_alloc_object_clear(uls_tokdef_name_t);
+	}
 	uls_init_namebuf(e_nam->name, ULS_TOKNAM_MAXSIZ);
 	uls_set_namebuf_value(e_nam->name, name);
 
@@ -140,7 +231,9 @@ void
 ULS_QUALIFIED_METHOD(dealloc_tokdef_name)(uls_tokdef_name_ptr_t e_nam)
 {
 	uls_deinit_namebuf(e_nam->name);
-	uls_dealloc_object(e_nam);
+	if (!(e_nam->flags & ULS_VX_ARENA)) {
+		uls_dealloc_object(e_nam);
+	}
 }
 
 int
@@ -231,6 +324,12 @@ ULS_QUALIFIED_METHOD(uls_change_tokdef_vx_name)(uls_tokdef_vx_ptr_t e_vx, const
 
 int
 ULS_QUALIFIED_METHOD(uls_add_tokdef_vx_name)(uls_tokdef_vx_ptr_t e_vx, const char *name)
+{
+	return uls_add_tokdef_vx_name_2(nilptr, e_vx, name);
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_add_tokdef_vx_name_2)(uls_spec_arena_ptr_t arena, uls_tokdef_vx_ptr_t e_vx, const char *name)
 {
 	int stat = 0;
 	uls_tokdef_name_ptr_t e_nam;
@@ -239,7 +338,7 @@ ULS_QUALIFIED_METHOD(uls_add_tokdef_vx_name)(uls_tokdef_vx_ptr_t e_vx, const cha
 		uls_set_namebuf_value(e_vx->name, name);
 		stat = 1;
 	} else if ((e_nam = find_tokdef_alias(e_vx, name)) == nilptr) {
-		e_nam = alloc_tokdef_name(name);
+		e_nam = alloc_tokdef_name(arena, name);
 		insert_tokdef_name_to_group(e_vx, e_nam);
 		stat = 1;
 	}
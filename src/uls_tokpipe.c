@@ -0,0 +1,321 @@
+/*
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * uls_tokpipe.c -- the stages filtering the tokens before uls_get_tok() returns them --
+ *     written by Stanley Hong <link2next@gmail.com>, October 2026.
+ *
+ *  This file is part of ULS, Unified Lexical Scheme.
+ */
+#ifndef ULS_EXCLUDE_HFILES
+#define __ULS_TOKPIPE__
+#include "uls/uls_tokpipe.h"
+#include "uls/uls_core.h"
+#include "uls/uls_misc.h"
+#include "uls/uls_log.h"
+#endif
+
+ULS_DECL_STATIC void
+ULS_QUALIFIED_METHOD(__init_tokq)(uls_tokq_ptr_t q)
+{
+	q->ents = nilptr;
+	q->i_head = q->n_ents = q->n_alloc_ents = 0;
+
+	_uls_tool(str_init)(uls_ptr(q->pool), 0);
+	q->l_pool = 0;
+}
+
+ULS_DECL_STATIC void
+ULS_QUALIFIED_METHOD(__deinit_tokq)(uls_tokq_ptr_t q)
+{
+	uls_mfree(q->ents);
+	q->i_head = q->n_ents = q->n_alloc_ents = 0;
+
+	_uls_tool(str_free)(uls_ptr(q->pool));
+	q->l_pool = 0;
+}
+
+ULS_DECL_STATIC void
+ULS_QUALIFIED_METHOD(__reset_tokq)(uls_tokq_ptr_t q)
+{
+	q->i_head = q->n_ents = 0;
+	q->l_pool = 0;
+}
+
+ULS_DECL_STATIC ULS_QUALIFIED_RETTYP(uls_tokq_ent_ptr_t)
+ULS_QUALIFIED_METHOD(__append_tokq)(uls_tokq_ptr_t q, uls_tokrec_ptr_t rec, const char *lxm_raw)
+{
+	uls_tokq_ent_ptr_t e;
+
+	if (q->n_ents >= q->n_alloc_ents) {
+		q->n_alloc_ents = q->n_alloc_ents > 0 ? 2 * q->n_alloc_ents : 8;
+		q->ents = (uls_tokq_ent_ptr_t) uls_mrealloc(q->ents, q->n_alloc_ents * sizeof(uls_tokq_ent_t));
+	}
+
+	e = q->ents + q->n_ents++;
+	e->rec = *rec;
+
+	// The lexeme of the lexer stays until the next raw token, the others are copied.
+	if (lxm_raw != NULL && rec->lxm == lxm_raw) {
+		e->lxm_off = -1;
+	} else {
+		e->lxm_off = q->l_pool;
+		_uls_tool(str_modify)(uls_ptr(q->pool), q->l_pool, rec->lxm, rec->l_lxm);
+		str_putc(uls_ptr(q->pool), q->l_pool + rec->l_lxm, '\0');
+		q->l_pool += rec->l_lxm + 1;
+		e->rec.lxm = NULL;
+	}
+
+	return e;
+}
+
+ULS_DECL_STATIC int
+ULS_QUALIFIED_METHOD(__run_tokstages)(uls_lex_ptr_t uls, uls_tokpipe_ptr_t pipe)
+{
+	uls_context_ptr_t ctx = uls->xcontext.context;
+	uls_tokq_ptr_t qin = uls_ptr(pipe->queues[0]), qout = uls_ptr(pipe->queues[1]), q;
+	uls_tokstage_slot_ptr_t stage;
+	uls_tokq_ent_ptr_t e;
+	uls_tokdef_vx_ptr_t e_vx0;
+	const char *lxm_raw = __uls_lexeme(uls); // stages may take it as a C-string
+	uls_tokrec_t rec;
+	int i, k, tok_id0;
+
+	rec.tok_id = ctx->tok;
+	rec.lxm = lxm_raw;
+	rec.l_lxm = ctx->s_val_len;
+	rec.lineno = ctx->lineno;
+	rec.tokdef_vx = uls->tokdef_vx;
+
+	__reset_tokq(qin);
+	__append_tokq(qin, uls_ptr(rec), lxm_raw);
+
+	for (i=0; i<pipe->n_stages; i++) {
+		stage = pipe->stages + i;
+		__reset_tokq(qout);
+		pipe->q_emit = qout;
+
+		for (k=0; k<qin->n_ents; k++) {
+			e = qin->ents + k;
+			rec = e->rec;
+			if (e->lxm_off >= 0) {
+				rec.lxm = qin->pool.buf + e->lxm_off;
+			}
+
+			tok_id0 = rec.tok_id;
+			e_vx0 = rec.tokdef_vx;
+			pipe->lineno_emit = rec.lineno;
+
+			if (tok_id0 == uls->xcontext.toknum_EOI) {
+				// The stages can't drop or rewrite the EOI token.
+				stage->proc(uls, uls_ptr(rec), stage->data);
+				rec = e->rec;
+				rec.lxm = "";
+				rec.l_lxm = 0;
+			} else if (stage->proc(uls, uls_ptr(rec), stage->data) == ULS_TOKSTAGE_DROP) {
+				continue;
+			}
+
+			if (rec.tok_id != tok_id0 && rec.tokdef_vx == e_vx0) {
+				rec.tokdef_vx = uls_find_tokdef_vx(uls, rec.tok_id);
+			}
+			if (rec.lxm == NULL) {
+				rec.lxm = "";
+				rec.l_lxm = 0;
+			}
+
+			__append_tokq(qout, uls_ptr(rec), lxm_raw);
+		}
+
+		pipe->q_emit = nilptr;
+		q = qin; qin = qout; qout = q;
+	}
+
+	// Giving out a token overwrites the lexeme of the lexer.
+	if (qin->n_ents > 1) {
+		for (k=0; k<qin->n_ents; k++) {
+			e = qin->ents + k;
+			if (e->lxm_off < 0) {
+				e->lxm_off = qin->l_pool;
+				_uls_tool(str_modify)(uls_ptr(qin->pool), qin->l_pool, lxm_raw, e->rec.l_lxm);
+				str_putc(uls_ptr(qin->pool), qin->l_pool + e->rec.l_lxm, '\0');
+				qin->l_pool += e->rec.l_lxm + 1;
+			}
+		}
+	}
+
+	pipe->qout = qin;
+	return qin->n_ents;
+}
+
+void
+ULS_QUALIFIED_METHOD(uls_tokpipe_drop)(uls_tokpipe_ptr_t pipe)
+{
+	// The queues are reused by the stages running now.
+	if (pipe->q_emit == nilptr) {
+		pipe->qout = nilptr;
+	}
+	pipe->eoi_passed = 0;
+}
+
+void
+ULS_QUALIFIED_METHOD(uls_destroy_tokpipe)(uls_tokpipe_ptr_t pipe)
+{
+	__deinit_tokq(uls_ptr(pipe->queues[0]));
+	__deinit_tokq(uls_ptr(pipe->queues[1]));
+
+	uls_mfree(pipe->stages);
+	pipe->n_stages = pipe->n_alloc_stages = 0;
+
+	uls_dealloc_object(pipe);
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_tokpipe_get_tok)(uls_lex_ptr_t uls)
+{
+	uls_tokpipe_ptr_t pipe = uls->tokpipe;
+	uls_xcontext_ptr_t xctx = uls_ptr(uls->xcontext);
+	uls_context_ptr_t ctx;
+	uls_tokq_ptr_t q;
+	uls_tokq_ent_ptr_t e;
+	const char *lxm;
+	int tok;
+
+	for ( ; ; ) {
+		if ((q = pipe->qout) != nilptr && q->i_head < q->n_ents) {
+			e = q->ents + q->i_head++;
+			ctx = xctx->context;
+
+			if (e->lxm_off >= 0) {
+				lxm = q->pool.buf + e->lxm_off;
+				uls_set_tok(uls, e->rec.tok_id, lxm, e->rec.l_lxm);
+			} else if (e->rec.tok_id != ctx->tok || e->rec.l_lxm != ctx->s_val_len) {
+				uls_set_tok(uls, e->rec.tok_id, ctx->s_val, e->rec.l_lxm);
+			}
+
+			__uls_ctx_set_lineno(ctx, e->rec.lineno);
+			uls->tokdef_vx = e->rec.tokdef_vx;
+			return e->rec.tok_id;
+		}
+
+		if (q != nilptr) {
+			__uls_ctx_set_lineno(xctx->context, pipe->lineno_raw);
+			pipe->qout = nilptr;
+		}
+
+		tok = __uls_get_tok(uls);
+		if (tok == xctx->toknum_ERR || tok == xctx->toknum_NONE) {
+			return tok;
+		}
+
+		if (tok == xctx->toknum_EOI) {
+			if (pipe->eoi_passed) return tok;
+			pipe->eoi_passed = 1;
+		}
+
+		pipe->lineno_raw = uls_ctx_get_lineno(xctx->context);
+		__run_tokstages(uls, pipe);
+	}
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_add_tokstage)(uls_lex_ptr_t uls, uls_tokstage_t proc, uls_voidptr_t data)
+{
+	uls_tokpipe_ptr_t pipe = uls->tokpipe;
+	uls_tokstage_slot_ptr_t stage;
+
+	if (proc == nilptr) {
+		_uls_log(err_log)("%s: invalid parameter!", __func__);
+		return -1;
+	}
+
+	if (pipe == nilptr) {
+		pipe = uls_alloc_object_clear(uls_tokpipe_t);
+		__init_tokq(uls_ptr(pipe->queues[0]));
+		__init_tokq(uls_ptr(pipe->queues[1]));
+		uls->tokpipe = pipe;
+	}
+
+	if (pipe->q_emit != nilptr) {
+		_uls_log(err_log)("%s: can't add a stage while the stages run!", __func__);
+		return -1;
+	}
+
+	if (pipe->n_stages >= pipe->n_alloc_stages) {
+		pipe->n_alloc_stages = pipe->n_alloc_stages > 0 ? 2 * pipe->n_alloc_stages : 4;
+		pipe->stages = (uls_tokstage_slot_ptr_t) uls_mrealloc(pipe->stages,
+			pipe->n_alloc_stages * sizeof(uls_tokstage_slot_t));
+	}
+
+	stage = pipe->stages + pipe->n_stages;
+	stage->proc = proc;
+	stage->data = data;
+
+	return pipe->n_stages++;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_clear_tokstages)(uls_lex_ptr_t uls)
+{
+	uls_tokpipe_ptr_t pipe = uls->tokpipe;
+
+	if (pipe != nilptr) {
+		if (pipe->q_emit != nilptr) {
+			_uls_log(err_log)("%s: can't clear the stages while they run!", __func__);
+			return -1;
+		}
+
+		uls_destroy_tokpipe(pipe);
+		uls->tokpipe = nilptr;
+	}
+
+	return 0;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_emit_tok)(uls_lex_ptr_t uls, int tok_id, const char *lxm, int l_lxm)
+{
+	uls_tokpipe_ptr_t pipe = uls->tokpipe;
+	uls_tokrec_t rec;
+
+	if (pipe == nilptr || pipe->q_emit == nilptr) {
+		_uls_log(err_log)("%s: called out of a stage!", __func__);
+		return -1;
+	}
+
+	if (lxm == NULL) {
+		lxm = "";
+		l_lxm = 0;
+	} else if (l_lxm < 0) {
+		l_lxm = _uls_tool_(strlen)(lxm);
+	}
+
+	rec.tok_id = tok_id;
+	rec.lxm = lxm;
+	rec.l_lxm = l_lxm;
+	rec.lineno = pipe->lineno_emit;
+	rec.tokdef_vx = uls_find_tokdef_vx(uls, tok_id);
+
+	__append_tokq(pipe->q_emit, uls_ptr(rec), NULL);
+	return 0;
+}
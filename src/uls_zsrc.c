@@ -0,0 +1,411 @@
+/*
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * uls_zsrc.c -- reading and writing compressed files in-process --
+ *     written by Stanley Hong <link2next@gmail.com>, October 2026.
+ *
+ *  This file is part of ULS, Unified Lexical Scheme.
+ */
+#ifndef ULS_EXCLUDE_HFILES
+#define __ULS_ZSRC__
+#include "uls/uls_zsrc.h"
+#include "uls/uls_fileio.h"
+#include "uls/uls_misc.h"
+#include "uls/uls_log.h"
+#endif
+
+#if defined(HAVE_ZLIB_H) && defined(HAVE_LIBZ)
+#define ULS_ZSRC_USE_ZLIB
+#include <zlib.h>
+#endif
+
+ULS_DECL_STATIC ULS_QUALIFIED_RETTYP(uls_zsrc_ptr_t)
+ULS_QUALIFIED_METHOD(__zsrc_create)(int fd, int format, int flags)
+{
+	uls_zsrc_ptr_t zs;
+	int rc = -1;
+
+	zs = uls_alloc_object_clear(uls_zsrc_t);
+	zs->flags = flags;
+	zs->fd = fd;
+	zs->format = format;
+
+	zs->window_siz = ULS_ZSRC_WINDOW_SIZ;
+	zs->window = (char *) _uls_tool_(malloc)(zs->window_siz);
+
+#ifdef ULS_ZSRC_USE_ZLIB
+	if (format == ULS_ZSRC_GZIP) {
+		z_stream *strm = uls_alloc_object_clear(z_stream);
+
+		// 15+32: zlib or gzip by its header, 15+16: gzip
+		if (flags & ULS_ZSRC_FL_WRITE) {
+			rc = deflateInit2(strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+		} else {
+			rc = inflateInit2(strm, 15 + 32);
+		}
+
+		if (rc != Z_OK) {
+			uls_dealloc_object(strm);
+			rc = -1;
+		} else {
+			zs->zstrm = (uls_voidptr_t) strm;
+			rc = 0;
+		}
+	}
+#endif
+
+	if (rc < 0) {
+		_uls_log(err_log)("%s: can't initialize the codec of format %d", __func__, format);
+		uls_mfree(zs->window);
+		uls_dealloc_object(zs);
+		zs = nilptr;
+	}
+
+	return zs;
+}
+
+ULS_DECL_STATIC void
+ULS_QUALIFIED_METHOD(__zsrc_destroy)(uls_zsrc_ptr_t zs)
+{
+#ifdef ULS_ZSRC_USE_ZLIB
+	if (zs->format == ULS_ZSRC_GZIP) {
+		z_stream *strm = (z_stream *) zs->zstrm;
+		if (zs->flags & ULS_ZSRC_FL_WRITE) deflateEnd(strm);
+		else inflateEnd(strm);
+		uls_dealloc_object(strm);
+	}
+#endif
+
+	zs->zstrm = nilptr;
+	uls_mfree(zs->pushback);
+	uls_mfree(zs->window);
+	uls_dealloc_object(zs);
+}
+
+ULS_DECL_STATIC int
+ULS_QUALIFIED_METHOD(__zsrc_fill_window)(uls_zsrc_ptr_t zs)
+{
+	int rc;
+
+	if ((rc = _uls_tool_(readn)(zs->fd, zs->window, zs->window_siz)) < 0) {
+		zs->flags |= ULS_ZSRC_FL_ERR;
+		return -1;
+	}
+
+	if (rc < zs->window_siz) {
+		zs->flags |= ULS_ZSRC_FL_EOF;
+	}
+
+	zs->i_window = 0;
+	zs->n_window = rc;
+
+	return rc;
+}
+
+ULS_DECL_STATIC int
+ULS_QUALIFIED_METHOD(__zsrc_flush_window)(uls_zsrc_ptr_t zs)
+{
+	int len = zs->n_window;
+
+	if (len > 0 && _uls_tool_(writen)(zs->fd, zs->window, len) < len) {
+		zs->flags |= ULS_ZSRC_FL_ERR;
+		return -1;
+	}
+
+	zs->n_window = 0;
+	return 0;
+}
+
+ULS_DECL_STATIC int
+ULS_QUALIFIED_METHOD(__zsrc_decode)(uls_zsrc_ptr_t zs, char *buf, int bufsiz)
+{
+	int n_in = zs->n_window, n_out = 0;
+
+	if (n_in > 0) zs->flags |= ULS_ZSRC_FL_INSTRM;
+
+#ifdef ULS_ZSRC_USE_ZLIB
+	if (zs->format == ULS_ZSRC_GZIP) {
+		z_stream *strm = (z_stream *) zs->zstrm;
+		int rc;
+
+		strm->next_in = (Bytef *) (zs->window + zs->i_window);
+		strm->avail_in = n_in;
+		strm->next_out = (Bytef *) buf;
+		strm->avail_out = bufsiz;
+
+		rc = inflate(strm, Z_NO_FLUSH);
+		n_in -= strm->avail_in;
+		n_out = bufsiz - strm->avail_out;
+
+		if (rc == Z_STREAM_END) {
+			// The next member of a concatenated gzip, if any, starts afresh.
+			inflateReset(strm);
+			zs->flags &= ~ULS_ZSRC_FL_INSTRM;
+		} else if (rc != Z_OK && !(rc == Z_BUF_ERROR && strm->avail_in == 0)) {
+			_uls_log(err_log)("%s: gzip: %s", __func__, strm->msg != NULL ? strm->msg : "corrupted");
+			zs->flags |= ULS_ZSRC_FL_ERR;
+			return -1;
+		}
+	}
+#endif
+
+	zs->i_window += n_in;
+	zs->n_window -= n_in;
+
+	return n_out;
+}
+
+ULS_DECL_STATIC int
+ULS_QUALIFIED_METHOD(__zsrc_encode)(uls_zsrc_ptr_t zs, const char *buf, int len, int finish)
+{
+	int done = 0, n_out;
+
+	while (!done) {
+		if (zs->n_window >= zs->window_siz && __zsrc_flush_window(zs) < 0) {
+			return -1;
+		}
+
+		n_out = zs->window_siz - zs->n_window;
+#ifdef ULS_ZSRC_USE_ZLIB
+		if (zs->format == ULS_ZSRC_GZIP) {
+			z_stream *strm = (z_stream *) zs->zstrm;
+			int rc;
+
+			strm->next_in = (Bytef *) buf;
+			strm->avail_in = len;
+			strm->next_out = (Bytef *) (zs->window + zs->n_window);
+			strm->avail_out = n_out;
+
+			rc = deflate(strm, finish ? Z_FINISH : Z_NO_FLUSH);
+			if (rc == Z_STREAM_ERROR) {
+				zs->flags |= ULS_ZSRC_FL_ERR;
+				return -1;
+			}
+
+			buf += len - strm->avail_in;
+			len = strm->avail_in;
+			n_out -= strm->avail_out;
+
+			if (finish) done = rc == Z_STREAM_END;
+			else done = len == 0 && strm->avail_out > 0;
+		}
+#endif
+		zs->n_window += n_out;
+	}
+
+	return 0;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_zsrc_probe)(const char *buf, int len)
+{
+	const unsigned char *ptr = (const unsigned char *) buf;
+
+	if (len >= 2 && ptr[0] == 0x1F && ptr[1] == 0x8B) {
+		return ULS_ZSRC_GZIP;
+	}
+
+	return ULS_ZSRC_NONE;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_zsrc_supported)(int format)
+{
+	int stat = 0;
+
+#ifdef ULS_ZSRC_USE_ZLIB
+	if (format == ULS_ZSRC_GZIP) stat = 1;
+#endif
+
+	return stat;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_zsrc_format_of_path)(const char *filepath)
+{
+	int len = _uls_tool_(strlen)(filepath);
+
+	if (len > 3 && uls_streql(filepath + len - 3, ".gz")) {
+		return ULS_ZSRC_GZIP;
+	}
+
+	return ULS_ZSRC_NONE;
+}
+
+ULS_QUALIFIED_RETTYP(uls_zsrc_ptr_t)
+ULS_QUALIFIED_METHOD(uls_zsrc_open)(int fd, int format, const char *prefix, int len_prefix)
+{
+	uls_zsrc_ptr_t zs;
+
+	if (fd < 0 || len_prefix < 0 || len_prefix > ULS_ZSRC_WINDOW_SIZ) {
+		_uls_log(err_log)("%s: invalid parameter!", __func__);
+		return nilptr;
+	}
+
+	if (!uls_zsrc_supported(format)) {
+		_uls_log(err_log)("%s: the compression format %d not supported in this build", __func__, format);
+		return nilptr;
+	}
+
+	if ((zs = __zsrc_create(fd, format, 0)) == nilptr) {
+		return nilptr;
+	}
+
+	// The bytes consumed from fd, say, in probing the magic, go first.
+	if (len_prefix > 0) {
+		_uls_tool_(memcopy)(zs->window, prefix, len_prefix);
+		zs->n_window = len_prefix;
+	}
+
+	return zs;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_zsrc_readn)(uls_zsrc_ptr_t zs, uls_native_vptr_t vptr, int n)
+{
+	char *ptr = (char *) vptr;
+	int  nleft, rc;
+
+	if (n <= 0) {
+		_uls_log(err_log)("%s: invalid parameter n=%d!", __func__, n);
+		return -3;
+	}
+
+	if (zs->flags & ULS_ZSRC_FL_ERR) {
+		return -1;
+	}
+
+	nleft = n;
+	if ((rc = zs->n_pushback) > 0) {
+		if (rc > nleft) rc = nleft;
+		_uls_tool_(memcopy)(ptr, zs->pushback + zs->i_pushback, rc);
+		zs->i_pushback += rc;
+		zs->n_pushback -= rc;
+		nleft -= rc;
+		ptr   += rc;
+	}
+
+	for ( ; nleft > 0; ) {
+		if (zs->n_window <= 0 && !(zs->flags & ULS_ZSRC_FL_EOF)) {
+			if (__zsrc_fill_window(zs) < 0) return -1;
+		}
+
+		if ((rc = __zsrc_decode(zs, ptr, nleft)) < 0) {
+			return -1;
+		}
+
+		if (rc == 0 && zs->n_window <= 0 && (zs->flags & ULS_ZSRC_FL_EOF)) {
+			if (zs->flags & ULS_ZSRC_FL_INSTRM) {
+				_uls_log(err_log)("%s: the compressed stream truncated!", __func__);
+				zs->flags |= ULS_ZSRC_FL_ERR;
+				return -1;
+			}
+			break;
+		}
+
+		nleft -= rc;
+		ptr   += rc;
+	}
+
+	return n - nleft;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_zsrc_unread)(uls_zsrc_ptr_t zs, const char *buf, int len)
+{
+	char *ptr;
+	int  n;
+
+	if (len <= 0) {
+		return 0;
+	}
+
+	n = zs->n_pushback + len;
+	ptr = (char *) _uls_tool_(malloc)(n);
+
+	_uls_tool_(memcopy)(ptr, buf, len);
+	if (zs->n_pushback > 0) {
+		_uls_tool_(memcopy)(ptr + len, zs->pushback + zs->i_pushback, zs->n_pushback);
+	}
+
+	uls_mfree(zs->pushback);
+	zs->pushback = ptr;
+	zs->i_pushback = 0;
+	zs->n_pushback = n;
+
+	return len;
+}
+
+ULS_QUALIFIED_RETTYP(uls_zsrc_ptr_t)
+ULS_QUALIFIED_METHOD(uls_zsrc_create)(int fd, int format)
+{
+	if (fd < 0) {
+		_uls_log(err_log)("%s: invalid parameter!", __func__);
+		return nilptr;
+	}
+
+	if (!uls_zsrc_supported(format)) {
+		_uls_log(err_log)("%s: the compression format %d not supported in this build", __func__, format);
+		return nilptr;
+	}
+
+	return __zsrc_create(fd, format, ULS_ZSRC_FL_WRITE);
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_zsrc_writen)(uls_zsrc_ptr_t zs, uls_native_vptr_t ptr, int n)
+{
+	if (n <= 0) {
+		return 0;
+	}
+
+	if ((zs->flags & ULS_ZSRC_FL_ERR) || __zsrc_encode(zs, (const char *) ptr, n, 0) < 0) {
+		return -1;
+	}
+
+	return n;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_zsrc_close)(uls_zsrc_ptr_t zs)
+{
+	int stat = 0;
+
+	if (zs == nilptr) {
+		return -1;
+	}
+
+	if (zs->flags & ULS_ZSRC_FL_WRITE) {
+		if ((zs->flags & ULS_ZSRC_FL_ERR) || __zsrc_encode(zs, "", 0, 1) < 0 ||
+			__zsrc_flush_window(zs) < 0) {
+			_uls_log(err_log)("%s: failed to finish the compressed file", __func__);
+			stat = -1;
+		}
+	} else if (zs->flags & ULS_ZSRC_FL_ERR) {
+		stat = -1;
+	}
+
+	__zsrc_destroy(zs);
+	return stat;
+}
@@ -173,6 +173,7 @@ ULS_QUALIFIED_METHOD(__uls_unget_str)(uls_lex_ptr_t uls, const char *str, int le
 
 	if (ctx->flags & ULS_CTX_FL_GETTOK_RAW) {
 		if (ctx->flags & ULS_CTX_FL_UNGET_CONTEXT) {
+			__uls_ctx_renew_serial(uls_ptr(uls->xcontext), ctx);
 			if (ctx->line + len <= ctx->lptr) {
 				lptr1 = NULL; len1 = 0;
 				ctx->lptr = ctx->lptr - len;
@@ -224,6 +225,7 @@ ULS_QUALIFIED_METHOD(__uls_unget_quote)(uls_lex_ptr_t uls,
 
 	if (ctx->flags & ULS_CTX_FL_GETTOK_RAW) {
 		if (ctx->flags & ULS_CTX_FL_UNGET_CONTEXT) {
+			__uls_ctx_renew_serial(uls_ptr(uls->xcontext), ctx);
 			if (ctx->i_lexsegs > 0) {
 				--ctx->i_lexsegs;
 				lexseg = uls_get_array_slot_type10(uls_ptr(ctx->lexsegs), ctx->i_lexsegs);
@@ -408,11 +410,181 @@ ULS_QUALIFIED_METHOD(uls_get_ch)(uls_lex_ptr_t uls, uls_nextch_detail_ptr_t deta
 		ctx->tokbuf.buf[0] = '\0';
 		ctx->s_val = ctx->tokbuf.buf;
 		ctx->s_val_len = 0;
+		ctx->l_wtokbuf = -1;
 	}
 
 	return wch;
 }
 
+ULS_DECL_STATIC const char*
+ULS_QUALIFIED_METHOD(__scan_span_in_line)(const char *lptr, const char *charset_map, int until,
+	const char *delim, uls_ptrtype_tool(outparam) parms)
+{
+	int l_delim, n_lfs = 0, found = 0;
+	char ch;
+
+	if (delim != NULL) {
+		l_delim = _uls_tool_(strlen)(delim);
+		for ( ; (ch = *lptr) != '\0'; lptr++) {
+			if (ch == delim[0] && _uls_tool_(strncmp)(lptr, delim, l_delim) == 0) {
+				found = 1;
+				break;
+			}
+			if (ch == '\n') ++n_lfs;
+		}
+	} else {
+		for ( ; (ch = *lptr) != '\0'; lptr++) {
+			if (charset_map[(unsigned char) ch] == until) {
+				found = 1;
+				break;
+			}
+			if (ch == '\n') ++n_lfs;
+		}
+	}
+
+	parms->n += n_lfs;
+	parms->flags = found;
+	return lptr;
+}
+
+ULS_DECL_STATIC const char*
+ULS_QUALIFIED_METHOD(__scan_class_in_line)(uls_lex_ptr_t uls, const char *lptr, int ch_mask,
+	uls_ptrtype_tool(outparam) parms)
+{
+	const char *ch_ctx = uls->ch_context;
+	int n_lfs = 0, found = 0, rc, in_span;
+	uls_wch_t wch;
+	char ch;
+
+	for ( ; (ch = *lptr) != '\0'; lptr += rc) {
+		if ((unsigned char) ch < ULS_SYNTAX_TABLE_SIZE) {
+			in_span = ch_mask != 0 ? (ch_ctx[(int) ch] & ch_mask) != 0 : ch_ctx[(int) ch] == 0;
+			rc = 1;
+		} else if ((ch_mask & ULS_CH_IDFIRST) && (rc = uls_is_char_idfirst(uls, lptr, &wch)) > 0) {
+			in_span = 1;
+		} else if ((rc = _uls_tool_(decode_utf8)(lptr, -1, &wch)) > 0) {
+			in_span = (ch_mask & ULS_CH_ID) && uls_is_char_id(uls, wch);
+		} else {
+			in_span = 0;
+		}
+
+		if (!in_span) {
+			found = 1;
+			break;
+		}
+		if (ch == '\n') ++n_lfs;
+	}
+
+	parms->n += n_lfs;
+	parms->flags = found;
+	return lptr;
+}
+
+ULS_DECL_STATIC int
+ULS_QUALIFIED_METHOD(__uls_scan_span)(uls_lex_ptr_t uls, const char *charset, int ch_mask, int until,
+	const char *delim, uls_ptrtype_tool(outparam) parms)
+{
+	uls_context_ptr_t ctx = uls->xcontext.context;
+	char charset_map[256];
+	const char *lptr, *lptr1;
+	int k = 0, len, rc;
+
+	if (ctx->flags & ULS_CTX_FL_TOKEN_UNGOT) {
+		ctx->flags &= ~ULS_CTX_FL_TOKEN_UNGOT;
+		ctx = __uls_unget_current(uls);
+	}
+
+	if (charset != NULL) {
+		_uls_tool_(bzero)(charset_map, sizeof(charset_map));
+		for ( ; *charset != '\0'; charset++) {
+			charset_map[(unsigned char) *charset] = 1;
+		}
+	}
+
+	parms->n = 0;
+	ctx->tok = uls->xcontext.toknum_NONE;
+	ctx->s_val_len = 0;
+	ctx->l_wtokbuf = -1;
+
+	for ( ; ; ) {
+		lptr = ctx->lptr;
+		if (charset != NULL || delim != NULL) {
+			lptr1 = __scan_span_in_line(lptr, charset_map, until, delim, parms);
+		} else {
+			lptr1 = __scan_class_in_line(uls, lptr, ch_mask, parms);
+		}
+		len = (int) (lptr1 - lptr);
+
+		if (parms->flags || ctx->i_lexsegs < ctx->n_lexsegs) {
+			// stopped by a char of 'charset', 'delim', or a quote-string ahead.
+			ctx->lptr = lptr1;
+			if (parms->flags && delim != NULL) {
+				ctx->lptr += _uls_tool_(strlen)(delim);
+			}
+			break;
+		}
+
+		// The span continues to the next buffer, so save it before refilling.
+		if (len > 0) {
+			k = _uls_tool(str_append)(uls_ptr(ctx->tokbuf), k, lptr, len);
+		}
+		ctx->lptr = lptr1;
+		len = 0;
+
+		if ((rc = uls_clear_and_fillbuff(uls)) < 0) {
+			parms->lptr = ctx->tokbuf.buf;
+			parms->len = 0;
+			return -1;
+		} else if (rc == 0) {
+			break; // EOF
+		}
+	}
+
+	if (k > 0) {
+		if (len > 0) k = _uls_tool(str_append)(uls_ptr(ctx->tokbuf), k, lptr, len);
+		str_putc(uls_ptr(ctx->tokbuf), k, '\0');
+		parms->lptr = ctx->tokbuf.buf;
+		parms->len = k;
+	} else {
+		ctx->tokbuf.buf[0] = '\0';
+		parms->lptr = lptr;
+		parms->len = len;
+	}
+
+	ctx->s_val = ctx->tokbuf.buf;
+	__uls_ctx_inc_lineno(ctx, parms->n);
+
+	return parms->len;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_scan_filtered_while)(uls_lex_ptr_t uls, int ch_mask, uls_ptrtype_tool(outparam) parms)
+{
+	return __uls_scan_span(uls, NULL, ch_mask, 0, NULL, parms);
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_scan_filtered_until)(uls_lex_ptr_t uls, const char *charset, uls_ptrtype_tool(outparam) parms)
+{
+	if (charset == NULL) {
+		_uls_log(err_log)("%s: null charset!", __func__);
+		return -1;
+	}
+
+	return __uls_scan_span(uls, charset, 0, 1, NULL, parms);
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_take_filtered_until)(uls_lex_ptr_t uls, const char *delim, uls_ptrtype_tool(outparam) parms)
+{
+	if (delim == NULL || *delim == '\0') {
+		_uls_log(err_log)("%s: empty delimiter!", __func__);
+		return -1;
+	}
+
+	return __uls_scan_span(uls, NULL, 0, 0, delim, parms);
+}
+
 int
 ULS_QUALIFIED_METHOD(uls_unget_current)(uls_lex_ptr_t uls)
 {
@@ -479,6 +651,7 @@ ULS_QUALIFIED_METHOD(uls_unget_tok)(uls_lex_ptr_t uls, int tok_id, const char *l
 	}
 
 	ctx->l_tokbuf_aux = -1;
+	ctx->l_wtokbuf = -1;
 	uls->tokdef_vx = slots_rsv[NONE_TOK_IDX];
 	uls_mfree(lxm_buff);
 
@@ -530,11 +703,140 @@ ULS_QUALIFIED_METHOD(uls_unget_str)(uls_lex_ptr_t uls, const char *str)
 
 	ctx = __uls_unget_str(uls, str, _uls_tool_(strlen)(str));
 	ctx->l_tokbuf_aux = -1;
+	ctx->l_wtokbuf = -1;
 	uls->tokdef_vx = slots_rsv[NONE_TOK_IDX];
 
 	return 0;
 }
 
+int
+ULS_QUALIFIED_METHOD(uls_mark)(uls_lex_ptr_t uls)
+{
+	uls_xcontext_ptr_t xctx = uls_ptr(uls->xcontext);
+	uls_context_ptr_t ctx = xctx->context;
+	uls_lexmark_ptr_t mark;
+	int k, lxm_size;
+
+	if (xctx->n_lexmarks >= xctx->n_alloc_lexmarks) {
+		xctx->n_alloc_lexmarks = xctx->n_alloc_lexmarks > 0 ? 2 * xctx->n_alloc_lexmarks : 16;
+		xctx->lexmarks = (uls_lexmark_ptr_t) uls_mrealloc(xctx->lexmarks,
+			xctx->n_alloc_lexmarks * sizeof(uls_lexmark_t));
+	}
+
+	if (xctx->n_lexmarks > 0) {
+		mark = xctx->lexmarks + xctx->n_lexmarks - 1;
+		k = mark->lxm_offset + mark->lxm_size;
+	} else {
+		k = 0;
+	}
+
+	// The suffix of NUMBER follows the '\0' of its lexeme.
+	lxm_size = ctx->s_val_len;
+	if (ctx->tok == xctx->toknum_NUMBER) {
+		lxm_size += 1 + _uls_tool_(strlen)(ctx->s_val + lxm_size + 1);
+	}
+
+	_uls_tool(str_modify)(uls_ptr(xctx->lexmark_lxms), k, ctx->s_val, lxm_size);
+	str_putc(uls_ptr(xctx->lexmark_lxms), k + lxm_size, '\0');
+
+	mark = xctx->lexmarks + xctx->n_lexmarks;
+	mark->ctx = ctx;
+	mark->buf_serial = ctx->buf_serial;
+
+	mark->lptr = ctx->lptr;
+	mark->line = ctx->line;
+	mark->line_end = ctx->line_end;
+	mark->tok_lptr = ctx->tok_lptr;
+	mark->i_lexsegs = ctx->i_lexsegs;
+	mark->lineno = ctx->lineno;
+	mark->delta_lineno = ctx->delta_lineno;
+	mark->ctx_flags = ctx->flags & (ULS_CTX_FL_QTOK | ULS_CTX_FL_TOKEN_UNGOT);
+
+	mark->tok = ctx->tok;
+	mark->atom_id = ctx->atom_id;
+	mark->litfrag_flags = ctx->litfrag_flags;
+	mark->s_val_len = ctx->s_val_len;
+	mark->s_val_wchars = ctx->s_val_wchars;
+	mark->n_digits = ctx->n_digits;
+	mark->n_expo = ctx->n_expo;
+	mark->lxm_offset = k;
+	mark->lxm_size = lxm_size + 1;
+	mark->tokdef_vx = uls->tokdef_vx;
+
+	return xctx->n_lexmarks++;
+}
+
+int
+ULS_QUALIFIED_METHOD(uls_rewind)(uls_lex_ptr_t uls, int mark_id)
+{
+	uls_xcontext_ptr_t xctx = uls_ptr(uls->xcontext);
+	uls_context_ptr_t ctx;
+	uls_lexmark_ptr_t mark;
+
+	if (mark_id < 0 || mark_id >= xctx->n_lexmarks) {
+		_uls_log(err_log)("%s: invalid mark %d!", __func__, mark_id);
+		return -1;
+	}
+	mark = xctx->lexmarks + mark_id;
+
+	// The contexts pushed after the mark are dropped, the marked one must be intact.
+	for (ctx = xctx->context; ctx != nilptr; ctx = ctx->prev) {
+		if (ctx == mark->ctx) break;
+	}
+
+	// The filling of the mark may be one kept after it was read on.
+	if (ctx == nilptr || uls_context_show_fill(ctx, mark->buf_serial) < 0) {
+		return -1;
+	}
+
+	while (xctx->context != ctx) {
+		uls_pop(uls);
+	}
+
+	// The tokens pending in the stages are of the text after the mark.
+	if (uls->tokpipe != nilptr) {
+		uls_tokpipe_drop(uls->tokpipe);
+	}
+
+	ctx->lptr = mark->lptr;
+	ctx->line = mark->line;
+	ctx->line_end = mark->line_end;
+	ctx->tok_lptr = mark->tok_lptr;
+	ctx->i_lexsegs = mark->i_lexsegs;
+	ctx->lineno = mark->lineno;
+	ctx->delta_lineno = mark->delta_lineno;
+	ctx->flags &= ~(ULS_CTX_FL_QTOK | ULS_CTX_FL_TOKEN_UNGOT | ULS_CTX_FL_EXTERN_TOKBUF);
+	ctx->flags |= mark->ctx_flags;
+
+	_uls_tool(str_modify)(uls_ptr(ctx->tokbuf), 0,
+		xctx->lexmark_lxms.buf + mark->lxm_offset, mark->lxm_size);
+	ctx->s_val = ctx->tokbuf.buf;
+
+	ctx->tok = mark->tok;
+	ctx->atom_id = mark->atom_id;
+	ctx->litfrag_flags = mark->litfrag_flags;
+	ctx->s_val_len = mark->s_val_len;
+	ctx->s_val_wchars = mark->s_val_wchars;
+	ctx->n_digits = mark->n_digits;
+	ctx->n_expo = mark->n_expo;
+	ctx->l_tokbuf_aux = -1;
+	ctx->l_wtokbuf = -1;
+	uls->tokdef_vx = mark->tokdef_vx;
+
+	xctx->n_lexmarks = mark_id + 1;
+	return 0;
+}
+
+void
+ULS_QUALIFIED_METHOD(uls_release_mark)(uls_lex_ptr_t uls, int mark_id)
+{
+	uls_xcontext_ptr_t xctx = uls_ptr(uls->xcontext);
+
+	if (mark_id >= 0 && mark_id < xctx->n_lexmarks) {
+		xctx->n_lexmarks = mark_id;
+	}
+}
+
 int
 ULS_QUALIFIED_METHOD(ulsjava_unget_str)(uls_lex_ptr_t uls, const uls_native_vptr_t str, int len_str)
 {
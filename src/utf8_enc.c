@@ -39,28 +39,83 @@
 #include "uls/uls_log.h"
 #endif
 
-char*
-ULS_QUALIFIED_METHOD(uls_enc_utf16str_to_utf8str)(uls_uint16 *wstr1, int l_wstr1, uls_outparam_ptr_t parms)
+// Transcodes the UTF-16 code units straight into 'utf8buf' until it's full.
+// Returns the # of bytes put and the # of the code units consumed in *p_l_wstr, -1 if malformed.
+int
+ULS_QUALIFIED_METHOD(uls_utf16_to_utf8buf)(const uls_uint16 *wstr, int l_wstr, char *utf8buf, int siz_utf8buf, int *p_l_wstr)
 {
-	char *utf_chrs, *buff_chrs;
-	int i, rc, l_buff_chrs, siz_buff_chrs;
+	char *outptr = utf8buf, *outptr_end = utf8buf + siz_utf8buf;
+	int i, rc;
 	uls_wch_t wch;
 
-	if (wstr1 == NULL || l_wstr1 <= 0) return NULL;
+	for (i=0; i < l_wstr; i += rc) {
+		if ((wch = wstr[i]) < 0x80) {
+			if (outptr >= outptr_end) break;
+			*outptr++ = (char) wch;
+			rc = 1;
+			continue;
+		}
 
-	siz_buff_chrs = 4 * l_wstr1 + 1;
-	buff_chrs = utf_chrs = (char *) uls_malloc(siz_buff_chrs);
+		if ((rc = uls_decode_utf16(wstr + i, l_wstr - i, &wch)) <= 0) {
+			if (rc < -ULS_UTF16_CH_MAXLEN) return -1;
+			break; // a surrogate pair cut at the end
+		}
 
-	for (i=0; i < l_wstr1; i += rc) {
-		if ((rc = uls_decode_utf16(wstr1 + i, l_wstr1 - i, &wch)) <= 0) {
-			_uls_log(err_log)("Incorrect UTF-16 format!");
-			uls_mfree(buff_chrs);
-			return NULL;
+		if (outptr + uls_encode_utf8(wch, NULL, -1) > outptr_end) break;
+		outptr += uls_encode_utf8(wch, outptr, -1);
+	}
+
+	if (p_l_wstr != NULL) *p_l_wstr = i;
+	return (int) (outptr - utf8buf);
+}
+
+// Returns the # of the UTF-16 code units of the utf-8 string, putting as many of them as fit in 'wbuf'.
+int
+ULS_QUALIFIED_METHOD(uls_utf8_to_utf16buf)(const char *str, int len, uls_uint16 *wbuf, int siz_wbuf)
+{
+	const char *lptr = str, *lptr_end = str + len;
+	uls_uint16 tmpbuf[ULS_UTF16_CH_MAXLEN];
+	int j, k = 0, rc;
+	uls_wch_t wch;
+
+	while (lptr < lptr_end) {
+		if ((wch = (unsigned char) *lptr) < 0x80) {
+			if (wbuf != NULL && k < siz_wbuf) wbuf[k] = (uls_uint16) wch;
+			++k; ++lptr;
+			continue;
+		}
+
+		if ((rc = uls_decode_utf8(lptr, (int) (lptr_end - lptr), &wch)) <= 0) {
+			return -1;
+		}
+		lptr += rc;
+
+		rc = uls_encode_utf16(wch, tmpbuf, ULS_UTF16_CH_MAXLEN);
+		for (j=0; j < rc; j++, k++) {
+			if (wbuf != NULL && k < siz_wbuf) wbuf[k] = tmpbuf[j];
 		}
-		utf_chrs += uls_encode_utf8(wch, utf_chrs, -1);
 	}
 
-	l_buff_chrs = (int) (utf_chrs - buff_chrs);
+	return k;
+}
+
+char*
+ULS_QUALIFIED_METHOD(uls_enc_utf16str_to_utf8str)(uls_uint16 *wstr1, int l_wstr1, uls_outparam_ptr_t parms)
+{
+	char *buff_chrs;
+	int l_buff_chrs, siz_buff_chrs;
+
+	if (wstr1 == NULL || l_wstr1 <= 0) return NULL;
+
+	// A code unit takes 3 bytes at most in utf-8, a surrogate pair 4 bytes.
+	siz_buff_chrs = 3 * l_wstr1 + 1;
+	buff_chrs = (char *) uls_malloc(siz_buff_chrs);
+
+	if ((l_buff_chrs = uls_utf16_to_utf8buf(wstr1, l_wstr1, buff_chrs, siz_buff_chrs - 1, NULL)) < 0) {
+		_uls_log(err_log)("Incorrect UTF-16 format!");
+		uls_mfree(buff_chrs);
+		return NULL;
+	}
 	buff_chrs[l_buff_chrs] = '\0';
 
 	if (parms != nilptr) {
@@ -139,6 +194,33 @@ ULS_QUALIFIED_METHOD(uls_fill_utf8buf)(uls_utf_inbuf_ptr_t inp, char *utf8buf, i
 	int i, rc, n_words, n_bytes, n_uchbuf;
 	uls_wch_t *uchbuf, wch;
 
+	if (inp->enc_rawbuf != nilptr && inp->wch_buffered == 0) {
+		// No need to decode into uls_wch_t's before encoding them again.
+		for ( ; len_utf8buf < siz_utf8buf; len_utf8buf += rc) {
+			if (inp->n_wrds < 4 && inp->fill_rawbuf(inp) < 0) {
+				_uls_log(err_log)("Can't read input!!");
+				return -1;
+			}
+
+			if (inp->n_wrds <= 0) {
+				break;
+			}
+
+			if ((rc = inp->enc_rawbuf(inp, utf8buf + len_utf8buf, siz_utf8buf - len_utf8buf)) < 0) {
+				return -1;
+			} else if (rc == 0) {
+				if (siz_utf8buf - len_utf8buf >= ULS_UTF8_CH_MAXLEN) {
+					_uls_log(err_log)("I/O error at EOF, file truncated or encoding error!?");
+					inp->is_eof = -1;
+					return -1;
+				}
+				break;
+			}
+		}
+
+		return len_utf8buf - len0_utf8buf;
+	}
+
 	while (1) {
 		i = uls_roundup(len_utf8buf, wrdsiz);
 		if (i + ULS_UTF8_CH_MAXLEN > siz_utf8buf) {
@@ -260,6 +342,7 @@ void
 ULS_QUALIFIED_METHOD(uls_utf_set_inbuf)(uls_utf_inbuf_ptr_t inp, int fd)
 {
 	inp->fd = fd;
+	inp->zsrc = nilptr;
 	inp->is_eof = 0;
 	inp->n_wrds = 0;
 	inp->wch_buffered = 0;
@@ -274,18 +357,22 @@ ULS_QUALIFIED_METHOD(uls_utf_reset_inbuf)(uls_utf_inbuf_ptr_t inp, int mode)
 	if (enc_fmt == UTF_INPUT_FORMAT_8) {
 		inp->fill_rawbuf = uls_ref_callback_this(fill_utf8_buf);
 		inp->dec_rawbuf = uls_ref_callback_this(dec_utf8_buf);
+		inp->enc_rawbuf = nilptr;
 
 	} else if (enc_fmt == UTF_INPUT_FORMAT_16) {
 		inp->fill_rawbuf = uls_ref_callback_this(fill_utf16_buf);
 		inp->dec_rawbuf = uls_ref_callback_this(dec_utf16_buf);
+		inp->enc_rawbuf = uls_ref_callback_this(enc_utf16_buf);
 
 	} else if (enc_fmt == UTF_INPUT_FORMAT_32) {
 		inp->fill_rawbuf = uls_ref_callback_this(fill_utf32_buf);
 		inp->dec_rawbuf = uls_ref_callback_this(dec_utf32_buf);
+		inp->enc_rawbuf = nilptr;
 
 	} else {
 		inp->fill_rawbuf = nilptr;
 		inp->dec_rawbuf = nilptr;
+		inp->enc_rawbuf = nilptr;
 	}
 
 	inp->reverse = reverse;
@@ -293,6 +380,7 @@ ULS_QUALIFIED_METHOD(uls_utf_reset_inbuf)(uls_utf_inbuf_ptr_t inp, int mode)
 	inp->n_wrds = 0;
 
 	inp->fd = -1;
+	inp->zsrc = nilptr;
 	inp->is_eof = 0;
 }
 
@@ -331,6 +419,16 @@ ULS_QUALIFIED_METHOD(uls_utf_drain_inbuf)(uls_utf_inbuf_ptr_t inp, uls_wch_t *bu
 	return buflen;
 }
 
+ULS_DECL_STATIC int
+ULS_QUALIFIED_METHOD(__utf_readn_inbuf)(uls_utf_inbuf_ptr_t inp, uls_native_vptr_t ptr, int n)
+{
+	if (inp->zsrc != nilptr) {
+		return _uls_tool_(zsrc_readn)(inp->zsrc, ptr, n);
+	}
+
+	return uls_readn(inp->fd, ptr, n);
+}
+
 ULS_DECL_STATIC int
 ULS_QUALIFIED_METHOD(fill_utf8_buf)(uls_utf_inbuf_ptr_t inp)
 {
@@ -349,7 +447,7 @@ ULS_QUALIFIED_METHOD(fill_utf8_buf)(uls_utf_inbuf_ptr_t inp)
 	}
 
 	codpnts = inp->bytesbuf + inp->n_wrds;
-	if ((rc = uls_readn(inp->fd, codpnts, n_wrds_req)) < 0) {
+	if ((rc = __utf_readn_inbuf(inp, codpnts, n_wrds_req)) < 0) {
 		_uls_log(err_log)("IO error or segmented utf16-char at EOF!");
 		inp->is_eof = -1;
 		return -1;
@@ -408,7 +506,7 @@ ULS_QUALIFIED_METHOD(fill_utf16_buf)(uls_utf_inbuf_ptr_t inp)
 	}
 
 	codpnts = (uls_uint16 *) (inp->bytesbuf + inp->n_wrds * wrdsiz);
-	if ((rc = uls_readn(inp->fd, codpnts, n_wrds_req*wrdsiz)) == 0) {
+	if ((rc = __utf_readn_inbuf(inp, codpnts, n_wrds_req*wrdsiz)) == 0) {
 		inp->is_eof = 1;
 	} else if (rc < 0 || rc % wrdsiz != 0) { // 2-bytes ~ utf16
 		_uls_log(err_log)("IO error or segmented utf16-char at EOF!");
@@ -456,6 +554,24 @@ ULS_QUALIFIED_METHOD(dec_utf16_buf)(uls_utf_inbuf_ptr_t inp, uls_wch_t* out_buf,
 	return n_uchs;
 }
 
+ULS_DECL_STATIC int
+ULS_QUALIFIED_METHOD(enc_utf16_buf)(uls_utf_inbuf_ptr_t inp, char *utf8buf, int siz_utf8buf)
+{
+	int n_bytes, n_codpnts;
+
+	if ((n_bytes = uls_utf16_to_utf8buf((uls_uint16 *) inp->wrdptr, inp->n_wrds,
+		utf8buf, siz_utf8buf, &n_codpnts)) < 0) {
+		_uls_log(err_log)("Incorrect utf-16 format!");
+		inp->is_eof = -1;
+		return -1;
+	}
+
+	inp->wrdptr += n_codpnts * sizeof(uls_uint16);
+	inp->n_wrds -= n_codpnts;
+
+	return n_bytes;
+}
+
 ULS_DECL_STATIC int
 ULS_QUALIFIED_METHOD(fill_utf32_buf)(uls_utf_inbuf_ptr_t inp)
 {
@@ -475,7 +591,7 @@ ULS_QUALIFIED_METHOD(fill_utf32_buf)(uls_utf_inbuf_ptr_t inp)
 	}
 
 	codpnts = (uls_uint32 *) (inp->bytesbuf + inp->n_wrds * wrdsiz);
-	if ((rc = uls_readn(inp->fd, codpnts, n_wrds_req*wrdsiz)) == 0) {
+	if ((rc = __utf_readn_inbuf(inp, codpnts, n_wrds_req*wrdsiz)) == 0) {
 		inp->is_eof = 1;
 	} else if (rc < 0 || rc % wrdsiz != 0) {
 		_uls_log(err_log)("IO error or segmented utf32-char at EOF!");
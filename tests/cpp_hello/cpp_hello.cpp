@@ -476,6 +476,64 @@ cpp_test_dumptok(UlsLex *lex)
 	return 0;
 }
 
+int
+test_token_range(UlsLex *lex, tstring& input_file)
+{
+	std::string lxm;
+	int n = 0;
+
+	lex->pushFile(input_file);
+
+	for (const UlsToken& tok : lex->tokens()) {
+		// The token and the copying wrapper must agree.
+		lex->UlsLexUStr::getTokStr(lxm);
+		if (tok.str() != lxm) {
+			ult_log(_T("mismatched lexeme at line %d"), tok.lineno);
+			return -1;
+		}
+#if __cplusplus >= 201703L
+		if (tok.view() != lxm || lex->getTokView() != tok.view()) {
+			ult_log(_T("mismatched view at line %d"), tok.lineno);
+			return -1;
+		}
+#endif
+
+		ult_printf(_T("%3d: [%4d] %2d "), tok.lineno, tok.tok_id, tok.n_wchars);
+		ult_putstr(tok.str().c_str());
+		ult_printf(_T("\n"));
+		++n;
+	}
+
+	ult_printf(_T("%d tokens, last tok=%d\n"), n, lex->getTokNum());
+	return 0;
+}
+
+// The wide lexemes are converted from as many bytes as the token has.
+int
+test_wtoken_range(tstring& input_file)
+{
+	UlsLexAWStr *wlex = new UlsLexAWStr(L"dumptoks.ulc");
+	std::wstring wlxm;
+	int n = 0, n_diffs = 0;
+
+	wlex->pushFile(std::wstring(input_file.begin(), input_file.end()));
+
+	for (const UlsToken& tok : wlex->tokens()) {
+		wlex->getTokStr(wlxm);
+		if ((int) wlxm.size() != tok.n_wchars) {
+			ult_log(_T("the wide lexeme at line %d has %d chars, not %d"),
+				tok.lineno, (int) wlxm.size(), tok.n_wchars);
+			++n_diffs;
+		}
+		++n;
+	}
+
+	ult_printf(_T("%d wide tokens, %d differ\n"), n, n_diffs);
+	delete wlex;
+
+	return n_diffs > 0 ? -1 : 0;
+}
+
 void
 test_awstr_api(UlsLex *lex1, int lex_no, int file_idx, int n)
 {
@@ -571,6 +629,14 @@ _tmain(int n_targv, LPTSTR *targv)
 		}
 		break;
 
+	case 6:
+		if (input_fpath != NULL) {
+			if ((stat = test_token_range(sample1_lex, *input_fpath)) >= 0) {
+				stat = test_wtoken_range(*input_fpath);
+			}
+		}
+		break;
+
 	default:
 		break;
 	}
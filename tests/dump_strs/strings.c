@@ -291,6 +291,165 @@ test_uls_3(uls_lex_ptr_t uls, LPCTSTR fpath)
 	return stat;
 }
 
+#define LITSTR_CHUNKSIZ  64
+#define LITSTR_FEEDSIZ   7
+
+typedef struct {
+	int tok, lineno, len;
+	char *str;
+} litstr_t;
+
+static int
+collect_litstrs(LPCTSTR fpath, litstr_t *lits, int n_alloc_lits)
+{
+	uls_lex_ptr_t uls;
+	int tok, n_lits = 0;
+
+	if ((uls = uls_create(config_name)) == NULL) {
+		return -1;
+	}
+
+	uls_push_file(uls, fpath, 0);
+
+	for ( ; (tok = uls_get_tok(uls)) != TOK_EOI && tok != TOK_ERR; ) {
+		if (!uls_is_quote(uls) || n_lits >= n_alloc_lits) continue;
+
+		lits[n_lits].tok = tok;
+		lits[n_lits].lineno = uls_get_lineno(uls);
+		lits[n_lits].len = uls_lexeme_len(uls);
+		lits[n_lits].str = uls_strdup(uls_lexeme(uls), uls_lexeme_len(uls));
+		++n_lits;
+	}
+
+	uls_destroy(uls);
+	return n_lits;
+}
+
+/*
+ * Joins the fragments of the literal strings against 'lits'.
+ * If 'buf' is given, the input is fed by LITSTR_FEEDSIZ bytes when starved.
+ */
+static int
+join_litstr_chunks(uls_lex_ptr_t uls, litstr_t *lits, int n_lits, const char *buf, int len_buf)
+{
+	char *joined = NULL;
+	int len_joined = 0, siz_joined = 0, len, max_len = 0;
+	int tok, flags, i = 0, n, i_lit = 0, in_lit = 0, lno = 0;
+	int n_frags = 0, n_diffs = 0, n_starved = 0;
+	litstr_t *lit;
+
+	for ( ; ; ) {
+		tok = uls_get_tok(uls);
+		if (tok == TOK_EOI) break;
+
+		if (buf != NULL && uls_is_starved(uls)) {
+			if (i < len_buf) {
+				if ((n = len_buf - i) > LITSTR_FEEDSIZ) n = LITSTR_FEEDSIZ;
+				uls_feed(uls, buf + i, n);
+				i += n;
+			} else {
+				uls_feed_end(uls);
+			}
+			if (in_lit) ++n_starved;
+			continue;
+		}
+
+		if (tok == TOK_ERR) {
+			err_log(_T("ErrorToken: %s"), uls_lexeme(uls));
+			break;
+		}
+
+		if (!uls_is_quote(uls)) continue;
+
+		flags = uls_litstr_fragment(uls);
+		if (flags & ULS_LITFRAG_FIRST) {
+			if (in_lit || (flags & ULS_LITFRAG_MIDDLE)) ++n_diffs;
+			in_lit = 1;
+			len_joined = n_frags = 0;
+			lno = uls_get_lineno(uls);
+		} else if (!in_lit || (flags & (ULS_LITFRAG_MIDDLE | ULS_LITFRAG_LAST)) == 0) {
+			uls_printf(_T("#%-2d: bad fragment 0x%x\n"), uls_get_lineno(uls), flags);
+			++n_diffs;
+			continue;
+		}
+
+		if ((len = uls_lexeme_len(uls)) > max_len) max_len = len;
+		if (len_joined + len + 1 > siz_joined) {
+			siz_joined = len_joined + len + 1 + 128;
+			joined = (char *) uls_mrealloc(joined, siz_joined);
+		}
+		memcpy(joined + len_joined, uls_lexeme(uls), len);
+		len_joined += len;
+		++n_frags;
+
+		if ((flags & ULS_LITFRAG_LAST) == 0) continue;
+		in_lit = 0;
+
+		if (i_lit >= n_lits) {
+			uls_printf(_T("#%-2d: no literal string to compare\n"), lno);
+			++n_diffs;
+			continue;
+		}
+
+		lit = lits + i_lit++;
+		uls_printf(_T("#%-2d: <%3d> %3d bytes in %d fragment(s)"), lno, tok, len_joined, n_frags);
+		if (tok != lit->tok || lno != lit->lineno || len_joined != lit->len ||
+			memcmp(joined, lit->str, len_joined) != 0) {
+			uls_printf(_T(", differs from <%3d> #%d"), lit->tok, lit->lineno);
+			++n_diffs;
+		}
+		uls_printf(_T("\n"));
+	}
+
+	if (in_lit || i_lit != n_lits) ++n_diffs;
+	uls_printf(_T("%d literal strings, the longest fragment %d bytes, %d differ\n"),
+		i_lit, max_len, n_diffs);
+	if (buf != NULL) uls_printf(_T("starved in a literal string: %s\n"), n_starved > 0 ? "yes" : "no");
+
+	uls_mfree(joined);
+	return n_diffs;
+}
+
+int
+test_litstr_chunks(uls_lex_ptr_t uls, LPCTSTR fpath)
+{
+	litstr_t lits[64];
+	char *buf;
+	FILE *fp;
+	int i, n_lits, len_buf;
+
+	if ((n_lits = collect_litstrs(fpath, lits, 64)) < 0) {
+		err_log(_T("can't get the literal strings of %s"), fpath);
+		return -1;
+	}
+
+	if ((fp = uls_fp_open(fpath, ULS_FIO_READ | ULS_FIO_NO_UTF8BOM)) == NULL) {
+		err_log(_T("can't open the file '%s'"), fpath);
+		return -1;
+	}
+
+	buf = (char *) uls_malloc(64 * 1024);
+	len_buf = (int) fread(buf, 1, 64 * 1024, fp);
+	uls_fp_close(fp);
+
+	uls_set_litstr_chunk(uls, LITSTR_CHUNKSIZ);
+
+	uls_printf(_T("file:\n"));
+	uls_push_file(uls, fpath, 0);
+	join_litstr_chunks(uls, lits, n_lits, NULL, 0);
+
+	uls_printf(_T("feed:\n"));
+	uls_push_feed(uls, 0);
+	join_litstr_chunks(uls, lits, n_lits, buf, len_buf);
+
+	for (i = 0; i < n_lits; i++) {
+		uls_mfree(lits[i].str);
+	}
+	uls_mfree(buf);
+
+	return 0;
+}
+
 int
 _tmain(int n_targv, LPTSTR *targv)
 {
@@ -324,6 +483,9 @@ _tmain(int n_targv, LPTSTR *targv)
 	case 3:
 		test_uls_3(sample_lex, input_file);
 		break;
+	case 4:
+		test_litstr_chunks(sample_lex, input_file);
+		break;
 	default:
 		break;
 	}
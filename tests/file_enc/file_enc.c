@@ -34,10 +34,12 @@
 
 
 #include "uls/uls_lex.h"
+#include "uls/uls_ostream.h"
 #include "uls/uls_fileio.h"
 #include "uls/uls_auw.h"
 #include "uls/uls_util.h"
 #include "uls/uls_log.h"
+#include "uls/utf8_enc.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -217,6 +219,299 @@ test_uls_strings_2(uls_lex_ptr_t uls, LPTSTR fpath)
 	uls_fp_close(fp);
 }
 
+void
+test_dump_gz(uls_lex_ptr_t uls, LPTSTR fpath)
+{
+	LPCTSTR tokstr;
+	int t;
+
+	// The gzip-compressed is recognized by its magic bytes, not by the file name.
+	if (uls_push_file(uls, fpath, 0) < 0) {
+		err_log(_T("can't set the input '%s' to uls"), fpath);
+		return;
+	}
+
+	for ( ; ; ) {
+		t = uls_get_tok(uls);
+		tokstr = uls_tokstr(uls);
+
+		if (t == TOK_ERR) {
+			err_log(_T("ErrorToken: %s"), tokstr);
+			break;
+		}
+
+		if (t == TOK_EOI) {
+			break;
+		}
+
+		uls_printf(_T("#%d(%6d) : %s\n"), uls_get_lineno(uls), t, tokstr);
+	}
+}
+
+void
+test_uls_stream_gz(uls_lex_ptr_t uls, LPTSTR fpath)
+{
+	LPCTSTR out_file = _T("file_enc_out.uls.gz");
+	uls_ostream_ptr_t ostr;
+
+	if (uls_push_file(uls, fpath, 0) < 0) {
+		err_log(_T("can't set the input '%s' to uls"), fpath);
+		return;
+	}
+
+	if ((ostr = uls_create_ostream_file(out_file, uls, _T("<<file_enc>>"))) == NULL) {
+		err_log(_T("can't create the output '%s'"), out_file);
+		return;
+	}
+
+	if (uls_start_stream(ostr, ULS_LINE_NUMBERING) < 0) {
+		err_log(_T("fail to write the stream '%s'"), out_file);
+	}
+	uls_destroy_ostream(ostr);
+
+	test_dump_gz(uls, (LPTSTR) out_file);
+	uls_unlink(out_file);
+}
+
+#define N_WLXM_BUF 128
+
+// Encodes the code points of the lexeme in UTF-16 apart from the library to have the reference.
+static int
+utf16_of_wchs(const uls_wch_t *wchs, int n_wchs, uls_uint16 *wbuf)
+{
+	int i, k = 0;
+	uls_wch_t wch;
+
+	for (i=0; i < n_wchs; i++) {
+		if ((wch = wchs[i]) >= 0x10000) {
+			wch -= 0x10000;
+			wbuf[k++] = (uls_uint16) (0xD800 | (wch >> 10));
+			wbuf[k++] = (uls_uint16) (0xDC00 | (wch & 0x3FF));
+		} else {
+			wbuf[k++] = (uls_uint16) wch;
+		}
+	}
+
+	return k;
+}
+
+static int
+check_wlexeme(uls_lex_ptr_t uls, const uls_wch_t *wchs, int n_wchs, const uls_uint16 *ref16, int n16)
+{
+	const wchar_t *wlxm;
+	int i, wlen;
+
+	if ((wlxm = uls_wlexeme(uls, &wlen)) == NULL) {
+		return -1;
+	}
+
+	if (sizeof(wchar_t) == sizeof(uls_uint16)) {
+		if (wlen != n16) return -1;
+		for (i=0; i < n16; i++) {
+			if ((uls_uint16) wlxm[i] != ref16[i]) return -1;
+		}
+	} else {
+		if (wlen != n_wchs) return -1;
+		for (i=0; i < n_wchs; i++) {
+			if ((uls_wch_t) wlxm[i] != wchs[i]) return -1;
+		}
+	}
+
+	return wlxm[wlen] == L'\0' ? 0 : -1;
+}
+
+// Checks the UTF-16 of the lexeme got with a full and a short buffer, which keeps the rest of it untouched.
+static int
+check_utf16_lexeme(uls_lex_ptr_t uls, const char *lxm, int len, const uls_uint16 *ref16, int n16)
+{
+	uls_uint16 wbuf[N_WLXM_BUF + 1];
+	int siz;
+
+	if (uls_lexeme_utf16(uls, NULL, 0) != n16 || uls_utf8_to_utf16buf(lxm, len, NULL, 0) != n16) {
+		return -1;
+	}
+
+	if (uls_lexeme_utf16(uls, wbuf, N_WLXM_BUF) != n16 ||
+		memcmp(wbuf, ref16, n16 * sizeof(uls_uint16)) != 0) {
+		return -1;
+	}
+
+	if (uls_utf8_to_utf16buf(lxm, len, wbuf, N_WLXM_BUF) != n16 ||
+		memcmp(wbuf, ref16, n16 * sizeof(uls_uint16)) != 0) {
+		return -1;
+	}
+
+	if ((siz = n16 - 1) <= 0) return 0;
+
+	wbuf[siz] = 0xFFFF;
+	if (uls_lexeme_utf16(uls, wbuf, siz) != n16 || wbuf[siz] != 0xFFFF ||
+		memcmp(wbuf, ref16, siz * sizeof(uls_uint16)) != 0) {
+		return -1;
+	}
+
+	wbuf[siz] = 0xFFFF;
+	if (uls_utf8_to_utf16buf(lxm, len, wbuf, siz) != n16 || wbuf[siz] != 0xFFFF ||
+		memcmp(wbuf, ref16, siz * sizeof(uls_uint16)) != 0) {
+		return -1;
+	}
+
+	return 0;
+}
+
+// Converts the UTF-16 back to utf-8 into a full and a short buffer, and with the last surrogate pair cut.
+static int
+check_utf16_to_utf8(const char *lxm, int len, const uls_uint16 *ref16, int n16)
+{
+	char buf[ULS_UTF8_CH_MAXLEN * N_WLXM_BUF];
+	int n_bytes, l_wstr;
+
+	n_bytes = uls_utf16_to_utf8buf(ref16, n16, buf, sizeof(buf), &l_wstr);
+	if (n_bytes != len || l_wstr != n16 || memcmp(buf, lxm, len) != 0) {
+		return -1;
+	}
+
+	if (len > 0) {
+		// The char which doesn't fit is left out as a whole.
+		n_bytes = uls_utf16_to_utf8buf(ref16, n16, buf, len - 1, &l_wstr);
+		if (n_bytes >= len || l_wstr >= n16 || memcmp(buf, lxm, n_bytes) != 0 ||
+			uls_utf8_to_utf16buf(lxm, n_bytes, NULL, 0) != l_wstr) {
+			return -1;
+		}
+	}
+
+	if (n16 >= 2 && (ref16[n16 - 1] & 0xFC00) == 0xDC00) {
+		n_bytes = uls_utf16_to_utf8buf(ref16, n16 - 1, buf, sizeof(buf), &l_wstr);
+		if (n_bytes != len - 4 || l_wstr != n16 - 2 || memcmp(buf, lxm, n_bytes) != 0) {
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+void
+test_wide_lexemes(uls_lex_ptr_t uls, LPTSTR fpath)
+{
+	uls_wch_t wchs[N_WLXM_BUF];
+	uls_uint16 ref16[2 * N_WLXM_BUF];
+	const char *lxm;
+	int t, i, rc, len, n_wchs, n16;
+	int n_toks = 0, n_pairs = 0, n_differ = 0, differ;
+
+	if (uls_push_file(uls, fpath, 0) < 0) {
+		err_log(_T("can't set the input '%s' to uls"), fpath);
+		return;
+	}
+
+	uls_want_wlexeme(uls, 1);
+
+	for ( ; ; ) {
+		t = uls_get_tok(uls);
+		if (t == TOK_ERR) {
+			err_log(_T("ErrorToken: %s"), uls_tokstr(uls));
+			break;
+		}
+
+		if (t == TOK_EOI) {
+			break;
+		}
+
+		lxm = uls_lexeme(uls);
+		len = uls_lexeme_len(uls);
+
+		for (i = n_wchs = 0; i < len && n_wchs < N_WLXM_BUF; i += rc) {
+			if ((rc = uls_decode_utf8(lxm + i, len - i, wchs + n_wchs)) <= 0) break;
+			++n_wchs;
+		}
+
+		if (i < len) {
+			differ = 1;
+			n16 = -1;
+		} else {
+			n16 = utf16_of_wchs(wchs, n_wchs, ref16);
+			differ = check_wlexeme(uls, wchs, n_wchs, ref16, n16) < 0 ||
+				check_utf16_lexeme(uls, lxm, len, ref16, n16) < 0 ||
+				check_utf16_to_utf8(lxm, len, ref16, n16) < 0;
+		}
+
+		if (n16 > n_wchs) ++n_pairs;
+		if (differ) ++n_differ;
+		++n_toks;
+
+		if (opt_verbose || differ) {
+			uls_printf(_T("#%d: %d bytes, %d chars, %d utf-16 units%s\n"),
+				uls_get_lineno(uls), len, n_wchs, n16, differ ? _T(" differ") : _T(""));
+		}
+	}
+
+	uls_want_wlexeme(uls, 0);
+	uls_printf(_T("%d tokens, %d with surrogate pairs, %d differ\n"), n_toks, n_pairs, n_differ);
+}
+
+// The lexemes of the UTF-16 source are its spans but those of the literal strings.
+void
+test_utf16_spans(uls_lex_ptr_t uls, LPTSTR fpath)
+{
+	uls_uint16 wbuf[N_WLXM_BUF], *wsrc;
+	const uls_uint16 *span;
+	char buf[4096];
+	int t, len, l_wsrc, wlen, n16;
+	int n_toks = 0, n_spans = 0, n_differ = 0, differ;
+	FILE *fp;
+
+	if ((fp = uls_fp_open(fpath, ULS_FIO_READ | ULS_FIO_NO_UTF8BOM)) == NULL) {
+		err_log(_T("can't open the file '%s'"), fpath);
+		return;
+	}
+	len = (int) fread(buf, 1, sizeof(buf), fp);
+	uls_fp_close(fp);
+
+	l_wsrc = uls_utf8_to_utf16buf(buf, len, NULL, 0);
+	wsrc = (uls_uint16 *) malloc((l_wsrc + 1) * sizeof(uls_uint16));
+	uls_utf8_to_utf16buf(buf, len, wsrc, l_wsrc);
+
+	if (uls_push_utf16_source(uls, wsrc, l_wsrc) < 0) {
+		err_log(_T("can't set the input '%s' to uls"), fpath);
+		free(wsrc);
+		return;
+	}
+
+	for ( ; ; ) {
+		t = uls_get_tok(uls);
+		if (t == TOK_ERR) {
+			err_log(_T("ErrorToken: %s"), uls_tokstr(uls));
+			break;
+		}
+
+		if (t == TOK_EOI) {
+			break;
+		}
+
+		n16 = uls_lexeme_utf16(uls, wbuf, N_WLXM_BUF);
+		if ((span = uls_lexeme_utf16_span(uls, &wlen)) != NULL) {
+			differ = span < wsrc || span + wlen > wsrc + l_wsrc || wlen != n16 ||
+				memcmp(span, wbuf, wlen * sizeof(uls_uint16)) != 0;
+			++n_spans;
+		} else {
+			// The literal strings and the numbers are copied, whose lexemes are made from the source.
+			differ = t != TOK_SQUOTE && t != TOK_DQUOTE && t != TOK_NUMBER && n16 > 0;
+		}
+
+		if (differ) ++n_differ;
+		++n_toks;
+
+		if (opt_verbose || differ) {
+			uls_printf(_T("#%d: %d, %s%s\n"), uls_get_lineno(uls), t,
+				span != NULL ? _T("span") : _T("copied"), differ ? _T(" differ") : _T(""));
+		}
+	}
+
+	uls_pop(uls);
+	free(wsrc);
+
+	uls_printf(_T("%d tokens, %d spans, %d differ\n"), n_toks, n_spans, n_differ);
+}
+
 int
 _tmain(int n_targv, LPTSTR *targv)
 {
@@ -247,6 +542,18 @@ _tmain(int n_targv, LPTSTR *targv)
 	case 2:
 		test_uls_strings_2(sample_lex, input_file);
 		break;
+	case 3:
+		test_dump_gz(sample_lex, input_file);
+		break;
+	case 4:
+		test_uls_stream_gz(sample_lex, input_file);
+		break;
+	case 5:
+		test_wide_lexemes(sample_lex, input_file);
+		break;
+	case 6:
+		test_utf16_spans(sample_lex, input_file);
+		break;
 	default:
 		break;
 	}
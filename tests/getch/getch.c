@@ -36,9 +36,14 @@
 #include "uls/uls_auw.h"
 #include "uls/uls_util.h"
 #include "uls/uls_log.h"
+#include "uls/uls_relex.h"
+#include "uls/uls_plex.h"
 
 #include <stdlib.h>
 #include <string.h>
+#ifndef __ULS_WINDOWS__
+#include <unistd.h>
+#endif
 
 #include "sample_lex.h"
 
@@ -201,6 +206,395 @@ test_unget(uls_lex_ptr_t uls)
 	return 0;
 }
 
+static void
+dump_span(uls_lex_ptr_t uls, int len, uls_outparam_ptr_t parms)
+{
+	char buff[128];
+
+	if (len >= (int) sizeof(buff)) len = sizeof(buff) - 1;
+	if (len > 0) memcpy(buff, parms->lptr, len);
+	buff[len > 0 ? len : 0] = '\0';
+
+	uls_printf(_T(" span = '%s' (lfs=%d, found=%d, line=%d)\n"),
+		buff, parms->n, parms->flags, uls_get_lineno(uls));
+}
+
+void
+test_scan_span(uls_lex_ptr_t uls)
+{
+	uls_outparam_t parms;
+	int len, tok_id;
+
+	uls_set_file(uls, input_file, 0);
+
+	len = uls_scan_filtered_until(uls, _T("<"), &parms);
+	dump_span(uls, len, &parms);
+
+	len = uls_take_filtered_until(uls, _T("<!--"), &parms);
+	dump_span(uls, len, &parms);
+
+	len = uls_take_filtered_until(uls, _T("-->"), &parms);
+	dump_span(uls, len, &parms);
+
+	len = uls_scan_filtered_while(uls, 0, &parms);
+	dump_span(uls, len, &parms);
+
+	len = uls_scan_filtered_while(uls, ULS_CH_ID, &parms);
+	dump_span(uls, len, &parms);
+
+	// The comment of the spec is gone and the spaces are collapsed in the filtered text.
+	len = uls_scan_filtered_until(uls, _T("#"), &parms);
+	dump_span(uls, len, &parms);
+
+	tok_id = uls_get_tok(uls);
+	uls_printf(_T(" str = '%s' (%d)\n"), uls_lexeme(uls), tok_id);
+
+	len = uls_scan_filtered_until(uls, _T("#"), &parms);
+	dump_span(uls, len, &parms);
+
+	tok_id = uls_get_tok(uls);
+	uls_printf(_T(" tok = %d, EOI = %d\n"), tok_id, tok_id == tokEOI);
+}
+
+static void
+apply_edit(char *buf, int *ptr_len, const char *pat, const char *str)
+{
+	char *ptr = strstr(buf, pat);
+	int offset = (int) (ptr - buf), old_len = strlen(pat), new_len = strlen(str);
+
+	memmove(ptr + new_len, ptr + old_len, *ptr_len - offset - old_len + 1);
+	memcpy(ptr, str, new_len);
+	*ptr_len += new_len - old_len;
+}
+
+static int
+same_relex_toks(uls_relex_ptr_t rlx1, uls_relex_ptr_t rlx2)
+{
+	uls_outparam_t parms1, parms2;
+	int i;
+
+	if (uls_relex_num_tokens(rlx1) != uls_relex_num_tokens(rlx2) ||
+		uls_relex_num_lines(rlx1) != uls_relex_num_lines(rlx2)) {
+		return 0;
+	}
+
+	for (i = 0; i < uls_relex_num_tokens(rlx1); i++) {
+		if (uls_relex_get_tok(rlx1, i, &parms1) != uls_relex_get_tok(rlx2, i, &parms2) ||
+			parms1.n != parms2.n || parms1.len != parms2.len ||
+			memcmp(parms1.lptr, parms2.lptr, parms1.len) != 0) {
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+void
+test_relex(uls_lex_ptr_t uls)
+{
+	static const char *edits[][2] = {
+		{ "main", "start_up" },
+		{ "return", "x = 1;\n\treturn" },
+		{ "/*", "" },
+		{ "a comment", "/* a comment" },
+		{ "= \"hello\"", "= /* to\n\t */ \"hello\"" },
+		{ "x = 1;\n\t", "" },
+		{ "\"hello\"", "\"hello" },
+		{ "\"hello", "\"hello\"" },
+	};
+	char buf[1024];
+	uls_relex_ptr_t rlx, rlx_full;
+	uls_outparam_t parms;
+	int i, len, offset, old_len, n;
+	FILE *fp;
+
+	if ((fp = fopen(input_file, "r")) == NULL) {
+		err_log(_T("can't open %s"), input_file);
+		return;
+	}
+	len = fread(buf, 1, sizeof(buf) - 256, fp);
+	buf[len] = '\0';
+	fclose(fp);
+
+	rlx = uls_create_relex(uls);
+	rlx_full = uls_create_relex(uls);
+
+	n = uls_relex_set_text(rlx, buf, len);
+	uls_printf(_T(" set_text: %d tokens, %d lines\n"), n, uls_relex_num_lines(rlx));
+
+	for (i = 0; i < (int) (sizeof(edits) / sizeof(edits[0])); i++) {
+		offset = (int) (strstr(buf, edits[i][0]) - buf);
+		old_len = strlen(edits[i][0]);
+		apply_edit(buf, &len, edits[i][0], edits[i][1]);
+
+		n = uls_relex_edit(rlx, buf, len, offset, old_len, strlen(edits[i][1]), &parms);
+		uls_relex_set_text(rlx_full, buf, len);
+
+		if (n < 0) {
+			// a quote-string left open while typing
+			uls_printf(_T(" edit %d: failed, same = %d\n"), i + 1, same_relex_toks(rlx, rlx_full));
+			continue;
+		}
+
+		uls_printf(_T(" edit %d: relexed %d tokens for %d ones at [%d, %d), same = %d\n"),
+			i + 1, n, parms.n, parms.n1, parms.n2, same_relex_toks(rlx, rlx_full));
+	}
+
+	for (i = 0; i < uls_relex_num_tokens(rlx); i++) {
+		n = uls_relex_get_tok(rlx, i, &parms);
+		if (n == tokLF) continue;
+		uls_printf(_T(" %d: '%s' (%d)\n"), parms.n, parms.lptr, n);
+	}
+
+	uls_destroy_relex(rlx_full);
+	uls_destroy_relex(rlx);
+}
+
+void
+test_feed(uls_lex_ptr_t uls)
+{
+	char buf[1024];
+	int i, n, len, tok_id, n_starved = 0;
+	FILE *fp;
+
+	if ((fp = fopen(input_file, "r")) == NULL) {
+		err_log(_T("can't open %s"), input_file);
+		return;
+	}
+	len = fread(buf, 1, sizeof(buf), fp);
+	fclose(fp);
+
+	uls_push_feed(uls, 0);
+
+	for (i = 0; ; ) {
+		tok_id = uls_get_tok(uls);
+		if (tok_id == tokEOI) break;
+
+		if (uls_is_starved(uls)) {
+			// 7 bytes at a time to split the tokens, comments and quote-strings
+			if (i < len) {
+				if ((n = len - i) > 7) n = 7;
+				uls_feed(uls, buf + i, n);
+				i += n;
+			} else {
+				uls_feed_end(uls);
+			}
+			++n_starved;
+			continue;
+		}
+
+		uls_printf(_T("%3d:"), uls_get_lineno(uls));
+		uls_dumpln_tok(uls);
+	}
+
+	uls_printf(_T(" starved %d times\n"), n_starved);
+}
+
+static int
+same_plex_toks(uls_lex_ptr_t uls, uls_plex_ptr_t plx, const char *text, int len)
+{
+	uls_outparam_t parms;
+	int i, tok_id, stat = 1;
+
+	uls_push_line(uls, text, len, 0);
+
+	for (i = 0; ; i++) {
+		tok_id = uls_get_tok(uls);
+		if (tok_id == tokEOI) break;
+
+		if (i >= uls_plex_num_tokens(plx) || uls_plex_get_tok(plx, i, &parms) != tok_id ||
+			parms.n != uls_get_lineno(uls) || parms.len != uls_lexeme_len(uls) ||
+			memcmp(parms.lptr, uls_lexeme(uls), parms.len) != 0) {
+			stat = 0;
+			break;
+		}
+	}
+
+	if (stat && i != uls_plex_num_tokens(plx)) stat = 0;
+
+	uls_pop(uls);
+	return stat;
+}
+
+void
+test_plex(uls_lex_ptr_t uls)
+{
+	char buf[1024], *text;
+	uls_plex_ptr_t plx;
+	int i, n_chunks, len, n, n_file;
+	FILE *fp;
+
+	if ((fp = fopen(input_file, "r")) == NULL) {
+		err_log(_T("can't open %s"), input_file);
+		return;
+	}
+	n_file = fread(buf, 1, sizeof(buf), fp);
+	fclose(fp);
+
+	// The comments and quote-strings cross the chunk boundaries at all sorts of places.
+	text = (char *) malloc(64 * n_file);
+	for (len = i = 0; i < 64; i++) {
+		memcpy(text + len, buf, n_file);
+		len += n_file;
+	}
+
+	for (n_chunks = 1; n_chunks <= 8; n_chunks++) {
+		plx = uls_create_plex(config_name, n_chunks);
+		n = uls_plex_lex_text(plx, text, len);
+
+		uls_printf(_T(" %d chunks: %d tokens, %d fixes, same = %d\n"),
+			n_chunks, n, uls_plex_num_fixes(plx), same_plex_toks(uls, plx, text, len));
+		uls_destroy_plex(plx);
+	}
+
+	plx = uls_create_plex(config_name, 3);
+	n = uls_plex_lex_file(plx, input_file);
+	uls_printf(_T(" file: %d tokens, same = %d\n"), n, same_plex_toks(uls, plx, buf, n_file));
+	uls_destroy_plex(plx);
+
+#ifndef __ULS_WINDOWS__
+	// The files of 3GB and 5GB, sparse, are refused rather than lexed in part.
+	for (i = 3; i <= 5; i += 2) {
+		if ((fp = fopen("plex_large.txt", "w")) == NULL) break;
+		fclose(fp);
+
+		if (truncate("plex_large.txt", (off_t) i << 30) == 0) {
+			plx = uls_create_plex(config_name, 3);
+			uls_printf(_T(" %dGB file: %d\n"), i, uls_plex_lex_file(plx, "plex_large.txt"));
+			uls_destroy_plex(plx);
+		}
+		unlink("plex_large.txt");
+	}
+#endif
+
+	free(text);
+}
+
+#define TOKS_BUFSIZ 65536
+static char toks_buf1[TOKS_BUFSIZ], toks_buf2[TOKS_BUFSIZ];
+
+// up to 'n' tokens before the EOF, written one per line with the line numbers
+static int
+read_toks(uls_lex_ptr_t uls, char *buf, int n)
+{
+	int i, k, tok;
+
+	for (k = i = 0; i < n; i++) {
+		if ((tok = uls_get_tok(uls)) == tokEOF || tok == tokEOI) break;
+		k += snprintf(buf + k, TOKS_BUFSIZ - k, "%d:%d:%s\n", uls_get_lineno(uls), tok, uls_lexeme(uls));
+		if (k >= TOKS_BUFSIZ) {
+			err_log(_T("too many tokens!"));
+			break;
+		}
+	}
+
+	buf[k < TOKS_BUFSIZ ? k : TOKS_BUFSIZ - 1] = '\0';
+	return i;
+}
+
+// A comment and a literal string of many lines, fed a few bytes at a time, are read only once.
+void
+test_feed_long(uls_lex_ptr_t uls)
+{
+	uls_stats_t stats;
+	char *text;
+	int i, k, n, len, tok;
+
+	text = (char *) malloc(32 * 1024);
+	len = sprintf(text, "x = /* ");
+	for (i = 0; i < 500; i++) len += sprintf(text + len, "comment line %d\n", i);
+	len += sprintf(text + len, "*/ y = \"");
+	for (i = 0; i < 500; i++) len += sprintf(text + len, "string line %d\\\n", i);
+	len += sprintf(text + len, "\" z\n");
+
+	uls_push_line(uls, text, len, 0);
+	read_toks(uls, toks_buf1, TOKS_BUFSIZ);
+	uls_pop(uls);
+
+	uls_enable_stats(uls, 1);
+	uls_push_feed(uls, 0);
+
+	for (i = k = 0; ; ) {
+		if ((tok = uls_get_tok(uls)) == tokEOI) break;
+
+		if (uls_is_starved(uls)) {
+			if (i < len) {
+				if ((n = len - i) > 7) n = 7;
+				uls_feed(uls, text + i, n);
+				i += n;
+			} else {
+				uls_feed_end(uls);
+			}
+			continue;
+		}
+
+		k += snprintf(toks_buf2 + k, TOKS_BUFSIZ - k, "%d:%d:%s\n", uls_get_lineno(uls), tok, uls_lexeme(uls));
+		if (k >= TOKS_BUFSIZ) {
+			err_log(_T("too many tokens!"));
+			break;
+		}
+	}
+
+	uls_get_stats(uls, &stats);
+	uls_printf(_T(" fed %d bytes, read %d bytes, same = %d\n"), len,
+		(int) stats.n_refill_bytes, strcmp(toks_buf1, toks_buf2) == 0);
+
+	free(text);
+}
+
+void
+test_rewind(uls_lex_ptr_t uls)
+{
+	uls_stats_t stats;
+	int m0, m1, m2, n0, n1, n2, rc, n_fills;
+
+	uls_enable_stats(uls, 1);
+	uls_set_file(uls, input_file, 0);
+	uls_want_eof(uls);
+
+	// The text up to the EOF is read in several fillings.
+	n0 = read_toks(uls, toks_buf1, 5);
+	m0 = uls_mark(uls);
+	n1 = read_toks(uls, toks_buf1, TOKS_BUFSIZ);
+	uls_get_stats(uls, &stats);
+	n_fills = (int) stats.n_fillbuff;
+	uls_printf(_T(" mark %d after %d tokens, %d tokens to EOF in %d fillings\n"), m0, n0, n1, n_fills);
+
+	rc = uls_rewind(uls, m0);
+	uls_printf(_T(" rewind(%d) = %d: <%d> '%s' line %d\n"), m0, rc,
+		uls_tok(uls), uls_lexeme(uls), uls_get_lineno(uls));
+	n2 = read_toks(uls, toks_buf2, TOKS_BUFSIZ);
+	uls_get_stats(uls, &stats);
+	uls_printf(_T(" read again %d tokens, same = %d, filled again = %d\n"), n2,
+		strcmp(toks_buf1, toks_buf2) == 0, (int) stats.n_fillbuff - n_fills);
+
+	// a mark in the middle
+	uls_rewind(uls, m0);
+	read_toks(uls, toks_buf1, 150);
+	m1 = uls_mark(uls);
+	n1 = read_toks(uls, toks_buf1, 600);
+	rc = uls_rewind(uls, m1);
+	n2 = read_toks(uls, toks_buf2, 600);
+	uls_printf(_T(" rewind(%d) = %d, %d tokens, same = %d\n"), m1, rc, n2,
+		n1 == n2 && strcmp(toks_buf1, toks_buf2) == 0);
+
+	// The later marks are dropped by rewinding to an earlier one.
+	rc = uls_rewind(uls, m0);
+	uls_printf(_T(" rewind(%d) = %d: '%s' line %d\n"), m0, rc, uls_lexeme(uls), uls_get_lineno(uls));
+	uls_printf(_T(" rewind(%d) = %d\n"), m1, uls_rewind(uls, m1));
+
+	uls_release_mark(uls, m0);
+	uls_printf(_T(" rewind(%d) released = %d\n"), m0, uls_rewind(uls, m0));
+
+	// The mark on an input popped
+	uls_push_line(uls, _T("x = 1;"), -1, 0);
+	m2 = uls_mark(uls);
+	uls_pop(uls);
+	uls_printf(_T(" rewind(%d) popped = %d\n"), m2, uls_rewind(uls, m2));
+
+	uls_pop_all(uls);
+}
+
 int
 _tmain(int n_targv, LPTSTR *targv)
 {
@@ -233,6 +627,22 @@ _tmain(int n_targv, LPTSTR *targv)
 	case 2:
 		test_unget(sample_lex);
 		break;
+	case 3:
+		test_scan_span(sample_lex);
+		break;
+	case 4:
+		test_relex(sample_lex);
+		break;
+	case 5:
+		test_feed(sample_lex);
+		test_feed_long(sample_lex);
+		break;
+	case 6:
+		test_plex(sample_lex);
+		break;
+	case 7:
+		test_rewind(sample_lex);
+		break;
 	default:
 		break;
 	}
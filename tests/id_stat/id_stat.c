@@ -33,6 +33,8 @@
 */
 
 #include "uls/uls_lex.h"
+#include "uls/uls_spec_cache.h"
+#include "uls/uld_conf.h"
 #include "uls/uls_fileio.h"
 #include "uls/uls_auw.h"
 #include "uls/uls_util.h"
@@ -116,6 +118,10 @@ id_stat_t *id_stat_array;
 int n_id_stat_array;
 int n_alloc_id_stat_array;
 
+// id_stat_array[] index by atom-id, -1 if not yet seen
+int *atom_id_stat;
+int n_alloc_atom_id_stat;
+
 id_stat_t*
 find_id_stat(LPCTSTR name)
 {
@@ -152,7 +158,7 @@ int
 proc_file(LPCTSTR fpath)
 {
 	id_stat_t *e;
-	int tok;
+	int tok, atom_id, i;
 
 	if (fpath == NULL) return -1;
 
@@ -162,9 +168,28 @@ proc_file(LPCTSTR fpath)
 		tok = uls_get_tok(&sample_lex);
 
 		if (tok == TOK_EOI) break;
+		if (tok == TOK_ERR) {
+			err_log(_T("%s"), uls_lexeme(&sample_lex));
+			break;
+		}
 
 		if (tok == TOK_ID) {
-			if ((e=find_id_stat(uls_lexeme(&sample_lex))) == NULL) {
+			if ((atom_id = uls_tok_atom(&sample_lex)) > 0) {
+				if (atom_id >= n_alloc_atom_id_stat) {
+					i = n_alloc_atom_id_stat;
+					n_alloc_atom_id_stat = atom_id + 128;
+					atom_id_stat = uls_mrealloc(atom_id_stat, n_alloc_atom_id_stat * sizeof(int));
+					for ( ; i < n_alloc_atom_id_stat; i++) atom_id_stat[i] = -1;
+				}
+
+				if (atom_id_stat[atom_id] < 0) {
+					append_id_stat(uls_lexeme(&sample_lex));
+					atom_id_stat[atom_id] = n_id_stat_array - 1;
+				}
+
+				e = id_stat_array + atom_id_stat[atom_id];
+
+			} else if ((e=find_id_stat(uls_lexeme(&sample_lex))) == NULL) {
 				e = append_id_stat(uls_lexeme(&sample_lex));
 			}
 
@@ -195,6 +220,302 @@ test_id_stat(LPCTSTR fpath)
 	return 0;
 }
 
+// The tokens of the tokid-only mode against those of the normal mode
+int
+test_tokid_only(LPCTSTR fpath)
+{
+	uls_lex_ptr_t uls_ref;
+	int tok, tok_ref, lno, n_diffs = 0;
+
+	if ((uls_ref = uls_create(config_name)) == NULL) {
+		return -1;
+	}
+
+	uls_want_tokid_only(&sample_lex, 1);
+	uls_push_file(&sample_lex, fpath, 0);
+	uls_push_file(uls_ref, fpath, 0);
+
+	for ( ; ; ) {
+		tok = uls_get_tok(&sample_lex);
+		tok_ref = uls_get_tok(uls_ref);
+		lno = uls_get_lineno(&sample_lex);
+
+		if (tok != tok_ref || lno != uls_get_lineno(uls_ref) ||
+			uls_lexeme_len(&sample_lex) != uls_lexeme_len(uls_ref) ||
+			uls_lexeme_wlen(&sample_lex) != uls_lexeme_wlen(uls_ref) ||
+			uls_str_compare(uls_lexeme(&sample_lex), uls_lexeme(uls_ref)) != 0) {
+			uls_printf(_T("%3d: <%3d> differs from <%3d> '%s'\n"), lno, tok, tok_ref, uls_lexeme(uls_ref));
+			++n_diffs;
+		}
+
+		if (tok == TOK_EOI || tok_ref == TOK_EOI) break;
+
+		uls_printf(_T("%3d: <%3d> (%d) "), lno, tok, uls_lexeme_wlen(&sample_lex));
+		uls_dump_tok(&sample_lex, NULL, _T("\n"));
+	}
+
+	uls_printf(_T("%d tokens differ\n"), n_diffs);
+	uls_destroy(uls_ref);
+
+	return 0;
+}
+
+static int
+profile_file(uls_lex_ptr_t uls, LPCTSTR fpath, int n_times)
+{
+	int tok, k;
+
+	for (k = 0; k < n_times; k++) {
+		if (uls_push_file(uls, fpath, 0) < 0) return -1;
+
+		do {
+			if ((tok = uls_get_tok(uls)) == TOK_ERR) return -1;
+		} while (tok != TOK_EOI);
+	}
+
+	return 0;
+}
+
+static int
+print_file(LPCTSTR fpath)
+{
+	char linebuff[256];
+	FILE *fp;
+	int len;
+
+	if ((fp = uls_fp_open(fpath, ULS_FIO_READ)) == NULL) {
+		return -1;
+	}
+
+	while ((len = uls_fp_gets(fp, linebuff, sizeof(linebuff), 0)) > ULS_EOF) {
+		uls_printf(_T("%s\n"), linebuff);
+	}
+
+	uls_fp_close(fp);
+	return 0;
+}
+
+static int
+same_files(LPCTSTR fpath1, LPCTSTR fpath2)
+{
+	char linebuff1[256], linebuff2[256];
+	FILE *fp1, *fp2;
+	int len1, len2, same = 0;
+
+	fp1 = uls_fp_open(fpath1, ULS_FIO_READ);
+	fp2 = uls_fp_open(fpath2, ULS_FIO_READ);
+
+	if (fp1 != NULL && fp2 != NULL) {
+		do {
+			len1 = uls_fp_gets(fp1, linebuff1, sizeof(linebuff1), 0);
+			len2 = uls_fp_gets(fp2, linebuff2, sizeof(linebuff2), 0);
+			if (len1 != len2 || (len1 > ULS_EOF && strcmp(linebuff1, linebuff2) != 0)) break;
+		} while (len1 > ULS_EOF);
+		same = len1 == len2 && len1 <= ULS_EOF;
+	}
+
+	if (fp1 != NULL) uls_fp_close(fp1);
+	if (fp2 != NULL) uls_fp_close(fp2);
+
+	return same;
+}
+
+// The ulf-file of the profile merged from two lexers, loaded and dumped again.
+int
+test_profile_ulf(LPCTSTR fpath)
+{
+	LPCTSTR ulc_file = _T("prof_sample.ulc"), ulf_file = _T("prof_sample.ulf");
+	LPCTSTR ulf_file2 = _T("prof_sample2.ulf");
+	uls_lex_ptr_t uls1 = NULL, uls2 = NULL, uls3 = NULL;
+	uls_hash_stat_ptr_t hs;
+	int stat = -1;
+
+	if (uls_copyfile(config_name, ulc_file) < 0) {
+		err_log(_T("can't copy %s"), config_name);
+		return -1;
+	}
+
+	// The profiles are merged only between the lexers sharing the spec.
+	if ((uls1 = uls_create_shared(config_name)) == NULL ||
+		(uls2 = uls_create_shared(config_name)) == NULL) {
+		goto end_1;
+	}
+
+	uls_enable_profile(uls1, 1);
+	uls_enable_profile(uls2, 1);
+	if (profile_file(uls1, fpath, 1) < 0 || profile_file(uls2, fpath, 1) < 0 ||
+		uls_merge_profile(uls1, uls2) < 0 || uls_dump_profile_ulf(uls1, ulf_file) < 0) {
+		err_log(_T("can't profile %s"), fpath);
+		goto end_1;
+	}
+	print_file(ulf_file);
+
+	// The lexer of prof_sample.ulc reads prof_sample.ulf.
+	if ((uls3 = uls_create(ulc_file)) == NULL) {
+		err_log(_T("can't load %s"), ulf_file);
+		goto end_1;
+	}
+
+	hs = &uls3->idkeyw_table.hash_stat;
+	uls_printf(_T("loaded: table-size = %d, weight = { %d, %d, %d }\n"),
+		hs->table_size, hs->weight[0], hs->weight[1], hs->weight[2]);
+
+	uls_enable_profile(uls3, 1);
+	if (profile_file(uls3, fpath, 2) < 0 || uls_dump_profile_ulf(uls3, ulf_file2) < 0) {
+		err_log(_T("can't profile %s again"), fpath);
+		goto end_1;
+	}
+
+	uls_printf(_T("round-trip: %s\n"), same_files(ulf_file, ulf_file2) ? _T("same") : _T("differs"));
+	stat = 0;
+
+end_1:
+	if (uls3 != NULL) uls_destroy(uls3);
+	if (uls2 != NULL) uls_destroy(uls2);
+	if (uls1 != NULL) uls_destroy(uls1);
+
+	uls_unlink(ulf_file2);
+	uls_unlink(ulf_file);
+	uls_unlink(ulc_file);
+
+	return stat;
+}
+
+// The keywords of a case-insensitive spec out of ASCII, with and without interning
+int
+test_casefold_keyw(LPCTSTR fpath)
+{
+	LPCTSTR ulc_file = _T("casefold.ulc");
+	uls_lex_ptr_t uls, uls_intern;
+	int tok, tok_intern, lno, n_keyws = 0, n_diffs = 0;
+
+	if ((uls = uls_create(ulc_file)) == NULL) {
+		return -1;
+	}
+
+	if ((uls_intern = uls_create(ulc_file)) == NULL) {
+		uls_destroy(uls);
+		return -1;
+	}
+
+	uls_enable_intern(uls_intern, 1);
+	uls_push_file(uls, fpath, 0);
+	uls_push_file(uls_intern, fpath, 0);
+
+	for ( ; ; ) {
+		tok = uls_get_tok(uls);
+		tok_intern = uls_get_tok(uls_intern);
+		lno = uls_get_lineno(uls);
+
+		if (tok != tok_intern || uls_str_compare(uls_lexeme(uls), uls_lexeme(uls_intern)) != 0) {
+			uls_printf(_T("%3d: <%3d> differs from <%3d> with interning\n"), lno, tok, tok_intern);
+			++n_diffs;
+		}
+
+		if (tok == uls_toknum_eoi(uls) || tok == uls_toknum_err(uls) ||
+			tok_intern == uls_toknum_eoi(uls_intern) || tok_intern == uls_toknum_err(uls_intern)) {
+			break;
+		}
+
+		if (tok != uls_toknum_id(uls)) ++n_keyws;
+		uls_printf(_T("%3d: <%3d> %s\n"), lno, tok, uls_lexeme(uls));
+	}
+
+	uls_printf(_T("%d keywords, %d tokens differ with interning\n"), n_keyws, n_diffs);
+	uls_destroy(uls_intern);
+	uls_destroy(uls);
+
+	return 0;
+}
+
+static int
+append_file(LPCTSTR fpath, const char *text)
+{
+	FILE *fp;
+
+	if ((fp = fopen(fpath, "a")) == NULL) {
+		return -1;
+	}
+
+	fputs(text, fp);
+	fclose(fp);
+
+	return 0;
+}
+
+static void
+print_tokens(uls_lex_ptr_t uls, LPCTSTR name, LPCTSTR fpath)
+{
+	int tok;
+
+	uls_printf(_T("%s:"), name);
+	uls_push_file(uls, fpath, 0);
+
+	while ((tok = uls_get_tok(uls)) != TOK_EOI && tok != TOK_ERR) {
+		if (tok != TOK_EOL) uls_printf(_T(" <%d>%s"), tok, uls_lexeme(uls));
+	}
+	uls_printf(_T("\n"));
+}
+
+// The spec shared by uls_create_shared() is recompiled only if a file of it changes.
+int
+test_spec_cache(LPCTSTR fpath)
+{
+	LPCTSTR ulc_file = _T("cache_sample.ulc"), ulf_file = _T("cache_sample.ulf");
+	uls_lex_ptr_t uls1 = NULL, uls2 = NULL, uls3 = NULL, uls4 = NULL;
+	int stat = -1;
+
+	if (uls_copyfile(config_name, ulc_file) < 0) {
+		err_log(_T("can't copy %s"), config_name);
+		return -1;
+	}
+
+	if ((uls1 = uls_create_shared(ulc_file)) == NULL ||
+		(uls2 = uls_create_shared(ulc_file)) == NULL) {
+		goto end_1;
+	}
+	uls_printf(_T("hit: %s\n"), uls1->shared_spec == uls2->shared_spec ? _T("shared") : _T("recompiled"));
+	print_tokens(uls1, _T("uls1"), fpath);
+
+	// A keyword added to the ulc-file
+	if (append_file(ulc_file, "GIVEN    given    301\n") < 0 ||
+		(uls3 = uls_create_shared(ulc_file)) == NULL) {
+		goto end_1;
+	}
+	uls_printf(_T("ulc changed: %s\n"), uls1->shared_spec == uls3->shared_spec ? _T("shared") : _T("recompiled"));
+	print_tokens(uls3, _T("uls3"), fpath);
+	print_tokens(uls1, _T("uls1"), fpath);
+
+	// The ulf-file found next to the ulc-file
+	uls_enable_profile(uls3, 1);
+	if (profile_file(uls3, fpath, 1) < 0 || uls_dump_profile_ulf(uls3, ulf_file) < 0 ||
+		(uls4 = uls_create_shared(ulc_file)) == NULL) {
+		goto end_1;
+	}
+	uls_printf(_T("ulf added: %s\n"), uls3->shared_spec == uls4->shared_spec ? _T("shared") : _T("recompiled"));
+
+	// The tables of a shared spec are read-only.
+	uls_printf(_T("set_extra_tokdef: %d\n"), uls_set_extra_tokdef(uls4, TOK_IF, uls4));
+	uls_printf(_T("change_litstr_analyzer: %d\n"),
+		uls_change_litstr_analyzer(uls4, "\"", NULL, NULL));
+	uls_printf(_T("delete_litstr_analyzer: %d\n"), uls_delete_litstr_analyzer(uls4, "\""));
+	uls_printf(_T("uld_prepare_names: %s\n"), uld_prepare_names(uls4) == NULL ? _T("null") : _T("non-null"));
+	print_tokens(uls4, _T("uls4"), fpath);
+	stat = 0;
+
+end_1:
+	if (uls4 != NULL) uls_destroy(uls4);
+	if (uls3 != NULL) uls_destroy(uls3);
+	if (uls2 != NULL) uls_destroy(uls2);
+	if (uls1 != NULL) uls_destroy(uls1);
+	uls_flush_spec_cache();
+
+	uls_unlink(ulf_file);
+	uls_unlink(ulc_file);
+
+	return stat;
+}
+
 int
 proc_filelist(FILE *fin)
 {
@@ -318,6 +639,35 @@ _tmain(int n_targv, LPTSTR *targv)
 	case 2:
 		rc = test_initial_tok(&sample_lex);
 		break;
+	case 3:
+		uls_enable_intern(&sample_lex, 1);
+		rc = get_id_stats(n_targv, targv, i0);
+		uls_printf(_T("#atoms = %d\n"), uls_num_atoms(&sample_lex));
+		break;
+	case 4:
+		for (i=i0; i<n_targv; i++) {
+			rc = test_tokid_only(targv[i]);
+			if (rc < 0) break;
+		}
+		break;
+	case 5:
+		for (i=i0; i<n_targv; i++) {
+			rc = test_profile_ulf(targv[i]);
+			if (rc < 0) break;
+		}
+		break;
+	case 6:
+		for (i=i0; i<n_targv; i++) {
+			rc = test_casefold_keyw(targv[i]);
+			if (rc < 0) break;
+		}
+		break;
+	case 7:
+		for (i=i0; i<n_targv; i++) {
+			rc = test_spec_cache(targv[i]);
+			if (rc < 0) break;
+		}
+		break;
 	default:
 		rc = 0;
 		break;
@@ -325,6 +675,7 @@ _tmain(int n_targv, LPTSTR *targv)
 
 	uls_destroy(&sample_lex);
 	uls_mfree(id_stat_array);
+	uls_mfree(atom_id_stat);
 
 	return 0;
 }
@@ -36,9 +36,11 @@
 #include "uls/uls_auw.h"
 #include "uls/uls_util.h"
 #include "uls/uls_log.h"
+#include "uls/utf8_enc.h"
 
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
 
 #include "sample_g_lex.h"
 
@@ -406,6 +408,167 @@ lex_gcc_preprocd(uls_lex_ptr_t uls, LPCTSTR filepath)
 	return stat;
 }
 
+#define LEX_FEEDSIZ  7
+#define LEX_TEXTSIZ  (64 * 1024)
+
+static char*
+read_whole_file(LPCTSTR filepath, int *ptr_len)
+{
+	char *buf;
+	FILE *fp;
+
+	if ((fp = uls_fp_open(filepath, ULS_FIO_READ | ULS_FIO_NO_UTF8BOM)) == NULL) {
+		err_log(_T("can't open '%s'"), filepath);
+		return NULL;
+	}
+
+	buf = (char *) uls_malloc(LEX_TEXTSIZ + 1);
+	*ptr_len = (int) fread(buf, 1, LEX_TEXTSIZ, fp);
+	buf[*ptr_len] = '\0';
+	uls_fp_close(fp);
+
+	return buf;
+}
+
+// The same text in UTF-16 of the native byte order, led by the BOM.
+static int
+write_utf16_file(LPCTSTR filepath, const char *text, int len_text)
+{
+	uls_uint16 *wbuf;
+	FILE *fp;
+	int l_wbuf, stat = 0;
+
+	wbuf = (uls_uint16 *) uls_malloc((len_text + 2) * sizeof(uls_uint16));
+	wbuf[0] = 0xFEFF;
+	if ((l_wbuf = uls_utf8_to_utf16buf(text, len_text, wbuf + 1, len_text + 1)) < 0 ||
+		(fp = uls_fp_open(filepath, ULS_FIO_WRITE | ULS_FIO_NO_UTF8BOM)) == NULL) {
+		uls_mfree(wbuf);
+		return -1;
+	}
+
+	if (fwrite(wbuf, sizeof(uls_uint16), l_wbuf + 1, fp) != (size_t) (l_wbuf + 1)) {
+		stat = -1;
+	}
+
+	uls_fp_close(fp);
+	uls_mfree(wbuf);
+
+	return stat;
+}
+
+/*
+ * For every token from the input, the bytes at its offset are its lexeme,
+ *   and the line and the column of the offset, counted in 'text', agree with
+ *   uls_get_lineno(), uls_offset_lineno() and uls_lineno_offset().
+ * The lexeme of a literal string follows the opening quote, up to its first escape.
+ * Fed by LEX_FEEDSIZ bytes, the fillings cut in the comments are rolled back.
+ */
+static int
+check_tok_offsets(uls_lex_ptr_t uls, LPCTSTR name, const char *text, int len_text, int feed)
+{
+	const char *lxm;
+	int tok, lno, lno2, offset, column, column2, len, i = 0, n, k;
+	int n_toks = 0, n_diffs = 0, lno_text, lstart;
+
+	for ( ; ; ) {
+		tok = uls_get_tok(uls);
+		if (tok == TOK_EOI) break;
+
+		if (feed && uls_is_starved(uls)) {
+			if (i < len_text) {
+				if ((n = len_text - i) > LEX_FEEDSIZ) n = LEX_FEEDSIZ;
+				uls_feed(uls, text + i, n);
+				i += n;
+			} else {
+				uls_feed_end(uls);
+			}
+			continue;
+		}
+
+		if (tok == TOK_ERR) {
+			err_log(_T("ErrorToken: %s"), uls_lexeme(uls));
+			++n_diffs;
+			break;
+		}
+
+		if (tok == TOK_EOF || tok == TOK_NONE) continue;
+		++n_toks;
+
+		lno = uls_get_lineno(uls);
+		lxm = uls_lexeme(uls);
+		len = uls_lexeme_len(uls);
+
+		if ((offset = uls_tok_offset(uls, &column)) < 0 || offset + len > len_text) {
+			uls_printf(_T("  %3d: <%4d> '%s' not in the input\n"), lno, tok, lxm);
+			++n_diffs;
+			continue;
+		}
+
+		lno2 = uls_offset_lineno(uls, offset, &column2);
+		for (lno_text = 1, k = 0; k < offset; k++) {
+			if (text[k] == '\n') ++lno_text;
+		}
+		for (lstart = offset; lstart > 0 && text[lstart - 1] != '\n'; lstart--)
+			/* NOTHING */;
+
+		if (uls_is_quote(uls)) {
+			// the literal string up to the first escape
+			for (n = 0; n < len && text[offset + 1 + n] != '\\'; n++)
+				/* NOTHING */;
+			n = memcmp(text + offset + 1, lxm, n) != 0;
+		} else if (tok == TOK_NUMBER) {
+			n = !isdigit((unsigned char) text[offset]);
+		} else {
+			n = memcmp(text + offset, lxm, len) != 0;
+		}
+
+		if (n || lno != lno_text || lno2 != lno || column2 != column ||
+			column != offset - lstart + 1 || uls_lineno_offset(uls, lno) != lstart) {
+			uls_printf(_T("  %3d: <%4d> '%s' at %d, line %d column %d\n"),
+				lno, tok, lxm, offset, lno2, column);
+			++n_diffs;
+		}
+	}
+
+	uls_printf(_T("%s: %d tokens, %d differ\n"), name, n_toks, n_diffs);
+
+	return n_diffs;
+}
+
+int
+test_tok_offsets(uls_lex_ptr_t uls, LPCTSTR filepath)
+{
+	LPCTSTR utf16_file = _T("lex_input_utf16.txt");
+	char *text;
+	int len_text;
+
+	if ((text = read_whole_file(filepath, &len_text)) == NULL) {
+		return -1;
+	}
+
+	uls_want_lineidx(uls, 1);
+
+	uls_push_file(uls, filepath, 0);
+	check_tok_offsets(uls, _T("file"), text, len_text, 0);
+
+	uls_push_line(uls, text, len_text, ULS_DO_DUP);
+	check_tok_offsets(uls, _T("line"), text, len_text, 0);
+
+	uls_push_feed(uls, 0);
+	check_tok_offsets(uls, _T("feed"), text, len_text, 1);
+
+	if (write_utf16_file(utf16_file, text, len_text) < 0) {
+		err_log(_T("can't write %s"), utf16_file);
+	} else {
+		uls_push_file(uls, utf16_file, 0);
+		check_tok_offsets(uls, _T("utf16"), text, len_text, 0);
+		uls_unlink(utf16_file);
+	}
+
+	uls_mfree(text);
+	return 0;
+}
+
 int
 _tmain(int n_targv, LPTSTR *targv)
 {
@@ -441,6 +604,9 @@ _tmain(int n_targv, LPTSTR *targv)
 	case 3:
 		lex_gcc_preprocd(gcc_lex, targv[i0]);
 		break;
+	case 4:
+		test_tok_offsets(gcc_lex, targv[i0]);
+		break;
 	default:
 		break;
 	}
@@ -125,9 +125,167 @@ test_uls(LPCTSTR fpath)
 	}
 }
 
+void
+dump_tok(int t)
+{
+	uls_printf(_T("%3d: <%4d> '%s'\n"), uls_get_lineno(sample_lex), t, uls_lexeme(sample_lex));
+}
+
+// 1 -> 0: the tabs and the line-feeds are dropped.
+int
+stage_drop_blanks(uls_lex_ptr_t uls, uls_tokrec_ptr_t rec, uls_voidptr_t data)
+{
+	if (rec->tok_id == TOK_TAB || rec->tok_id == TOK_EOL) {
+		return ULS_TOKSTAGE_DROP;
+	}
+
+	return ULS_TOKSTAGE_PASS;
+}
+
+// 1 -> N: the identifier 'a_b_c' is split into 'a', 'b' and 'c'.
+int
+stage_split_id(uls_lex_ptr_t uls, uls_tokrec_ptr_t rec, uls_voidptr_t data)
+{
+	int i, i0;
+
+	if (rec->tok_id != TOK_ID || memchr(rec->lxm, '_', rec->l_lxm) == NULL) {
+		return ULS_TOKSTAGE_PASS;
+	}
+
+	for (i0 = i = 0; i <= rec->l_lxm; i++) {
+		if (i == rec->l_lxm || rec->lxm[i] == '_') {
+			if (i > i0) uls_emit_tok(uls, TOK_ID, rec->lxm + i0, i - i0);
+			i0 = i + 1;
+		}
+	}
+
+	return ULS_TOKSTAGE_DROP;
+}
+
+// rewriting: the identifiers are upper-cased and 'int' becomes 'long', 100 lines down.
+int
+stage_rewrite(uls_lex_ptr_t uls, uls_tokrec_ptr_t rec, uls_voidptr_t data)
+{
+	char *buf = (char *) data;
+	int i;
+
+	if (rec->tok_id == TOK_ID && rec->l_lxm < 64) {
+		for (i=0; i<rec->l_lxm; i++) {
+			buf[i] = uls_toupper(rec->lxm[i]);
+		}
+		buf[i] = '\0';
+		rec->lxm = buf;
+	} else if (rec->tok_id == TOK_INT) {
+		rec->tok_id = TOK_LONG;
+		rec->lxm = "long";
+		rec->l_lxm = 4;
+	}
+
+	rec->lineno += 100;
+	return ULS_TOKSTAGE_PASS;
+}
+
+// holding back: the tokens are swapped by pairs, the last one is flushed at EOI.
+typedef struct {
+	int  held, tok_id, l_lxm, lineno;
+	char lxm[64];
+} swap_stage_t;
+
+int
+stage_swap(uls_lex_ptr_t uls, uls_tokrec_ptr_t rec, uls_voidptr_t data)
+{
+	swap_stage_t *sw = (swap_stage_t *) data;
+
+	if (rec->tok_id == TOK_EOI) {
+		if (sw->held) {
+			uls_emit_tok(uls, sw->tok_id, sw->lxm, sw->l_lxm);
+			sw->held = 0;
+		}
+		return ULS_TOKSTAGE_DROP;
+	}
+
+	if (!sw->held) {
+		if (rec->l_lxm >= (int) sizeof(sw->lxm)) return ULS_TOKSTAGE_PASS;
+		sw->tok_id = rec->tok_id;
+		memcpy(sw->lxm, rec->lxm, rec->l_lxm);
+		sw->l_lxm = rec->l_lxm;
+		sw->lineno = rec->lineno;
+		sw->held = 1;
+		return ULS_TOKSTAGE_DROP;
+	}
+
+	uls_emit_tok(uls, rec->tok_id, rec->lxm, rec->l_lxm);
+
+	rec->tok_id = sw->tok_id;
+	rec->lxm = sw->lxm;
+	rec->l_lxm = sw->l_lxm;
+	rec->lineno = sw->lineno;
+	sw->held = 0;
+
+	return ULS_TOKSTAGE_PASS;
+}
+
+int
+stage_clear(uls_lex_ptr_t uls, uls_tokrec_ptr_t rec, uls_voidptr_t data)
+{
+	int *ptr_rc = (int *) data;
+
+	if (*ptr_rc > 0) {
+		*ptr_rc = uls_clear_tokstages(uls);
+	}
+
+	return ULS_TOKSTAGE_PASS;
+}
+
+void
+test_tokstages(LPCTSTR fpath)
+{
+	int t;
+
+	if (uls_set_file(sample_lex, fpath, 0) < 0) {
+		err_log(_T(" file open error"));
+		return;
+	}
+
+	do {
+		t = uls_get_tok(sample_lex);
+		dump_tok(t);
+	} while (t != TOK_EOI);
+
+	// The EOI is given to the stages only once.
+	dump_tok(uls_get_tok(sample_lex));
+}
+
+void
+test_tokstages_reset(LPCTSTR fpath)
+{
+	int t, rc = 1;
+
+	uls_add_tokstage(sample_lex, stage_clear, &rc);
+
+	// A piece of the split token is given, the others are dropped with the input.
+	uls_set_file(sample_lex, fpath, 0);
+	dump_tok(uls_get_tok(sample_lex));
+	uls_printf(_T("uls_clear_tokstages() in a stage: %d\n"), rc);
+
+	uls_set_file(sample_lex, fpath, 0);
+	do {
+		t = uls_get_tok(sample_lex);
+		dump_tok(t);
+	} while (t != TOK_EOI && t != TOK_END);
+
+	if (uls_clear_tokstages(sample_lex) == 0) {
+		uls_printf(_T("uls_clear_tokstages() out of the stages: 0\n"));
+	}
+
+	dump_tok(uls_get_tok(sample_lex));
+}
+
 int
 _tmain(int n_targv, LPTSTR *targv)
 {
+	swap_stage_t swap_stage;
+	char rewrite_buf[64];
 	int i, i0;
 
 	progname = uls_filename(targv[0], NULL);
@@ -143,9 +301,37 @@ _tmain(int n_targv, LPTSTR *targv)
 		return -1;
 	}
 
+	if (test_mode > 0) {
+		uls_add_tokstage(sample_lex, stage_drop_blanks, NULL);
+	}
+
+	switch (test_mode) {
+	case 2:
+		uls_add_tokstage(sample_lex, stage_split_id, NULL);
+		break;
+	case 3:
+		uls_add_tokstage(sample_lex, stage_rewrite, rewrite_buf);
+		break;
+	case 4:
+		swap_stage.held = 0;
+		uls_add_tokstage(sample_lex, stage_swap, &swap_stage);
+		break;
+	case 5:
+		uls_add_tokstage(sample_lex, stage_split_id, NULL);
+		break;
+	default:
+		break;
+	}
+
 	for (i=i0; i<n_targv; i++) {
 		input_file = targv[i];
-		test_uls(input_file);
+		if (test_mode == 5) {
+			test_tokstages_reset(input_file);
+		} else if (test_mode > 0) {
+			test_tokstages(input_file);
+		} else {
+			test_uls(input_file);
+		}
 	}
 
 	uls_destroy(sample_lex);
@@ -73,6 +73,54 @@ if [ $? != 0 ]; then
 	exit 1
 fi
 
+# With no random samples, the hashcode searched is the same however many threads share the search.
+ulf_gen_det="$MAKE_ULF -n 0 -O 2 -L $ULC_FILE -l $TEST_FILE_1"
+for n_threads in 1 4; do
+	cmdline="$ulf_gen_det -j $n_threads -o $TEST_DIR/sample_j${n_threads}.ulf $TARGET_DIR_1"
+	if [ "$opt_verbose" = "yes" ]; then
+		echo "$cmdline"
+	fi
+
+	$cmdline
+	if [ $? != 0 ]; then
+		echo "FAIL: $cmdline"
+		exit 1
+	fi
+done
+
+diff $TEST_DIR/sample_j1.ulf $TEST_DIR/sample_j4.ulf
+if [ $? != 0 ]; then
+	echo "FAIL: the ulf-files of 1 and 4 threads differ"
+	exit 1
+fi
+
+# The ulf-file beside the ulc-file is loaded with it, even in a table size other than the default.
+cp $ULC_FILE $TEST_DIR/sample.ulc
+cmdline="$ulf_gen_det -s 29 -o $TEST_DIR/sample.ulf $TARGET_DIR_1"
+$cmdline
+if [ $? != 0 ]; then
+	echo "FAIL: $cmdline"
+	exit 1
+fi
+
+cmdline="$MAKE_ULF -n 0 -O 2 -s 29 -L $TEST_DIR/sample.ulc -l $TEST_FILE_1 -o $TEST_DIR/sample_2.ulf $TARGET_DIR_1"
+if [ "$opt_verbose" = "yes" ]; then
+	echo "$cmdline"
+fi
+
+$cmdline 2> $TEST_DIR/sample_2.err
+if [ $? != 0 ] || grep -qE "ULF|ulf[- )]" $TEST_DIR/sample_2.err; then
+	cat $TEST_DIR/sample_2.err
+	echo "FAIL: can't load $TEST_DIR/sample.ulf"
+	exit 1
+fi
+
+diff $TEST_DIR/sample.ulf $TEST_DIR/sample_2.ulf
+if [ $? != 0 ]; then
+	echo "FAIL: the ulf-file changes after loaded"
+	exit 1
+fi
+
 if [ -d $TEST_DIR ]; then
 	rm -rf $TEST_DIR
 fi
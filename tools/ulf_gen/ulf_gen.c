@@ -41,15 +41,22 @@
 #include "ult_log.h"
 #include <ctype.h>
 #include <time.h>
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+#ifndef __ULS_WINDOWS__
+#include <unistd.h>
+#endif
 
 #define THIS_PROGNAME "ulf_gen"
 #define DFL_N_SAMPLES 1000
+#define ULFGEN_MAX_THREADS 64
 
 _ULS_DEFINE_STRUCT(round_stat)
 {
 	int n_buckets;
 	double avg, sigma2;
-	double gamma;
+	double probes;
 };
 
 _ULS_DEFINE_STRUCT(stat_of_round)
@@ -58,6 +65,14 @@ _ULS_DEFINE_STRUCT(stat_of_round)
 	round_stat_t state;
 };
 
+_ULS_DEFINE_STRUCT(search_worker)
+{
+	int id, n_workers;
+	int *buckets;
+	stat_of_round_t best;
+	int i_best;
+};
+
 char *progname;
 char home_dir[ULS_FILEPATH_MAX+1];
 const char *config_file;
@@ -67,13 +82,19 @@ char *out_file;
 char out_file_buff[ULS_FILEPATH_MAX+1];
 int opt_verbose;
 int opt_optimize_level;
+int opt_table_size;
+int opt_n_threads;
 
 uls_lex_ptr_t sam_lex;
 uls_hashfunc_t ulf_hashfunc;
 int n_samples;
-int *g_hash_buckets;
 
-static int i_weight_list, j_weight_list, k_weight_list;
+// the keywords sorted by ulf_sort_kwstat_by_chain() while searching the hashcode
+static uls_keyw_stat_list_t *g_ks_lst;
+static double g_n_misses;
+
+static int *g_rand_weights;
+static int g_n_candidates;
 
 #define NUM_WPRIMES  25
 static int weight_plist[NUM_WPRIMES] = {
@@ -89,10 +110,7 @@ static int weight_plist[NUM_WPRIMES] = {
 	97
 };
 
-void init_weights_indices();
-int next_weights_indices(int space_size);
-
-#define ULFGEN_OPTSTR "L:l:o:O:n:s:vVHh"
+#define ULFGEN_OPTSTR "L:l:o:O:n:s:j:vVHh"
 
 #ifdef HAVE_GETOPT
 #include <getopt.h>
@@ -104,6 +122,7 @@ static const struct option longopts[] = {
 	{ "num-iter",  required_argument,  NULL, 'n' },
 	{ "size-hash",  required_argument, NULL, 's' },
 	{ "optimize",  required_argument,  NULL, 'O' },
+	{ "jobs",  required_argument,      NULL, 'j' },
 	{ "verbose",  no_argument,         NULL, 'v' },
 	{ "version", no_argument,          NULL, 'V' },
 	{ "Help",    no_argument,          NULL, 'H' },
@@ -129,6 +148,8 @@ static void usage_desc(void)
 	ult_log("  -o <a-file>        Specify the the output filepath(*.ulf)");
 	ult_log("  -O <level=1,2,3>   Specify the optimizing level for hashcode");
 	ult_log("  -n <num>           Specify the number of random samples");
+	ult_log("  -s <size>          Specify the size of hash table");
+	ult_log("  -j <num>           Specify the number of threads searching hashcode");
 	ult_log("  -v, --verbose      verbose mode");
 	ult_log("  -V, --version      Print the version information");
 	ult_log("  -h, --help         Display the short help");
@@ -138,6 +159,8 @@ static void usage_desc(void)
 	ult_log("  -o, --output=<a-file>   Specify the the output filepath(*.ulf)");
 	ult_log("  -O, --optimize <1,2,3>  Specify the optimizing level for hashcode");
 	ult_log("  -n <num>                Specify the number of random samples");
+	ult_log("  -s, --size-hash=<size>  Specify the size of hash table");
+	ult_log("  -j, --jobs=<num>        Specify the number of threads searching hashcode");
 	ult_log("  -v, --verbose           verbose mode");
 	ult_log("  -V, --version           Print the version information");
 	ult_log("  -h, --help              Display the short help");
@@ -209,6 +232,21 @@ static int ulfgen_options(int opt, char *optarg)
 		break;
 
 	case 's':
+		opt_table_size = atoi(optarg);
+		if (opt_table_size <= 0 || opt_table_size > ULF_HASH_TABLE_MAXSIZE) {
+			ult_log("The size of hash table must be in [1, %d]", ULF_HASH_TABLE_MAXSIZE);
+			stat = -1;
+		}
+		break;
+
+	case 'j':
+		opt_n_threads = atoi(optarg);
+		if (opt_n_threads <= 0) {
+			ult_log("invalid number of threads, %s", optarg);
+			stat = -1;
+		} else if (opt_n_threads > ULFGEN_MAX_THREADS) {
+			opt_n_threads = ULFGEN_MAX_THREADS;
+		}
 		break;
 
 	case 'O':
@@ -244,6 +282,18 @@ static int ulfgen_options(int opt, char *optarg)
 	return stat;
 }
 
+static int
+num_online_cpus(void)
+{
+	int n = 1;
+
+#if defined(HAVE_PTHREAD) && defined(_SC_NPROCESSORS_ONLN)
+	if ((n = (int) sysconf(_SC_NPROCESSORS_ONLN)) <= 0) n = 1;
+	else if (n > ULFGEN_MAX_THREADS) n = ULFGEN_MAX_THREADS;
+#endif
+	return n;
+}
+
 static int
 parse_options(int argc, char *argv[])
 {
@@ -258,6 +308,7 @@ parse_options(int argc, char *argv[])
 	filelist = NULL;
 	out_file = NULL;
 	n_samples = DFL_N_SAMPLES;
+	opt_n_threads = num_online_cpus();
 
 #ifdef HAVE_GETOPT
 	while ((opt=getopt_long(argc, argv, ULFGEN_OPTSTR, longopts, &longindex)) != -1) {
@@ -302,12 +353,6 @@ copy_stat_round(stat_of_round_ptr_t p_stat_src, stat_of_round_ptr_t p_stat_dst)
 	p_stat_dst->state = p_stat_src->state;
 }
 
-void
-reset_hash_buckets()
-{
-	memset(g_hash_buckets, 0x00, ULF_HASH_TABLE_SIZE * sizeof(int));
-}
-
 int
 incl_if_keyw(uls_keyw_stat_list_t *ks_lst, const char *keyw)
 {
@@ -328,27 +373,6 @@ incl_if_keyw(uls_keyw_stat_list_t *ks_lst, const char *keyw)
 	return stat;
 }
 
-void
-dump_hash_freq(stat_of_round_ptr_t p_round)
-{
-	uls_hash_stat_t *hs = &p_round->hcodes;
-	int i;
-
-	uls_printf("weight = { %d, %d, %d }\n",
-		hs->weight[0], hs->weight[1], hs->weight[2]);
-
-	uls_printf("avg(%.2f), sigma2(%.2f), gamma(%.2f)\n",
-		p_round->state.avg, p_round->state.sigma2, p_round->state.gamma);
-
-	if (opt_verbose >= 2) {
-		uls_printf("hash-table distribution:\n");
-		for (i=0; i < ULF_HASH_TABLE_SIZE; i++) {
-			uls_printf("\t%2d] %d\n", i, g_hash_buckets[i]);
-		}
-		uls_printf("\n");
-	}
-}
-
 int
 proc_file(uls_keyw_stat_list_t *ks_lst, const char *filepath)
 {
@@ -363,7 +387,10 @@ proc_file(uls_keyw_stat_list_t *ks_lst, const char *filepath)
 		uls_get_tok(sam_lex);
 		if (uls_is_eoi(sam_lex)) break;
 
-		incl_if_keyw(ks_lst, uls_lexeme(sam_lex));
+		if (incl_if_keyw(ks_lst, uls_lexeme(sam_lex)) == 0 && uls_is_id(sam_lex)) {
+			// an identifier looked up in vain in the keyword table
+			g_n_misses += 1.;
+		}
 	}
 
 	return 1;
@@ -415,150 +442,227 @@ uls_hashfunc_set_params(stat_of_round_ptr_t p_round, int w0, int w1, int w2)
 	hs->weight[2] = w2;
 }
 
-void
-hashfunc_set_params_random(stat_of_round_ptr_t p_round)
+static void
+gen_random_weights(void)
 {
-	uls_hash_stat_t *hs = &p_round->hcodes;
-	int w0, w1, w2;
+	int i, w;
 
-	w0 = rand() % 100;
-	if (rand() % 2) w0 = -w0;
+	g_rand_weights = (int *) uls_malloc((n_samples > 0 ? n_samples : 1) * 3 * sizeof(int));
+	for (i = 0; i < n_samples * 3; i++) {
+		w = rand() % 100;
+		if (rand() % 2) w = -w;
+		g_rand_weights[i] = w;
+	}
+}
 
-	w1 = rand() % 100;
-	if (rand() % 2) w1 = -w1;
+/*
+ * The candidates of weights are numbered in the order of
+ *   { 1, 1, 1 }, the random samples, O1 and O2.
+ */
+static int
+count_candidates(void)
+{
+	int n = 1 + n_samples;
 
-	w2 = rand() % 100;
-	if (rand() % 2) w1 = -w1;
+	if (opt_optimize_level >= 1)
+		n += ULF_N_O1_WEIGHTS * ULF_N_O1_WEIGHTS * ULF_N_O1_WEIGHTS;
+	if (opt_optimize_level >= 2)
+		n += NUM_WPRIMES * NUM_WPRIMES * NUM_WPRIMES;
 
-	hs->weight[0] = w0;
-	hs->weight[1] = w1;
-	hs->weight[2] = w2;
+	return n;
 }
 
+static void
+set_candidate_params(stat_of_round_ptr_t p_round, int idx)
+{
+	int *w;
+
+	if (idx == 0) {
+		uls_hashfunc_set_params(p_round, 1, 1, 1);
+		return;
+	}
+	--idx;
+
+	if (idx < n_samples) {
+		w = g_rand_weights + 3 * idx;
+		uls_hashfunc_set_params(p_round, w[0], w[1], w[2]);
+		return;
+	}
+	idx -= n_samples;
+
+	if (opt_optimize_level >= 1) {
+		if (idx < ULF_N_O1_WEIGHTS * ULF_N_O1_WEIGHTS * ULF_N_O1_WEIGHTS) {
+			ulf_set_o1_weights(&p_round->hcodes, idx);
+			return;
+		}
+		idx -= ULF_N_O1_WEIGHTS * ULF_N_O1_WEIGHTS * ULF_N_O1_WEIGHTS;
+	}
+
+	uls_hashfunc_set_params(p_round,
+		weight_plist[idx / (NUM_WPRIMES * NUM_WPRIMES)],
+		weight_plist[(idx / NUM_WPRIMES) % NUM_WPRIMES],
+		weight_plist[idx % NUM_WPRIMES]);
+}
+
+/*
+ * Distributes the keywords by the hashcode of p_round.
+ * The cost of the round is ulf_hash_probes(), the same as uls_dump_profile_ulf() minimizes.
+ */
 void
-go_round(uls_keyw_stat_list_t *ks_lst, stat_of_round_ptr_t p_round)
+go_round(stat_of_round_ptr_t p_round, int *buckets)
 {
-	uls_ref_parray(lst, keyw_stat);
-	uls_decl_parray_slots(slots_lst, keyw_stat);
-	uls_keyw_stat_ptr_t e;
+	int table_size = p_round->hcodes.table_size;
 	double sum1, sum2, avg;
 	int i, hash, n;
 
-	lst = uls_ptr(ks_lst->lst);
-	slots_lst = uls_parray_slots(lst);
-
-	reset_hash_buckets();
-	for (i=0; i < ks_lst->lst.n; i++) {
-		e = slots_lst[i];
-		hash = ulf_hashfunc(&p_round->hcodes, e->keyw);
-		if (g_hash_buckets[hash] < INT_MAX)
-			++g_hash_buckets[hash];
-	}
+	p_round->state.probes = ulf_hash_probes(&p_round->hcodes, ulf_hashfunc,
+		g_ks_lst, g_n_misses, buckets);
 
 	n = 0;
 	sum1 = sum2 = 0.;
-	for (hash=0; hash < ULF_HASH_TABLE_SIZE; hash++) {
-		if ((i=g_hash_buckets[hash]) > 0) {
+	for (hash=0; hash < table_size; hash++) {
+		if ((i=buckets[hash]) > 0) {
 			sum1 += i;
-			sum2 += i*i;
+			sum2 += (double) i*i;
 			++n;
 		}
 	}
 
 	p_round->state.n_buckets = n;
-	p_round->state.avg = avg = sum1 / n;
-	p_round->state.sigma2 = sum2 / n - avg * avg;
-	p_round->state.gamma =  ( 1 / (1 + p_round->state.sigma2) + 1) * n;
+	p_round->state.avg = avg = n > 0 ? sum1 / n : 0.;
+	p_round->state.sigma2 = n > 0 ? sum2 / n - avg * avg : 0.;
 
 	if (opt_verbose >= 3) {
 		uls_hash_stat_t *hs = &p_round->hcodes;
-		int w0, w1, w2;
-
-		w0 = hs->weight[0];
-		w1 = hs->weight[1];
-		w2 = hs->weight[2];
-		uls_printf("w0=%d, w1=%d, w2=%d:\n", w0, w1, w2);
 
-		uls_printf("\t#buckets=%d, sum1=%f, sum2=%f\n", n, sum1, sum2);
-		uls_printf("\tavg=%f, sigma2=%f --> gamma=%f\n\n",
-			avg, p_round->state.sigma2, p_round->state.gamma);
+		uls_printf("w0=%d, w1=%d, w2=%d:\n\t#buckets=%d, sum1=%f, sum2=%f\n\tavg=%f, sigma2=%f --> probes=%f\n\n",
+			hs->weight[0], hs->weight[1], hs->weight[2],
+			n, sum1, sum2, avg, p_round->state.sigma2, p_round->state.probes);
 	}
 }
 
 void
-calc_good_hcode_O0(uls_keyw_stat_list_t *ks_lst, stat_of_round_ptr_t p_round)
+dump_hash_freq(stat_of_round_ptr_t p_round)
 {
-	stat_of_round_t  round;
-	int     i;
+	uls_hash_stat_t *hs = &p_round->hcodes;
+	int *buckets;
+	int i;
 
-	init_stat_round(uls_ptr(round));
+	uls_printf("table-size = %d, weight = { %d, %d, %d }\n",
+		hs->table_size, hs->weight[0], hs->weight[1], hs->weight[2]);
+
+	uls_printf("avg(%.2f), sigma2(%.2f), probes(%.3f)\n",
+		p_round->state.avg, p_round->state.sigma2, p_round->state.probes);
+
+	if (opt_verbose >= 2) {
+		buckets = (int *) uls_malloc(hs->table_size * sizeof(int));
+		go_round(p_round, buckets);
 
-	for (i = 0; i<n_samples; i++) {
-		hashfunc_set_params_random(uls_ptr(round));
-		go_round(ks_lst, uls_ptr(round));
-		if (round.state.gamma > p_round->state.gamma) {
-			copy_stat_round(uls_ptr(round), p_round);
+		uls_printf("hash-table distribution:\n");
+		for (i=0; i < hs->table_size; i++) {
+			uls_printf("\t%2d] %d\n", i, buckets[i]);
 		}
+		uls_printf("\n");
+		uls_mfree(buckets);
 	}
-
-	deinit_stat_round(uls_ptr(round));
 }
 
-void
-calc_good_hcode_O1(uls_keyw_stat_list_t *ks_lst, stat_of_round_ptr_t p_round)
+/*
+ * Each worker tries the candidates of its stride in ascending order,
+ *   keeping the first one of the least cost.
+ */
+static void *
+search_worker_proc(void *arg)
 {
-	stat_of_round_t  round;
-	int w0, w1, w2;
+	search_worker_ptr_t wrk = (search_worker_ptr_t) arg;
+	stat_of_round_t round;
+	int idx;
 
-	init_weights_indices();
 	init_stat_round(uls_ptr(round));
+	round.hcodes.table_size = wrk->best.hcodes.table_size;
 
-	do {
-		w0 = i_weight_list - 9;
-		w1 = j_weight_list - 9;
-		w2 = k_weight_list - 9;
+	for (idx = wrk->id; idx < g_n_candidates; idx += wrk->n_workers) {
+		set_candidate_params(uls_ptr(round), idx);
+		go_round(uls_ptr(round), wrk->buckets);
 
-		uls_hashfunc_set_params(uls_ptr(round), w0,  w1, w2);
-		go_round(ks_lst, uls_ptr(round));
-		if (round.state.gamma > p_round->state.gamma) {
-			copy_stat_round(uls_ptr(round), p_round);
+		if (wrk->i_best < 0 || round.state.probes < wrk->best.state.probes) {
+			copy_stat_round(uls_ptr(round), uls_ptr(wrk->best));
+			wrk->i_best = idx;
 		}
-	} while (next_weights_indices(19));
+	}
 
 	deinit_stat_round(uls_ptr(round));
+	return NULL;
 }
 
-void
-calc_good_hcode_O2(uls_keyw_stat_list_t *ks_lst, stat_of_round_ptr_t p_round)
+/*
+ * Searches the weights for a table of 'table_size' chains across the threads.
+ * The result doesn't depend on the number of threads,
+ *   ties being broken by the lower candidate number.
+ */
+static int
+calc_good_hcode(stat_of_round_ptr_t p_round, int table_size)
 {
-	stat_of_round_t  round;
-	int w0, w1, w2;
+	search_worker_t workers[ULFGEN_MAX_THREADS];
+	search_worker_ptr_t wrk;
+#ifdef HAVE_PTHREAD
+	pthread_t tids[ULFGEN_MAX_THREADS];
+	int started[ULFGEN_MAX_THREADS];
+#endif
+	int k, n_workers, i_best = -1;
 
-	init_weights_indices();
-	init_stat_round(uls_ptr(round));
+	n_workers = opt_n_threads;
+	if (n_workers > g_n_candidates) n_workers = g_n_candidates;
 
-	while (next_weights_indices(NUM_WPRIMES)) {
-		w0 = weight_plist[i_weight_list];
-		w1 = weight_plist[j_weight_list];
-		w2 = weight_plist[k_weight_list];
+	for (k = 0; k < n_workers; k++) {
+		wrk = workers + k;
+		wrk->id = k;
+		wrk->n_workers = n_workers;
+		wrk->buckets = (int *) uls_malloc(table_size * sizeof(int));
+		init_stat_round(uls_ptr(wrk->best));
+		wrk->best.hcodes.table_size = table_size;
+		wrk->i_best = -1;
+	}
+
+#ifdef HAVE_PTHREAD
+	for (k = 1; k < n_workers; k++) {
+		started[k] = pthread_create(tids + k, NULL, search_worker_proc, workers + k) == 0;
+	}
+	search_worker_proc(workers);
+	for (k = 1; k < n_workers; k++) {
+		if (started[k]) pthread_join(tids[k], NULL);
+		else search_worker_proc(workers + k);
+	}
+#else
+	for (k = 0; k < n_workers; k++) {
+		search_worker_proc(workers + k);
+	}
+#endif
 
-		uls_hashfunc_set_params(uls_ptr(round), w0,  w1, w2);
-		go_round(ks_lst, uls_ptr(round));
-		if (round.state.gamma > p_round->state.gamma) {
-			copy_stat_round(uls_ptr(round), p_round);
+	for (k = 0; k < n_workers; k++) {
+		wrk = workers + k;
+		if (wrk->i_best >= 0 && (i_best < 0 ||
+			wrk->best.state.probes < p_round->state.probes ||
+			(wrk->best.state.probes == p_round->state.probes && wrk->i_best < i_best))) {
+			copy_stat_round(uls_ptr(wrk->best), p_round);
+			i_best = wrk->i_best;
 		}
+
+		uls_mfree(wrk->buckets);
+		deinit_stat_round(uls_ptr(wrk->best));
 	}
 
-	deinit_stat_round(uls_ptr(round));
+	return i_best;
 }
 
 static int
 __create_file_internal(uls_keyw_stat_list_t *ks_lst, const char *tgt_dir,
 	FILE *fp_list, FILE *fp_out, int n_args, char *args[])
 {
-	stat_of_round_t best_round_stat;
+	stat_of_round_t best_round_stat, size_round_stats[ULF_N_TABLE_SIZES];
 	uls_hash_stat_t *hs;
-	int i, rval;
+	int i, rval, table_size, n_sizes = 0;
+	double least_probes = 0.;
 
 	if (ks_lst->lst.n <= 0) {
 		ult_log("%s: No keywords!", __func__);
@@ -593,32 +697,53 @@ __create_file_internal(uls_keyw_stat_list_t *ks_lst, const char *tgt_dir,
 		}
 	}
 
+	// the search models the chains of the ulf-file loaded
+	ulf_sort_kwstat_by_chain(ks_lst);
+	g_ks_lst = ks_lst;
+	gen_random_weights();
+	g_n_candidates = count_candidates();
+
 	init_stat_round(uls_ptr(best_round_stat));
 	hs = &best_round_stat.hcodes;
 
 	// 2. distribution of keywords in hash-table
-	uls_hashfunc_set_params(uls_ptr(best_round_stat), 1, 1, 1);
-	go_round(ks_lst, uls_ptr(best_round_stat));
+	if (opt_table_size > 0) {
+		calc_good_hcode(uls_ptr(best_round_stat), opt_table_size);
 
-	calc_good_hcode_O0(ks_lst, uls_ptr(best_round_stat));
+	} else {
+		for (n_sizes = 0; (table_size = ulf_table_size(n_sizes, ks_lst->lst.n)) > 0; n_sizes++) {
+			init_stat_round(uls_ptr(size_round_stats[n_sizes]));
+			calc_good_hcode(uls_ptr(size_round_stats[n_sizes]), table_size);
+			if (opt_verbose >= 1) {
+				uls_printf("table-size = %d: probes(%.3f)\n",
+					table_size, size_round_stats[n_sizes].state.probes);
+			}
 
-	if (opt_optimize_level >= 1) {
-		calc_good_hcode_O1(ks_lst, uls_ptr(best_round_stat));
-		uls_printf("O1: weight = { %d, %d, %d }\n",
-			hs->weight[0], hs->weight[1], hs->weight[2]
-		);
-	}
+			if (n_sizes == 0 || size_round_stats[n_sizes].state.probes < least_probes)
+				least_probes = size_round_stats[n_sizes].state.probes;
+		}
 
-	if (opt_optimize_level >= 2) {
-		calc_good_hcode_O2(ks_lst, uls_ptr(best_round_stat));
-		uls_printf("O2: weight = { %d, %d, %d }\n",
-			hs->weight[0], hs->weight[1], hs->weight[2]
-		);
+		// the smallest table within the slack of the least probes
+		for (i = 0; i < n_sizes; i++) {
+			if (size_round_stats[i].state.probes <= least_probes * (1. + ULF_PROBES_SLACK)) {
+				copy_stat_round(uls_ptr(size_round_stats[i]), uls_ptr(best_round_stat));
+				break;
+			}
+		}
 	}
 
 	dump_hash_freq(uls_ptr(best_round_stat));
+	g_ks_lst = NULL;
+
+	ulf_sort_kwstat_by_keyw(ks_lst);
 	rval = ulf_create_file(hs, ks_lst, fp_out);
+
+	for (i = 0; i < n_sizes; i++) {
+		deinit_stat_round(uls_ptr(size_round_stats[i]));
+	}
 	deinit_stat_round(uls_ptr(best_round_stat));
+	uls_mfree(g_rand_weights);
+
 	return rval;
 }
 
@@ -630,8 +755,6 @@ main_proc(const char *tgt_dir, FILE *fp_list,
 	uls_keyw_stat_list_t *ks_lst;
 	FILE *fp_out;
 
-	g_hash_buckets = (int *) uls_malloc(ULF_HASH_TABLE_SIZE * sizeof(int));
-
 	if ((fp_out = uls_fp_open(out_filepath, ULS_FIO_WRITE)) == NULL) {
 		ult_log("%s: fail to create '%s'", __func__, out_filepath);
 		return -1;
@@ -651,7 +774,6 @@ main_proc(const char *tgt_dir, FILE *fp_list,
 	}
 
 	uls_fp_close(fp_out);
-	uls_mfree(g_hash_buckets);
 
 	return stat;
 }
@@ -788,27 +910,3 @@ main(int argc, char *argv[])
 
 	return stat;
 }
-
-void
-init_weights_indices()
-{
-	i_weight_list = j_weight_list = k_weight_list = 0;
-}
-
-int
-next_weights_indices(int space_size)
-{
-
-	if (++k_weight_list >= space_size) {
-		if (++j_weight_list >= space_size) {
-			if (++i_weight_list >= space_size) {
-				init_weights_indices();
-				return 0;
-			}
-			j_weight_list = 0;
-		}
-		k_weight_list = 0;
-	}
-
-	return 1; // true
-}
@@ -0,0 +1,83 @@
+#!/bin/bash
+# Permission is hereby granted, free of charge, to any person
+# obtaining a copy of this software and associated documentation
+# files (the "Software"), to deal in the Software without
+# restriction, including without limitation the rights to use,
+# copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following
+# conditions:
+# 
+# The above copyright notice and this permission notice shall be
+# included in all copies or substantial portions of the Software.
+
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+# EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+# OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+# NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+# HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+# WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+# OTHER DEALINGS IN THE SOFTWARE.
+
+#
+# FILE: run_bench
+# DATE: October 2026
+# AUTHOR: Stanley Hong
+# DESCRIPTION: Measuring the throughput of ULS with the shipped specs
+#   This file is part of ULS, Unified Lexical Scheme.
+#
+# The environment variables below override the defaults.
+#   ULS_BENCH_SIZES    the corpus sizes, e.g. "1m 8m"
+#   ULS_BENCH_MODES    the input paths, e.g. "text,bin"
+#   ULS_BENCH_REPEAT   the number of repetitions per input path
+#   ULS_BENCH_OUT      the tab-separated result file
+#
+
+ULS_BENCH=./uls_bench
+
+top_srcdir=$1
+
+if [ -n "$LD_LIBRARY_PATH" ]; then
+	export LD_LIBRARY_PATH="$2:$LD_LIBRARY_PATH"
+else
+	export LD_LIBRARY_PATH="$2"
+fi
+
+if [ $# -ge 3 ]; then
+	export ULS_SYSPROPS=$3
+fi
+
+if [ ! -x $ULS_BENCH ]; then
+	echo "$ULS_BENCH : not found"
+	exit 1
+fi
+
+bench_sizes=${ULS_BENCH_SIZES:-"1m"}
+bench_modes=${ULS_BENCH_MODES:-"all"}
+bench_repeat=${ULS_BENCH_REPEAT:-3}
+bench_out=${ULS_BENCH_OUT:-"./uls_bench_$(date +%Y%m%d%H%M%S).tsv"}
+
+specs="examples/Css3/css3.ulc:css3
+examples/Html5/html5.ulc:html5
+examples/Shell/shell.ulc:shell
+examples/Mkf/mkf.ulc:mkf
+tests/many_kwrds/sample.ulc:many_kwrds"
+
+stat=0
+for ent in $specs; do
+	ulc_file="$top_srcdir/${ent%%:*}"
+	label="${ent##*:}"
+
+	for siz in $bench_sizes; do
+		if ! $ULS_BENCH -L "$ulc_file" -n $siz -m $bench_modes \
+			-r $bench_repeat -o "$bench_out" $label; then
+			echo "$label: failed to benchmark with size $siz"
+			stat=1
+		fi
+	done
+done
+
+cat "$bench_out"
+echo "The results are saved in $bench_out"
+exit $stat
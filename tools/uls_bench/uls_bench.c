@@ -0,0 +1,1011 @@
+/*
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+  <file> uls_bench.c </file>
+  <brief>
+    Measuring the throughput of the lexical analyzer on synthetic corpora.
+    This file is part of ULS, Unified Lexical Scheme.
+  </brief>
+  <author>
+    Stanley Hong <link2next@gmail.com>, October 2026.
+  </author>
+*/
+
+#include "uls.h"
+#include "uls/uls_auw.h"
+#include "uls/uls_misc.h"
+
+#include "ult_utils.h"
+#include "ult_log.h"
+#include <ctype.h>
+#include <time.h>
+#ifndef __ULS_WINDOWS__
+#include <sys/time.h>
+#include <sys/resource.h>
+#endif
+
+#define THIS_PROGNAME "uls_bench"
+#define DFL_CORPUS_SIZE  (1024*1024)
+#define DFL_N_REPEATS    3
+#define DFL_SEED         20111
+
+#define BENCH_MODE_TEXT   0x01
+#define BENCH_MODE_UTF16  0x02
+#define BENCH_MODE_BIN    0x04
+#define BENCH_MODE_TXT    0x08
+#define BENCH_MODE_ALL    0x0F
+
+#define BENCH_MAX_WORDLEN 63
+
+_ULS_DEFINE_STRUCT(bench_vocab)
+{
+	const char **keyws;
+	int n_keyws;
+	const char **opers;
+	int n_opers;
+	char quote_start, quote_end;
+	char id_first[64], id_chars[64];
+	int n_id_first, n_id_chars;
+};
+
+_ULS_DEFINE_STRUCT(bench_result)
+{
+	int n_bytes;
+	int n_toks;
+	double secs;
+	unsigned long n_allocs;
+	long peak_rss_kb;
+};
+
+char *progname;
+const char *config_file;
+char spec_label[ULS_FILEPATH_MAX+1];
+char *out_file;
+char *work_dir;
+int opt_verbose;
+int opt_header;
+int opt_keep;
+int bench_modes;
+int corpus_size;
+int n_repeats;
+unsigned int bench_seed;
+
+uls_lex_ptr_t sam_lex;
+static unsigned int rand_state;
+
+/*
+ * The allocations are counted by interposing malloc() in the executable.
+ * This needs the glibc entry points and does nothing elsewhere,
+ * in which case the column 'allocs' is reported as zero.
+ */
+#if defined(__GLIBC__) && !defined(ULS_BENCH_NO_MALLOC_HOOK)
+#define BENCH_COUNT_ALLOCS
+
+extern void *__libc_malloc(size_t n);
+extern void *__libc_calloc(size_t n, size_t siz);
+extern void *__libc_realloc(void *ptr, size_t n);
+
+static volatile unsigned long bench_n_allocs;
+
+void *
+malloc(size_t n)
+{
+	++bench_n_allocs;
+	return __libc_malloc(n);
+}
+
+void *
+calloc(size_t n, size_t siz)
+{
+	++bench_n_allocs;
+	return __libc_calloc(n, siz);
+}
+
+void *
+realloc(void *ptr, size_t n)
+{
+	++bench_n_allocs;
+	return __libc_realloc(ptr, n);
+}
+#endif
+
+#define ULSBENCH_OPTSTR "L:n:r:s:m:o:d:kvVHh"
+
+#ifdef HAVE_GETOPT
+#include <getopt.h>
+
+static const struct option longopts[] = {
+	{ "lang",     required_argument, NULL, 'L' },
+	{ "size",     required_argument, NULL, 'n' },
+	{ "repeat",   required_argument, NULL, 'r' },
+	{ "seed",     required_argument, NULL, 's' },
+	{ "mode",     required_argument, NULL, 'm' },
+	{ "output",   required_argument, NULL, 'o' },
+	{ "work-dir", required_argument, NULL, 'd' },
+	{ "keep",     no_argument,       NULL, 'k' },
+	{ "verbose",  no_argument,       NULL, 'v' },
+	{ "version",  no_argument,       NULL, 'V' },
+	{ "Help",     no_argument,       NULL, 'H' },
+	{ "help",     no_argument,       NULL, 'h' },
+	{ NULL, 0, NULL, 0 }
+};
+#endif
+
+static void usage_synopsis(void)
+{
+	ult_log("Usage: %s -L <ulc-file> [options] [label]", progname);
+	ult_log("  %s measures the throughput of the lexical analyzer on a synthetic corpus.", progname);
+	ult_log("       %s -L css3.ulc", progname);
+	ult_log("       %s -L css3.ulc -n 8m -m text,bin -o result.tsv css3", progname);
+}
+
+static void usage_desc(void)
+{
+#ifdef __ULS_WINDOWS__
+	ult_log("  -L <ulc-spec>      Specify the lexical-spec(*.ulc) of the language");
+	ult_log("  -n <size>          Specify the size of the corpus, suffixed by k or m");
+	ult_log("  -r <num>           Specify the number of repetitions per input path");
+	ult_log("  -s <seed>          Specify the seed of the corpus generator");
+	ult_log("  -m <modes>         Specify the input paths: text,utf16,bin,txt or all");
+	ult_log("  -o <a-file>        Append the results to the file instead of stdout");
+	ult_log("  -d <dir>           Specify the directory for the corpus files");
+	ult_log("  -k                 Keep the corpus files after measuring");
+	ult_log("  -v, --verbose      verbose mode");
+	ult_log("  -V, --version      Print the version information");
+	ult_log("  -h, --help         Display the short help");
+#else
+	ult_log("  -L, --lang=<ulc-spec>   Specify the lexical-spec(*.ulc) of the language");
+	ult_log("  -n, --size=<size>       Specify the size of the corpus, suffixed by k or m");
+	ult_log("  -r, --repeat=<num>      Specify the number of repetitions per input path");
+	ult_log("  -s, --seed=<seed>       Specify the seed of the corpus generator");
+	ult_log("  -m, --mode=<modes>      Specify the input paths: text,utf16,bin,txt or all");
+	ult_log("  -o, --output=<a-file>   Append the results to the file instead of stdout");
+	ult_log("  -d, --work-dir=<dir>    Specify the directory for the corpus files");
+	ult_log("  -k, --keep              Keep the corpus files after measuring");
+	ult_log("  -v, --verbose           verbose mode");
+	ult_log("  -V, --version           Print the version information");
+	ult_log("  -h, --help              Display the short help");
+#endif
+}
+
+static void usage_brief(void)
+{
+	usage_synopsis();
+	ult_log("");
+
+	usage_desc();
+	ult_log("");
+}
+
+static void usage(void)
+{
+	usage_brief();
+}
+
+static void usage_long(void)
+{
+	usage_brief();
+
+	ult_log("%s generates a deterministic corpus from the keywords of the given spec,", progname);
+	ult_log(" mixing them with identifiers, numbers and quoted strings.");
+	ult_log("The same corpus is tokenized through the text, utf16, bin and txt input paths.");
+	ult_log("The bin and txt paths replay the uls-stream files written from the corpus.");
+	ult_log("");
+
+	ult_log("A tab-separated line is printed per input path, whose columns are");
+	ult_log("  spec, mode, size, bytes, tokens, secs, tokens/s, bytes/s, allocs, allocs/token, peak-rss(KB)");
+	ult_log("The secs is the best of the repetitions. The line starting with '#' is the header.");
+	ult_log("");
+
+	ult_log("To compare the throughput before and after an upgrade,");
+	ult_log("  %s -L css3.ulc -n 4m -o before.tsv", progname);
+	ult_log("  %s -L css3.ulc -n 4m -o after.tsv", progname);
+	ult_log("");
+}
+
+static int
+parse_size(const char *str)
+{
+	char *endp;
+	long n;
+
+	n = strtol(str, &endp, 10);
+	if (*endp == 'k' || *endp == 'K') {
+		n *= 1024; ++endp;
+	} else if (*endp == 'm' || *endp == 'M') {
+		n *= 1024 * 1024; ++endp;
+	}
+
+	if (*endp != '\0' || n <= 0 || n > INT_MAX / 2) {
+		return -1;
+	}
+
+	return (int) n;
+}
+
+static int
+parse_modes(const char *str)
+{
+	const char *ptr, *wrd;
+	int len, modes = 0;
+
+	for (ptr = str; *ptr != '\0'; ) {
+		for (wrd = ptr; *ptr != '\0' && *ptr != ','; ptr++)
+			/* NOTHING */;
+		len = (int) (ptr - wrd);
+		if (*ptr == ',') ++ptr;
+
+		if (len == 4 && strncmp(wrd, "text", 4) == 0) {
+			modes |= BENCH_MODE_TEXT;
+		} else if (len == 5 && strncmp(wrd, "utf16", 5) == 0) {
+			modes |= BENCH_MODE_UTF16;
+		} else if (len == 3 && strncmp(wrd, "bin", 3) == 0) {
+			modes |= BENCH_MODE_BIN;
+		} else if (len == 3 && strncmp(wrd, "txt", 3) == 0) {
+			modes |= BENCH_MODE_TXT;
+		} else if (len == 3 && strncmp(wrd, "all", 3) == 0) {
+			modes |= BENCH_MODE_ALL;
+		} else {
+			return -1;
+		}
+	}
+
+	return modes;
+}
+
+static int ulsbench_options(int opt, char *optarg)
+{
+	int   stat = 0;
+
+	switch (opt) {
+	case 'L':
+		config_file = optarg;
+		break;
+
+	case 'n':
+		if ((corpus_size = parse_size(optarg)) < 0) {
+			ult_log("invalid corpus size '%s'", optarg);
+			stat = -1;
+		}
+		break;
+
+	case 'r':
+		if ((n_repeats = atoi(optarg)) <= 0) {
+			ult_log("invalid number of repetitions '%s'", optarg);
+			stat = -1;
+		}
+		break;
+
+	case 's':
+		bench_seed = (unsigned int) strtoul(optarg, NULL, 10);
+		break;
+
+	case 'm':
+		if ((bench_modes = parse_modes(optarg)) <= 0) {
+			ult_log("invalid modes '%s'", optarg);
+			stat = -1;
+		}
+		break;
+
+	case 'o':
+		out_file = ult_strdup(optarg);
+		uls_path_normalize(out_file, out_file);
+		break;
+
+	case 'd':
+		work_dir = ult_strdup(optarg);
+		uls_path_normalize(work_dir, work_dir);
+		break;
+
+	case 'k':
+		opt_keep = 1;
+		break;
+
+	case 'v':
+		++opt_verbose;
+		break;
+
+	case 'V':
+		uls_printf("%s %s, written by %s,\n\tis provided under %s.\n",
+			progname, ULS_BENCH_PROGVER, ULS_AUTHOR, ULS_LICENSE_NAME);
+		stat = 1;
+		break;
+
+	case 'H':
+		usage_long();
+		stat = 3;
+		break;
+
+	case 'h':
+		usage();
+		stat = 2;
+		break;
+
+	default:
+		ult_log("undefined option -%c", opt);
+		stat = -1;
+		break;
+	}
+
+	return stat;
+}
+
+static int
+parse_options(int argc, char *argv[])
+{
+#ifdef HAVE_GETOPT
+	int   rc, opt, longindex;
+#endif
+	int   i0;
+
+	out_file = NULL;
+	work_dir = NULL;
+	corpus_size = DFL_CORPUS_SIZE;
+	n_repeats = DFL_N_REPEATS;
+	bench_seed = DFL_SEED;
+	bench_modes = BENCH_MODE_ALL;
+
+#ifdef HAVE_GETOPT
+	while ((opt=getopt_long(argc, argv, ULSBENCH_OPTSTR, longopts, &longindex)) != -1) {
+		if ((rc=ulsbench_options(opt, optarg)) != 0) {
+			if (rc > 0) rc = 0;
+			return rc;
+		}
+	}
+	i0 = optind;
+#else
+	if ((i0=uls_getopts(argc, argv, ULSBENCH_OPTSTR, ulsbench_options)) <= 0) {
+		return i0;
+	}
+#endif
+
+	if (config_file == NULL) {
+		ult_log("specify the path of config-file(*.ulc)");
+		return -1;
+	}
+
+	return i0;
+}
+
+// ================================================================
+// The corpus generator
+
+static unsigned int
+bench_rand(void)
+{
+	// xorshift32: the corpus must be identical across the platforms.
+	rand_state ^= rand_state << 13;
+	rand_state ^= rand_state >> 17;
+	rand_state ^= rand_state << 5;
+	return rand_state;
+}
+
+static int
+is_bench_printable(const char *str)
+{
+	const char *ptr;
+
+	if (*str == '\0') return 0;
+
+	for (ptr = str; *ptr != '\0'; ptr++) {
+		if (*ptr <= ' ' || *ptr >= 0x7F) return 0;
+	}
+
+	return 1;
+}
+
+static int
+starts_with_mark(uls_lex_ptr_t uls, const char *keyw)
+{
+	uls_decl_parray_slots(slots_qmt, quotetype);
+	uls_quotetype_ptr_t qmt;
+	uls_commtype_ptr_t cmt;
+	const char *mark;
+	int i, len;
+
+	for (i = 0; i < uls->n_commtypes; i++) {
+		cmt = uls_get_array_slot_type01(uls_ptr(uls->commtypes), i);
+		mark = uls_get_namebuf_value(cmt->start_mark);
+		len = cmt->len_start_mark;
+		if (len > 0 && strncmp(keyw, mark, len) == 0) return 1;
+	}
+
+	slots_qmt = uls_parray_slots(uls_ptr(uls->quotetypes));
+	for (i = 0; i < uls->quotetypes.n; i++) {
+		qmt = slots_qmt[i];
+		mark = uls_get_namebuf_value(qmt->start_mark);
+		len = qmt->len_start_mark;
+		if (len > 0 && strncmp(keyw, mark, len) == 0) return 1;
+	}
+
+	return 0;
+}
+
+static int
+collect_vocab(uls_lex_ptr_t uls, bench_vocab_ptr_t vocab)
+{
+	uls_decl_parray_slots_init(slots_td, tokdef, uls_ptr(uls->tokdef_array));
+	uls_decl_parray_slots(slots_qmt, quotetype);
+	uls_quotetype_ptr_t qmt;
+	uls_tokdef_ptr_t e;
+	const char *keyw;
+	int i;
+
+	vocab->keyws = (const char **) uls_malloc((uls->tokdef_array.n + 1) * sizeof(char *));
+	vocab->opers = (const char **) uls_malloc((uls->tokdef_array.n + 1) * sizeof(char *));
+	vocab->n_keyws = vocab->n_opers = 0;
+
+	for (i = 0; i < uls->tokdef_array.n; i++) {
+		e = slots_td[i];
+		keyw = uls_get_namebuf_value(e->keyword);
+		if (!is_bench_printable(keyw) || starts_with_mark(uls, keyw)) continue;
+
+		if (e->keyw_type == ULS_KEYW_TYPE_IDSTR) {
+			vocab->keyws[vocab->n_keyws++] = keyw;
+		} else if (e->keyw_type == ULS_KEYW_TYPE_TWOPLUS || e->keyw_type == ULS_KEYW_TYPE_1CHAR) {
+			vocab->opers[vocab->n_opers++] = keyw;
+		}
+	}
+
+	// The identifiers are made of the ASCII letters and digits the spec accepts.
+	vocab->n_id_first = vocab->n_id_chars = 0;
+	for (i = '0'; i <= 'z'; i++) {
+		if (!isalnum(i)) continue;
+		if (uls->ch_context[i] & ULS_CH_IDFIRST) {
+			vocab->id_first[vocab->n_id_first++] = (char) i;
+		}
+		if (uls->ch_context[i] & (ULS_CH_IDFIRST | ULS_CH_ID)) {
+			vocab->id_chars[vocab->n_id_chars++] = (char) i;
+		}
+	}
+
+	vocab->quote_start = vocab->quote_end = '\0';
+	slots_qmt = uls_parray_slots(uls_ptr(uls->quotetypes));
+	for (i = 0; i < uls->quotetypes.n; i++) {
+		qmt = slots_qmt[i];
+		if (qmt->len_start_mark == 1 && qmt->len_end_mark == 1 &&
+			is_bench_printable(uls_get_namebuf_value(qmt->start_mark))) {
+			vocab->quote_start = uls_get_namebuf_value(qmt->start_mark)[0];
+			vocab->quote_end = uls_get_namebuf_value(qmt->end_mark)[0];
+			break;
+		}
+	}
+
+	if (opt_verbose) {
+		ult_log("%s: %d keywords, %d operators, quote '%c'", config_file,
+			vocab->n_keyws, vocab->n_opers, vocab->quote_start ? vocab->quote_start : ' ');
+	}
+
+	return 0;
+}
+
+static void
+free_vocab(bench_vocab_ptr_t vocab)
+{
+	uls_mfree(vocab->keyws);
+	uls_mfree(vocab->opers);
+}
+
+static int
+gen_word(char *buf, int min_len, int max_len)
+{
+	int i, len;
+
+	len = min_len + (int) (bench_rand() % (max_len - min_len + 1));
+	for (i = 0; i < len; i++) {
+		buf[i] = 'a' + (char) (bench_rand() % 26);
+	}
+	buf[len] = '\0';
+
+	return len;
+}
+
+static int
+gen_ident(bench_vocab_ptr_t vocab, char *buf)
+{
+	int i, len;
+
+	len = 1 + (int) (bench_rand() % 12);
+	buf[0] = vocab->id_first[bench_rand() % vocab->n_id_first];
+	for (i = 1; i < len; i++) {
+		buf[i] = vocab->id_chars[bench_rand() % vocab->n_id_chars];
+	}
+	buf[len] = '\0';
+
+	return len;
+}
+
+static int
+gen_token(bench_vocab_ptr_t vocab, char *buf)
+{
+	unsigned int r = bench_rand() % 100;
+	int i, len;
+
+	if (r < 30 && vocab->n_keyws > 0) {
+		strcpy(buf, vocab->keyws[bench_rand() % vocab->n_keyws]);
+		len = (int) strlen(buf);
+
+	} else if (r < 45 && vocab->n_opers > 0) {
+		strcpy(buf, vocab->opers[bench_rand() % vocab->n_opers]);
+		len = (int) strlen(buf);
+
+	} else if (r < 60 || vocab->n_id_first == 0) {
+		len = (int) (bench_rand() % 6) + 1;
+		buf[0] = '1' + (char) (bench_rand() % 9);
+		for (i = 1; i < len; i++) {
+			buf[i] = '0' + (char) (bench_rand() % 10);
+		}
+		buf[len] = '\0';
+
+	} else if (r < 70 && vocab->quote_start != '\0') {
+		buf[0] = vocab->quote_start;
+		len = 1 + gen_word(buf + 1, 2, 24);
+		buf[len++] = vocab->quote_end;
+		buf[len] = '\0';
+
+	} else {
+		len = gen_ident(vocab, buf);
+	}
+
+	return len;
+}
+
+static int
+write_corpus(bench_vocab_ptr_t vocab, const char *fpath_text, const char *fpath_utf16)
+{
+	char wrdbuf[BENCH_MAX_WORDLEN + ULS_TWOPLUS_WMAXLEN*ULS_UTF8_CH_MAXLEN + 4];
+	FILE *fp_text, *fp_wide;
+	int i, len, n_bytes = 0, n_line = 0;
+
+	if ((fp_text = uls_fp_open(fpath_text, ULS_FIO_WRITE | ULS_FIO_NO_UTF8BOM)) == NULL) {
+		ult_log("%s: can't create %s", __func__, fpath_text);
+		return -1;
+	}
+
+	if ((fp_wide = uls_fp_open(fpath_utf16, ULS_FIO_WRITE | ULS_FIO_NO_UTF8BOM)) == NULL) {
+		ult_log("%s: can't create %s", __func__, fpath_utf16);
+		uls_fp_close(fp_text);
+		return -1;
+	}
+
+	// The BOM of UTF-16LE, the corpus is composed of ASCII chars only.
+	fputc(0xFF, fp_wide);
+	fputc(0xFE, fp_wide);
+
+	rand_state = bench_seed != 0 ? bench_seed : DFL_SEED;
+
+	while (n_bytes < corpus_size) {
+		len = gen_token(vocab, wrdbuf);
+
+		if (++n_line >= 8 + (int) (bench_rand() % 8)) {
+			wrdbuf[len++] = '\n';
+			n_line = 0;
+		} else {
+			wrdbuf[len++] = ' ';
+		}
+
+		fwrite(wrdbuf, 1, len, fp_text);
+		for (i = 0; i < len; i++) {
+			fputc(wrdbuf[i], fp_wide);
+			fputc(0x00, fp_wide);
+		}
+
+		n_bytes += len;
+	}
+
+	uls_fp_close(fp_text);
+	uls_fp_close(fp_wide);
+
+	return n_bytes;
+}
+
+static int
+write_uls_file(uls_lex_ptr_t uls, const char *fpath_text, const char *fpath_uls, int stream_type)
+{
+	uls_ostream_ptr_t ostr;
+	int fd_out, lno, stat = 0;
+
+	if ((fd_out = ult_fd_create_wronly(fpath_uls)) < 0) {
+		ult_log("%s: can't create %s", __func__, fpath_uls);
+		return -1;
+	}
+
+	if ((ostr = __uls_create_ostream(fd_out, uls, stream_type, THIS_PROGNAME)) == uls_nil) {
+		ult_log("%s: can't set uls-stream to %s", __func__, fpath_uls);
+		ult_fd_close(fd_out);
+		return -1;
+	}
+
+	if (uls_push_file(uls, fpath_text, 0) < 0) {
+		ult_log("%s: can't open %s", __func__, fpath_text);
+		stat = -1;
+
+	} else {
+		lno = uls_get_lineno(uls);
+		__uls_print_tok_linenum(ostr, lno, fpath_text, strlen(fpath_text));
+
+		for ( ; ; ) {
+			uls_get_tok(uls);
+			if (uls_is_err(uls)) {
+				stat = -1;
+				break;
+			}
+
+			if (uls_is_eoi(uls)) break;
+
+			if (lno != uls_get_lineno(uls)) {
+				lno = uls_get_lineno(uls);
+				__uls_print_tok_linenum(ostr, lno, NULL, 0);
+			}
+
+			if (__uls_print_tok(ostr, uls_tok(uls), uls_lexeme(uls), uls_lexeme_len(uls)) < 0) {
+				stat = -1;
+				break;
+			}
+		}
+
+		uls_pop(uls);
+	}
+
+	uls_destroy_ostream(ostr);
+	ult_fd_close(fd_out);
+
+	return stat;
+}
+
+// ================================================================
+// The measurements
+
+static double
+bench_clock(void)
+{
+#ifdef __ULS_WINDOWS__
+	return (double) clock() / CLOCKS_PER_SEC;
+#else
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+#endif
+}
+
+static void
+reset_peak_rss(void)
+{
+#ifdef __LINUX__
+	FILE *fp;
+
+	// Writing '5' resets the high-water mark VmHWM, since Linux 4.0.
+	if ((fp = fopen("/proc/self/clear_refs", "w")) != NULL) {
+		fputs("5", fp);
+		fclose(fp);
+	}
+#endif
+}
+
+static long
+get_peak_rss(void)
+{
+	long kb = 0;
+#ifdef __LINUX__
+	char linebuff[128];
+	FILE *fp;
+
+	if ((fp = fopen("/proc/self/status", "r")) != NULL) {
+		while (fgets(linebuff, sizeof(linebuff), fp) != NULL) {
+			if (strncmp(linebuff, "VmHWM:", 6) == 0) {
+				kb = atol(linebuff + 6);
+				break;
+			}
+		}
+		fclose(fp);
+	}
+#endif
+#ifndef __ULS_WINDOWS__
+	if (kb <= 0) {
+		struct rusage ru;
+		if (getrusage(RUSAGE_SELF, &ru) == 0) kb = ru.ru_maxrss;
+	}
+#endif
+	return kb;
+}
+
+static int
+bench_run_once(uls_lex_ptr_t uls, const char *fpath, bench_result_ptr_t res)
+{
+	int n_toks = 0;
+	double t0, t1;
+
+#ifdef BENCH_COUNT_ALLOCS
+	bench_n_allocs = 0;
+#endif
+	t0 = bench_clock();
+
+	if (uls_push_file(uls, fpath, 0) < 0) {
+		ult_log("%s: can't open %s", __func__, fpath);
+		return -1;
+	}
+
+	for ( ; ; ) {
+		uls_get_tok(uls);
+		if (uls_is_err(uls)) {
+			ult_log("%s: lexical error at line %d", fpath, uls_get_lineno(uls));
+			uls_pop(uls);
+			return -1;
+		}
+		if (uls_is_eoi(uls)) break;
+		++n_toks;
+	}
+
+	uls_pop(uls);
+	t1 = bench_clock();
+
+	res->n_toks = n_toks;
+	res->secs = t1 - t0;
+#ifdef BENCH_COUNT_ALLOCS
+	res->n_allocs = bench_n_allocs;
+#else
+	res->n_allocs = 0;
+#endif
+
+	return 0;
+}
+
+static int
+bench_input_path(uls_lex_ptr_t uls, const char *fpath, bench_result_ptr_t res)
+{
+	bench_result_t res1;
+	int i;
+
+	reset_peak_rss();
+
+	for (i = 0; i < n_repeats; i++) {
+		if (bench_run_once(uls, fpath, uls_ptr(res1)) < 0) {
+			return -1;
+		}
+
+		if (i == 0 || res1.secs < res->secs) {
+			res->secs = res1.secs;
+		}
+		res->n_toks = res1.n_toks;
+		res->n_allocs = res1.n_allocs;
+	}
+
+	res->peak_rss_kb = get_peak_rss();
+	return 0;
+}
+
+static void
+print_result(FILE *fp_out, const char *mode, bench_result_ptr_t res)
+{
+	double secs = res->secs > 0. ? res->secs : 1e-9;
+
+	fprintf(fp_out, "%s\t%s\t%d\t%d\t%d\t%.6f\t%.0f\t%.0f\t%lu\t%.4f\t%ld\n",
+		spec_label, mode, corpus_size, res->n_bytes, res->n_toks, res->secs,
+		res->n_toks / secs, res->n_bytes / secs, res->n_allocs,
+		res->n_toks > 0 ? (double) res->n_allocs / res->n_toks : 0.,
+		res->peak_rss_kb);
+	fflush(fp_out);
+}
+
+static void
+make_work_path(char *fpath, const char *suffix)
+{
+	const char *dir = work_dir != NULL ? work_dir : "/tmp";
+	uls_snprintf(fpath, ULS_FILEPATH_MAX+1, "%s/%s_%d%s", dir, THIS_PROGNAME, (int) getpid(), suffix);
+}
+
+static int
+bench_spec(uls_lex_ptr_t uls, FILE *fp_out)
+{
+	char fpath_text[ULS_FILEPATH_MAX+1], fpath_utf16[ULS_FILEPATH_MAX+1];
+	char fpath_bin[ULS_FILEPATH_MAX+1], fpath_txt[ULS_FILEPATH_MAX+1];
+	bench_vocab_t vocab;
+	bench_result_t res;
+	int n_bytes, stat = 0;
+
+	make_work_path(fpath_text, ".txt");
+	make_work_path(fpath_utf16, "_utf16.txt");
+	make_work_path(fpath_bin, "_bin.uls");
+	make_work_path(fpath_txt, "_txt.uls");
+
+	collect_vocab(uls, uls_ptr(vocab));
+	n_bytes = write_corpus(uls_ptr(vocab), fpath_text, fpath_utf16);
+	free_vocab(uls_ptr(vocab));
+	if (n_bytes < 0) return -1;
+
+	if ((bench_modes & BENCH_MODE_BIN) &&
+		write_uls_file(uls, fpath_text, fpath_bin, ULS_STREAM_BIN_LE) < 0) {
+		ult_log("%s: fail to write the uls-stream", fpath_bin);
+		stat = -1; goto end_1;
+	}
+
+	if ((bench_modes & BENCH_MODE_TXT) &&
+		write_uls_file(uls, fpath_text, fpath_txt, ULS_STREAM_TXT) < 0) {
+		ult_log("%s: fail to write the uls-stream", fpath_txt);
+		stat = -1; goto end_1;
+	}
+
+	if (opt_header) {
+		fprintf(fp_out, "#spec\tmode\tsize\tbytes\ttokens\tsecs\ttokens_per_sec"
+			"\tbytes_per_sec\tallocs\tallocs_per_tok\tpeak_rss_kb\n");
+	}
+
+	// The bytes/s is computed against the text corpus for all the paths.
+	res.n_bytes = n_bytes;
+
+	if (bench_modes & BENCH_MODE_TEXT) {
+		if (bench_input_path(uls, fpath_text, uls_ptr(res)) < 0) {
+			stat = -1; goto end_1;
+		}
+		print_result(fp_out, "text", uls_ptr(res));
+	}
+
+	if (bench_modes & BENCH_MODE_UTF16) {
+		if (bench_input_path(uls, fpath_utf16, uls_ptr(res)) < 0) {
+			stat = -1; goto end_1;
+		}
+		print_result(fp_out, "utf16", uls_ptr(res));
+	}
+
+	if (bench_modes & BENCH_MODE_BIN) {
+		if (bench_input_path(uls, fpath_bin, uls_ptr(res)) < 0) {
+			stat = -1; goto end_1;
+		}
+		print_result(fp_out, "bin", uls_ptr(res));
+	}
+
+	if (bench_modes & BENCH_MODE_TXT) {
+		if (bench_input_path(uls, fpath_txt, uls_ptr(res)) < 0) {
+			stat = -1; goto end_1;
+		}
+		print_result(fp_out, "txt", uls_ptr(res));
+	}
+
+ end_1:
+	if (!opt_keep) {
+		uls_unlink(fpath_text);
+		uls_unlink(fpath_utf16);
+		if (bench_modes & BENCH_MODE_BIN) uls_unlink(fpath_bin);
+		if (bench_modes & BENCH_MODE_TXT) uls_unlink(fpath_txt);
+	}
+
+	return stat;
+}
+
+int
+main_ustr(int argc, char *argv[])
+{
+	FILE *fp_out;
+	const char *conf_fname;
+	int i0, conf_fname_len, stat = 0;
+
+	progname = THIS_PROGNAME;
+	if (argc <= 1) {
+		usage_brief();
+		return 1;
+	}
+
+	if (ulc_prepend_searchpath_pwd() < 0) {
+		ult_log("InternalError: don't know about the program '%s'.", THIS_PROGNAME);
+		return -1;
+	}
+
+	if ((i0 = parse_options(argc, argv)) <= 0) {
+		if (i0 < 0) ult_log("Incorrect use of command options.");
+		return i0;
+	}
+
+	if (i0 < argc) {
+		uls_strcpy(spec_label, argv[i0]);
+	} else {
+		conf_fname = uls_filename(config_file, &conf_fname_len);
+		uls_strncpy(spec_label, conf_fname, conf_fname_len);
+	}
+
+	if ((sam_lex = uls_create(config_file)) == uls_nil) {
+		ult_log("can't create a uls-object for %s.", config_file);
+		return -1;
+	}
+
+	if (out_file != NULL) {
+		// The header is written only once into a new output file.
+		opt_header = uls_dirent_exist(out_file) != ST_MODE_FILE;
+		if ((fp_out = fopen(out_file, "a")) == NULL) {
+			ult_log("%s: can't append to %s", __func__, out_file);
+			uls_destroy(sam_lex);
+			return -1;
+		}
+	} else {
+		opt_header = 1;
+		fp_out = _uls_stdio_fp(1);
+	}
+
+	if (bench_spec(sam_lex, fp_out) < 0) {
+		ult_log("%s: fail to benchmark", config_file);
+		stat = -1;
+	}
+
+	if (out_file != NULL) {
+		fclose(fp_out);
+	}
+
+	uls_destroy(sam_lex);
+
+	uls_mfree(out_file);
+	uls_mfree(work_dir);
+
+	return stat;
+}
+
+int
+main(int argc, char *argv[])
+{
+	int i, stat = 0;
+	char **uargs;
+#ifdef __ULS_WINDOWS__
+	auw_outparam_t *arglst;
+	const char *ustr;
+#endif
+
+	uargs = (char **) uls_malloc(argc *sizeof(char *));
+
+#ifdef __ULS_WINDOWS__
+	arglst = (auw_outparam_t *) uls_malloc(argc *sizeof(auw_outparam_t));
+	for (i = 0; i < argc; i++) {
+		auw_init_outparam(arglst + i);
+	}
+
+	for (i = 0; i < argc; i++) {
+		if ((ustr = uls_astr2ustr_ptr(argv[i], -1, arglst + i)) == NULL) {
+			stat = -1;
+			uargs[i] = NULL;
+		} else {
+			uargs[i] = uls_strdup(ustr, -1);
+		}
+	}
+#else
+	for (i = 0; i < argc; i++) {
+		uargs[i] = uls_strdup(argv[i], -1);
+	}
+#endif
+
+	if (stat == 0) {
+		stat = main_ustr(argc, uargs);
+	}
+
+	for (i = 0; i < argc; i++) {
+		uls_mfree(uargs[i]);
+	}
+	uls_mfree(uargs);
+
+#ifdef __ULS_WINDOWS__
+	for (i = 0; i < argc; i++) {
+		auw_deinit_outparam(arglst + i);
+	}
+	uls_mfree(arglst);
+#endif
+
+	return stat;
+}
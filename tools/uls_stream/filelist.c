@@ -30,6 +30,10 @@
 #include "write_uls.h"
 #include "ult_log.h"
 
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+
 #ifdef ULS_FDF_SUPPORT
 static int
 conglomerate_uls_files_via_filter(int fd_list, const char *cmd_flt, uls_ostream_ptr_t ostr)
@@ -137,6 +141,225 @@ conglomerate_files(FILE *fp_list, uls_ostream_t* ostr)
 	return stat;
 }
 
+#ifdef HAVE_PTHREAD
+#define CGLM_FILE_PENDING  0
+#define CGLM_FILE_DONE     1
+#define CGLM_FILE_NOTFOUND 2
+#define CGLM_FILE_FAILED   3
+
+// The number of files lexed ahead of the writer per a job
+#define CGLM_FILES_AHEAD   4
+
+typedef struct _cglm_file cglm_file_t;
+struct _cglm_file {
+	char *filepath;
+	uls_ostream_ptr_t seg;
+	int  stat;
+};
+
+typedef struct _cglm_pool cglm_pool_t;
+struct _cglm_pool {
+	uls_ostream_ptr_t ostr;
+	cglm_file_t *files;
+	int  n_files, n_alloc_files;
+
+	int  i_next;  // the next file to lex
+	int  i_write; // the next file to append to ostr
+	int  n_ahead, aborted;
+
+	pthread_mutex_t mtx;
+	pthread_cond_t  cond;
+};
+
+typedef struct _cglm_worker cglm_worker_t;
+struct _cglm_worker {
+	cglm_pool_t *pool;
+	uls_lex_ptr_t uls;
+};
+
+static int
+load_filelist(FILE *fp_list, cglm_pool_t *pool)
+{
+	char linebuff[ULS_LINEBUFF_SIZ+1], *lptr;
+	cglm_file_t *f;
+	int len;
+
+	while (1) {
+		if ((len=uls_fp_gets(fp_list, linebuff, sizeof(linebuff), 0)) <= ULS_EOF) {
+			if (len < ULS_EOF) {
+				return -1;
+			}
+			break;
+		}
+
+		if (*(lptr = skip_blanks(linebuff)) == '\0' || *lptr == '#')
+			continue;
+
+		str_trim_end(lptr, -1);
+
+		if (pool->n_files >= pool->n_alloc_files) {
+			pool->n_alloc_files = uls_roundup(pool->n_files + 1, 256);
+			pool->files = (cglm_file_t *) uls_mrealloc(pool->files,
+				pool->n_alloc_files * sizeof(cglm_file_t));
+		}
+
+		f = pool->files + pool->n_files++;
+		f->filepath = ult_strdup(lptr);
+		f->seg = uls_nil;
+		f->stat = CGLM_FILE_PENDING;
+	}
+
+	return 0;
+}
+
+/*
+ * Lexes the files taken in list order into the segments of their own.
+ * The segments are created and destroyed with the mutex held
+ *   since they grab and ungrab the lexer of the worker.
+ */
+static void *
+cglm_worker_proc(void *arg)
+{
+	cglm_worker_t *wrk = (cglm_worker_t *) arg;
+	cglm_pool_t *pool = wrk->pool;
+	cglm_file_t *f;
+	uls_ostream_ptr_t seg;
+	int fd, stat;
+
+	pthread_mutex_lock(&pool->mtx);
+
+	while (!pool->aborted && pool->i_next < pool->n_files) {
+		if (pool->i_next >= pool->i_write + pool->n_ahead) {
+			pthread_cond_wait(&pool->cond, &pool->mtx);
+			continue;
+		}
+
+		f = pool->files + pool->i_next++;
+		seg = uls_create_ostream_seg(pool->ostr, wrk->uls);
+		pthread_mutex_unlock(&pool->mtx);
+
+		if ((fd = ult_fd_open_rdonly(f->filepath)) < 0) {
+			stat = CGLM_FILE_NOTFOUND;
+		} else {
+			if (seg == uls_nil || conglomerate_uls_file(fd, f->filepath, seg) < 0) {
+				stat = CGLM_FILE_FAILED;
+			} else {
+				stat = CGLM_FILE_DONE;
+			}
+			ult_fd_close(fd);
+		}
+
+		pthread_mutex_lock(&pool->mtx);
+		f->seg = seg;
+		f->stat = stat;
+		pthread_cond_broadcast(&pool->cond);
+	}
+
+	pthread_mutex_unlock(&pool->mtx);
+	return NULL;
+}
+
+/*
+ * The same as conglomerate_files() except that 'n_jobs' threads lex the files.
+ * The segments are appended to 'ostr' in list order by this (writer) thread,
+ *   so the output is identical to the one of conglomerate_files().
+ */
+static int
+conglomerate_files_parallel(FILE *fp_list, uls_ostream_ptr_t ostr, int n_jobs)
+{
+	cglm_pool_t pool;
+	cglm_worker_t workers[ULSSTREAM_MAX_JOBS];
+	pthread_t tids[ULSSTREAM_MAX_JOBS];
+	int started[ULSSTREAM_MAX_JOBS];
+	cglm_file_t *f;
+	int i, k, n_started = 0, stat = 0;
+
+	memset(&pool, 0x00, sizeof(pool));
+	pool.ostr = ostr;
+
+	if (load_filelist(fp_list, &pool) < 0) {
+		ult_log("%s: fail to read the list", __func__);
+		stat = -1; goto end_1;
+	}
+
+	if (n_jobs > pool.n_files) n_jobs = pool.n_files;
+	pool.n_ahead = CGLM_FILES_AHEAD * n_jobs;
+
+	pthread_mutex_init(&pool.mtx, NULL);
+	pthread_cond_init(&pool.cond, NULL);
+
+	for (k = 0; k < n_jobs; k++) {
+		workers[k].pool = &pool;
+		started[k] = 0;
+
+		// The lexers share the compiled spec, giving the same token numbers.
+		if ((workers[k].uls = uls_create_shared(ulc_config)) == uls_nil) {
+			ult_log("Failed to create the lexical analyzer for '%s'.", ulc_config);
+			continue;
+		}
+
+		if ((started[k] = pthread_create(tids + k, NULL, cglm_worker_proc, workers + k) == 0)) {
+			++n_started;
+		}
+	}
+
+	if (n_started == 0 && pool.n_files > 0) {
+		ult_log("%s: no thread to lex the files", __func__);
+		stat = -1;
+	}
+
+	pthread_mutex_lock(&pool.mtx);
+
+	for (i = 0; stat == 0 && i < pool.n_files; i++) {
+		f = pool.files + i;
+		while (f->stat == CGLM_FILE_PENDING) {
+			pthread_cond_wait(&pool.cond, &pool.mtx);
+		}
+
+		ult_log("%s:", f->filepath);
+
+		if (f->stat == CGLM_FILE_NOTFOUND) {
+			ult_log("Can't open '%s'! continuing...", f->filepath);
+		} else if (f->stat == CGLM_FILE_FAILED || uls_append_ostream_seg(ostr, f->seg) < 0) {
+			ult_log("Fail to process '%s'! breaking...", f->filepath);
+			stat = -1;
+		}
+
+		if (f->seg != uls_nil) {
+			uls_destroy_ostream(f->seg);
+			f->seg = uls_nil;
+		}
+
+		pool.i_write = i + 1;
+		pthread_cond_broadcast(&pool.cond);
+	}
+
+	pool.aborted = 1;
+	pthread_cond_broadcast(&pool.cond);
+	pthread_mutex_unlock(&pool.mtx);
+
+	for (k = 0; k < n_jobs; k++) {
+		if (started[k]) pthread_join(tids[k], NULL);
+		if (workers[k].uls != uls_nil) uls_destroy(workers[k].uls);
+	}
+
+	pthread_cond_destroy(&pool.cond);
+	pthread_mutex_destroy(&pool.mtx);
+
+	if (!stat) ult_log("\nDone!");
+
+ end_1:
+	for (i = 0; i < pool.n_files; i++) {
+		f = pool.files + i;
+		if (f->seg != uls_nil) uls_destroy_ostream(f->seg);
+		uls_mfree(f->filepath);
+	}
+	uls_mfree(pool.files);
+
+	return stat;
+}
+#endif
+
 int
 proc_filelist(const char *tgt_dir)
 {
@@ -196,9 +419,20 @@ proc_filelist(const char *tgt_dir)
 			if (uls_chdir(tgt_dir) < 0) {
 				ult_log("can't change to %s", tgt_dir);
 				stat = -4;
-			} else if ((rc = conglomerate_files(fp_list, ostr)) < 0) {
-				ult_log("fail to process %s.", filelist);
-				stat = -5;
+			} else {
+#ifdef HAVE_PTHREAD
+				if (opt_n_jobs > 1) {
+					rc = conglomerate_files_parallel(fp_list, ostr, opt_n_jobs);
+				} else {
+					rc = conglomerate_files(fp_list, ostr);
+				}
+#else
+				rc = conglomerate_files(fp_list, ostr);
+#endif
+				if (rc < 0) {
+					ult_log("fail to process %s.", filelist);
+					stat = -5;
+				}
 			}
 		}
 		uls_fp_close(fp_list);
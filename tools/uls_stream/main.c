@@ -45,16 +45,17 @@
 #define THIS_PROGNAME "uls_stream"
 
 #ifdef ULS_FDF_SUPPORT
-#define ULSSTREAM_OPTSTR "bo:t:T:L:n:vsC:VHhf:z"
+#define ULSSTREAM_OPTSTR "bo:t:T:L:n:vsSC:j:VHhf:z"
 #else
-#define ULSSTREAM_OPTSTR "bo:t:T:L:n:vsC:VHhz"
+#define ULSSTREAM_OPTSTR "bo:t:T:L:n:vsSC:j:VHhz"
 #endif
 
 int uls_endian;
 char *progname;
 int  opt_verbose, opt_binary;
 int  opt_no_numbering;
-int  opt_mygcc;
+int  opt_mygcc, opt_stats;
+int  opt_n_jobs = 1;
 
 char home_dir[ULS_FILEPATH_MAX+1];
 const char *ulc_config, *tag_name;
@@ -77,12 +78,14 @@ static const struct option longopts[] = {
 	{ "tmpl",    required_argument,        NULL, 'T' },
 	{ "lang",    required_argument,        NULL, 'L' },
 	{ "conglomerate", required_argument,   NULL, 'C' },
+	{ "jobs",    required_argument,        NULL, 'j' },
 #ifdef ULS_FDF_SUPPORT
 	{ "filter",  required_argument,        NULL, 'f' },
 #endif
 	{ "mygcc",   no_argument,              NULL, 'z' },
 	{ "name",    required_argument,        NULL, 'n' },
 	{ "short",   no_argument,              NULL, 's' },
+	{ "stats",   no_argument,              NULL, 'S' },
 	{ "verbose", no_argument,              NULL, 'v' },
 	{ "version", no_argument,              NULL, 'V' },
 	{ "Help",    no_argument,              NULL, 'H' },
@@ -97,7 +100,7 @@ static void usage_synopsis(void)
 	ult_log("    %s generates token sequence file from (plain text) input files.", progname);
 	ult_log("       %s <uls-file|(*.uls)>", progname);
 	ult_log("       %s -L <ulc-file> [-b] [-o <output-file>] <text-file|(*.uls)>", progname);
-	ult_log("       %s [-L <ulc-file>] -C <listing-of-files> <target-dir>", progname);
+	ult_log("       %s [-L <ulc-file>] -C <listing-of-files> [-j <num>] <target-dir>", progname);
 	ult_log("       %s [-L <ulc-file>] -C <listing-of-files> -f 'filter-path' <target-dir>", progname);
 }
 
@@ -108,6 +111,8 @@ static void usage_desc(void)
 	ult_log("  -o <filepath>     Specify the output filepath");
 	ult_log("  -t <file-type>    Specify the type of the output file");
 	ult_log("  -C <listfile>     This outputs a conglomerate file from the multiple input-files");
+	ult_log("  -j <num>          Lex the files of -C-option in <num> threads");
+	ult_log("  -S                Print the counters of the lexical analyzer at exit");
 	ult_log("  -v                Verbose mode.");
 	ult_log("  -V                Prints the version information.");
 	ult_log("  -h                Display a short help.");
@@ -116,9 +121,11 @@ static void usage_desc(void)
 	ult_log("  -o, --output=<filepath>       Specify the output filepath.");
 	ult_log("  -t, --type=<file-type>        Specify the type of the output file");
 	ult_log("  -C, --conglomerate=<listfile> This outputs a conglomerate file from the multiple input-files");
+	ult_log("  -j, --jobs=<num>              Lex the files of -C-option in <num> threads");
 #ifdef ULS_FDF_SUPPORT
 	ult_log("  -f, --filter=<cmdline>        Specify the filter for the input files with the -C-option");
 #endif
+	ult_log("  -S, --stats                   Print the counters of the lexical analyzer at exit");
 	ult_log("  -v, --verbose                 Verbose mode.");
 	ult_log("  -V, --version                 Print the version information");
 	ult_log("  -h, --help                    Display a short help");
@@ -198,6 +205,10 @@ static void usage_long(void)
 	ult_log("The output file is specified with -o-option.");
 	ult_log("The default output-file in binary mode is 'a.uls'.");
 
+	ult_log("With -j-option, the files in the list are lexed in parallel by <num> threads.");
+	ult_log("The output is the same as the one without it, the files being appended in the order of the list.");
+	ult_log("  %s -C a.list -j 8 /package/home/target-dir", progname);
+
 	ult_log("The -f-option can be used with -C-option to filter the files before the input to be passed to lexical analyzer.");
 	ult_log("The argument of -f-option should be a command line which inputs from stdin and outputs to stdout like 'gcc -E'.");
 	ult_log("");
@@ -354,10 +365,22 @@ ulsstream_options(int opt, char *optarg)
 		uls_path_normalize(filelist, filelist);
 		break;
 
+	case 'j':
+		opt_n_jobs = uls_str2int(optarg);
+		if (opt_n_jobs <= 0 || opt_n_jobs > ULSSTREAM_MAX_JOBS) {
+			ult_log("%s: the number of jobs should be in [1,%d]", optarg, ULSSTREAM_MAX_JOBS);
+			stat = -1;
+		}
+		break;
+
 	case 's': // short
 		opt_no_numbering = 1;
 		break;
 
+	case 'S':
+		opt_stats = 1;
+		break;
+
 	case 'n':
 		tag_name = optarg;
 		break;
@@ -486,6 +509,39 @@ add_name_val_ent(const char *name, const char *val)
 	return 1;
 }
 
+void
+print_lex_stats(uls_lex_ptr_t uls)
+{
+	FILE *fp = _uls_stdio_fp(2);
+	uls_stats_t stats;
+	int i;
+
+	if (uls_get_stats(uls, uls_ptr(stats)) < 0) {
+		return;
+	}
+
+	uls_fprintf(fp, "tokens: id=%llu keyword=%llu number=%llu 1char=%llu 2plus=%llu quote=%llu\n",
+		stats.n_toks_id, stats.n_toks_keyw, stats.n_toks_number,
+		stats.n_toks_1char, stats.n_toks_2plus, stats.n_toks_quote);
+	uls_fprintf(fp, "fillbuff: calls=%llu zbuf1-bytes=%llu zbuf2-bytes=%llu\n",
+		stats.n_fillbuff, stats.n_bytes_zbuf1, stats.n_bytes_zbuf2);
+	uls_fprintf(fp, "context: push=%llu pop=%llu\n", stats.n_push, stats.n_pop);
+	uls_fprintf(fp, "refill: reads=%llu sleeps=%llu bytes=%llu\n",
+		stats.n_refill_reads, stats.n_refill_sleeps, stats.n_refill_bytes);
+	uls_fprintf(fp, "keyword: lookups=%llu probes=%llu max-chain=%d\n",
+		stats.n_kw_lookups, stats.n_kw_probes, stats.kw_probe_max);
+
+	uls_fprintf(fp, "keyword-probes:");
+	for (i = 0; i < ULS_STATS_N_PROBE_BINS; i++) {
+		uls_fprintf(fp, " %d%s=%llu", i, i == ULS_STATS_N_PROBE_BINS - 1 ? "+" : "",
+			stats.kw_probe_hist[i]);
+	}
+	uls_fprintf(fp, "\n");
+
+	uls_fprintf(fp, "csz-pool: hits=%llu misses=%llu\n",
+		stats.n_csz_pool_hits, stats.n_csz_pool_misses);
+}
+
 int
 main_ustr(int argc, char *argv[])
 {
@@ -567,6 +623,10 @@ main_ustr(int argc, char *argv[])
 		stat = -1; goto end_1;
 	}
 
+	if (opt_stats) {
+		uls_enable_stats(sam_lex, 1);
+	}
+
 	if (filelist != NULL) {
 		stat = proc_filelist(target_dir);
 
@@ -603,6 +663,10 @@ main_ustr(int argc, char *argv[])
 		}
 	}
 
+	if (opt_stats) {
+		print_lex_stats(sam_lex);
+	}
+
 	uls_destroy(sam_lex);
 
 end_1:
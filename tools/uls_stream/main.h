@@ -33,10 +33,13 @@
 #endif
 
 #define N_TMPLVAL_ARRAY 64
+#define ULSSTREAM_MAX_JOBS 64
 
 extern int uls_endian;
 extern int  opt_verbose, opt_binary;
 extern int  opt_no_numbering;
+extern int  opt_stats;
+extern int  opt_n_jobs;
 
 extern char home_dir[ULS_FILEPATH_MAX+1];
 extern const char *ulc_config, *uld_config, *tag_name;
@@ -51,5 +54,6 @@ extern int exist_name_val_ent(const char *name);
 extern int add_name_val_ent(const char *name, const char *val);
 
 extern uls_lex_ptr_t sam_lex;
+extern void print_lex_stats(uls_lex_ptr_t uls);
 
 #endif
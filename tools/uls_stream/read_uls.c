@@ -163,6 +163,8 @@ dump_uls_file(const char *filepath, FILE *fp_out)
 
 	if ((uls=istr->uls) == uls_nil) {
 		uls = sam_lex;
+	} else if (opt_stats) {
+		uls_enable_stats(uls, 1);
 	}
 
 	if (uls_set_istream(uls, istr, uls_ptr(tmpl_list), 0) < 0) {
@@ -175,6 +177,10 @@ dump_uls_file(const char *filepath, FILE *fp_out)
 		stat = -5; goto end_1;
 	}
 
+	if (opt_stats && uls != sam_lex) {
+		print_lex_stats(uls);
+	}
+
  end_1:
 	uls_destroy_istream(istr);
 
@@ -180,6 +180,31 @@ fi
 
 rm -f $DUMPFILE_TXT2
 rm -f $TMPL_ULSFILE
+
+# conglomerate with -j: the same token sequence as the one in a thread
+echo "checking conglomerate -j ..."
+CGLM_LIST="/tmp/uls_cglm.list"
+CGLM_ULSFILE1="/tmp/uls_cglm_1.uls"
+CGLM_ULSFILE2="/tmp/uls_cglm_2.uls"
+for i in 1 2 3; do
+	echo "input1.txt"
+	echo "tmpl_ex.txt"
+done > $CGLM_LIST
+
+$PROG -C $CGLM_LIST -o $CGLM_ULSFILE1 . 2> /dev/null
+$PROG -C $CGLM_LIST -j 3 -o $CGLM_ULSFILE2 . 2> /dev/null
+$PROG $CGLM_ULSFILE1 > /tmp/uls_cglm_1.txt
+$PROG $CGLM_ULSFILE2 > /tmp/uls_cglm_2.txt
+
+cmdline="diff /tmp/uls_cglm_1.txt /tmp/uls_cglm_2.txt"
+if [ "$opt_verbose" = "yes" ]; then
+	echo "  $cmdline"
+fi
+$cmdline
+if [ $? != 0 ]; then
+	echo "FAIL: conglomerate -j"
+fi
+rm -f $CGLM_LIST $CGLM_ULSFILE1 $CGLM_ULSFILE2 /tmp/uls_cglm_1.txt /tmp/uls_cglm_2.txt
 if [ -f $DFL_OUTPUT_FILE ]; then
 	rm -f $DFL_OUTPUT_FILE
 fi
@@ -534,6 +534,11 @@ uls_lexeme_wstr(uls_lex_ptr_t uls)
 	wchar_t *wlxm;
 	int l_lxm;
 
+	// In the wide mode, the lexeme is already decoded by the lexer.
+	if ((wlxm = (wchar_t *) uls_wlexeme(uls, NULL)) != NULL) {
+		return wlxm;
+	}
+
 	if (wuls->wtokbuf_len < 0) {
 		lxm = uls_lexeme(uls);
 		l_lxm = uls_lexeme_len(uls);
@@ -555,6 +560,11 @@ int
 uls_lexeme_len_wstr(uls_lex_ptr_t uls)
 {
 	uls_wlex_shell_ptr_t wuls = (uls_wlex_shell_ptr_t) uls->shell;
+	int l_wlxm;
+
+	if (uls_wlexeme(uls, &l_wlxm) != NULL) {
+		return l_wlxm;
+	}
 
 	if (wuls->wtokbuf_len < 0)
 		uls_lexeme_wstr(uls);
@@ -570,6 +580,12 @@ uls_tokstr_wstr(uls_lex_ptr_t uls)
 	wchar_t *wlxm;
 	int l_lxm;
 
+	// The tokstr differs from the lexeme only for NUMBER.
+	if (_uls_tok_id(uls) != _uls_toknum_NUMBER(uls) &&
+		(wlxm = (wchar_t *) uls_wlexeme(uls, NULL)) != NULL) {
+		return wlxm;
+	}
+
 	if (wuls->wtokbuf2_len < 0) {
 		lxm = uls_tokstr(uls);
 		l_lxm = uls_tokstr_len(uls);
@@ -587,6 +603,11 @@ int
 uls_tokstr_len_wstr(uls_lex_ptr_t uls)
 {
 	uls_wlex_shell_ptr_t wuls = (uls_wlex_shell_ptr_t) uls->shell;
+	int l_wlxm;
+
+	if (_uls_tok_id(uls) != _uls_toknum_NUMBER(uls) && uls_wlexeme(uls, &l_wlxm) != NULL) {
+		return l_wlxm;
+	}
 
 	if (wuls->wtokbuf2_len < 0) {
 		uls_tokstr_wstr(uls);
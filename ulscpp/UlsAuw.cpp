@@ -104,9 +104,10 @@ UlsAuw::wstr2mbstr(const wchar_t *wstr, int mode, int slot_no)
 // <parm name="mbstr">astr(ANSI) or utf8-string pointer</parm>
 // <parm name="mode">specify the encoding of the input string.</parm>
 // <parm name="slot_no">the index of buffer to be used to convert the input string</parm>
+// <parm name="len">the #-bytes of 'mbstr', -1 if it's terminated by NUL</parm>
 // <return>the converted wide-string</return>
 wchar_t *
-UlsAuw::mbstr2wstr(const char *mbstr, int mode, int slot_no)
+UlsAuw::mbstr2wstr(const char *mbstr, int mode, int slot_no, int len)
 {
 	wchar_t *wstr2;
 
@@ -115,10 +116,10 @@ UlsAuw::mbstr2wstr(const char *mbstr, int mode, int slot_no)
 	}
 
 	if (mode == CVT_MBSTR_USTR) {
-		wstr2 = uls_ustr2wstr(mbstr, -1, auwstr_buf + slot_no);
+		wstr2 = uls_ustr2wstr(mbstr, len, auwstr_buf + slot_no);
 	}
 	else if (mode == CVT_MBSTR_ASTR) {
-		wstr2 = uls_astr2wstr(mbstr, -1, auwstr_buf + slot_no);
+		wstr2 = uls_astr2wstr(mbstr, len, auwstr_buf + slot_no);
 	}
 	else {
 		wstr2 = NULL;
@@ -133,9 +134,10 @@ UlsAuw::mbstr2wstr(const char *mbstr, int mode, int slot_no)
 // <parm name="mbstr">astr(ANSI) or utf8-string pointer</parm>
 // <parm name="mode">specify the encoding of the input string.</parm>
 // <parm name="slot_no">the index of buffer to be used to convert the input string</parm>
+// <parm name="len">the #-bytes of 'mbstr', -1 if it's terminated by NUL</parm>
 // <return>the converted string</return>
 char*
-UlsAuw::mbstr2mbstr(const char *mbstr, int mode, int slot_no)
+UlsAuw::mbstr2mbstr(const char *mbstr, int mode, int slot_no, int len)
 {
 	char *mbstr2;
 
@@ -144,10 +146,10 @@ UlsAuw::mbstr2mbstr(const char *mbstr, int mode, int slot_no)
 	}
 
 	if (mode == CVT_MBSTR_USTR) {
-		mbstr2 = uls_astr2ustr(mbstr, -1, auwstr_buf + slot_no);
+		mbstr2 = uls_astr2ustr(mbstr, len, auwstr_buf + slot_no);
 	}
 	else if (mode == CVT_MBSTR_ASTR) {
-		mbstr2 = uls_ustr2astr(mbstr, -1, auwstr_buf + slot_no);
+		mbstr2 = uls_ustr2astr(mbstr, len, auwstr_buf + slot_no);
 	}
 	else {
 		mbstr2 = NULL;
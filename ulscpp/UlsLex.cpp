@@ -674,6 +674,109 @@ int UlsLexUStr::getLineNum(void)
 	return uls_get_lineno(&lex);
 }
 
+// <brief>
+//   Turns on or off the counters of the lexer.
+// </brief>
+// <parm name="on">true to start counting</parm>
+void UlsLexUStr::enableStats(bool on)
+{
+	uls_enable_stats(&lex, on ? 1 : 0);
+}
+
+// <brief>
+//   Gets the counters of the lexer.
+// </brief>
+// <parm name="stats">the output buffer</parm>
+// <return>0 on success, -1 if the counters are off</return>
+int UlsLexUStr::getStats(uls_stats_t& stats)
+{
+	return uls_get_stats(&lex, &stats);
+}
+
+// <brief>
+//   Turns on or off the interning of identifiers.
+// </brief>
+// <parm name="on">true to intern</parm>
+void UlsLexUStr::enableIntern(bool on)
+{
+	uls_enable_intern(&lex, on ? 1 : 0);
+}
+
+// <brief>
+//   The atom-id of the current token.
+// </brief>
+// <return>atom-id, 0 if none</return>
+int UlsLexUStr::getTokAtom(void)
+{
+	return uls_tok_atom(&lex);
+}
+
+// <brief>
+//   The string of an atom.
+// </brief>
+// <parm name="atom_id">atom-id</parm>
+// <parm name="ptr_len">the length of the string</parm>
+// <return>the string or NULL</return>
+const char *UlsLexUStr::getAtomStr(int atom_id, int *ptr_len)
+{
+	return uls_atom_str(&lex, atom_id, ptr_len);
+}
+
+// <brief>
+//   Consumes the filtered text while the chars are of the classes in 'chMask'.
+// </brief>
+// <parm name="chMask">ULS_CH_ID, ULS_CH_IDFIRST, ..., or 0 for the spaces</parm>
+// <parm name="span">the consumed text</parm>
+// <return>the length of 'span'</return>
+int UlsLexUStr::scanFilteredWhile(int chMask, const char*& span)
+{
+	uls_outparam_t parms;
+	int len;
+
+	len = uls_scan_filtered_while(&lex, chMask, &parms);
+	span = parms.lptr;
+
+	return len;
+}
+
+// <brief>
+//   Consumes the filtered text until a char in 'charset' appears.
+// </brief>
+// <parm name="charset">a set of ASCII chars</parm>
+// <parm name="span">the consumed text</parm>
+// <return>the length of 'span'</return>
+int UlsLexUStr::scanFilteredUntil(const char *charset, const char*& span)
+{
+	uls_outparam_t parms;
+	int len;
+
+	len = uls_scan_filtered_until(&lex, charset, &parms);
+	span = parms.lptr;
+
+	return len;
+}
+
+// <brief>
+//   Consumes the filtered text up to and including 'delim'.
+// </brief>
+// <parm name="delim">the delimiter</parm>
+// <parm name="span">the text before 'delim'</parm>
+// <parm name="found">whether 'delim' is found</parm>
+// <return>the length of 'span'</return>
+int UlsLexUStr::takeFilteredUntil(const char *delim, const char*& span, bool& found)
+{
+	uls_outparam_t parms;
+	int len;
+
+	parms.lptr = NULL;
+	parms.flags = 0;
+	len = uls_take_filtered_until(&lex, delim, &parms);
+	span = parms.lptr;
+	found = parms.flags != 0;
+
+	return len;
+}
+
 // <brief>
 //   Sets the log level of the object, UlsLexUStr.
 //   The possible 'loglvl' are ULS_LOG_EMERG, ULS_LOG_ALERT, ULS_LOG_CRIT, ...
@@ -842,6 +945,54 @@ void UlsLexUStr::setFd(int fd, int flags)
 	uls_set_lineno(&lex, 1);
 }
 
+// <brief>
+//   This method pushes an input in push-mode on the internal stack.
+//   The bytes of it are given by feed() as they arrive.
+// </brief>
+// <parm name="flags">ULS_WANT_EOFTOK or ULS_NO_EOFTOK</parm>
+void UlsLexUStr::pushFeed(int flags)
+{
+	if (flags < 0) {
+		flags = getInputOpts();
+	}
+
+	uls_push_feed(&lex, flags);
+}
+
+void UlsLexUStr::setFeed(int flags)
+{
+	if (flags < 0) {
+		flags = getInputOpts();
+	}
+
+	uls_set_feed(&lex, flags);
+}
+
+// <brief>
+//   Appends the bytes to the input in push-mode.
+//   The tokens, comments and quote-strings may be split across the calls.
+// </brief>
+// <parm name="bytes">the next chunk of the input</parm>
+// <parm name="len">the length of 'bytes'</parm>
+// <return>false if there's no input in push-mode or it's ended</return>
+bool UlsLexUStr::feed(const char *bytes, int len)
+{
+	return uls_feed(&lex, bytes, len) >= 0;
+}
+
+bool UlsLexUStr::feedEnd(void)
+{
+	return uls_feed_end(&lex) >= 0;
+}
+
+// <brief>
+//   Checks if the last getTok() returned for lack of the bytes fed.
+// </brief>
+bool UlsLexUStr::isStarved(void)
+{
+	return uls_is_starved(&lex) ? true : false;
+}
+
 // <brief>
 //   This method will push the input-file on the top of the input stack.
 // </brief>
@@ -1048,7 +1199,39 @@ UlsLexUStr::getTokUtf8Str(int *ptr_ulen)
 void
 UlsLexUStr::getTokStr(string& lxm)
 {
-	lxm = getTokUtf8Str();
+	UlsToken tok;
+
+	getToken(tok);
+	lxm.assign(tok.lxm, tok.lxm_len);
+}
+
+void
+UlsLexUStr::getToken(UlsToken& tok)
+{
+	tok.tok_id = uls_tok(&lex);
+	tok.lxm = getTokUtf8Str(&tok.lxm_len);
+	// The NUMBER lexeme is in the normalized form of uls_tokstr().
+	tok.n_wchars = (tok.tok_id == toknum_NUMBER) ? tok.lxm_len : uls_lexeme_wlen(&lex);
+	tok.lineno = uls_get_lineno(&lex);
+}
+
+UlsTokenRange::iterator::iterator(UlsLexUStr *lex)
+	: lex(lex)
+{
+	if (lex != NULL) advance();
+}
+
+void
+UlsTokenRange::iterator::advance(void)
+{
+	int t = lex->next();
+
+	if (t == lex->toknum_EOI || t == lex->toknum_ERR) {
+		lex = NULL;
+		return;
+	}
+
+	lex->getToken(tok);
 }
 
 int
@@ -1796,11 +1979,12 @@ UlsLexAWStr::setTag(const char *afname)
 void
 UlsLexAWStr::getTokStr(string& alxm)
 {
-	const char *ustr = getTokUtf8Str();
+	UlsToken tok;
 	const char *astr;
 
-	_ULSCPP_USTR2ASTR(ustr, astr, 0);
-	alxm = astr;
+	getToken(tok);
+	_ULSCPP_NUSTR2ASTR(tok.lxm, tok.lxm_len, astr, 0);
+	alxm.assign(astr, _ULSCPP_AUWCVT_LEN(0));
 }
 
 void
@@ -2288,11 +2472,12 @@ UlsLexAWStr::setTag(const wstring& fname)
 void
 UlsLexAWStr::getTokStr(wstring& wlxm)
 {
-	const char *ustr = getTokUtf8Str();
+	UlsToken tok;
 	const wchar_t *wstr;
 
-	_ULSCPP_USTR2WSTR(ustr, wstr, 0);
-	wlxm = wstr;
+	getToken(tok);
+	_ULSCPP_NUSTR2WSTR(tok.lxm, tok.lxm_len, wstr, 0);
+	wlxm.assign(wstr, _ULSCPP_AUWCVT_LEN(0) / sizeof(wchar_t));
 }
 
 void
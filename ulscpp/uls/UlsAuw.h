@@ -101,13 +101,14 @@ namespace uls {
 		// specify the encoding of the output string in case of wstr2mbstr.
 		// </parm>
 		// <parm name="slot_no">the index of buffer to be used to convert the input string</parm>
+		// <parm name="len">the #-bytes of 'mbstr', which needn't be terminated by NUL if it's given</parm>
 		// <return>
 		//  the converted string
 		//   It refers the string in the buffer in auwstr_buf[]
 		// </return>
 		char *wstr2mbstr(const wchar_t *wstr, int mode, int slot_no);
-		wchar_t *mbstr2wstr(const char *mbstr, int mode, int slot_no);
-		char *mbstr2mbstr(const char *mbstr, int mode, int slot_no);
+		wchar_t *mbstr2wstr(const char *mbstr, int mode, int slot_no, int len=-1);
+		char *mbstr2mbstr(const char *mbstr, int mode, int slot_no, int len=-1);
 
 		// <brief>
 		// return the #-bytes in the internal buffer specified by 'slot_no'
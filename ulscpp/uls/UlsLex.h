@@ -42,6 +42,9 @@
 
 #include <string>
 #include <map>
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
 
 namespace uls {
 	typedef uls_mutex_t MutexType;
@@ -191,6 +194,68 @@ namespace uls {
 #undef _ULS_NAME_IF1
 #undef _ULS_NAME_IF2
 
+		class UlsLexUStr;
+
+		// <brief>
+		//   A token of the lexer without a copy of its lexeme.
+		//   The 'lxm' points to the utf-8 lexeme in the internal buffer of the lexer,
+		//     which is valid only until the next call of getTok().
+		// </brief>
+		struct UlsToken {
+			int tok_id;
+			const char *lxm;
+			int lxm_len, n_wchars;
+			int lineno;
+
+			std::string str(void) const {
+				return std::string(lxm, lxm_len);
+			}
+#if __cplusplus >= 201703L
+			std::string_view view(void) const {
+				return std::string_view(lxm, lxm_len);
+			}
+#endif
+#ifdef __cpp_char8_t
+			std::u8string_view u8view(void) const {
+				return std::u8string_view(reinterpret_cast<const char8_t *>(lxm), lxm_len);
+			}
+#endif
+		};
+
+		// <brief>
+		//   The tokens of a lexer as an input range: for (const UlsToken& t : lex.tokens()) { ... }
+		//   Each step calls getTok() of the lexer and nothing is allocated.
+		//   The range ends at EOI or ERR, which is not yielded. Check getTokNum() after the loop for ERR.
+		// </brief>
+		class ULSCPP_DLL_EXTERN UlsTokenRange {
+			UlsLexUStr *lex;
+
+		public:
+			class ULSCPP_DLL_EXTERN iterator {
+				UlsLexUStr *lex; // NULL at the end
+				UlsToken tok;
+				void advance(void);
+
+			public:
+				iterator(UlsLexUStr *lex);
+
+				const UlsToken& operator*() const { return tok; }
+				const UlsToken* operator->() const { return &tok; }
+				iterator& operator++() {
+					advance();
+					return *this;
+				}
+
+				bool operator==(const iterator& other) const { return lex == other.lex; }
+				bool operator!=(const iterator& other) const { return lex != other.lex; }
+			};
+
+			UlsTokenRange(UlsLexUStr *lex) : lex(lex) {}
+
+			iterator begin(void) { return iterator(lex); }
+			iterator end(void) { return iterator(NULL); }
+		};
+
 		// <brief>
 		//   This is the main class of ulscpp library.
 		//   You can instantiate this class with a parameter representing lexical configuration.
@@ -359,6 +424,62 @@ namespace uls {
 			// <return>the current line number</return>
 			int getLineNum(void);
 
+			// <brief>
+			//   Turns on or off the counters of the lexer, which are off by default.
+			// </brief>
+			// <parm name="on">true to start counting, false to stop</parm>
+			void enableStats(bool on);
+
+			// <brief>
+			//   Copies the counters accumulated since enableStats(true) into 'stats'.
+			// </brief>
+			// <parm name="stats">the output buffer</parm>
+			// <return>0 on success, -1 if the counters are off</return>
+			int getStats(uls_stats_t& stats);
+
+			// <brief>
+			//   Turns on or off the interning of identifiers.
+			//   While on, each distinct identifier gets a stable atom-id, which is 1-based and dense.
+			// </brief>
+			// <parm name="on">true to intern the identifiers</parm>
+			void enableIntern(bool on);
+
+			// <brief>
+			//   The atom-id of the current ID or keyword token, 0 if it's not interned.
+			// </brief>
+			// <return>atom-id</return>
+			int getTokAtom(void);
+
+			// <brief>
+			//   The spelling of the atom 'atom_id', which is valid while interning is on.
+			// </brief>
+			// <parm name="atom_id">an atom-id from getTokAtom()</parm>
+			// <parm name="ptr_len">the length of the string, if not NULL</parm>
+			// <return>the string, NULL if 'atom_id' is invalid</return>
+			const char *getAtomStr(int atom_id, int *ptr_len = NULL);
+
+			// <brief>
+			//   Consumes the filtered text while the chars are of the classes in 'chMask',
+			//     or until a char in 'charset' appears, not char by char.
+			//   The filtered text is what the tokenizer reads, with the comments removed and the spaces collapsed.
+			//   The 'span' points to the consumed text, which is valid until the next call of the object.
+			//   It stops before a quote-string or at EOF.
+			// </brief>
+			// <parm name="chMask">ULS_CH_ID, ULS_CH_IDFIRST, ..., or 0 for the spaces</parm>
+			// <parm name="charset">a set of ASCII chars</parm>
+			// <parm name="span">the consumed text</parm>
+			// <return>the length of 'span', -1 on error</return>
+			int scanFilteredWhile(int chMask, const char*& span);
+			int scanFilteredUntil(const char *charset, const char*& span);
+
+			// <brief>
+			//   Consumes the filtered text up to and including 'delim', setting 'span' to the text before it.
+			//   The 'found' is false if the text ended without 'delim'.
+			// </brief>
+			// <parm name="delim">the delimiter such as "-->"</parm>
+			// <return>the length of 'span', -1 on error</return>
+			int takeFilteredUntil(const char *delim, const char*& span, bool& found);
+
 			// <brief>
 			//   Changes the literal-string analyzer to 'proc'.
 			//   The 'proc' will be applied to the quote type starting with 'pfx'.
@@ -427,6 +548,16 @@ namespace uls {
 			void pushFd(int fd, int flags = -1);
 			void setFd(int fd, int flags = -1);
 
+			// <brief>
+			//   The input in push-mode, fed by feed() and ended by feedEnd().
+			//   getTok() returns the NONE-token and isStarved() is true while it waits for more bytes.
+			// </brief>
+			void pushFeed(int flags = -1);
+			void setFeed(int flags = -1);
+			bool feed(const char *bytes, int len);
+			bool feedEnd(void);
+			bool isStarved(void);
+
 			// <brief>
 			//   Skips the white chars.
 			//   The white chars are to be defined by the spec. written by user
@@ -482,6 +613,25 @@ namespace uls {
 			virtual const char *getTokUtf8Str(int *ptr_ulen = NULL) override;
 			virtual void getTokStr(std::string& lxm) override;
 
+			// <brief>
+			//   Fills 'tok' with the current token, its line and the pointer to the lexeme, not a copy of it.
+			//   tokens() is the range of the tokens from the next one to the end of input.
+			//   getTokView() is the view of the current utf-8 lexeme.
+			//   They are valid only until the next call of getTok().
+			// </brief>
+			// <parm name="tok">the output token</parm>
+			void getToken(UlsToken& tok);
+			UlsTokenRange tokens(void) {
+				return UlsTokenRange(this);
+			}
+#if __cplusplus >= 201703L
+			std::string_view getTokView(void) {
+				int len;
+				const char *lxm = getTokUtf8Str(&len);
+				return std::string_view(lxm, len);
+			}
+#endif
+
 			// <brief>
 			//   Returns the current token id in the object obtained by getTok().
 			//   It is the same as the return value of getTok().
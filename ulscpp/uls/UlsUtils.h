@@ -109,6 +109,10 @@ namespace uls {
 	wstr = auwcvt.mbstr2wstr(ustr, UlsAuw::CVT_MBSTR_USTR, slot_no); \
 	if (!wstr) throw invalid_argument(string("invalid string encodeing")); \
 	} while (0)
+#define _ULSCPP_NUSTR2WSTR(ustr, ulen, wstr, slot_no) do { \
+	wstr = auwcvt.mbstr2wstr(ustr, UlsAuw::CVT_MBSTR_USTR, slot_no, ulen); \
+	if (!wstr) throw invalid_argument(string("invalid string encodeing")); \
+	} while (0)
 #define _ULSCPP_WSTR2USTR(wstr, ustr, slot_no) do { \
 	ustr = auwcvt.wstr2mbstr(wstr, UlsAuw::CVT_MBSTR_USTR, slot_no); \
 	if (!ustr) throw invalid_argument(string("invalid string encodeing")); \
@@ -131,4 +135,8 @@ namespace uls {
 	astr = auwcvt.mbstr2mbstr(ustr, UlsAuw::CVT_MBSTR_ASTR, slot_no); \
 	if (!astr) throw invalid_argument(string("invalid string encodeing")); \
 	} while (0)
+#define _ULSCPP_NUSTR2ASTR(ustr, ulen, astr, slot_no) do { \
+	astr = auwcvt.mbstr2mbstr(ustr, UlsAuw::CVT_MBSTR_ASTR, slot_no, ulen); \
+	if (!astr) throw invalid_argument(string("invalid string encodeing")); \
+	} while (0)
 #endif // _ULSCPP_IMPLDLL